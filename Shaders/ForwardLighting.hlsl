@@ -20,6 +20,7 @@
 #define PS_OUTPUT_MOTION_VECTORS    (OUTPUT_MOTION_VECTORS)
 
 #include "Lighting.hlsl"
+#include "VertexAttributes.hlsl"
 
 
 
@@ -31,8 +32,8 @@
 struct VSInput
 {
 	float3 position : POSITION;
-	float3 normal   : NORMAL;
-	float3 tangent  : TANGENT;
+	VERTEX_NORMAL_TYPE  normal  : NORMAL;
+	VERTEX_TANGENT_TYPE tangent : TANGENT;
 	float2 uv       : TEXCOORD0;
 #if INSTANCED_DRAW
 	uint instanceID : SV_InstanceID;
@@ -207,8 +208,8 @@ PSInput VSMain(VSInput vertex)
 		vertex.instanceID,
 #endif
 		vertex.position,
-		vertex.normal,
-		vertex.tangent,
+		UnpackVertexNormal(vertex.normal),
+		UnpackVertexTangent(vertex.normal, vertex.tangent),
 		vertex.uv
 	);
 }
@@ -21,6 +21,7 @@
 
 #define VQ_GPU 1
 #include "LightingConstantBufferData.h"
+#include "VertexAttributes.hlsl"
 
 struct VSInput
 {
@@ -18,12 +18,13 @@
 
 #define VQ_GPU 1
 #include "LightingConstantBufferData.h"
+#include "VertexAttributes.hlsl"
 
 
 struct VSInput
 {
 	float3 position : POSITION;
-	float3 normal   : NORMAL;
+	VERTEX_NORMAL_TYPE normal : NORMAL;
 	float2 uv       : TEXCOORD0;
 #if INSTANCED_DRAW
 	uint instanceID : SV_InstanceID;
@@ -149,7 +150,7 @@ PSInput VSMain(VSInput VSIn)
 		VSIn.instanceID,
 	#endif
 		VSIn.position,
-		VSIn.normal,
+		UnpackVertexNormal(VSIn.normal),
 		0.0.xxx,
 		VSIn.uv
 	);
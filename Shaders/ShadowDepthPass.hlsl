@@ -18,6 +18,7 @@
 
 #define VQ_GPU 1
 #include "LightingConstantBufferData.h"
+#include "VertexAttributes.hlsl"
 
 struct VSInput
 {
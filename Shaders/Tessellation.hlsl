@@ -144,11 +144,11 @@ bool ShouldCullBackFace(float4 ClipPos0, float4 ClipPos1, float4 ClipPos2, float
 struct VSInput_Tess
 {
 	float3 position           : POSITION;
-#if CONTROL_POINT_NORMAL_DATA // for tri
-	float3 normal             : NORMAL;
+#if CONTROL_POINT_NORMAL_DATA || (CONTROL_POINT_TANGENT_DATA && PACKED_VERTEX_ATTRIBUTES == 1) // for tri, packed1 stores tangent.x in normal.w
+	VERTEX_NORMAL_TYPE  normal  : NORMAL;
 #endif
 #if CONTROL_POINT_TANGENT_DATA // for tri + lines
-	float3 tangent            : TANGENT;
+	VERTEX_TANGENT_TYPE tangent : TANGENT;
 #endif
 	float2 uv                 : TEXCOORD0;
 #if INSTANCED_DRAW
@@ -316,10 +316,14 @@ HSInput VSMain_Tess(VSInput_Tess vertex /*control point*/)
 	o.WorldSpacePosition = mul(matW, LocalSpacePosition).xyz;
 	o.uv = vertex.uv;
 #if CONTROL_POINT_NORMAL_DATA
-	o.LocalSpaceNormal = vertex.normal;
+	o.LocalSpaceNormal = UnpackVertexNormal(vertex.normal);
 #endif
 #if CONTROL_POINT_TANGENT_DATA
-	o.LocalSpaceTangent = vertex.tangent;
+	#if PACKED_VERTEX_ATTRIBUTES == 1
+	o.LocalSpaceTangent = UnpackVertexTangent(vertex.normal, vertex.tangent);
+	#else
+	o.LocalSpaceTangent = UnpackVertexTangent((VERTEX_NORMAL_TYPE)0, vertex.tangent);
+	#endif
 #endif
 #if INSTANCED_DRAW
 	o.instanceID = vertex.instanceID;
@@ -0,0 +1,67 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+
+#ifndef _VERTEX_ATTRIBUTES_H
+#define _VERTEX_ATTRIBUTES_H
+
+// Packed vertex formats of the imported meshes (see VertexQuantization.h), the input layout
+// of the PSO provides the attributes as UNORM:
+//
+//  PACKED_VERTEX_ATTRIBUTES == 1 : FVertexWithNormalAndTangentPacked1
+//      NORMAL  : RGBA16 = (normal.xyz, tangent.x)
+//      TANGENT : RG16   = tangent.yz
+//  PACKED_VERTEX_ATTRIBUTES == 2 : FVertexWithNormalAndTangentPacked2
+//      NORMAL  : RGB10A2 = normal.xyz
+//      TANGENT : RGB10A2 = tangent.xyz
+//
+// Texture coordinates are RG16 in both, remapped to the mesh's UV bounds. The remap is folded
+// into the uv scale & bias constants, hence the uvs are used as-is.
+//
+#ifndef PACKED_VERTEX_ATTRIBUTES
+#define PACKED_VERTEX_ATTRIBUTES 0
+#endif
+
+#if PACKED_VERTEX_ATTRIBUTES
+	#define VERTEX_NORMAL_TYPE  float4
+	#define VERTEX_TANGENT_TYPE float4
+#else
+	#define VERTEX_NORMAL_TYPE  float3
+	#define VERTEX_TANGENT_TYPE float3
+#endif
+
+inline float3 UnpackVertexNormal(VERTEX_NORMAL_TYPE Normal)
+{
+#if PACKED_VERTEX_ATTRIBUTES
+	return Normal.xyz * 2.0f - 1.0f;
+#else
+	return Normal;
+#endif
+}
+
+inline float3 UnpackVertexTangent(VERTEX_NORMAL_TYPE Normal, VERTEX_TANGENT_TYPE Tangent)
+{
+#if PACKED_VERTEX_ATTRIBUTES == 1
+	return float3(Normal.w, Tangent.xy) * 2.0f - 1.0f;
+#elif PACKED_VERTEX_ATTRIBUTES == 2
+	return Tangent.xyz * 2.0f - 1.0f;
+#else
+	return Tangent;
+#endif
+}
+
+#endif // _VERTEX_ATTRIBUTES_H
@@ -0,0 +1,526 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+
+#include "AssetCache.h"
+#include "GPUMarker.h"
+#include "Scene/Scene.h"
+#include "Scene/Serialization.h"
+
+#include "../Renderer/Renderer.h"
+
+#include "Libs/VQUtils/Include/Log.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+
+static bool IsRendererOwnedTexture(StringID Path) { return StringInterner::GetString(Path).rfind("Procedural/", 0) == 0; }
+
+static std::array<TextureID, 9> GetMaterialTextures(const Material& mat)
+{
+	return {
+		  mat.TexDiffuseMap
+		, mat.TexNormalMap
+		, mat.TexEmissiveMap
+		, mat.TexAlphaMaskMap
+		, mat.TexMetallicMap
+		, mat.TexRoughnessMap
+		, mat.TexOcclusionRoughnessMetalnessMap
+		, mat.TexAmbientOcclusionMap
+		, mat.TexHeightMap
+	};
+}
+
+// returns true when the last reference is dropped
+template<class TKey> static bool ReleaseRef(std::unordered_map<TKey, uint>& Refs, TKey Key)
+{
+	auto it = Refs.find(Key);
+	if (it == Refs.end())
+		return false;
+	if (--it->second > 0)
+		return false;
+	Refs.erase(it);
+	return true;
+}
+
+
+AssetCache::AssetCache(VQRenderer& Renderer)
+	: mRenderer(Renderer)
+{}
+
+//----------------------------------------------------------------------------------------------------------------
+// TEXTURES
+//----------------------------------------------------------------------------------------------------------------
+void AssetCache::AcquireTexture(TextureID ID, StringID Path)
+{
+	std::lock_guard<std::mutex> lk(mMtx);
+	AcquireTexture_NoLock(ID, Path);
+}
+
+void AssetCache::AcquireTexture_NoLock(TextureID ID, StringID Path)
+{
+	if (IsRendererOwnedTexture(Path))
+		return;
+
+	FTextureEntry& Entry = mTextures[ID];
+	if (Entry.Path == EMPTY_STRING_ID)
+	{
+		Entry.Path = Path;
+		Entry.NumBytes = mRenderer.GetTextureManager().GetTextureAllocationSize(ID);
+	}
+	else if (Entry.RefCount == 0)
+	{
+		++mStats.NumReusedTextures;
+	}
+	++Entry.RefCount;
+}
+
+void AssetCache::ReleaseTextures(const std::vector<TextureID>& IDs)
+{
+	SCOPED_CPU_MARKER("AssetCache::ReleaseTextures()");
+	std::vector<TextureID> TexturesToDestroy;
+	{
+		std::lock_guard<std::mutex> lk(mMtx);
+		for (TextureID ID : IDs)
+			ReleaseTexture_NoLock(ID, TexturesToDestroy);
+	}
+	mRenderer.GetTextureManager().DestroyTextures(TexturesToDestroy);
+}
+
+void AssetCache::AddPreloadedTexture(TextureID ID, StringID Path)
+{
+	if (IsRendererOwnedTexture(Path))
+		return;
+
+	std::lock_guard<std::mutex> lk(mMtx);
+	mPreloadedTexturePaths.insert(Path);
+	FTextureEntry& Entry = mTextures[ID];
+	if (Entry.Path == EMPTY_STRING_ID) // otherwise it's already resident: referenced by the running scene or retained
+	{
+		Entry.Path = Path;
+		Entry.NumBytes = mRenderer.GetTextureManager().GetTextureAllocationSize(ID);
+		Entry.ReleaseSeq = ++mReleaseSeq;
+	}
+}
+
+void AssetCache::ReleaseTexture_NoLock(TextureID ID, std::vector<TextureID>& TexturesToDestroy)
+{
+	auto it = mTextures.find(ID);
+	if (it == mTextures.end() || it->second.RefCount == 0)
+	{
+		TexturesToDestroy.push_back(ID);
+		if (it != mTextures.end())
+			mTextures.erase(it);
+		return;
+	}
+	if (--it->second.RefCount == 0)
+	{
+		it->second.ReleaseSeq = ++mReleaseSeq;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------------------
+// MODELS
+//----------------------------------------------------------------------------------------------------------------
+void AssetCache::RetainModels(Scene* pScene)
+{
+	SCOPED_CPU_MARKER("AssetCache::RetainModels()");
+	std::lock_guard<std::mutex> lkPaths(pScene->mMtxTexturePaths); // same lock order as DoAssignments()
+	std::lock_guard<std::mutex> lk(mMtx);
+	for (const Model& model : pScene->mModels)
+	{
+		// builtin mesh models are created by the scene itself & models still loading aren't complete
+		if (model.mModelPath.empty() || !model.mbLoaded)
+			continue;
+		const StringID ModelPath = StringInterner::Intern(model.mModelPath);
+		if (mModels.find(ModelPath) != mModels.end())
+			continue;
+
+		FRetainedModel Entry;
+		Entry.ModelName = model.mModelName;
+		std::unordered_map<MeshID, int> MeshIndices;
+		std::unordered_map<MaterialID, int> MaterialIndices;
+		for (int iType = 0; iType < Model::Data::NUM_MESH_TYPES; ++iType)
+		{
+			const Model::Data::EMeshType eType = static_cast<Model::Data::EMeshType>(iType);
+			for (const auto& [meshID, matID] : model.mData.GetMeshMaterialIDPairs(eType))
+			{
+				auto itMesh = MeshIndices.find(meshID);
+				if (itMesh == MeshIndices.end())
+				{
+					itMesh = MeshIndices.emplace(meshID, static_cast<int>(Entry.Meshes.size())).first;
+					const Mesh& mesh = pScene->GetMesh(meshID);
+					for (int lod = 0; lod < (int)mesh.GetNumLODs(); ++lod)
+					{
+						const std::pair<BufferID, BufferID> VBIB = mesh.GetIABufferIDs(lod);
+						++mBufferRefs[VBIB.first];
+						++mBufferRefs[VBIB.second];
+					}
+					Entry.Meshes.push_back(mesh);
+				}
+
+				auto itMat = MaterialIndices.find(matID);
+				if (itMat == MaterialIndices.end())
+				{
+					itMat = MaterialIndices.emplace(matID, static_cast<int>(Entry.Materials.size())).first;
+					const Material& mat = pScene->GetMaterial(matID);
+					if (mat.SRVMaterialMaps != INVALID_ID) ++mSRVRefs[mat.SRVMaterialMaps];
+					if (mat.SRVHeightMap    != INVALID_ID) ++mSRVRefs[mat.SRVHeightMap];
+					for (TextureID TexID : GetMaterialTextures(mat))
+					{
+						auto itPath = pScene->mTexturePaths.find(TexID);
+						if (TexID == INVALID_ID || itPath == pScene->mTexturePaths.end() || IsRendererOwnedTexture(itPath->second))
+							continue;
+						if (std::find(Entry.Textures.begin(), Entry.Textures.end(), TexID) != Entry.Textures.end())
+							continue;
+						AcquireTexture_NoLock(TexID, itPath->second);
+						++mTextures.at(TexID).NumModelRefs;
+						Entry.Textures.push_back(TexID);
+					}
+					Entry.Materials.emplace_back(StringInterner::Intern(pScene->GetMaterialName(matID)), mat);
+				}
+
+				Entry.Data.AddMesh(itMesh->second, itMat->second, eType);
+			}
+		}
+
+		Entry.ReleaseSeq = ++mReleaseSeq;
+		mModels.emplace(ModelPath, std::move(Entry));
+		++mStats.NumRetainedModels;
+	}
+}
+
+ModelID AssetCache::RestoreModel(Scene* pScene, StringID ModelPath, const std::string& ModelName)
+{
+	SCOPED_CPU_MARKER("AssetCache::RestoreModel()");
+	FRetainedModel Entry;
+	{
+		std::lock_guard<std::mutex> lk(mMtx);
+		auto it = mModels.find(ModelPath);
+		if (it == mModels.end())
+			return INVALID_ID;
+		Entry = std::move(it->second);
+		mModels.erase(it);
+	}
+
+	// the meshes keep their buffers & their references until the scene unloads, see ReleaseSceneReferences()
+	std::vector<MeshID> MeshIDs(Entry.Meshes.size());
+	for (size_t i = 0; i < Entry.Meshes.size(); ++i)
+		MeshIDs[i] = pScene->AddMesh(Entry.Meshes[i]);
+
+	// materials are shared by name: a material that already exists in the scene wins over the retained one
+	std::vector<MaterialID> MaterialIDs(Entry.Materials.size());
+	std::vector<SRV_ID> SRVsToRelease;
+	std::unordered_set<SRV_ID> AdoptedSRVs;
+	{
+		std::lock_guard<std::mutex> lk(pScene->mMtx_Materials);
+		for (size_t i = 0; i < Entry.Materials.size(); ++i)
+		{
+			const auto& [MaterialName, RetainedMaterial] = Entry.Materials[i];
+			auto itID = pScene->mMaterialIDs.find(MaterialName);
+			if (itID == pScene->mMaterialIDs.end())
+			{
+				const MaterialID id = pScene->mMaterials.Insert(RetainedMaterial);
+				pScene->mLoadedMaterials.emplace(id);
+				pScene->mMaterialNames[id] = MaterialName;
+				pScene->mMaterialIDs[MaterialName] = id;
+				MaterialIDs[i] = id;
+				AdoptedSRVs.insert(RetainedMaterial.SRVMaterialMaps);
+				AdoptedSRVs.insert(RetainedMaterial.SRVHeightMap);
+			}
+			else
+			{
+				MaterialIDs[i] = itID->second;
+				const Material& SceneMaterial = *pScene->mMaterials.Get(itID->second);
+				AdoptedSRVs.insert(SceneMaterial.SRVMaterialMaps); // restored by another model sharing the material
+				AdoptedSRVs.insert(SceneMaterial.SRVHeightMap);
+			}
+			SRVsToRelease.push_back(RetainedMaterial.SRVMaterialMaps);
+			SRVsToRelease.push_back(RetainedMaterial.SRVHeightMap);
+		}
+	}
+
+	// the scene takes over the texture references it doesn't already hold
+	std::vector<TextureID> TexturesToRelease;
+	{
+		std::lock_guard<std::mutex> lkPaths(pScene->mMtxTexturePaths);
+		std::lock_guard<std::mutex> lk(mMtx);
+		for (TextureID TexID : Entry.Textures)
+		{
+			FTextureEntry& Texture = mTextures.at(TexID);
+			--Texture.NumModelRefs;
+			if (!pScene->mTexturePaths.emplace(TexID, Texture.Path).second)
+				TexturesToRelease.push_back(TexID);
+		}
+	}
+
+	std::vector<SRV_ID> SRVsToDestroy;
+	std::vector<TextureID> TexturesToDestroy;
+	{
+		std::lock_guard<std::mutex> lk(mMtx);
+		for (const Mesh& mesh : Entry.Meshes)
+		{
+			for (int lod = 0; lod < (int)mesh.GetNumLODs(); ++lod)
+			{
+				const std::pair<BufferID, BufferID> VBIB = mesh.GetIABufferIDs(lod);
+				mSceneBufferRefs.push_back(VBIB.first);
+				mSceneBufferRefs.push_back(VBIB.second);
+			}
+		}
+		for (SRV_ID SRV : SRVsToRelease)
+		{
+			if (AdoptedSRVs.find(SRV) != AdoptedSRVs.end())
+				mSceneSRVRefs.push_back(SRV);
+			else if (ReleaseRef(mSRVRefs, SRV))
+				SRVsToDestroy.push_back(SRV);
+		}
+		for (TextureID TexID : TexturesToRelease)
+			ReleaseTexture_NoLock(TexID, TexturesToDestroy);
+		++mStats.NumRestoredModels;
+	}
+	mRenderer.DestroySRVs(SRVsToDestroy);
+	assert(TexturesToDestroy.empty()); // the scene holds a reference to each of them
+
+	Model::Data Data;
+	for (int iType = 0; iType < Model::Data::NUM_MESH_TYPES; ++iType)
+	{
+		const Model::Data::EMeshType eType = static_cast<Model::Data::EMeshType>(iType);
+		for (const auto& [iMesh, iMat] : Entry.Data.GetMeshMaterialIDPairs(eType))
+			Data.AddMesh(MeshIDs[iMesh], MaterialIDs[iMat], eType);
+	}
+
+	ModelID mID = pScene->CreateModel();
+	Model& model = pScene->GetModel(mID);
+	model = Model(StringInterner::GetString(ModelPath), ModelName, std::move(Data));
+	return mID;
+}
+
+bool AssetCache::HasModel(StringID ModelPath) const
+{
+	std::lock_guard<std::mutex> lk(mMtx);
+	return mModels.find(ModelPath) != mModels.end();
+}
+
+bool AssetCache::IsBufferRetained(BufferID ID) const
+{
+	std::lock_guard<std::mutex> lk(mMtx);
+	return mBufferRefs.find(ID) != mBufferRefs.end();
+}
+
+bool AssetCache::IsSRVRetained(SRV_ID ID) const
+{
+	std::lock_guard<std::mutex> lk(mMtx);
+	return mSRVRefs.find(ID) != mSRVRefs.end();
+}
+
+void AssetCache::ReleaseSceneReferences()
+{
+	// the scene destroys what's no longer retained after this
+	std::lock_guard<std::mutex> lk(mMtx);
+	for (BufferID ID : mSceneBufferRefs)
+		ReleaseRef(mBufferRefs, ID);
+	for (SRV_ID ID : mSceneSRVRefs)
+		ReleaseRef(mSRVRefs, ID);
+	mSceneBufferRefs.clear();
+	mSceneSRVRefs.clear();
+}
+
+//----------------------------------------------------------------------------------------------------------------
+// RETENTION
+//----------------------------------------------------------------------------------------------------------------
+void AssetCache::SetKeepSet(const FSceneRepresentation& NextScene)
+{
+	std::lock_guard<std::mutex> lk(mMtx);
+	mKeepModelPaths.clear();
+	mKeepTexturePaths.clear();
+	for (const FGameObjectRepresentation& ObjRep : NextScene.Objects)
+	{
+		if (!ObjRep.ModelFilePath.empty())
+			mKeepModelPaths.insert(StringInterner::Intern(ObjRep.ModelFilePath));
+	}
+	for (const FMaterialRepresentation& MatRep : NextScene.Materials)
+	{
+		for (const std::string* pPath : { &MatRep.DiffuseMapFilePath, &MatRep.NormalMapFilePath, &MatRep.EmissiveMapFilePath, &MatRep.AlphaMaskMapFilePath
+			, &MatRep.MetallicMapFilePath, &MatRep.RoughnessMapFilePath, &MatRep.AOMapFilePath, &MatRep.HeightMapFilePath })
+		{
+			if (!pPath->empty())
+				mKeepTexturePaths.insert(StringInterner::Intern(*pPath));
+		}
+	}
+}
+
+void AssetCache::ClearKeepSet()
+{
+	std::lock_guard<std::mutex> lk(mMtx);
+	mKeepModelPaths.clear();
+	mKeepTexturePaths.clear();
+	mPreloadedTexturePaths.clear();
+}
+
+uint64 AssetCache::GetUnreferencedBytes() const
+{
+	std::lock_guard<std::mutex> lk(mMtx);
+	return GetUnreferencedBytes_NoLock();
+}
+
+uint64 AssetCache::GetUnreferencedBytes_NoLock() const
+{
+	// textures w/o a reference or only referenced by the retained models, mesh buffers aren't reclaimed (see AssetCache.h)
+	uint64 NumBytes = 0;
+	for (const auto& [TexID, Entry] : mTextures)
+		NumBytes += Entry.RefCount == Entry.NumModelRefs ? Entry.NumBytes : 0;
+	return NumBytes;
+}
+
+void AssetCache::Trim()
+{
+	SCOPED_CPU_MARKER("AssetCache::Trim()");
+	std::vector<TextureID> TexturesToDestroy;
+	std::vector<BufferID> VBs, IBs;
+	std::vector<SRV_ID> SRVs;
+	uint64 NumBytes = 0;
+	{
+		std::lock_guard<std::mutex> lk(mMtx);
+		NumBytes = GetUnreferencedBytes_NoLock();
+		while (NumBytes > mBudget)
+		{
+			// least recently released model or unreferenced texture that the next scene doesn't need
+			uint64 OldestSeq = UINT64_MAX;
+			auto itModel = mModels.end();
+			auto itTexture = mTextures.end();
+			for (auto it = mModels.begin(); it != mModels.end(); ++it)
+			{
+				if (it->second.ReleaseSeq < OldestSeq && mKeepModelPaths.find(it->first) == mKeepModelPaths.end())
+				{
+					OldestSeq = it->second.ReleaseSeq;
+					itModel = it;
+				}
+			}
+			for (auto it = mTextures.begin(); it != mTextures.end(); ++it)
+			{
+				const bool bKeep = mKeepTexturePaths.find(it->second.Path) != mKeepTexturePaths.end() || mPreloadedTexturePaths.find(it->second.Path) != mPreloadedTexturePaths.end();
+				if (it->second.RefCount == 0 && it->second.ReleaseSeq < OldestSeq && !bKeep)
+				{
+					OldestSeq = it->second.ReleaseSeq;
+					itTexture = it;
+				}
+			}
+
+			if (itTexture != mTextures.end())
+			{
+				TexturesToDestroy.push_back(itTexture->first);
+				mTextures.erase(itTexture);
+				++mStats.NumEvictedTextures;
+			}
+			else if (itModel != mModels.end())
+			{
+				FRetainedModel& Entry = itModel->second;
+				for (const Mesh& mesh : Entry.Meshes)
+				{
+					for (int lod = 0; lod < (int)mesh.GetNumLODs(); ++lod)
+					{
+						const std::pair<BufferID, BufferID> VBIB = mesh.GetIABufferIDs(lod);
+						if (ReleaseRef(mBufferRefs, VBIB.first )) VBs.push_back(VBIB.first);
+						if (ReleaseRef(mBufferRefs, VBIB.second)) IBs.push_back(VBIB.second);
+					}
+				}
+				for (const auto& [MaterialName, mat] : Entry.Materials)
+				{
+					if (ReleaseRef(mSRVRefs, mat.SRVMaterialMaps)) SRVs.push_back(mat.SRVMaterialMaps);
+					if (ReleaseRef(mSRVRefs, mat.SRVHeightMap   )) SRVs.push_back(mat.SRVHeightMap);
+				}
+				for (TextureID TexID : Entry.Textures)
+				{
+					--mTextures.at(TexID).NumModelRefs;
+					ReleaseTexture_NoLock(TexID, TexturesToDestroy); // unreferenced textures are candidates for the next iterations
+				}
+				mModels.erase(itModel);
+				++mStats.NumEvictedModels;
+			}
+			else
+			{
+				break; // everything left is needed by the next scene
+			}
+			NumBytes = GetUnreferencedBytes_NoLock();
+		}
+	}
+
+	mRenderer.GetTextureManager().DestroyTextures(TexturesToDestroy);
+	mRenderer.DestroyVertexAndIndexBuffers(VBs, IBs);
+	mRenderer.DestroySRVs(SRVs);
+	if (!TexturesToDestroy.empty() || !VBs.empty() || !SRVs.empty())
+	{
+		Log::Info("[AssetCache] Trimmed to %.1fMB (budget %.1fMB): released %zu textures, %zu buffers, %zu SRVs"
+			, NumBytes / (1024.0 * 1024.0), mBudget / (1024.0 * 1024.0), TexturesToDestroy.size(), VBs.size() + IBs.size(), SRVs.size());
+	}
+}
+
+void AssetCache::Clear()
+{
+	SCOPED_CPU_MARKER("AssetCache::Clear()");
+	std::vector<TextureID> TexturesToDestroy;
+	std::vector<BufferID> VBs, IBs;
+	std::vector<SRV_ID> SRVs;
+	{
+		std::lock_guard<std::mutex> lk(mMtx);
+		for (const auto& [Path, Entry] : mModels)
+		{
+			for (const Mesh& mesh : Entry.Meshes)
+			{
+				for (int lod = 0; lod < (int)mesh.GetNumLODs(); ++lod)
+				{
+					const std::pair<BufferID, BufferID> VBIB = mesh.GetIABufferIDs(lod);
+					if (ReleaseRef(mBufferRefs, VBIB.first )) VBs.push_back(VBIB.first);
+					if (ReleaseRef(mBufferRefs, VBIB.second)) IBs.push_back(VBIB.second);
+				}
+			}
+			for (const auto& [MaterialName, mat] : Entry.Materials)
+			{
+				if (ReleaseRef(mSRVRefs, mat.SRVMaterialMaps)) SRVs.push_back(mat.SRVMaterialMaps);
+				if (ReleaseRef(mSRVRefs, mat.SRVHeightMap   )) SRVs.push_back(mat.SRVHeightMap);
+			}
+		}
+		for (const auto& [TexID, Entry] : mTextures)
+			TexturesToDestroy.push_back(TexID);
+
+		mModels.clear();
+		mTextures.clear();
+		mBufferRefs.clear();
+		mSRVRefs.clear();
+		mSceneBufferRefs.clear();
+		mSceneSRVRefs.clear();
+		mKeepModelPaths.clear();
+		mKeepTexturePaths.clear();
+		mPreloadedTexturePaths.clear();
+	}
+	mRenderer.GetTextureManager().DestroyTextures(TexturesToDestroy);
+	mRenderer.DestroyVertexAndIndexBuffers(VBs, IBs);
+	mRenderer.DestroySRVs(SRVs);
+}
+
+AssetCache::FStats AssetCache::GetStats() const
+{
+	std::lock_guard<std::mutex> lk(mMtx);
+	return mStats;
+}
+
+void AssetCache::ResetStats()
+{
+	std::lock_guard<std::mutex> lk(mMtx);
+	mStats = {};
+}
@@ -0,0 +1,136 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+#pragma once
+
+#include "Core/Types.h"
+#include "Core/StringInterner.h"
+#include "Scene/Model.h"
+#include "Scene/Mesh.h"
+#include "Scene/Material.h"
+
+#include <mutex>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+class VQRenderer;
+class Scene;
+struct FSceneRepresentation;
+
+//
+// ASSET CACHE
+//
+// Reference-counted ownership of the file assets across scene loads.
+//
+// Textures: a scene holds one reference per texture in its path table (Scene::mTexturePaths), taken when
+// the texture is assigned to a material and dropped by Scene::Unload(). Unreferenced textures stay resident
+// and the TextureManager keeps handing out the same TextureID for their path until they're trimmed.
+//
+// Models: Scene::Unload() hands its loaded file models over to the cache along with their meshes (vertex &
+// index buffers), materials (SRVs) and textures. The next scene restores a retained model instead of
+// importing it again, see AssetLoader::StartLoadingModels().
+//
+// Trim() releases the least recently released assets until the unreferenced ones fit in the retention
+// budget (FEngineSettings::AssetRetentionBudgetMB), skipping the assets of the next scene (SetKeepSet()).
+// Only the texture memory counts against the budget: the textures w/o a reference and the ones only the
+// retained models hold, each counted once. Mesh buffers live in the StaticBufferHeap, a linear allocator:
+// evicting a model releases their views but not the heap memory, so retaining them costs nothing extra.
+// It runs at the end of the unload and once more when the next scene has finished loading: the assets
+// the next scene didn't pick up are released after the load instead of in the middle of the switch.
+//
+class AssetCache
+{
+public:
+	struct FStats
+	{
+		uint NumRetainedModels  = 0; // handed over by Scene::Unload()
+		uint NumRestoredModels  = 0; // restored instead of imported
+		uint NumReusedTextures  = 0; // unreferenced textures picked up by a scene
+		uint NumEvictedModels   = 0;
+		uint NumEvictedTextures = 0;
+	};
+
+	AssetCache(VQRenderer& Renderer);
+
+	inline void SetBudget(uint64 NumBytes) { mBudget = NumBytes; }
+
+	// Textures
+	void AcquireTexture(TextureID ID, StringID Path);
+	void ReleaseTextures(const std::vector<TextureID>& IDs); // textures w/o a reference are destroyed right away
+	void AddPreloadedTexture(TextureID ID, StringID Path); // unreferenced, kept until ClearKeepSet()
+
+	// Models
+	void    RetainModels(Scene* pScene);
+	ModelID RestoreModel(Scene* pScene, StringID ModelPath, const std::string& ModelName); // INVALID_ID if not retained
+	bool    HasModel(StringID ModelPath) const;
+	bool    IsBufferRetained(BufferID ID) const;
+	bool    IsSRVRetained(SRV_ID ID) const;
+	// Restored models keep their buffer & SRV references while the scene uses them: another retained model sharing
+	// a mesh or a material can't release them. Called by the scene unload after RetainModels().
+	void    ReleaseSceneReferences();
+
+	// Retention
+	void SetKeepSet(const FSceneRepresentation& NextScene); // models & textures Trim() won't release
+	void ClearKeepSet(); // also drops the preloaded textures from the keep set
+	void Trim();
+	void Clear(); // releases all the retained assets, e.g. on exit
+
+	FStats GetStats() const;
+	void   ResetStats();
+	uint64 GetUnreferencedBytes() const;
+
+private:
+	struct FTextureEntry
+	{
+		StringID    Path         = EMPTY_STRING_ID;
+		uint64      NumBytes     = 0;
+		uint        RefCount     = 0;
+		uint        NumModelRefs = 0; // references held by the retained models, <= RefCount
+		uint64      ReleaseSeq   = 0; // order of the last release, Trim() evicts the lowest first
+	};
+	struct FRetainedModel
+	{
+		std::string ModelName;
+		Model::Data Data; // indices into Meshes & Materials instead of IDs
+		std::vector<Mesh> Meshes;
+		std::vector<std::pair<StringID, Material>> Materials; // <name, material>
+		std::vector<TextureID> Textures; // each holds a reference
+		uint64 ReleaseSeq = 0;
+	};
+
+	void   AcquireTexture_NoLock(TextureID ID, StringID Path);
+	void   ReleaseTexture_NoLock(TextureID ID, std::vector<TextureID>& TexturesToDestroy);
+	uint64 GetUnreferencedBytes_NoLock() const;
+
+	VQRenderer& mRenderer;
+	uint64      mBudget = 0;
+
+	mutable std::mutex mMtx;
+	std::unordered_map<TextureID, FTextureEntry>  mTextures;
+	std::unordered_map<StringID, FRetainedModel>  mModels; // key: model file path
+	std::unordered_map<BufferID, uint>            mBufferRefs; // retained models sharing a mesh
+	std::unordered_map<SRV_ID, uint>              mSRVRefs;    // retained models sharing a material
+	std::vector<BufferID>                         mSceneBufferRefs; // held for the restored models, see ReleaseSceneReferences()
+	std::vector<SRV_ID>                           mSceneSRVRefs;
+	std::unordered_set<StringID>                  mKeepModelPaths;
+	std::unordered_set<StringID>                  mKeepTexturePaths;
+	std::unordered_set<StringID>                  mPreloadedTexturePaths; // survives SetKeepSet(): the preload runs before the switch
+	uint64                                        mReleaseSeq = 0;
+	FStats                                        mStats;
+};
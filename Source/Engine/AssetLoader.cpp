@@ -19,8 +19,16 @@
 #include "AssetLoader.h"
 
 #include "GPUMarker.h"
+#include "MeshCache.h"
+#include "GLTFDecode.h"
+#include "Core/VirtualFileSystem.h"
 
 #include "Scene/Mesh.h"
+#include "Scene/MeshSimplifier.h"
+#include "Scene/MeshOptimization.h"
+#include "Scene/TangentSpace.h"
+#include "Scene/MeshletBuilder.h"
+#include "Scene/VertexQuantization.h"
 #include "Scene/Material.h"
 #include "Scene/Scene.h"
 
@@ -49,8 +57,8 @@ static ModelID ImportOBJ(Scene* pScene, AssetLoader* pAssetLoader, VQRenderer* p
 static const std::unordered_map<std::string, AssetLoader::FModelLoadParams::pfnImportModel_t> ImportModelFunctions = 
 {
 	{ "gltf", AssetLoader::ImportGLTF },
+	{ "glb",  AssetLoader::ImportGLTF }, // cgltf detects the binary container, the BIN chunk is used in place, see FGLTFMappedFiles
 	{ "obj",  ImportOBJ },
-	// { "glb",  ImportGLB },
 	// { "fbx",  ImportFBX },
 	// add more formats here
 };
@@ -65,6 +73,7 @@ TaskID AssetLoader::GenerateModelLoadTaskID()
 AssetLoader::AssetLoader(ThreadPool& WorkerThreads_Model, ThreadPool& WorkerThreads_Mesh, VQRenderer& renderer)
 	: mWorkers_ModelLoad(WorkerThreads_Model)
 	, mWorkers_MeshLoad(WorkerThreads_Mesh)
+	, mAssetCache(renderer)
 	, mRenderer(renderer)
 {}
 
@@ -77,7 +86,7 @@ void AssetLoader::QueueModelLoad(GameObject* pObject, const std::string& ModelPa
 	const std::string FileExtension = DirectoryUtil::GetFileExtension(ModelPath);
 	{
 		std::unique_lock<std::mutex> lk(mMtxQueue_ModelLoad);
-		mModelLoadQueue.push({ pObject, ModelPath, ModelName, ImportModelFunctions.at(StrUtil::GetLowercased(FileExtension)) });
+		mModelLoadQueue.push({ pObject, StringInterner::Intern(ModelPath), ModelName, ImportModelFunctions.at(StrUtil::GetLowercased(FileExtension)) });
 	}
 }
 
@@ -94,14 +103,14 @@ AssetLoader::ModelLoadResults_t AssetLoader::StartLoadingModels(Scene* pScene)
 	}
 
 	// process model load queue
-	std::unordered_map<std::string, std::shared_future<ModelID>> ModelLoadResultMap;
+	std::unordered_map<StringID, std::shared_future<ModelID>> ModelLoadResultMap;
 	std::unique_lock<std::mutex> lk(mMtxQueue_ModelLoad);
 	do
 	{
 		SCOPED_CPU_MARKER("ProcessQueueItem");
 
 		FModelLoadParams ModelLoadParams = std::move(mModelLoadQueue.front());
-		const std::string& ModelPath = ModelLoadParams.ModelPath;
+		const StringID ModelPath = ModelLoadParams.ModelPath;
 		mModelLoadQueue.pop();
 
 		// queue unique model paths for loading
@@ -116,17 +125,23 @@ AssetLoader::ModelLoadResults_t AssetLoader::StartLoadingModels(Scene* pScene)
 				break;
 			}
 
-			// start loading the model
+			// start loading the model, or restore it if the previous scene left it in the cache
 			modelLoadResult = std::move(mWorkers_ModelLoad.AddTask([=]()
 			{
 				SCOPED_CPU_MARKER_C("ModelLoadWorker", 0xFFDDAA00);
-				return ModelLoadParams.pfnImportModel(pScene, this, pRenderer, ModelLoadParams.ModelPath, ModelLoadParams.ModelName);
+				const ModelID RestoredModelID = mAssetCache.RestoreModel(pScene, ModelLoadParams.ModelPath, ModelLoadParams.ModelName);
+				if (RestoredModelID != INVALID_ID)
+				{
+					mLoadTimeline.MarkStage(ModelLoadParams.ModelName, FLoadTimeline::READY);
+					return RestoredModelID;
+				}
+				return ModelLoadParams.pfnImportModel(pScene, this, pRenderer, StringInterner::GetString(ModelLoadParams.ModelPath), ModelLoadParams.ModelName);
 			}));
-			ModelLoadResultMap[ModelLoadParams.ModelPath] = modelLoadResult;
+			ModelLoadResultMap[ModelPath] = modelLoadResult;
 		}
 		else
 		{
-			modelLoadResult = ModelLoadResultMap.at(ModelLoadParams.ModelPath);
+			modelLoadResult = ModelLoadResultMap.at(ModelPath);
 		}
 
 		ModelLoadResults.emplace(std::make_pair(ModelLoadParams.pObject, modelLoadResult));
@@ -142,6 +157,7 @@ AssetLoader::ModelLoadResults_t AssetLoader::StartLoadingModels(Scene* pScene)
 //----------------------------------------------------------------------------------------------------------------
 void AssetLoader::QueueTextureLoad(TaskID taskID, const FTextureLoadParams& TexLoadParam)
 {
+	std::lock_guard<std::mutex> lk(mMtxTextureLoadContext);
 	FLoadTaskContext<FTextureLoadParams>& ctx = mLookup_TextureLoadContext[taskID];
 	ctx.LoadQueue.push(TexLoadParam);
 }
@@ -217,21 +233,27 @@ AssetLoader::TextureLoadResults_t AssetLoader::StartLoadingTextures(TaskID taskI
 	SCOPED_CPU_MARKER("AssetLoader.StartLoadingTextures()");
 	TextureLoadResults_t TextureLoadResults;
 	
-	if (mLookup_TextureLoadContext.find(taskID) == mLookup_TextureLoadContext.end())
+	// take the task's queue out of the lookup: the other tasks keep queueing while this one dispatches
+	FLoadTaskContext<FTextureLoadParams> ctx;
 	{
-		Log::Warning("AssetLoader::StartLoadingTextures(taskID=%d): no Textures to load", taskID);
-		return TextureLoadResults;
+		std::lock_guard<std::mutex> lk(mMtxTextureLoadContext);
+		auto it = mLookup_TextureLoadContext.find(taskID);
+		if (it == mLookup_TextureLoadContext.end())
+		{
+			Log::Warning("AssetLoader::StartLoadingTextures(taskID=%d): no Textures to load", taskID);
+			return TextureLoadResults;
+		}
+		ctx = std::move(it->second);
+		mLookup_TextureLoadContext.erase(it);
 	}
 
-	FLoadTaskContext<FTextureLoadParams>& ctx = mLookup_TextureLoadContext.at(taskID);
-
 	if (ctx.LoadQueue.empty())
 	{
 		Log::Warning("AssetLoader::StartLoadingTextures(taskID=%d): no Textures to load", taskID);
 		return TextureLoadResults;
 	}
 	
-	std::unordered_map<std::string, TextureID> Lookup_TextureLoadResult;
+	std::unordered_map<StringID, TextureID> Lookup_TextureLoadResult;
 
 	// process texture load queue
 	{
@@ -247,12 +269,12 @@ AssetLoader::TextureLoadResults_t AssetLoader::StartLoadingTextures(TaskID taskI
 				ctx.UniquePaths.insert(TexLoadParams.TexturePath);
 
 				// determine whether we'll load file OR use a procedurally generated texture
-				auto vPathTokens = StrUtil::split(TexLoadParams.TexturePath, '/');
+				const std::string& TexturePath = StringInterner::GetString(TexLoadParams.TexturePath);
+				auto vPathTokens = StrUtil::split(TexturePath, '/');
 				assert(!vPathTokens.empty());
 				const bool bProceduralTexture = vPathTokens[0] == "Procedural";
 
 				TextureID texID = INVALID_ID;
-				TextureManager& mTextureManager = mRenderer.GetTextureManager();
 				if (bProceduralTexture)
 				{
 					texID = mRenderer.GetProceduralTexture(
@@ -261,15 +283,7 @@ AssetLoader::TextureLoadResults_t AssetLoader::StartLoadingTextures(TaskID taskI
 				}
 				else
 				{
-					FTextureRequest Request;
-					Request.Name = DirectoryUtil::GetFileNameFromPath(TexLoadParams.TexturePath);
-					Request.FilePath = TexLoadParams.TexturePath;
-					Request.bGenerateMips = true;
-					Request.bCPUReadback = false;
-					Request.InitialState = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
-
-					const bool bCheckAlphaMask = (TexLoadParams.TexType == ETextureType::DIFFUSE) || TexLoadParams.TexType == ETextureType::ALPHA_MASK;
-					texID = mTextureManager.CreateTexture(Request, bCheckAlphaMask);
+					texID = CreateFileTexture(TexturePath, TexLoadParams.TexType);
 				}
 
 				// update results lookup for the shared textures (among different materials)
@@ -287,13 +301,23 @@ AssetLoader::TextureLoadResults_t AssetLoader::StartLoadingTextures(TaskID taskI
 		}
 	}
 
-	ctx.UniquePaths.clear();
-
-	mLookup_TextureLoadContext.erase(taskID);
-
+	TRACE_COUNTER("Load.TexturesDispatched", TextureLoadResults.size());
 	return std::move(TextureLoadResults);
 }
 
+TextureID AssetLoader::CreateFileTexture(const std::string& TexturePath, ETextureType TexType)
+{
+	FTextureRequest Request;
+	Request.Name = DirectoryUtil::GetFileNameFromPath(TexturePath);
+	Request.FilePath = TexturePath;
+	Request.bGenerateMips = true;
+	Request.bCPUReadback = false;
+	Request.InitialState = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+
+	const bool bCheckAlphaMask = (TexType == ETextureType::DIFFUSE) || TexType == ETextureType::ALPHA_MASK;
+	return mRenderer.GetTextureManager().CreateTexture(Request, bCheckAlphaMask);
+}
+
 static AssetLoader::ETextureType GetTextureTypeFromGLTF(const cgltf_texture_view* texture_view, const cgltf_material* material)
 {
 	// Map glTF texture roles to engine's ETextureType
@@ -311,7 +335,7 @@ static AssetLoader::ETextureType GetTextureTypeFromGLTF(const cgltf_texture_view
 }
 
 
-void AssetLoader::FMaterialTextureAssignments::DoAssignments(Scene* pScene, std::mutex& mtxTexturePaths, std::unordered_map<TextureID, std::string>& TexturePaths, VQRenderer* pRenderer)
+void AssetLoader::FMaterialTextureAssignments::DoAssignments(Scene* pScene, std::mutex& mtxTexturePaths, std::unordered_map<TextureID, StringID>& TexturePaths, VQRenderer* pRenderer)
 {
 	SCOPED_CPU_MARKER("MaterialTextureAssignments");
 	for (FMaterialTextureAssignment& assignment : mAssignments)
@@ -346,7 +370,7 @@ void AssetLoader::FMaterialTextureAssignments::DoAssignments(Scene* pScene, std:
 				case SPECULAR          : assert(false); /*mat.TexSpecularMap  = result.texLoadResult.get();*/ break;
 				case CUSTOM_MAP        :
 				{
-					const ECustomMapType customMapType = DetermineCustomMapType(result.TexturePath);
+					const ECustomMapType customMapType = DetermineCustomMapType(StringInterner::GetString(result.TexturePath));
 					switch (customMapType)
 					{
 					case OCCLUSION_ROUGHNESS_METALNESS:
@@ -382,8 +406,8 @@ void AssetLoader::FMaterialTextureAssignments::DoAssignments(Scene* pScene, std:
 						break;
 					default:
 					case UNKNOWN:
-						//Log::Warning("Unknown custom map (%s) type for material MatID=%d!", result.TexturePath.c_str(), assignment.matID);
-						DetermineCustomMapType(result.TexturePath);
+						//Log::Warning("Unknown custom map (%s) type for material MatID=%d!", StringInterner::GetString(result.TexturePath).c_str(), assignment.matID);
+						DetermineCustomMapType(StringInterner::GetString(result.TexturePath));
 						break;
 					}
 				} break;
@@ -396,18 +420,23 @@ void AssetLoader::FMaterialTextureAssignments::DoAssignments(Scene* pScene, std:
 				if (loadedTextureID != INVALID_ID)
 				{
 					std::lock_guard<std::mutex> lk(mtxTexturePaths);
-					TexturePaths[loadedTextureID] = result.TexturePath;
+					if (TexturePaths.emplace(loadedTextureID, result.TexturePath).second)
+						pScene->mAssetLoader.mAssetCache.AcquireTexture(loadedTextureID, result.TexturePath); // scene's reference, released by Scene::Unload()
 				}
 			}
 		}
 
 		//Log::Info(log);
 
-		if (mat.SRVMaterialMaps == INVALID_ID)
+		const bool bAllocateSRVs = mat.SRVMaterialMaps == INVALID_ID;
+		if (bAllocateSRVs || assignment.bReinitializeSRVs)
 		{
 			SCOPED_CPU_MARKER("SRVs");
-			mat.SRVMaterialMaps = pRenderer->AllocateSRV(NUM_MATERIAL_TEXTURE_MAP_BINDINGS - 1);
-			mat.SRVHeightMap = pRenderer->AllocateSRV(1);
+			if (bAllocateSRVs)
+			{
+				mat.SRVMaterialMaps = pRenderer->AllocateSRV(NUM_MATERIAL_TEXTURE_MAP_BINDINGS - 1);
+				mat.SRVHeightMap = pRenderer->AllocateSRV(1);
+			}
 
 			pRenderer->InitializeSRV(mat.SRVMaterialMaps, EMaterialTextureMapBindings::ALBEDO, mat.TexDiffuseMap);
 			pRenderer->InitializeSRV(mat.SRVMaterialMaps, EMaterialTextureMapBindings::NORMALS, mat.TexNormalMap);
@@ -449,10 +478,17 @@ static std::vector<AssetLoader::FTextureLoadParams> GenerateTextureLoadParams(
 
 	for (const cgltf_texture_view* view : texture_views)
 	{
+		if (view->texture && view->texture->image && !view->texture->image->uri && view->texture->image->buffer_view)
+		{
+			// .glb files usually embed their images in the BIN chunk: the textures are loaded by path, hence not supported yet
+			Log::Warning("GenerateTextureLoadParams(): skipping the embedded image '%s' of material '%s', export the textures as separate files"
+				, view->texture->image->name ? view->texture->image->name : "", material->name ? material->name : "");
+			continue;
+		}
 		if (view->texture && view->texture->image && view->texture->image->uri)
 		{
 			AssetLoader::FTextureLoadParams params = {};
-			params.TexturePath = modelDirectory + view->texture->image->uri;
+			params.TexturePath = StringInterner::Intern(modelDirectory + view->texture->image->uri);
 			params.MatID = matID;
 			params.TexType = GetTextureTypeFromGLTF(view, material);
 			if (params.TexType != AssetLoader::ETextureType::NUM_TEXTURE_TYPES)
@@ -465,11 +501,146 @@ static std::vector<AssetLoader::FTextureLoadParams> GenerateTextureLoadParams(
 	return TexLoadParams;
 }
 
+// bump when the output of ProcessGLTFMesh() changes: invalidates the cooked models in the MeshCache
+#define GLTF_IMPORTER_VERSION 8
+
+// Set to 0 to import LOD0 only, see MeshSimplifier::FLODChainParams for the LOD chain settings
+#define GLTF_GENERATE_LODS 1
+// Set to 0 to keep the exported triangle & vertex order, see MeshOptimization::FOptimizationParams
+#define GLTF_OPTIMIZE_GEOMETRY 1
+// Set to 0 to skip the meshlets: large meshes are culled as a whole, see MeshletBuilder::FParams
+#define GLTF_BUILD_MESHLETS 1
+// Set to 0 to keep full precision vertices, see VertexQuantization::FParams for the error limits
+#define GLTF_QUANTIZE_VERTICES 1
+// Set to 0 to copy the .gltf/.glb/.bin files into heap memory instead of using the mapped views, see FGLTFMappedFiles
+#define GLTF_MAP_BUFFERS 1
+
+struct FMeshImportStats
+{
+	MeshOptimization::FVertexCacheStats VertexCacheBefore; // LOD0
+	MeshOptimization::FVertexCacheStats VertexCacheAfter;
+	MeshletBuilder::FStats Meshlets;
+	VertexQuantization::FReport Quantization;
+	TangentSpace::FStats Tangents; // generated tangents, empty if the primitive has a TANGENT attribute
+};
+
+//
+// GLTF FILE MAPPING
+//
+// cgltf reads the files through the options.file callbacks and the VFS, loose or packed: the .glb binary
+// chunk and the external .bin buffers are used in place, memory-mapped (loose files & stored pak entries)
+// or decompressed (compressed pak entries), instead of being copied into heap memory, and the accessors
+// point into them. A primitive's mapped buffer views are released from the working set once the primitive
+// is decoded, so the binary data doesn't pile up in memory while the rest of the model is processed.
+// cgltf_data keeps a copy of the file options: the instance is reached through data->file.user_data.
+//
+struct FGLTFMappedFiles
+{
+	std::mutex Mtx;
+	std::vector<std::unique_ptr<VFS::FFile>> Files;
+	std::atomic<uint64> NumMappedBytes = 0;
+	std::atomic<uint64> NumReleasedBytes = 0;
+
+	inline const VFS::FFile* Find(const void* p, size_t Size)
+	{
+		std::lock_guard<std::mutex> lk(Mtx);
+		for (const std::unique_ptr<VFS::FFile>& pFile : Files)
+			if (pFile->Contains(p, Size))
+				return pFile.get();
+		return nullptr;
+	}
+};
+
+static cgltf_result ReadGLTFFile(const struct cgltf_memory_options* memory_options, const struct cgltf_file_options* file_options, const char* path, cgltf_size* size, void** data)
+{
+	std::unique_ptr<VFS::FFile> pFile = std::make_unique<VFS::FFile>();
+	if (!VFS::ReadFile(path, *pFile))
+		return cgltf_result_file_not_found;
+
+#if GLTF_MAP_BUFFERS
+	FGLTFMappedFiles* pMappedFiles = static_cast<FGLTFMappedFiles*>(file_options->user_data);
+	if (pMappedFiles && pFile->GetSize() > 0)
+	{
+		*size = static_cast<cgltf_size>(pFile->GetSize());
+		*data = const_cast<void*>(pFile->GetData()); // cgltf doesn't write to the file data
+		if (pFile->IsMapped())
+			pMappedFiles->NumMappedBytes += pFile->GetSize();
+		std::lock_guard<std::mutex> lk(pMappedFiles->Mtx);
+		pMappedFiles->Files.push_back(std::move(pFile));
+		return cgltf_result_success;
+	}
+#endif
+
+	// copy into cgltf's memory, e.g. empty files
+	*size = static_cast<cgltf_size>(pFile->GetSize());
+	void* file_data = memory_options->alloc_func(memory_options->user_data, *size);
+	if (!file_data)
+		return cgltf_result_out_of_memory;
+	if (*size > 0)
+		memcpy(file_data, pFile->GetData(), *size);
+	*data = file_data;
+	return cgltf_result_success;
+}
+
+static void ReleaseGLTFFile(const struct cgltf_memory_options* memory_options, const struct cgltf_file_options* file_options, void* data)
+{
+#if GLTF_MAP_BUFFERS
+	if (FGLTFMappedFiles* pMappedFiles = static_cast<FGLTFMappedFiles*>(file_options->user_data))
+	{
+		std::lock_guard<std::mutex> lk(pMappedFiles->Mtx);
+		auto it = std::find_if(pMappedFiles->Files.begin(), pMappedFiles->Files.end(), [data](const std::unique_ptr<VFS::FFile>& pFile) { return pFile->GetData() == data; });
+		if (it != pMappedFiles->Files.end())
+		{
+			pMappedFiles->Files.erase(it); // unmaps / frees the file
+			return;
+		}
+	}
+#endif
+	memory_options->free_func(memory_options->user_data, data);
+}
+
+static void ReleaseGLTFPrimitivePages(const cgltf_primitive* prim, const cgltf_data* data)
+{
+#if GLTF_MAP_BUFFERS
+	FGLTFMappedFiles* pMappedFiles = static_cast<FGLTFMappedFiles*>(data->file.user_data);
+	if (!pMappedFiles)
+		return;
+
+	SCOPED_CPU_MARKER("ReleasePages");
+	auto fnRelease = [&](const cgltf_buffer_view* view)
+	{
+		if (!view || !view->buffer || !view->buffer->data)
+			return;
+		const void* p = static_cast<const uint8*>(view->buffer->data) + view->offset;
+		if (const VFS::FFile* pFile = pMappedFiles->Find(p, view->size)) // skips the heap buffers, e.g. data URIs
+			pMappedFiles->NumReleasedBytes += pFile->ReleasePages(p, view->size);
+	};
+	auto fnReleaseAccessor = [&](const cgltf_accessor* acc)
+	{
+		if (!acc)
+			return;
+		fnRelease(acc->buffer_view);
+		if (acc->is_sparse)
+		{
+			fnRelease(acc->sparse.indices_buffer_view);
+			fnRelease(acc->sparse.values_buffer_view);
+		}
+	};
+
+	// views shared with other primitives are faulted back in from the file cache if they're read again
+	for (size_t i = 0; i < prim->attributes_count; ++i)
+		fnReleaseAccessor(prim->attributes[i].data);
+	fnReleaseAccessor(prim->indices);
+#endif
+}
+
 static Mesh ProcessGLTFMesh(
 	VQRenderer* pRenderer,
 	const cgltf_primitive* prim,
 	const cgltf_data* data,
-	const std::string& ModelName
+	const std::string& ModelName,
+	FMeshImportStats* pImportStats = nullptr,
+	ThreadPool* pWorkerThreadPool = nullptr // optional, for the tangent generation of large meshes
 )
 {
 	SCOPED_CPU_MARKER("ProcessGLTFMesh()");
@@ -525,99 +696,72 @@ static Mesh ProcessGLTFMesh(
 		Vertices.resize(NumVertices);
 	}
 
+	// Decode whole accessors straight into the vertex/index arrays
 	bool bTangentDataExists = false;
 	{
 		SCOPED_CPU_MARKER("Verts");
-		for (size_t i = 0; i < NumVertices; ++i)
+		uint8* pVertexData = reinterpret_cast<uint8*>(Vertices.data());
+		auto fnUnpackAttribute = [&](const cgltf_accessor* acc, size_t NumComponents, size_t MemberOffset, bool bNegateZ, const char* pAttributeName)
 		{
-			FVertexWithNormalAndTangent& Vert = Vertices[i];
-
-			// Process attributes
-			for (size_t j = 0; j < prim->attributes_count; ++j)
+			const size_t NumDecoded = GLTFDecode::UnpackFloats(acc, NumComponents, pVertexData + MemberOffset, sizeof(FVertexWithNormalAndTangent), NumVertices, bNegateZ);
+			if (NumDecoded != NumVertices)
 			{
-				const cgltf_attribute* attr = &prim->attributes[j];
-				const cgltf_accessor* acc = attr->data;
+				Log::Warning("Failed to read %s for %zu/%zu vertices in mesh %s", pAttributeName, NumVertices - NumDecoded, NumVertices, ModelName.c_str());
+			}
+			return NumDecoded > 0;
+		};
 
-				if (acc->is_sparse) 
-				{
-					Log::Warning("Sparse accessors not supported for mesh %s", ModelName.c_str());
-					continue;
-				}
+		// Process attributes
+		for (size_t j = 0; j < prim->attributes_count; ++j)
+		{
+			const cgltf_attribute* attr = &prim->attributes[j];
+			const cgltf_accessor* acc = attr->data;
 
-				switch (attr->type)
-				{
-				case cgltf_attribute_type_invalid:
-					Log::Warning("Invalid attribute type for mesh %s", ModelName.c_str());
-					break;
-				
-				case cgltf_attribute_type_position:
-					assert(acc->type == cgltf_type_vec3);
-					if (!cgltf_accessor_read_float(acc, i, Vert.position, 3))
-					{
-						Log::Warning("Failed to read position for vertex %zu in mesh %s", i, ModelName.c_str());
-						break;
-					}
-					Vert.position[2] = -Vert.position[2]; // Convert to left-handed coordinate system
-					break;
+			if (acc->is_sparse) 
+			{
+				Log::Warning("Sparse accessors not supported for mesh %s", ModelName.c_str());
+				continue;
+			}
 
-				case cgltf_attribute_type_normal:
-					assert(acc->type == cgltf_type_vec3);
-					if (!cgltf_accessor_read_float(acc, i, Vert.normal, 3))
-					{
-						Log::Warning("Failed to read normal for vertex %zu in mesh %s", i, ModelName.c_str());
-						break;
-					}
-					Vert.normal[2] = -Vert.normal[2]; // Convert to left-handed coordinate system
-					break;
+			switch (attr->type)
+			{
+			case cgltf_attribute_type_invalid:
+				Log::Warning("Invalid attribute type for mesh %s", ModelName.c_str());
+				break;
+			
+			case cgltf_attribute_type_position:
+				assert(acc->type == cgltf_type_vec3);
+				fnUnpackAttribute(acc, 3, offsetof(FVertexWithNormalAndTangent, position), true, "position"); // Convert to left-handed coordinate system
+				break;
 
-				case cgltf_attribute_type_tangent:
+			case cgltf_attribute_type_normal:
+				assert(acc->type == cgltf_type_vec3);
+				fnUnpackAttribute(acc, 3, offsetof(FVertexWithNormalAndTangent, normal), true, "normal"); // Convert to left-handed coordinate system
+				break;
+
+			case cgltf_attribute_type_tangent:
+				if (acc->type == cgltf_type_vec4 || acc->type == cgltf_type_vec3) // w (handedness) is dropped
 				{
-					if (acc->type == cgltf_type_vec4)
-					{
-						float tan[4];
-						if (!cgltf_accessor_read_float(acc, i, tan, 4))
-						{
-							Log::Warning("Failed to read tangent for vertex %zu in mesh %s", i, ModelName.c_str());
-							break;
-						}
-						Vert.tangent[0] = tan[0];
-						Vert.tangent[1] = tan[1];
-						Vert.tangent[2] = -tan[2]; // Convert to left-handed coordinate system
-						bTangentDataExists = true;
-					}
-					else if (acc->type == cgltf_type_vec3)
-					{
-						if (!cgltf_accessor_read_float(acc, i, Vert.tangent, 3))
-						{
-							Log::Warning("Failed to read tangent for vertex %zu in mesh %s", i, ModelName.c_str());
-							break;
-						}
-						Vert.tangent[2] = -Vert.tangent[2]; // Convert to left-handed coordinate system
-						bTangentDataExists = true;
-					}
-					else
-					{
-						Log::Warning("Unsupported tangent type for vertex %zu in mesh %s", i, ModelName.c_str());
-					}
-					break;
+					bTangentDataExists |= fnUnpackAttribute(acc, 3, offsetof(FVertexWithNormalAndTangent, tangent), true, "tangent"); // Convert to left-handed coordinate system
+				}
+				else
+				{
+					Log::Warning("Unsupported tangent type in mesh %s", ModelName.c_str());
 				}
+				break;
 
-				case cgltf_attribute_type_texcoord:
-					assert(acc->type == cgltf_type_vec2);
-					if (!cgltf_accessor_read_float(acc, i, Vert.uv, 2))
-					{
-						Log::Warning("Failed to read UV for vertex %zu in mesh %s", i, ModelName.c_str());
-					}
-					break;
+			case cgltf_attribute_type_texcoord:
+				assert(acc->type == cgltf_type_vec2);
+				fnUnpackAttribute(acc, 2, offsetof(FVertexWithNormalAndTangent, uv), false, "UV");
+				break;
 
-				case cgltf_attribute_type_color:
-				case cgltf_attribute_type_joints:
-				case cgltf_attribute_type_weights:
-				case cgltf_attribute_type_custom:
-				case cgltf_attribute_type_max_enum:
-					Log::Warning("Unhandled attribute type %d for vertex %zu in mesh %s", attr->type, i, ModelName.c_str());
-					break;
-				}
+			case cgltf_attribute_type_color:
+			case cgltf_attribute_type_joints:
+			case cgltf_attribute_type_weights:
+			case cgltf_attribute_type_custom:
+			case cgltf_attribute_type_max_enum:
+				Log::Warning("Unhandled attribute type %d in mesh %s", attr->type, ModelName.c_str());
+				break;
 			}
 		}
 	}
@@ -627,172 +771,105 @@ static Mesh ProcessGLTFMesh(
 		SCOPED_CPU_MARKER("Indices");
 		if (prim->type == cgltf_primitive_type_triangles)
 		{
-			for (size_t i = 0; i < NumIndices; i += 3)
+			if (GLTFDecode::UnpackIndices(prim->indices, Indices.data(), NumIndices, true /*bFlipWinding*/) != NumIndices)
 			{
-				Indices[i] = static_cast<unsigned>(cgltf_accessor_read_index(prim->indices, i));
-				Indices[i + 1] = static_cast<unsigned>(cgltf_accessor_read_index(prim->indices, i + 2)); // Flip winding
-				Indices[i + 2] = static_cast<unsigned>(cgltf_accessor_read_index(prim->indices, i + 1));
+				Log::Warning("Failed to read indices for mesh %s", ModelName.c_str());
 			}
 		}
-		else if (prim->type == cgltf_primitive_type_triangle_strip)
+		else
 		{
-			for (size_t i = 2; i < prim->indices->count; ++i)
+			// strips & fans: unpack as-is, then assemble the triangle list
+			std::vector<unsigned> SrcIndices(prim->indices->count);
+			if (GLTFDecode::UnpackIndices(prim->indices, SrcIndices.data(), SrcIndices.size(), false) != SrcIndices.size())
 			{
-				size_t idx0 = cgltf_accessor_read_index(prim->indices, i - 2);
-				size_t idx1 = cgltf_accessor_read_index(prim->indices, i - 1);
-				size_t idx2 = cgltf_accessor_read_index(prim->indices, i);
-				size_t base = (i - 2) * 3;
-				if (i % 2 == 0)
-				{
-					Indices[base] = static_cast<unsigned>(idx0);
-					Indices[base + 1] = static_cast<unsigned>(idx2); // Flip winding
-					Indices[base + 2] = static_cast<unsigned>(idx1);
-				}
-				else
+				Log::Warning("Failed to read indices for mesh %s", ModelName.c_str());
+			}
+
+			if (prim->type == cgltf_primitive_type_triangle_strip)
+			{
+				for (size_t i = 2; i < SrcIndices.size(); ++i)
 				{
-					Indices[base] = static_cast<unsigned>(idx0);
-					Indices[base + 1] = static_cast<unsigned>(idx1);
-					Indices[base + 2] = static_cast<unsigned>(idx2);
+					const size_t base = (i - 2) * 3;
+					Indices[base] = SrcIndices[i - 2];
+					if (i % 2 == 0)
+					{
+						Indices[base + 1] = SrcIndices[i];     // Flip winding
+						Indices[base + 2] = SrcIndices[i - 1];
+					}
+					else
+					{
+						Indices[base + 1] = SrcIndices[i - 1];
+						Indices[base + 2] = SrcIndices[i];
+					}
 				}
 			}
-		}
-		else if (prim->type == cgltf_primitive_type_triangle_fan)
-		{
-			size_t idx0 = cgltf_accessor_read_index(prim->indices, 0);
-			for (size_t i = 2; i < prim->indices->count; ++i)
+			else if (prim->type == cgltf_primitive_type_triangle_fan)
 			{
-				size_t idx1 = cgltf_accessor_read_index(prim->indices, i - 1);
-				size_t idx2 = cgltf_accessor_read_index(prim->indices, i);
-				size_t base = (i - 2) * 3;
-				Indices[base] = static_cast<unsigned>(idx0);
-				Indices[base + 1] = static_cast<unsigned>(idx2); // Flip winding
-				Indices[base + 2] = static_cast<unsigned>(idx1);
+				for (size_t i = 2; i < SrcIndices.size(); ++i)
+				{
+					const size_t base = (i - 2) * 3;
+					Indices[base] = SrcIndices[0];
+					Indices[base + 1] = SrcIndices[i]; // Flip winding
+					Indices[base + 2] = SrcIndices[i - 1];
+				}
 			}
 		}
 	}
 
+	// everything is decoded into Vertices & Indices at this point
+	ReleaseGLTFPrimitivePages(prim, data);
+
 	constexpr bool CALCULATE_TANGENTS = true;
 	if constexpr (CALCULATE_TANGENTS)
 	{
 		if (!bTangentDataExists)
 		{
 			SCOPED_CPU_MARKER("CalculateTangents");
+			// positions are already in the left-handed system: so are the tangents, same as the imported TANGENT attributes
+			TangentSpace::GenerateTangents(Vertices, Indices, pWorkerThreadPool, pImportStats ? &pImportStats->Tangents : nullptr);
+		}
+	}
 
-			size_t numTriangles = Indices.empty() ? NumVertices / 3 : Indices.size() / 3;
-			for (size_t i = 0; i < numTriangles; ++i) // Process triangles
-			{
-				// Get vertex indices for the triangle
-				size_t i0 = Indices.empty() ? (i * 3 + 0) : Indices[i * 3 + 0];
-				size_t i1 = Indices.empty() ? (i * 3 + 1) : Indices[i * 3 + 1];
-				size_t i2 = Indices.empty() ? (i * 3 + 2) : Indices[i * 3 + 2];
-
-				// Ensure indices are valid
-				if (i0 >= NumVertices || i1 >= NumVertices || i2 >= NumVertices)
-				{
-					Log::Warning("Invalid triangle indices for mesh %s", ModelName.c_str());
-					continue;
-				}
-
-				const FVertexWithNormalAndTangent& v0 = Vertices[i0];
-				const FVertexWithNormalAndTangent& v1 = Vertices[i1];
-				const FVertexWithNormalAndTangent& v2 = Vertices[i2];
-
-				// Compute edges
-				float e1[3] = { v1.position[0] - v0.position[0], v1.position[1] - v0.position[1], v1.position[2] - v0.position[2] };
-				float e2[3] = { v2.position[0] - v0.position[0], v2.position[1] - v0.position[1], v2.position[2] - v0.position[2] };
-
-				// Compute UV differences
-				float du1 = v1.uv[0] - v0.uv[0];
-				float dv1 = v1.uv[1] - v0.uv[1];
-				float du2 = v2.uv[0] - v0.uv[0];
-				float dv2 = v2.uv[1] - v0.uv[1];
-
-				// Compute determinant
-				float det = du1 * dv2 - dv1 * du2;
-				if (fabs(det) < 1e-6f)
-				{
-					// Degenerate UVs; skip or use fallback
-					continue;
-				}
-
-				float invDet = 1.0f / det;
-
-				// Compute tangent
-				float tangent[3];
-				tangent[0] = invDet * (dv2 * e1[0] - dv1 * e2[0]);
-				tangent[1] = invDet * (dv2 * e1[1] - dv1 * e2[1]);
-				tangent[2] = invDet * (dv2 * e1[2] - dv1 * e2[2]);
-
-				// Adjust for left-handed coordinate system (negate z)
-				tangent[2] = -tangent[2];
-
-				// Accumulate tangents for each vertex
-				for (size_t j : {i0, i1, i2})
-				{
-					FVertexWithNormalAndTangent& vert = Vertices[j];
-					vert.tangent[0] += tangent[0];
-					vert.tangent[1] += tangent[1];
-					vert.tangent[2] += tangent[2];
-				}
-			}
+#if GLTF_GENERATE_LODS
+	{
+		SCOPED_CPU_MARKER("GenerateLODs");
+		MeshSimplifier::GenerateLODChain(GeometryData, MeshSimplifier::FLODChainParams{});
+	}
+#endif
 
-			// Normalize tangents and orthogonalize against normals
-			for (size_t i = 0; i < NumVertices; ++i)
-			{
-				FVertexWithNormalAndTangent& vert = Vertices[i];
-
-				// Normalize tangent
-				float len = sqrtf(vert.tangent[0] * vert.tangent[0] + vert.tangent[1] * vert.tangent[1] + vert.tangent[2] * vert.tangent[2]);
-				if (len > 1e-6f) {
-					vert.tangent[0] /= len;
-					vert.tangent[1] /= len;
-					vert.tangent[2] /= len;
-				}
-				else 
-				{
-					// Fallback: use arbitrary tangent perpendicular to normal
-					float absNx = fabs(vert.normal[0]);
-					float absNy = fabs(vert.normal[1]);
-					float absNz = fabs(vert.normal[2]);
-					if (absNx <= absNy && absNx <= absNz)
-					{
-						vert.tangent[0] = 1.0f;
-						vert.tangent[1] = 0.0f;
-						vert.tangent[2] = 0.0f;
-					}
-					else if (absNy <= absNx && absNy <= absNz)
-					{
-						vert.tangent[0] = 0.0f;
-						vert.tangent[1] = 1.0f;
-						vert.tangent[2] = 0.0f;
-					}
-					else
-					{
-						vert.tangent[0] = 0.0f;
-						vert.tangent[1] = 0.0f;
-						vert.tangent[2] = 1.0f;
-					}
-				}
+#if GLTF_OPTIMIZE_GEOMETRY
+	{
+		SCOPED_CPU_MARKER("OptimizeGeometry");
+		MeshOptimization::OptimizeGeometry(GeometryData, MeshOptimization::FOptimizationParams{},
+			pImportStats ? &pImportStats->VertexCacheBefore : nullptr,
+			pImportStats ? &pImportStats->VertexCacheAfter : nullptr
+		);
+	}
+#endif
 
-				// Orthogonalize tangent against normal (Gram-Schmidt)
-				float dot = vert.normal[0] * vert.tangent[0] + vert.normal[1] * vert.tangent[1] + vert.normal[2] * vert.tangent[2];
-				vert.tangent[0] -= dot * vert.normal[0];
-				vert.tangent[1] -= dot * vert.normal[1];
-				vert.tangent[2] -= dot * vert.normal[2];
+#if GLTF_BUILD_MESHLETS
+	{
+		SCOPED_CPU_MARKER("BuildMeshlets");
+		MeshletBuilder::BuildMeshlets(GeometryData, MeshletBuilder::FParams{}, pImportStats ? &pImportStats->Meshlets : nullptr);
+	}
+#endif
 
-				// Re-normalize
-				len = sqrtf(vert.tangent[0] * vert.tangent[0] + vert.tangent[1] * vert.tangent[1] + vert.tangent[2] * vert.tangent[2]);
-				if (len > 1e-6f)
-				{
-					vert.tangent[0] /= len;
-					vert.tangent[1] /= len;
-					vert.tangent[2] /= len;
-				}
-			}
+#if GLTF_QUANTIZE_VERTICES
+	{
+		SCOPED_CPU_MARKER("QuantizeVertices");
+		float UVScaleBias[4];
+		const VertexQuantization::FReport Report = VertexQuantization::SelectFormat(GeometryData, VertexQuantization::FParams{}, UVScaleBias);
+		if (pImportStats)
+			pImportStats->Quantization = Report;
 
-			// Log::Info("Calculated tangents for mesh %s with %zu vertices", ModelName.c_str(), NumVertices);
+		switch (Report.Format)
+		{
+		case NORMAL_AND_TANGENT_PACKED1: return Mesh(nullptr, VertexQuantization::PackVertices1(std::move(GeometryData), UVScaleBias), ModelName);
+		case NORMAL_AND_TANGENT_PACKED2: return Mesh(nullptr, VertexQuantization::PackVertices2(std::move(GeometryData), UVScaleBias), ModelName);
+		default: break;
 		}
 	}
+#endif
 
 	return Mesh(nullptr, std::move(GeometryData), ModelName);
 }
@@ -832,49 +909,32 @@ static std::string CreateUniqueMaterialName(const cgltf_material* material, size
 	return uniqueMatName;
 }
 
-static void QueueUpTextureLoadRequests(
-	AssetLoader* pAssetLoader,
-	const std::string& modelDirectory,
-	const cgltf_material* material,
-	MaterialID matID,
-	TaskID taskID)
+static MeshCache::FCookedModelDesc::FMaterial GetGLTFMaterialDesc(const cgltf_material* material, size_t matIndex, const std::string& modelDirectory)
 {
-	SCOPED_CPU_MARKER("QueueUpTextureLoadRequests");
-	std::vector<AssetLoader::FTextureLoadParams> TexLoadParams = GenerateTextureLoadParams(material, matID, modelDirectory);
-	for (const auto& param : TexLoadParams) 
+	MeshCache::FCookedModelDesc::FMaterial desc;
+	desc.Name = CreateUniqueMaterialName(material, matIndex, modelDirectory);
+
+	// texture paths are kept relative to the model directory
+	for (const AssetLoader::FTextureLoadParams& param : GenerateTextureLoadParams(material, INVALID_ID, ""))
 	{
-		pAssetLoader->QueueTextureLoad(taskID, param);
+		desc.Textures.push_back({ static_cast<uint32>(param.TexType), StringInterner::GetString(param.TexturePath) });
 	}
-}
-
-static MaterialID ProcessGLTFMaterial(
-	const cgltf_material* material,
-	size_t matIndex,
-	const std::string& modelDirectory,
-	Scene* pScene,
-	AssetLoader* pAssetLoader,
-	AssetLoader::FMaterialTextureAssignments& MaterialTextureAssignments,
-	TaskID taskID)
-{
-	SCOPED_CPU_MARKER("ProcessGLTFMaterial");
-	const std::string matName = CreateUniqueMaterialName(material, matIndex, modelDirectory);
-	MaterialID matID = pScene->CreateMaterial(matName);
-	Material& mat = pScene->GetMaterial(matID);
-
-	QueueUpTextureLoadRequests(pAssetLoader, modelDirectory, material, matID, taskID);
-	MaterialTextureAssignments.mAssignments.push_back({ matID });
 
 	// Set material properties (PBR metallic-roughness model)
 	if (material->has_pbr_metallic_roughness) {
 		const auto& pbr = material->pbr_metallic_roughness;
-		mat.diffuse = XMFLOAT3(pbr.base_color_factor[0], pbr.base_color_factor[1], pbr.base_color_factor[2]);
-		mat.metalness = pbr.metallic_factor;
-		mat.roughness = pbr.roughness_factor;
-		mat.alpha = pbr.base_color_factor[3];
+		desc.Flags |= MeshCache::COOKED_MATERIAL_HAS_PBR_PARAMS;
+		desc.Diffuse[0] = pbr.base_color_factor[0];
+		desc.Diffuse[1] = pbr.base_color_factor[1];
+		desc.Diffuse[2] = pbr.base_color_factor[2];
+		desc.Metalness = pbr.metallic_factor;
+		desc.Roughness = pbr.roughness_factor;
+		desc.Alpha = pbr.base_color_factor[3];
 	}
 
 	if (material->emissive_factor[0] != 0.0f || material->emissive_factor[1] != 0.0f || material->emissive_factor[2] != 0.0f) {
-		mat.emissiveIntensity = std::max({ material->emissive_factor[0], material->emissive_factor[1], material->emissive_factor[2] });
+		desc.Flags |= MeshCache::COOKED_MATERIAL_HAS_EMISSIVE;
+		desc.EmissiveIntensity = std::max({ material->emissive_factor[0], material->emissive_factor[1], material->emissive_factor[2] });
 	}
 
 	// Handle alpha mode
@@ -885,9 +945,77 @@ static MaterialID ProcessGLTFMaterial(
 	// Note: glTF doesn't directly provide specular or shininess like Assimp; we rely on PBR properties
 	// If specular-glossiness is needed, check material->has_pbr_specular_glossiness and convert
 
+	return desc;
+}
+
+// creates the scene material and queues up its texture loads, used for both glTF and cooked materials
+static MaterialID CreateModelMaterial(
+	const MeshCache::FCookedModelDesc::FMaterial& desc,
+	const std::string& modelDirectory,
+	Scene* pScene,
+	AssetLoader* pAssetLoader,
+	AssetLoader::FMaterialTextureAssignments& MaterialTextureAssignments,
+	TaskID taskID)
+{
+	MaterialID matID = pScene->CreateMaterial(desc.Name);
+	Material& mat = pScene->GetMaterial(matID);
+
+	{
+		SCOPED_CPU_MARKER("QueueUpTextureLoadRequests");
+		for (const auto& [TexType, TexPath] : desc.Textures)
+		{
+			AssetLoader::FTextureLoadParams param = {};
+			param.TexType = static_cast<AssetLoader::ETextureType>(TexType);
+			param.MatID = matID;
+			param.TexturePath = StringInterner::Intern(modelDirectory + TexPath);
+			pAssetLoader->QueueTextureLoad(taskID, param);
+		}
+	}
+	MaterialTextureAssignments.mAssignments.push_back({ matID });
+
+	if (desc.Flags & MeshCache::COOKED_MATERIAL_HAS_PBR_PARAMS)
+	{
+		mat.diffuse = XMFLOAT3(desc.Diffuse[0], desc.Diffuse[1], desc.Diffuse[2]);
+		mat.metalness = desc.Metalness;
+		mat.roughness = desc.Roughness;
+		mat.alpha = desc.Alpha;
+	}
+	if (desc.Flags & MeshCache::COOKED_MATERIAL_HAS_EMISSIVE)
+	{
+		mat.emissiveIntensity = desc.EmissiveIntensity;
+	}
 	return matID;
 }
 
+static MaterialID ProcessGLTFMaterial(
+	const cgltf_material* material,
+	size_t matIndex,
+	const std::string& modelDirectory,
+	Scene* pScene,
+	AssetLoader* pAssetLoader,
+	AssetLoader::FMaterialTextureAssignments& MaterialTextureAssignments,
+	TaskID taskID)
+{
+	SCOPED_CPU_MARKER("ProcessGLTFMaterial");
+	return CreateModelMaterial(GetGLTFMaterialDesc(material, matIndex, modelDirectory), modelDirectory, pScene, pAssetLoader, MaterialTextureAssignments, taskID);
+}
+
+// Starts decoding the textures of the model's materials on the TextureManager workers as soon as the materials
+// are known, the decoding overlaps with the mesh processing & buffer uploads of the model.
+// The results are waited on in FinalizeModelImport(), after the mesh buffers are created.
+static void StartLoadingModelTextures(
+	const std::string& ModelName,
+	AssetLoader* pAssetLoader,
+	AssetLoader::FMaterialTextureAssignments& MaterialTextureAssignments,
+	TaskID taskID
+)
+{
+	if (MaterialTextureAssignments.mAssignments.empty())
+		return;
+	pAssetLoader->mLoadTimeline.BeginStage(ModelName, FLoadTimeline::TEXTURES);
+	MaterialTextureAssignments.mTextureLoadResults = pAssetLoader->StartLoadingTextures(taskID);
+}
+
 
 #define THREADED_MESH_LOAD 1
 static Model::Data ImportGLTFAllMeshes
@@ -914,9 +1042,33 @@ static Model::Data ImportGLTFAllMeshes
 		total_primitives += data->meshes[i].primitives_count;
 	}
 
+	// Create the materials first so that the textures decode while the meshes are processed
+	std::vector<MaterialID> MaterialIDs(total_primitives, INVALID_ID);
+	{
+		SCOPED_CPU_MARKER("ProcessMaterials");
+		FLoadTimeline::FScopedStage Stage(pAssetLoader->mLoadTimeline, ModelName, FLoadTimeline::MATERIALS);
+		size_t idx = 0;
+		for (size_t mesh_idx = 0; mesh_idx < data->meshes_count; ++mesh_idx)
+		{
+			for (size_t prim_idx = 0; prim_idx < data->meshes[mesh_idx].primitives_count; ++prim_idx)
+			{
+				if (data->meshes[mesh_idx].primitives[prim_idx].material)
+				{
+					MaterialIDs[idx] = ProcessGLTFMaterial(
+						data->meshes[mesh_idx].primitives[prim_idx].material, idx,
+						modelDirectory, pScene, pAssetLoader, MaterialTextureAssignments, taskID
+					);
+				}
+				++idx;
+			}
+		}
+	}
+	StartLoadingModelTextures(ModelName, pAssetLoader, MaterialTextureAssignments, taskID);
+
 	// Process all meshes in cgltf_data->meshes
+	FLoadTimeline::FScopedStage MeshStage(pAssetLoader->mLoadTimeline, ModelName, FLoadTimeline::MESHES);
 	std::vector<Mesh> MeshData(total_primitives);
-	std::vector<MaterialID> MaterialIDs(total_primitives, INVALID_ID);
+	std::vector<FMeshImportStats> ImportStats(total_primitives);
 	const bool bThreaded = THREADED_MESH_LOAD && total_primitives > 1;
 
 	if (bThreaded)
@@ -946,13 +1098,13 @@ static Model::Data ImportGLTFAllMeshes
 			SCOPED_CPU_MARKER("DispatchMeshWorkers");
 			for (size_t iRange = 1; iRange < vRanges.size(); ++iRange)
 			{
-				WorkerThreadPool.AddTask([=, &MeshData, &WorkerSignal, &WorkerCounter]()
+				WorkerThreadPool.AddTask([=, &MeshData, &ImportStats, &WorkerSignal, &WorkerCounter, &WorkerThreadPool]()
 				{
 					SCOPED_CPU_MARKER_C("MeshWorker", 0xFF0000FF);
 					for (size_t i = vRanges[iRange].first; i <= vRanges[iRange].second; ++i)
 					{
 						auto [mesh_idx, prim_idx] = primitive_map[i];
-						MeshData[i] = ProcessGLTFMesh(pRenderer, &data->meshes[mesh_idx].primitives[prim_idx], data, ModelName);
+						MeshData[i] = ProcessGLTFMesh(pRenderer, &data->meshes[mesh_idx].primitives[prim_idx], data, ModelName, &ImportStats[i], &WorkerThreadPool);
 					}
 					WorkerCounter.fetch_sub(1);
 					WorkerSignal.NotifyOne();
@@ -964,25 +1116,7 @@ static Model::Data ImportGLTFAllMeshes
 			for (size_t i = vRanges[0].first; i <= vRanges[0].second; ++i)
 			{
 				auto [mesh_idx, prim_idx] = primitive_map[i];
-				MeshData[i] = ProcessGLTFMesh(pRenderer, &data->meshes[mesh_idx].primitives[prim_idx], data, ModelName);
-			}
-		}
-		{
-			SCOPED_CPU_MARKER("ProcessMaterials");
-			size_t idx = 0;
-			for (size_t mesh_idx = 0; mesh_idx < data->meshes_count; ++mesh_idx)
-			{
-				for (size_t prim_idx = 0; prim_idx < data->meshes[mesh_idx].primitives_count; ++prim_idx)
-				{
-					if (data->meshes[mesh_idx].primitives[prim_idx].material)
-					{
-						MaterialIDs[idx] = ProcessGLTFMaterial(
-							data->meshes[mesh_idx].primitives[prim_idx].material, idx,
-							modelDirectory, pScene, pAssetLoader, MaterialTextureAssignments, taskID
-						);
-					}
-					++idx;
-				}
+				MeshData[i] = ProcessGLTFMesh(pRenderer, &data->meshes[mesh_idx].primitives[prim_idx], data, ModelName, &ImportStats[i], &WorkerThreadPool);
 			}
 		}
 		{
@@ -1008,24 +1142,89 @@ static Model::Data ImportGLTFAllMeshes
 		{
 			for (size_t prim_idx = 0; prim_idx < data->meshes[mesh_idx].primitives_count; ++prim_idx)
 			{
-				Mesh mesh = ProcessGLTFMesh(pRenderer, &data->meshes[mesh_idx].primitives[prim_idx], data, ModelName);
-				MaterialID mat_id = INVALID_ID;
-				if (data->meshes[mesh_idx].primitives[prim_idx].material)
-				{
-					mat_id = ProcessGLTFMaterial(
-						data->meshes[mesh_idx].primitives[prim_idx].material, idx,
-						modelDirectory, pScene, pAssetLoader, MaterialTextureAssignments, taskID);
-				}
+				Mesh mesh = ProcessGLTFMesh(pRenderer, &data->meshes[mesh_idx].primitives[prim_idx], data, ModelName, &ImportStats[idx], &WorkerThreadPool);
 				MeshID id = pScene->AddMesh(std::move(mesh));
-				if (mat_id != INVALID_ID)
+				if (MaterialIDs[idx] != INVALID_ID)
 				{
-					modelData.AddMesh(id, mat_id, Model::Data::EMeshType::OPAQUE_MESH);
+					modelData.AddMesh(id, MaterialIDs[idx], Model::Data::EMeshType::OPAQUE_MESH);
 				}
 				++idx;
 			}
 		}
 	}
 
+#if GLTF_OPTIMIZE_GEOMETRY
+	{
+		MeshOptimization::FVertexCacheStats Before, After;
+		for (const FMeshImportStats& Stats : ImportStats)
+		{
+			Before += Stats.VertexCacheBefore;
+			After += Stats.VertexCacheAfter;
+		}
+		Log::Info("   Vertex cache (LOD0, %zu triangles): ACMR %.3f -> %.3f, ATVR %.3f -> %.3f",
+			After.NumTriangles,
+			Before.ACMR(), After.ACMR(),
+			Before.ATVR(), After.ATVR()
+		);
+	}
+#endif
+	{
+		TangentSpace::FStats Total;
+		size_t NumLargestMeshTriangles = 0;
+		float LargestMeshTimeMs = 0.0f;
+		for (const FMeshImportStats& Stats : ImportStats)
+		{
+			Total += Stats.Tangents;
+			if (Stats.Tangents.NumTriangles > NumLargestMeshTriangles)
+			{
+				NumLargestMeshTriangles = Stats.Tangents.NumTriangles;
+				LargestMeshTimeMs = Stats.Tangents.TimeMs;
+			}
+		}
+		if (Total.NumTriangles > 0)
+		{
+			Log::Info("   Tangents: %zu triangles in %.2fms (largest mesh: %zu triangles in %.2fms, up to %zu threads), %zu degenerate UV triangles, %zu vertices split on UV mirror seams",
+				Total.NumTriangles, Total.TimeMs,
+				NumLargestMeshTriangles, LargestMeshTimeMs, Total.NumThreads,
+				Total.NumDegenerateTriangles,
+				Total.NumSplitVertices
+			);
+		}
+	}
+#if GLTF_BUILD_MESHLETS
+	{
+		MeshletBuilder::FStats Total;
+		for (const FMeshImportStats& Stats : ImportStats)
+			Total += Stats.Meshlets;
+		if (Total.NumMeshlets > 0)
+		{
+			Log::Info("   Meshlets (all LODs): %zu meshlets, %.1f triangles & %.1f vertices per meshlet, %.1f%% backface cullable",
+				Total.NumMeshlets,
+				Total.AvgTrianglesPerMeshlet(),
+				Total.AvgVerticesPerMeshlet(),
+				100.0f * Total.NumBackfaceCullable / Total.NumMeshlets
+			);
+		}
+	}
+#endif
+#if GLTF_QUANTIZE_VERTICES
+	{
+		VertexQuantization::FReport Total;
+		size_t NumMeshesPerFormat[NUM_VERTEX_FORMAT_OPTIONS] = {};
+		for (const FMeshImportStats& Stats : ImportStats)
+		{
+			Total += Stats.Quantization;
+			++NumMeshesPerFormat[GetVertexFormatOption(Stats.Quantization.Format)];
+		}
+		const float SavedPercent = Total.BytesBefore ? 100.0f * (1.0f - float(Total.BytesAfter) / Total.BytesBefore) : 0.0f;
+		Log::Info("   Vertex quantization: %zu full precision, %zu packed1 (28B), %zu packed2 (24B) meshes | max error: normal %.3f deg, uv %.6f | %.2f MB -> %.2f MB (%.1f%% saved)",
+			NumMeshesPerFormat[0], NumMeshesPerFormat[1], NumMeshesPerFormat[2],
+			Total.MaxNormalErrorDegrees, Total.MaxUVError,
+			Total.BytesBefore / (1024.0f * 1024.0f), Total.BytesAfter / (1024.0f * 1024.0f), SavedPercent
+		);
+	}
+#endif
+
 	return modelData;
 }
 
@@ -1175,6 +1374,119 @@ static Model::Data ImportGLTFScene
 		Log::Warning("No nodes found in glTF file for scene import: %s", ModelName.c_str());
 	}
 
+	// materials are created along with the node meshes here, the textures can only start afterwards
+	StartLoadingModelTextures(ModelName, pAssetLoader, MaterialTextureAssignments, taskID);
+	return modelData;
+}
+
+
+//----------------------------------------------------------------------------------------------------------------
+// MESH CACHE
+//----------------------------------------------------------------------------------------------------------------
+// Writes the meshes imported by ImportGLTFAllMeshes() into a cooked model file. Meshes w/o a
+// material don't make it into the model, hence they're skipped here too.
+static void CookGLTFModel(
+	const std::string& CookedFilePath,
+	uint64 SourceHash,
+	uint64 SourceStamp,
+	const std::string& ModelName,
+	const cgltf_data* data,
+	const std::string& modelDirectory,
+	const Model::Data& modelData,
+	const Scene* pScene
+)
+{
+	SCOPED_CPU_MARKER("CookGLTFModel()");
+	const std::vector<std::pair<MeshID, MaterialID>>& MeshMaterialIDPairs = modelData.GetMeshMaterialIDPairs(Model::Data::EMeshType::OPAQUE_MESH);
+
+	MeshCache::FCookedModelDesc Desc;
+	size_t iPrimitive = 0;
+	size_t iModelMesh = 0;
+	for (size_t mesh_idx = 0; mesh_idx < data->meshes_count; ++mesh_idx)
+	{
+		for (size_t prim_idx = 0; prim_idx < data->meshes[mesh_idx].primitives_count; ++prim_idx, ++iPrimitive)
+		{
+			const cgltf_material* material = data->meshes[mesh_idx].primitives[prim_idx].material;
+			if (!material)
+				continue;
+			if (iModelMesh == MeshMaterialIDPairs.size())
+				break;
+
+			const Mesh& mesh = pScene->GetMesh(MeshMaterialIDPairs[iModelMesh++].first);
+			MeshCache::FCookedModelDesc::FMesh& cookedMesh = Desc.Meshes.emplace_back();
+			cookedMesh.Name = ModelName;
+			cookedMesh.MaterialIndex = static_cast<int>(Desc.Materials.size());
+			cookedMesh.LocalSpaceBoundingBox = mesh.GetLocalSpaceBoundingBox();
+			cookedMesh.VertexFormat = mesh.GetVertexFormat();
+			cookedMesh.UVScaleBias = mesh.GetUVScaleBias();
+			cookedMesh.LODs = mesh.GetLODViews();
+			Desc.Materials.push_back(GetGLTFMaterialDesc(material, iPrimitive, modelDirectory));
+		}
+	}
+
+	if (Desc.Meshes.size() != MeshMaterialIDPairs.size())
+	{
+		Log::Warning("CookGLTFModel(): imported meshes don't match the glTF primitives for %s, skipping the mesh cache", ModelName.c_str());
+		return;
+	}
+	MeshCache::WriteCookedModel(CookedFilePath, SourceHash, SourceStamp, GLTF_IMPORTER_VERSION, Desc);
+}
+
+static Model::Data ImportCookedModel(
+	const std::string& ModelName,
+	const std::shared_ptr<MeshCache::FCookedModel>& pCookedModel,
+	const std::string& modelDirectory,
+	Scene* pScene,
+	AssetLoader* pAssetLoader,
+	AssetLoader::FMaterialTextureAssignments& MaterialTextureAssignments,
+	TaskID taskID
+)
+{
+	SCOPED_CPU_MARKER("ImportCookedModel()");
+	Model::Data modelData;
+	const MeshCache::FCookedModelHeader& Header = pCookedModel->GetHeader();
+
+	std::vector<MaterialID> MaterialIDs(Header.NumMaterials, INVALID_ID);
+	{
+		SCOPED_CPU_MARKER("Materials");
+		FLoadTimeline::FScopedStage Stage(pAssetLoader->mLoadTimeline, ModelName, FLoadTimeline::MATERIALS);
+		for (uint32 iMat = 0; iMat < Header.NumMaterials; ++iMat)
+		{
+			const MeshCache::FCookedMaterial& cooked = pCookedModel->GetMaterial(iMat);
+			MeshCache::FCookedModelDesc::FMaterial desc;
+			desc.Name = pCookedModel->GetString(cooked.NameOffset);
+			desc.Flags = cooked.Flags;
+			desc.Diffuse[0] = cooked.Diffuse[0];
+			desc.Diffuse[1] = cooked.Diffuse[1];
+			desc.Diffuse[2] = cooked.Diffuse[2];
+			desc.Alpha = cooked.Alpha;
+			desc.Metalness = cooked.Metalness;
+			desc.Roughness = cooked.Roughness;
+			desc.EmissiveIntensity = cooked.EmissiveIntensity;
+			for (uint32 iTex = 0; iTex < cooked.NumTextures; ++iTex)
+			{
+				const MeshCache::FCookedTexture& tex = pCookedModel->GetTexture(cooked.FirstTexture + iTex);
+				desc.Textures.push_back({ tex.TextureType, pCookedModel->GetString(tex.PathOffset) });
+			}
+			MaterialIDs[iMat] = CreateModelMaterial(desc, modelDirectory, pScene, pAssetLoader, MaterialTextureAssignments, taskID);
+		}
+	}
+	StartLoadingModelTextures(ModelName, pAssetLoader, MaterialTextureAssignments, taskID);
+	{
+		SCOPED_CPU_MARKER("Meshes");
+		FLoadTimeline::FScopedStage Stage(pAssetLoader->mLoadTimeline, ModelName, FLoadTimeline::MESHES);
+		for (uint32 iMesh = 0; iMesh < Header.NumMeshes; ++iMesh)
+		{
+			const MeshCache::FCookedMesh& cooked = pCookedModel->GetMesh(iMesh);
+			if (cooked.MaterialIndex < 0)
+				continue;
+
+			// the meshes reference the mapped file until their buffers are created
+			Mesh mesh(pCookedModel->GetMeshLODViews(iMesh), pCookedModel->GetMeshBoundingBox(iMesh), pCookedModel->GetMeshVertexFormat(iMesh), pCookedModel->GetMeshUVScaleBias(iMesh), pCookedModel, pCookedModel->GetString(cooked.NameOffset));
+			MeshID id = pScene->AddMesh(std::move(mesh));
+			modelData.AddMesh(id, MaterialIDs[cooked.MaterialIndex], Model::Data::EMeshType::OPAQUE_MESH);
+		}
+	}
 	return modelData;
 }
 
@@ -1182,6 +1494,56 @@ static Model::Data ImportGLTFScene
 //----------------------------------------------------------------------------------------------------------------
 // IMPORT MODEL FUNCTION FOR WORKER THREADS
 //----------------------------------------------------------------------------------------------------------------
+// Common to the glTF & cooked imports: creates the model & the mesh buffers, then assigns the textures.
+// The textures were started right after the materials were created (StartLoadingModelTextures()) and
+// keep decoding while the buffers are created & uploaded: they're waited on last.
+static ModelID FinalizeModelImport(
+	Scene* pScene,
+	AssetLoader* pAssetLoader,
+	VQRenderer* pRenderer,
+	const std::string& objFilePath,
+	const std::string& ModelName,
+	Model::Data&& modelData,
+	AssetLoader::FMaterialTextureAssignments& MaterialTextureAssignments,
+	TaskID taskID
+)
+{
+	SCOPED_CPU_MARKER("FinalizeModelImport()");
+	pRenderer->WaitHeapsInitialized();
+
+	{
+		SCOPED_CPU_MARKER("UploadVertexAndIndexBufferHeaps()");
+		pRenderer->UploadVertexAndIndexBufferHeaps();
+	}
+
+	// Cache the imported model
+	ModelID mID = pScene->CreateModel();
+	Model& model = pScene->GetModel(mID);
+	model = Model(objFilePath, ModelName, std::move(modelData));
+
+	{
+		FLoadTimeline::FScopedStage Stage(pAssetLoader->mLoadTimeline, ModelName, FLoadTimeline::BUFFERS);
+		pRenderer->WaitHeapsInitialized();
+		for (const auto& [meshID, matID] : model.mData.GetMeshMaterialIDPairs(Model::Data::EMeshType::OPAQUE_MESH))
+		{
+			if (!pScene->ClaimMeshBufferCreation(meshID))
+				continue; // geometry shared with another model, see Scene::AddMesh()
+			Mesh& mesh = pScene->GetMesh(meshID);
+			mesh.CreateBuffers(pRenderer, !SCENE_DEDUPLICATE_MESHES); // see Scene::ReleaseMeshGeometry()
+		}
+		pRenderer->UploadVertexAndIndexBufferHeaps();
+	}
+
+	// Assign texture IDs
+	{
+		FLoadTimeline::FScopedStage Stage(pAssetLoader->mLoadTimeline, ModelName, FLoadTimeline::TEXTURE_ASSIGNMENT);
+		MaterialTextureAssignments.DoAssignments(pScene, pScene->mMtxTexturePaths, pScene->mTexturePaths, pRenderer);
+	}
+	pAssetLoader->mLoadTimeline.EndStage(ModelName, FLoadTimeline::TEXTURES); // no-op w/o textures
+	pAssetLoader->mLoadTimeline.MarkStage(ModelName, FLoadTimeline::READY);
+	return mID;
+}
+
 ModelID AssetLoader::ImportGLTF(Scene* pScene, AssetLoader* pAssetLoader, VQRenderer* pRenderer, const std::string& objFilePath, std::string ModelName)
 {
 	SCOPED_CPU_MARKER("AssetLoader::ImportGLTF()");
@@ -1193,42 +1555,49 @@ ModelID AssetLoader::ImportGLTF(Scene* pScene, AssetLoader* pAssetLoader, VQRend
 	Timer t;
 	t.Start();
 
+	pAssetLoader->mLoadTimeline.BeginStage(ModelName, FLoadTimeline::PARSE);
+#if MESH_CACHE_ENABLED
+	const std::string CookedFilePath = MeshCache::GetCookedFilePath(objFilePath);
+	const uint64 SourceStamp = MeshCache::ComputeSourceStamp(objFilePath); // before the source is read: an edit during the import doesn't match it
+	std::shared_ptr<MeshCache::FCookedModel> pCookedModel = pAssetLoader->TakePreloadedModel(StringInterner::Intern(objFilePath)); // opened & validated by PreloadSceneAssets()
+	if (pCookedModel && pCookedModel->GetSourceStamp() != SourceStamp)
+	{
+		// the source was touched after the preload validated the cooked file: Open() below checks it again
+		Log::Info("MeshCache: %s changed since it was preloaded", objFilePath.c_str());
+		pCookedModel.reset();
+	}
+	if (!pCookedModel)
+	{
+		pCookedModel = MeshCache::FCookedModel::Open(CookedFilePath, objFilePath, SourceStamp, GLTF_IMPORTER_VERSION);
+	}
+	if (pCookedModel)
+	{
+		pAssetLoader->mLoadTimeline.EndStage(ModelName, FLoadTimeline::PARSE);
+		AssetLoader::FMaterialTextureAssignments MaterialTextureAssignments;
+		Model::Data modelData = ImportCookedModel(ModelName, pCookedModel, modelDirectory, pScene, pAssetLoader, MaterialTextureAssignments, taskID);
+		pCookedModel.reset(); // the meshes hold on to the mapped file until their buffers are created
+
+		ModelID mID = FinalizeModelImport(pScene, pAssetLoader, pRenderer, objFilePath, ModelName, std::move(modelData), MaterialTextureAssignments, taskID);
+
+		t.Stop();
+		const Model& model = pScene->GetModel(mID);
+		Log::Info("   [%.2fs] Loaded Model '%s' from %s: %d meshes, %d materials",
+			t.DeltaTime(),
+			ModelName.c_str(),
+			CookedFilePath.c_str(),
+			model.mData.GetNumMeshesOfAllTypes(),
+			model.mData.GetMaterials().size());
+		return mID;
+	}
+	const uint64 SourceHash = MeshCache::ComputeSourceHash(objFilePath); // for the cooked file written after the import
+#endif
+
 	// Initialize cgltf options
 	cgltf_options options = {};
-	options.file.read = [](const struct cgltf_memory_options* memory_options, const struct cgltf_file_options* file_options, const char* path, cgltf_size* size, void** data)
-	{
-		FILE* file = fopen(path, "rb");
-		if (!file)
-			return cgltf_result_file_not_found;
-		fseek(file, 0, SEEK_END);
-		long length = ftell(file);
-		fseek(file, 0, SEEK_SET);
-		if (length < 0)
-		{
-			fclose(file);
-			return cgltf_result_io_error;
-		}
-		*size = (cgltf_size)length;
-		char* file_data = (char*)memory_options->alloc_func(memory_options->user_data, *size);
-		if (!file_data)
-		{
-			fclose(file);
-			return cgltf_result_out_of_memory;
-		}
-		size_t read_size = fread(file_data, 1, *size, file);
-		fclose(file);
-		if (read_size != *size)
-		{
-			memory_options->free_func(memory_options->user_data, file_data);
-			return cgltf_result_io_error;
-		}
-		*data = file_data;
-		return cgltf_result_success;
-	};
-	options.file.release = [](const struct cgltf_memory_options* memory_options, const struct cgltf_file_options* file_options, void* data)
-	{
-		memory_options->free_func(memory_options->user_data, data);
-	};
+	std::shared_ptr<FGLTFMappedFiles> pMappedFiles = std::make_shared<FGLTFMappedFiles>(); // outlives the async cgltf_free()
+	options.file.read = ReadGLTFFile;
+	options.file.release = ReleaseGLTFFile;
+	options.file.user_data = pMappedFiles.get();
 	options.memory.alloc_func = [](void* user, cgltf_size size) { return malloc(size); };
 	options.memory.free_func = [](void* user, void* ptr) { free(ptr); };
 
@@ -1261,6 +1630,7 @@ ModelID AssetLoader::ImportGLTF(Scene* pScene, AssetLoader* pAssetLoader, VQRend
 		Log::Warning("cgltf_validate failed: %d", result);
 		// Proceed anyway, as some issues might be non-critical
 	}
+	pAssetLoader->mLoadTimeline.EndStage(ModelName, FLoadTimeline::PARSE);
 
 
 	// Process scene or all meshes based on mode
@@ -1278,44 +1648,38 @@ ModelID AssetLoader::ImportGLTF(Scene* pScene, AssetLoader* pAssetLoader, VQRend
 	}
 
 
-	pRenderer->WaitHeapsInitialized();
-
+#if MESH_CACHE_ENABLED
+	if (bImportAllMeshes)
 	{
-		SCOPED_CPU_MARKER("UploadVertexAndIndexBufferHeaps()");
-		pRenderer->UploadVertexAndIndexBufferHeaps();
+		Timer tCook;
+		tCook.Start();
+		CookGLTFModel(CookedFilePath, SourceHash, SourceStamp, ModelName, data, modelDirectory, modelData, pScene);
+		tCook.Stop();
+		Log::Info("   [%.2fs] Cooked '%s' into %s", tCook.DeltaTime(), ModelName.c_str(), CookedFilePath.c_str());
 	}
+#endif
 
-	if (!MaterialTextureAssignments.mAssignments.empty()) 
+#if GLTF_MAP_BUFFERS
+	if (pMappedFiles->NumMappedBytes > 0)
 	{
-		MaterialTextureAssignments.mTextureLoadResults = pAssetLoader->StartLoadingTextures(taskID);
+		Log::Info("   Mapped glTF buffers: %s instead of heap reads, %s released from the working set after decoding"
+			, StrUtil::FormatByte(static_cast<size_t>(pMappedFiles->NumMappedBytes.load())).c_str()
+			, StrUtil::FormatByte(static_cast<size_t>(pMappedFiles->NumReleasedBytes.load())).c_str()
+		);
 	}
-
-	// Cache the imported model
-	ModelID mID = pScene->CreateModel();
-	Model& model = pScene->GetModel(mID);
-	model = Model(objFilePath, ModelName, std::move(modelData));
+#endif
 
 	// Async cleanup
 	pAssetLoader->mWorkers_MeshLoad.AddTask([=]() 
 	{
 		SCOPED_CPU_MARKER("CleanUpGLTFData");
-		cgltf_free(data);
+		cgltf_free(data); // unmaps the files through pMappedFiles
 	});
 
-	// Assign texture IDs
-	MaterialTextureAssignments.DoAssignments(pScene, pScene->mMtxTexturePaths, pScene->mTexturePaths, pRenderer);
-
-	pRenderer->WaitHeapsInitialized();
-	for (const auto& [meshID, matID] : model.mData.GetMeshMaterialIDPairs(Model::Data::EMeshType::OPAQUE_MESH))
-	{
-		Mesh& mesh = pScene->GetMesh(meshID);
-		mesh.CreateBuffers(pRenderer);
-	}
-	//pObject->mModelID = modelID;
-
-	pRenderer->UploadVertexAndIndexBufferHeaps();
+	ModelID mID = FinalizeModelImport(pScene, pAssetLoader, pRenderer, objFilePath, ModelName, std::move(modelData), MaterialTextureAssignments, taskID);
 
 	t.Stop();
+	const Model& model = pScene->GetModel(mID);
 	Log::Info("   [%.2fs] Loaded Model '%s': %d meshes, %d materials",
 		fTimeReadFile + t.DeltaTime(),
 		ModelName.c_str(),
@@ -1323,4 +1687,121 @@ ModelID AssetLoader::ImportGLTF(Scene* pScene, AssetLoader* pAssetLoader, VQRend
 		model.mData.GetMaterials().size());
 
 	return mID;
-}
\ No newline at end of file
+}
+
+//----------------------------------------------------------------------------------------------------------------
+// SCENE PRELOAD
+//----------------------------------------------------------------------------------------------------------------
+void AssetLoader::PreloadSceneAssets(const FSceneRepresentation& SceneRep, uint64 MemoryCapBytes, const std::atomic<bool>& bCancel)
+{
+	SCOPED_CPU_MARKER("AssetLoader::PreloadSceneAssets()");
+	Timer t;
+	t.Start();
+
+	uint64 NumBytes = 0;
+	size_t NumModels = 0;
+	size_t NumTextures = 0;
+	auto fnStop = [&]() { return bCancel.load() || NumBytes >= MemoryCapBytes || mWorkers_ModelLoad.IsExiting(); };
+
+	// same paths & types as the scene load requests them, so that the TextureManager hands out the preloaded textures
+	std::vector<std::pair<StringID, ETextureType>> Textures;
+	std::unordered_set<StringID> UniqueTexturePaths;
+	auto fnAddTexture = [&](const std::string& Path, ETextureType TexType)
+	{
+		if (Path.empty() || Path.rfind("Procedural/", 0) == 0)
+			return;
+		const StringID PathID = StringInterner::Intern(Path);
+		if (UniqueTexturePaths.insert(PathID).second)
+			Textures.push_back({ PathID, TexType });
+	};
+	for (const FMaterialRepresentation& MatRep : SceneRep.Materials)
+	{
+		fnAddTexture(MatRep.DiffuseMapFilePath  , ETextureType::DIFFUSE);
+		fnAddTexture(MatRep.NormalMapFilePath   , ETextureType::NORMALS);
+		fnAddTexture(MatRep.EmissiveMapFilePath , ETextureType::EMISSIVE);
+		fnAddTexture(MatRep.AlphaMaskMapFilePath, ETextureType::ALPHA_MASK);
+		fnAddTexture(MatRep.MetallicMapFilePath , ETextureType::METALNESS);
+		fnAddTexture(MatRep.RoughnessMapFilePath, ETextureType::ROUGHNESS);
+		fnAddTexture(MatRep.AOMapFilePath       , ETextureType::AMBIENT_OCCLUSION);
+		fnAddTexture(MatRep.HeightMapFilePath   , ETextureType::HEIGHT);
+	}
+
+#if MESH_CACHE_ENABLED
+	// cooked models: opening decodes the index streams, the file is then faulted into memory
+	std::unordered_set<StringID> UniqueModelPaths;
+	for (const FGameObjectRepresentation& ObjRep : SceneRep.Objects)
+	{
+		if (fnStop())
+			break;
+		const std::string& ModelPath = ObjRep.ModelFilePath;
+		if (ModelPath.empty())
+			continue;
+		const StringID ModelPathID = StringInterner::Intern(ModelPath);
+		if (!UniqueModelPaths.insert(ModelPathID).second || mAssetCache.HasModel(ModelPathID))
+			continue;
+		{
+			std::lock_guard<std::mutex> lk(mMtxPreloadedModels);
+			if (mPreloadedModels.find(ModelPathID) != mPreloadedModels.end())
+				continue;
+		}
+
+		std::shared_ptr<MeshCache::FCookedModel> pCookedModel = MeshCache::FCookedModel::Open(MeshCache::GetCookedFilePath(ModelPath), ModelPath, MeshCache::ComputeSourceStamp(ModelPath), GLTF_IMPORTER_VERSION);
+		if (!pCookedModel)
+			continue; // not cooked yet: the scene load imports it from the source file
+		NumBytes += pCookedModel->Prefetch();
+
+		const std::string modelDirectory = DirectoryUtil::GetFolderPath(ModelPath);
+		for (uint32 iTex = 0; iTex < pCookedModel->GetHeader().NumTextures; ++iTex)
+		{
+			const MeshCache::FCookedTexture& tex = pCookedModel->GetTexture(iTex);
+			fnAddTexture(modelDirectory + pCookedModel->GetString(tex.PathOffset), static_cast<ETextureType>(tex.TextureType));
+		}
+
+		std::lock_guard<std::mutex> lk(mMtxPreloadedModels);
+		mPreloadedModels[ModelPathID] = std::move(pCookedModel);
+		++NumModels;
+	}
+#endif
+
+	// textures go through the whole TextureManager pipeline one at a time, leaving its workers to the running scene
+	TextureManager& TexMgr = mRenderer.GetTextureManager();
+	for (const auto& [TexturePath, TexType] : Textures)
+	{
+		if (fnStop())
+			break;
+		const TextureID TexID = CreateFileTexture(StringInterner::GetString(TexturePath), TexType);
+		if (TexID == INVALID_ID)
+			continue;
+		TexMgr.WaitForTexture(TexID);
+		NumBytes += TexMgr.GetTextureAllocationSize(TexID);
+		mAssetCache.AddPreloadedTexture(TexID, TexturePath);
+		++NumTextures;
+	}
+
+	t.Stop();
+	Log::Info("[Preload] %s: %zu models, %zu textures, %s in %.2fs%s"
+		, SceneRep.SceneName.c_str()
+		, NumModels
+		, NumTextures
+		, StrUtil::FormatByte(static_cast<size_t>(NumBytes)).c_str()
+		, t.DeltaTime()
+		, bCancel.load() ? " (cancelled)" : (NumBytes >= MemoryCapBytes ? " (memory cap reached)" : "")
+	);
+}
+
+std::shared_ptr<MeshCache::FCookedModel> AssetLoader::TakePreloadedModel(StringID ModelPath)
+{
+	std::lock_guard<std::mutex> lk(mMtxPreloadedModels);
+	auto it = mPreloadedModels.find(ModelPath);
+	if (it == mPreloadedModels.end())
+		return nullptr;
+	std::shared_ptr<MeshCache::FCookedModel> pCookedModel = std::move(it->second);
+	mPreloadedModels.erase(it);
+	return pCookedModel;
+}
+
+void AssetLoader::ClearPreloadedModels()
+{
+	std::lock_guard<std::mutex> lk(mMtxPreloadedModels);
+	mPreloadedModels.clear();
+}
@@ -18,15 +18,21 @@
 #pragma once
 
 #include "Scene/Model.h"
+#include "LoadTimeline.h"
+#include "AssetCache.h"
+#include "Core/StringInterner.h"
 
-#include <set>
 #include <queue>
 #include <mutex>
 #include <future>
+#include <atomic>
+#include <memory>
 
 class ThreadPool;
 class Scene;
 class GameObject;
+struct FSceneRepresentation;
+namespace MeshCache { class FCookedModel; }
 
 class AssetLoader
 {
@@ -68,12 +74,12 @@ public:
 	{
 		ETextureType TexType;
 		MaterialID   MatID;
-		std::string  TexturePath;
+		StringID     TexturePath;
 	};
 	struct FTextureLoadResult
 	{
 		ETextureType type; // material textures: diffuse/normal/alpha_mask/...
-		std::string TexturePath;
+		StringID TexturePath;
 		TextureID TexID;
 	};
 	using TextureLoadResults_t = std::unordered_multimap<MaterialID, FTextureLoadResult>;
@@ -86,7 +92,7 @@ public:
 		using pfnImportModel_t = ModelID(*)(Scene* pScene, AssetLoader* pAssetLoader, VQRenderer* pRenderer, const std::string& objFilePath, std::string ModelName);
 
 		GameObject* pObject = nullptr;
-		std::string      ModelPath;
+		StringID         ModelPath;
 		std::string      ModelName;
 		pfnImportModel_t pfnImportModel = nullptr;
 	};
@@ -96,13 +102,14 @@ public:
 	struct FMaterialTextureAssignment
 	{
 		MaterialID matID = INVALID_ID;
+		bool bReinitializeSRVs = false; // hot-reload: re-point the already allocated SRVs to the new textures
 	};
 	struct FMaterialTextureAssignments
 	{
 		void DoAssignments(
 			Scene* pScene, 
 			std::mutex& mtxTexturePaths,
-			std::unordered_map<TextureID, std::string>& TexturePaths, 
+			std::unordered_map<TextureID, StringID>& TexturePaths, 
 			VQRenderer* pRenderer
 		);
 
@@ -128,26 +135,39 @@ public:
 
 	static ModelID ImportGLTF(Scene* pScene, AssetLoader* pAssetLoader, VQRenderer* pRenderer, const std::string& objFilePath, std::string ModelName);
 
+	// Scene preload, see VQEngine::StartPreloadingScene(): opens & prefetches the cooked models of the scene,
+	// then creates its textures one at a time and hands them to mAssetCache, pinned until the next scene load
+	// completes. Stops once MemoryCapBytes worth of assets are resident or when bCancel is set.
+	void PreloadSceneAssets(const FSceneRepresentation& SceneRep, uint64 MemoryCapBytes, const std::atomic<bool>& bCancel);
+	std::shared_ptr<MeshCache::FCookedModel> TakePreloadedModel(StringID ModelPath); // nullptr if not preloaded
+	void ClearPreloadedModels();
+
 	//
 	// DATA
 	//
 public:
 	ThreadPool& mWorkers_ModelLoad;
 	ThreadPool& mWorkers_MeshLoad;
+	FLoadTimeline mLoadTimeline; // reset by Scene::StartLoading()
+	AssetCache    mAssetCache;   // assets kept across scene loads
 private:
+	TextureID CreateFileTexture(const std::string& TexturePath, ETextureType TexType);
+
 	VQRenderer& mRenderer;
 
 	template<class T> struct FLoadTaskContext
 	{
-		std::queue<T>         LoadQueue;
-		std::set<std::string> UniquePaths;
+		std::queue<T>                LoadQueue;
+		std::unordered_set<StringID> UniquePaths;
 	};
 	std::unordered_map<TaskID, FLoadTaskContext<FTextureLoadParams>> mLookup_TextureLoadContext;
+	std::mutex                                                        mMtxTextureLoadContext; // model workers queue & start their textures concurrently
 
 	// TODO: use ConcurrentQueue<T> with ProcessElements(pfnProcess);
 	std::queue<FModelLoadParams> mModelLoadQueue;
-	std::set<std::string>        mUniqueModelPaths;
+	std::unordered_set<StringID> mUniqueModelPaths;
 	std::mutex                   mMtxQueue_ModelLoad;
 
-	std::unordered_map<std::string, ModelID> mLoadedModels;
+	std::unordered_map<StringID, std::shared_ptr<MeshCache::FCookedModel>> mPreloadedModels;
+	std::mutex                                                             mMtxPreloadedModels;
 };
\ No newline at end of file
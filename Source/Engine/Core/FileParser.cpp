@@ -18,6 +18,7 @@
 
 #include "FileParser.h"
 #include "Platform.h"
+#include "VirtualFileSystem.h"
 
 #include "Libs/VQUtils/Include/utils.h"
 #include "Libs/VQUtils/Libs/tinyxml2/tinyxml2.h"
@@ -56,6 +57,15 @@ static std::pair<std::string, std::string> ParseLineINI(const std::string& iniLi
 	return SettingNameValuePair;
 }
 
+// scene & material files are assets: read through the VFS, they may be packed
+static tinyxml2::XMLError LoadXMLDocument(tinyxml2::XMLDocument& doc, const std::string& FilePath)
+{
+	VFS::FFile File;
+	if (!VFS::ReadFile(FilePath, File))
+		return tinyxml2::XML_ERROR_FILE_NOT_FOUND;
+	return doc.Parse(static_cast<const char*>(File.GetData()), File.GetSize());
+}
+
 static std::unordered_map<std::string, EDisplayMode> S_LOOKUP_STR_TO_DISPLAYMODE =
 {
 	  //{ "Fullscreen"           , EDisplayMode::EXCLUSIVE_FULLSCREEN   }
@@ -206,6 +216,21 @@ void FileParser::ParseEngineSettingsFile(FStartupParameters& params)
 				params.bOverrideENGSetting_StartupScene = true;
 				strncpy_s(params.EngineSettings.StartupScene, SettingValue.c_str(), sizeof(params.EngineSettings.StartupScene));
 			}
+			if (SettingName == "HotReloadScenes")
+			{
+				params.bOverrideENGSetting_bHotReloadScenes = true;
+				params.EngineSettings.bHotReloadScenes = StrUtil::ParseBool(SettingValue);
+			}
+			if (SettingName == "AssetRetentionBudgetMB")
+			{
+				params.bOverrideENGSetting_AssetRetentionBudgetMB = true;
+				params.EngineSettings.AssetRetentionBudgetMB = StrUtil::ParseInt(SettingValue);
+			}
+			if (SettingName == "ScenePreloadBudgetMB")
+			{
+				params.bOverrideENGSetting_ScenePreloadBudgetMB = true;
+				params.EngineSettings.ScenePreloadBudgetMB = StrUtil::ParseInt(SettingValue);
+			}
 		}
 	}
 	else
@@ -734,7 +759,7 @@ FSceneRepresentation FileParser::ParseSceneFile(const std::string& SceneFile)
 
 	// parse XML
 	tinyxml2::XMLDocument doc;
-	doc.LoadFile(SceneFile.c_str());
+	LoadXMLDocument(doc, SceneFile);
 
 	// scene name
 	SceneRep.SceneName = DirectoryUtil::GetFileNameWithoutExtension(SceneFile);
@@ -799,13 +824,19 @@ FSceneRepresentation FileParser::ParseSceneFile(const std::string& SceneFile)
 }
 
 
+bool FileParser::IsXMLFileValid(const std::string& XMLFilePath)
+{
+	tinyxml2::XMLDocument doc;
+	return LoadXMLDocument(doc, XMLFilePath) == tinyxml2::XML_SUCCESS;
+}
+
 std::vector<FMaterialRepresentation> FileParser::ParseMaterialFile(const std::string& MaterialFilePath)
 {
 	std::vector<FMaterialRepresentation> matReps;
 
 	// open xml file
 	tinyxml2::XMLDocument doc;
-	doc.LoadFile(MaterialFilePath.c_str());
+	LoadXMLDocument(doc, MaterialFilePath);
 
 	XMLElement* pRoot = doc.FirstChildElement();
 
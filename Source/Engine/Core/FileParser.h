@@ -32,4 +32,7 @@ namespace FileParser
 	std::vector<FDisplayHDRProfile>          ParseHDRProfilesFile();
 	FSceneRepresentation                     ParseSceneFile(const std::string& SceneFile);
 	std::vector<FMaterialRepresentation>     ParseMaterialFile(const std::string& MaterialFilePath);
+
+	// false if the file can't be read or isn't well-formed, e.g. while an editor is still writing it
+	bool                                     IsXMLFileValid(const std::string& XMLFilePath);
 }
\ No newline at end of file
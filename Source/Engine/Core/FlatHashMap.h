@@ -0,0 +1,507 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <type_traits>
+#include <tuple>
+#include <functional>
+#include <shared_mutex>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <cstdint>
+#include <cassert>
+
+//
+// FLAT HASH MAP
+//
+// Resources on open addressing / robin hood hashing
+//
+// - https://programming.guide/robin-hood-hashing.html
+// - https://probablydance.com/2017/02/26/i-wrote-the-fastest-hashtable/
+// - https://codecapsule.com/2013/11/17/robin-hood-hashing-backward-shift-deletion/
+//
+// Open addressing w/ linear probing & robin hood displacement over a flat bucket
+// array of { value pointer, 32-bit hash, value index }: a lookup walks a few contiguous
+// 16-byte buckets and only touches the value storage on a hash match. Erase uses
+// backward shift deletion, no tombstones.
+//
+// Unlike the usual flat maps, the key/value pairs are NOT stored in the buckets but
+// in fixed-size pages that are never reallocated: a rehash only moves the buckets.
+// This keeps the std::unordered_map guarantee the engine relies on -- pointers and
+// references to values stay valid until the value is erased -- which lets worker
+// threads hold on to values (e.g. PSO_ID* or latches) while the map grows,
+// and allows non-movable values like std::latch.
+//
+// Iterators are invalidated by insertion (rehash) and erasure, like std::unordered_map's on rehash.
+//
+template<class TKey, class TValue, class THash = std::hash<TKey>, class TKeyEqual = std::equal_to<TKey>>
+class FlatHashMap
+{
+public:
+	using key_type    = TKey;
+	using mapped_type = TValue;
+	using value_type  = std::pair<const TKey, TValue>;
+	using size_type   = size_t;
+
+	template<bool bConst>
+	class TIterator
+	{
+	public:
+		using MapPtr_t    = std::conditional_t<bConst, const FlatHashMap*, FlatHashMap*>;
+		using reference   = std::conditional_t<bConst, const value_type&, value_type&>;
+		using pointer     = std::conditional_t<bConst, const value_type*, value_type*>;
+
+		TIterator() = default;
+		TIterator(MapPtr_t pMap, size_t iBucket) : mpMap(pMap), miBucket(iBucket) { SkipEmptyBuckets(); }
+		template<bool B = bConst, class = std::enable_if_t<!B>>
+		operator TIterator<true>() const { return TIterator<true>(mpMap, miBucket); }
+
+		inline reference  operator*()  const { return *mpMap->mBuckets[miBucket].pValue; }
+		inline pointer    operator->() const { return  mpMap->mBuckets[miBucket].pValue; }
+		inline TIterator& operator++() { ++miBucket; SkipEmptyBuckets(); return *this; }
+		inline TIterator  operator++(int) { TIterator tmp = *this; ++(*this); return tmp; }
+		inline bool operator==(const TIterator& Other) const { return miBucket == Other.miBucket; }
+		inline bool operator!=(const TIterator& Other) const { return miBucket != Other.miBucket; }
+
+	private:
+		friend class FlatHashMap;
+		inline void SkipEmptyBuckets() { while (miBucket < mpMap->mBuckets.size() && mpMap->mBuckets[miBucket].Hash == 0) ++miBucket; }
+		MapPtr_t mpMap = nullptr;
+		size_t   miBucket = 0;
+	};
+	using iterator       = TIterator<false>;
+	using const_iterator = TIterator<true>;
+
+public:
+	FlatHashMap() = default;
+	~FlatHashMap();
+	FlatHashMap(const FlatHashMap& Other);
+	FlatHashMap(FlatHashMap&& Other) noexcept;
+	FlatHashMap& operator=(const FlatHashMap& Other);
+	FlatHashMap& operator=(FlatHashMap&& Other) noexcept;
+
+	template<class... TArgs>
+	std::pair<iterator, bool> try_emplace(const TKey& Key, TArgs&&... Args);
+	inline TValue& operator[](const TKey& Key) { return try_emplace(Key).first->second; }
+
+	iterator               find(const TKey& Key);
+	const_iterator         find(const TKey& Key) const;
+	inline bool            contains(const TKey& Key) const { return FindBucket(Key, HashOf(Key)) != NPOS; }
+	inline size_t          count(const TKey& Key) const { return contains(Key) ? 1 : 0; }
+	TValue&                at(const TKey& Key);
+	const TValue&          at(const TKey& Key) const;
+
+	size_t                 erase(const TKey& Key);
+	void                   erase(const_iterator it);
+	void                   clear();
+	void                   reserve(size_t NumElements);
+
+	inline size_t          size()  const { return mSize; }
+	inline bool            empty() const { return mSize == 0; }
+	inline iterator        begin()       { return iterator(this, 0); }
+	inline iterator        end()         { return iterator(this, mBuckets.size()); }
+	inline const_iterator  begin() const { return const_iterator(this, 0); }
+	inline const_iterator  end()   const { return const_iterator(this, mBuckets.size()); }
+
+private:
+	struct FBucket
+	{
+		value_type* pValue = nullptr; // cached GetValueSlot(iValue), saves the page table load on lookups
+		uint32_t    Hash = 0;         // 0: empty bucket, the lowest bit is always set for occupied buckets
+		uint32_t    iValue = 0;       // index into the value pages
+	};
+	static constexpr size_t   NPOS = static_cast<size_t>(-1);
+	static constexpr uint32_t VALUE_PAGE_SHIFT = 8;
+	static constexpr uint32_t VALUE_PAGE_SIZE  = 1u << VALUE_PAGE_SHIFT;
+	static constexpr uint32_t VALUE_PAGE_MASK  = VALUE_PAGE_SIZE - 1;
+	static constexpr size_t   MIN_NUM_BUCKETS  = 16;
+
+	static inline uint32_t HashOf(const TKey& Key)
+	{
+		// std::hash is the identity for integers on some platforms: fibonacci hashing spreads
+		// sequential IDs over the buckets for the cost of a single multiply. The buckets are indexed
+		// by the top bits of the product (GetHomeBucket()), its lower bits don't spread sequential IDs
+		// as evenly and cluster them. The lowest bit marks the bucket as occupied.
+		const uint64_t x = static_cast<uint64_t>(THash{}(Key)) * 0x9E3779B97F4A7C15ull;
+		return static_cast<uint32_t>(x >> 32) | 1u;
+	}
+	inline size_t      GetBucketMask() const { return mBuckets.size() - 1; }
+	inline size_t      GetHomeBucket(uint32_t Hash) const { return Hash >> mHomeBucketShift; }
+	inline size_t      GetProbeDistance(uint32_t Hash, size_t iBucket) const { return (iBucket - GetHomeBucket(Hash)) & GetBucketMask(); }
+	inline value_type* GetValueSlot(uint32_t iValue) const { return mValuePages[iValue >> VALUE_PAGE_SHIFT] + (iValue & VALUE_PAGE_MASK); }
+
+	size_t   FindBucket(const TKey& Key, uint32_t Hash) const;
+	size_t   InsertBucket(uint32_t Hash, uint32_t iValue);
+	void     EraseBucket(size_t iBucket);
+	void     Rehash(size_t NumBuckets);
+	uint32_t AllocateValueSlot();
+	void     ReleaseValuePages();
+
+private:
+	std::vector<FBucket>     mBuckets; // power of 2 sized
+	std::vector<value_type*> mValuePages;
+	std::vector<uint32_t>    mFreeValueSlots;
+	uint32_t                 mNumValueSlotsUsed = 0;
+	size_t                   mSize = 0;
+	uint32_t                 mHomeBucketShift = 32; // 32 - log2(mBuckets.size())
+};
+
+
+//
+// CONCURRENT FLAT HASH MAP
+//
+// Reader-friendly wrapper: lookups share a reader lock, insert/remove take the writer lock.
+// Since the values never move, Get() returns a pointer that stays valid after the lock is
+// released, until the key is removed. Synchronizing the access to the value itself
+// is up to the caller.
+//
+template<class TKey, class TValue, class THash = std::hash<TKey>>
+class ConcurrentFlatHashMap
+{
+public:
+	inline TValue* Get(const TKey& Key)
+	{
+		std::shared_lock<std::shared_mutex> lk(mMtx);
+		auto it = mMap.find(Key);
+		return it == mMap.end() ? nullptr : &it->second;
+	}
+	inline const TValue* Get(const TKey& Key) const
+	{
+		std::shared_lock<std::shared_mutex> lk(mMtx);
+		auto it = mMap.find(Key);
+		return it == mMap.end() ? nullptr : &it->second;
+	}
+	inline       TValue& At(const TKey& Key)       { std::shared_lock<std::shared_mutex> lk(mMtx); return mMap.at(Key); }
+	inline const TValue& At(const TKey& Key) const { std::shared_lock<std::shared_mutex> lk(mMtx); return mMap.at(Key); }
+	inline bool          Contains(const TKey& Key) const { std::shared_lock<std::shared_mutex> lk(mMtx); return mMap.contains(Key); }
+
+	TValue& Insert(const TKey& Key, TValue Value) // inserts or assigns
+	{
+		std::unique_lock<std::shared_mutex> lk(mMtx);
+		auto [it, bInserted] = mMap.try_emplace(Key, std::move(Value));
+		if (!bInserted)
+			it->second = std::move(Value);
+		return it->second;
+	}
+	bool Remove(const TKey& Key)
+	{
+		std::unique_lock<std::shared_mutex> lk(mMtx);
+		return mMap.erase(Key) != 0;
+	}
+	size_t Remove(const std::vector<TKey>& Keys) // single writer lock for the batch
+	{
+		std::unique_lock<std::shared_mutex> lk(mMtx);
+		size_t NumRemoved = 0;
+		for (const TKey& Key : Keys)
+			NumRemoved += mMap.erase(Key);
+		return NumRemoved;
+	}
+	void Clear()
+	{
+		std::unique_lock<std::shared_mutex> lk(mMtx);
+		mMap.clear();
+	}
+	template<class TFunc> void ForEach(TFunc&& fn) const
+	{
+		std::shared_lock<std::shared_mutex> lk(mMtx);
+		for (const auto& [Key, Value] : mMap)
+			fn(Key, Value);
+	}
+	inline size_t size() const { std::shared_lock<std::shared_mutex> lk(mMtx); return mMap.size(); }
+
+private:
+	FlatHashMap<TKey, TValue, THash> mMap;
+	mutable std::shared_mutex        mMtx;
+};
+
+
+
+//
+// FlatHashMap Template Implementation
+//
+template<class TKey, class TValue, class THash, class TKeyEqual>
+inline FlatHashMap<TKey, TValue, THash, TKeyEqual>::~FlatHashMap()
+{
+	clear();
+	ReleaseValuePages();
+}
+
+template<class TKey, class TValue, class THash, class TKeyEqual>
+inline FlatHashMap<TKey, TValue, THash, TKeyEqual>::FlatHashMap(const FlatHashMap& Other)
+{
+	reserve(Other.size());
+	for (const value_type& kvp : Other)
+		try_emplace(kvp.first, kvp.second);
+}
+
+template<class TKey, class TValue, class THash, class TKeyEqual>
+inline FlatHashMap<TKey, TValue, THash, TKeyEqual>::FlatHashMap(FlatHashMap&& Other) noexcept
+	: mBuckets(std::move(Other.mBuckets))
+	, mValuePages(std::move(Other.mValuePages))
+	, mFreeValueSlots(std::move(Other.mFreeValueSlots))
+	, mNumValueSlotsUsed(Other.mNumValueSlotsUsed)
+	, mSize(Other.mSize)
+	, mHomeBucketShift(Other.mHomeBucketShift)
+{
+	Other.mBuckets.clear();
+	Other.mValuePages.clear();
+	Other.mFreeValueSlots.clear();
+	Other.mNumValueSlotsUsed = 0;
+	Other.mSize = 0;
+	Other.mHomeBucketShift = 32;
+}
+
+template<class TKey, class TValue, class THash, class TKeyEqual>
+inline FlatHashMap<TKey, TValue, THash, TKeyEqual>& FlatHashMap<TKey, TValue, THash, TKeyEqual>::operator=(const FlatHashMap& Other)
+{
+	if (this != &Other)
+	{
+		clear();
+		reserve(Other.size());
+		for (const value_type& kvp : Other)
+			try_emplace(kvp.first, kvp.second);
+	}
+	return *this;
+}
+
+template<class TKey, class TValue, class THash, class TKeyEqual>
+inline FlatHashMap<TKey, TValue, THash, TKeyEqual>& FlatHashMap<TKey, TValue, THash, TKeyEqual>::operator=(FlatHashMap&& Other) noexcept
+{
+	if (this != &Other)
+	{
+		clear();
+		ReleaseValuePages();
+		std::swap(mBuckets, Other.mBuckets);
+		std::swap(mValuePages, Other.mValuePages);
+		std::swap(mFreeValueSlots, Other.mFreeValueSlots);
+		std::swap(mNumValueSlotsUsed, Other.mNumValueSlotsUsed);
+		std::swap(mSize, Other.mSize);
+		std::swap(mHomeBucketShift, Other.mHomeBucketShift);
+	}
+	return *this;
+}
+
+template<class TKey, class TValue, class THash, class TKeyEqual>
+template<class... TArgs>
+inline std::pair<typename FlatHashMap<TKey, TValue, THash, TKeyEqual>::iterator, bool> FlatHashMap<TKey, TValue, THash, TKeyEqual>::try_emplace(const TKey& Key, TArgs&&... Args)
+{
+	const uint32_t Hash = HashOf(Key);
+	size_t iBucket = FindBucket(Key, Hash);
+	if (iBucket != NPOS)
+		return { iterator(this, iBucket), false };
+
+	// keep the load factor under 7/8
+	if ((mSize + 1) * 8 > mBuckets.size() * 7)
+		Rehash(mBuckets.empty() ? MIN_NUM_BUCKETS : mBuckets.size() * 2);
+
+	const uint32_t iValue = AllocateValueSlot();
+	new (GetValueSlot(iValue)) value_type(std::piecewise_construct, std::forward_as_tuple(Key), std::forward_as_tuple(std::forward<TArgs>(Args)...));
+	iBucket = InsertBucket(Hash, iValue);
+	++mSize;
+	return { iterator(this, iBucket), true };
+}
+
+template<class TKey, class TValue, class THash, class TKeyEqual>
+inline typename FlatHashMap<TKey, TValue, THash, TKeyEqual>::iterator FlatHashMap<TKey, TValue, THash, TKeyEqual>::find(const TKey& Key)
+{
+	const size_t iBucket = FindBucket(Key, HashOf(Key));
+	return iBucket == NPOS ? end() : iterator(this, iBucket);
+}
+
+template<class TKey, class TValue, class THash, class TKeyEqual>
+inline typename FlatHashMap<TKey, TValue, THash, TKeyEqual>::const_iterator FlatHashMap<TKey, TValue, THash, TKeyEqual>::find(const TKey& Key) const
+{
+	const size_t iBucket = FindBucket(Key, HashOf(Key));
+	return iBucket == NPOS ? end() : const_iterator(this, iBucket);
+}
+
+template<class TKey, class TValue, class THash, class TKeyEqual>
+inline TValue& FlatHashMap<TKey, TValue, THash, TKeyEqual>::at(const TKey& Key)
+{
+	const size_t iBucket = FindBucket(Key, HashOf(Key));
+	if (iBucket == NPOS)
+		throw std::out_of_range("FlatHashMap::at(): key not found");
+	return mBuckets[iBucket].pValue->second;
+}
+
+template<class TKey, class TValue, class THash, class TKeyEqual>
+inline const TValue& FlatHashMap<TKey, TValue, THash, TKeyEqual>::at(const TKey& Key) const
+{
+	const size_t iBucket = FindBucket(Key, HashOf(Key));
+	if (iBucket == NPOS)
+		throw std::out_of_range("FlatHashMap::at(): key not found");
+	return mBuckets[iBucket].pValue->second;
+}
+
+template<class TKey, class TValue, class THash, class TKeyEqual>
+inline size_t FlatHashMap<TKey, TValue, THash, TKeyEqual>::erase(const TKey& Key)
+{
+	const size_t iBucket = FindBucket(Key, HashOf(Key));
+	if (iBucket == NPOS)
+		return 0;
+	EraseBucket(iBucket);
+	return 1;
+}
+
+template<class TKey, class TValue, class THash, class TKeyEqual>
+inline void FlatHashMap<TKey, TValue, THash, TKeyEqual>::erase(const_iterator it)
+{
+	assert(it.mpMap == this && it.miBucket < mBuckets.size());
+	EraseBucket(it.miBucket);
+}
+
+template<class TKey, class TValue, class THash, class TKeyEqual>
+inline void FlatHashMap<TKey, TValue, THash, TKeyEqual>::clear()
+{
+	for (FBucket& bucket : mBuckets)
+	{
+		if (bucket.Hash == 0)
+			continue;
+		bucket.pValue->~value_type();
+		bucket = FBucket{};
+	}
+	mFreeValueSlots.clear();
+	mNumValueSlotsUsed = 0; // keep the pages around for reuse
+	mSize = 0;
+}
+
+template<class TKey, class TValue, class THash, class TKeyEqual>
+inline void FlatHashMap<TKey, TValue, THash, TKeyEqual>::reserve(size_t NumElements)
+{
+	size_t NumBuckets = MIN_NUM_BUCKETS;
+	while (NumElements * 8 > NumBuckets * 7)
+		NumBuckets *= 2;
+	if (NumBuckets > mBuckets.size())
+		Rehash(NumBuckets);
+}
+
+template<class TKey, class TValue, class THash, class TKeyEqual>
+inline size_t FlatHashMap<TKey, TValue, THash, TKeyEqual>::FindBucket(const TKey& Key, uint32_t Hash) const
+{
+	if (mBuckets.empty())
+		return NPOS;
+
+	const size_t Mask = GetBucketMask();
+	size_t iBucket = GetHomeBucket(Hash);
+	for (size_t Distance = 0; ; ++Distance)
+	{
+		const FBucket& bucket = mBuckets[iBucket];
+		if (bucket.Hash == 0)
+			return NPOS;
+		if (GetProbeDistance(bucket.Hash, iBucket) < Distance) // robin hood: the key would have displaced this one
+			return NPOS;
+		if (bucket.Hash == Hash && TKeyEqual{}(bucket.pValue->first, Key))
+			return iBucket;
+		iBucket = (iBucket + 1) & Mask;
+	}
+}
+
+template<class TKey, class TValue, class THash, class TKeyEqual>
+inline size_t FlatHashMap<TKey, TValue, THash, TKeyEqual>::InsertBucket(uint32_t Hash, uint32_t iValue)
+{
+	const size_t Mask = GetBucketMask();
+	FBucket Inserted = { GetValueSlot(iValue), Hash, iValue };
+	size_t iBucket = GetHomeBucket(Hash);
+	size_t iResult = NPOS;
+	for (size_t Distance = 0; ; ++Distance)
+	{
+		FBucket& bucket = mBuckets[iBucket];
+		if (bucket.Hash == 0)
+		{
+			bucket = Inserted;
+			return iResult == NPOS ? iBucket : iResult;
+		}
+
+		// robin hood: take the slot from the richer bucket and keep probing with it
+		const size_t BucketDistance = GetProbeDistance(bucket.Hash, iBucket);
+		if (BucketDistance < Distance)
+		{
+			std::swap(bucket, Inserted);
+			if (iResult == NPOS)
+				iResult = iBucket;
+			Distance = BucketDistance;
+		}
+		iBucket = (iBucket + 1) & Mask;
+	}
+}
+
+template<class TKey, class TValue, class THash, class TKeyEqual>
+inline void FlatHashMap<TKey, TValue, THash, TKeyEqual>::EraseBucket(size_t iBucket)
+{
+	mBuckets[iBucket].pValue->~value_type();
+	mFreeValueSlots.push_back(mBuckets[iBucket].iValue);
+
+	// backward shift deletion
+	const size_t Mask = GetBucketMask();
+	for (;;)
+	{
+		const size_t iNext = (iBucket + 1) & Mask;
+		const FBucket& next = mBuckets[iNext];
+		if (next.Hash == 0 || GetProbeDistance(next.Hash, iNext) == 0)
+		{
+			mBuckets[iBucket] = FBucket{};
+			break;
+		}
+		mBuckets[iBucket] = next;
+		iBucket = iNext;
+	}
+	--mSize;
+}
+
+template<class TKey, class TValue, class THash, class TKeyEqual>
+inline void FlatHashMap<TKey, TValue, THash, TKeyEqual>::Rehash(size_t NumBuckets)
+{
+	assert((NumBuckets & (NumBuckets - 1)) == 0);
+	std::vector<FBucket> OldBuckets(NumBuckets);
+	std::swap(OldBuckets, mBuckets);
+	mHomeBucketShift = 32;
+	while ((size_t(1) << (32 - mHomeBucketShift)) < NumBuckets)
+		--mHomeBucketShift;
+	for (const FBucket& bucket : OldBuckets)
+		if (bucket.Hash != 0)
+			InsertBucket(bucket.Hash, bucket.iValue);
+}
+
+template<class TKey, class TValue, class THash, class TKeyEqual>
+inline uint32_t FlatHashMap<TKey, TValue, THash, TKeyEqual>::AllocateValueSlot()
+{
+	if (!mFreeValueSlots.empty())
+	{
+		const uint32_t iValue = mFreeValueSlots.back();
+		mFreeValueSlots.pop_back();
+		return iValue;
+	}
+	if ((mNumValueSlotsUsed >> VALUE_PAGE_SHIFT) == mValuePages.size())
+	{
+		void* pPage = ::operator new(sizeof(value_type) * VALUE_PAGE_SIZE, std::align_val_t(alignof(value_type)));
+		mValuePages.push_back(static_cast<value_type*>(pPage));
+	}
+	return mNumValueSlotsUsed++;
+}
+
+template<class TKey, class TValue, class THash, class TKeyEqual>
+inline void FlatHashMap<TKey, TValue, THash, TKeyEqual>::ReleaseValuePages()
+{
+	for (value_type* pPage : mValuePages)
+		::operator delete(pPage, std::align_val_t(alignof(value_type)));
+	mValuePages.clear();
+	mNumValueSlotsUsed = 0;
+}
@@ -0,0 +1,115 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+#pragma once
+
+#include "Types.h"
+
+#include <cstring>
+
+//
+// HASH
+//
+// XXH64 (https://github.com/Cyan4973/xxHash): fast hashing of large byte streams for change detection
+// and content keys (mesh cache, geometry deduplication), not for hash table bucketing.
+// Every input bit reaches every output bit, streams can be chained by passing the previous hash as the seed.
+//
+namespace Hash
+{
+	constexpr uint64 XXH_PRIME64_1 = 0x9E3779B185EBCA87ull;
+	constexpr uint64 XXH_PRIME64_2 = 0xC2B2AE3D27D4EB4Full;
+	constexpr uint64 XXH_PRIME64_3 = 0x165667B19E3779F9ull;
+	constexpr uint64 XXH_PRIME64_4 = 0x85EBCA77C2B2AE63ull;
+	constexpr uint64 XXH_PRIME64_5 = 0x27D4EB2F165667C5ull;
+
+	inline uint64 RotL64(uint64 x, int r) { return (x << r) | (x >> (64 - r)); }
+	inline uint64 ReadU64(const unsigned char* p) { uint64 v; memcpy(&v, p, sizeof(v)); return v; }
+	inline uint32 ReadU32(const unsigned char* p) { uint32 v; memcpy(&v, p, sizeof(v)); return v; }
+
+	inline uint64 XXH64Round(uint64 Acc, uint64 Input)
+	{
+		Acc += Input * XXH_PRIME64_2;
+		Acc  = RotL64(Acc, 31);
+		return Acc * XXH_PRIME64_1;
+	}
+	inline uint64 XXH64MergeRound(uint64 Acc, uint64 Val)
+	{
+		Acc ^= XXH64Round(0, Val);
+		return Acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+	}
+
+	inline uint64 HashBytes(const void* pData, size_t NumBytes, uint64 Seed = 0)
+	{
+		const unsigned char* p    = static_cast<const unsigned char*>(pData);
+		const unsigned char* pEnd = p + NumBytes;
+		uint64 h;
+
+		if (NumBytes >= 32)
+		{
+			uint64 v1 = Seed + XXH_PRIME64_1 + XXH_PRIME64_2;
+			uint64 v2 = Seed + XXH_PRIME64_2;
+			uint64 v3 = Seed;
+			uint64 v4 = Seed - XXH_PRIME64_1;
+			const unsigned char* pLimit = pEnd - 32;
+			do
+			{
+				v1 = XXH64Round(v1, ReadU64(p     ));
+				v2 = XXH64Round(v2, ReadU64(p +  8));
+				v3 = XXH64Round(v3, ReadU64(p + 16));
+				v4 = XXH64Round(v4, ReadU64(p + 24));
+				p += 32;
+			} while (p <= pLimit);
+
+			h = RotL64(v1, 1) + RotL64(v2, 7) + RotL64(v3, 12) + RotL64(v4, 18);
+			h = XXH64MergeRound(h, v1);
+			h = XXH64MergeRound(h, v2);
+			h = XXH64MergeRound(h, v3);
+			h = XXH64MergeRound(h, v4);
+		}
+		else
+		{
+			h = Seed + XXH_PRIME64_5;
+		}
+
+		h += static_cast<uint64>(NumBytes);
+
+		for (; p + 8 <= pEnd; p += 8)
+		{
+			h ^= XXH64Round(0, ReadU64(p));
+			h  = RotL64(h, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+		}
+		if (p + 4 <= pEnd)
+		{
+			h ^= static_cast<uint64>(ReadU32(p)) * XXH_PRIME64_1;
+			h  = RotL64(h, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+			p += 4;
+		}
+		for (; p < pEnd; ++p)
+		{
+			h ^= static_cast<uint64>(*p) * XXH_PRIME64_5;
+			h  = RotL64(h, 11) * XXH_PRIME64_1;
+		}
+
+		// avalanche
+		h ^= h >> 33;
+		h *= XXH_PRIME64_2;
+		h ^= h >> 29;
+		h *= XXH_PRIME64_3;
+		h ^= h >> 32;
+		return h;
+	}
+}
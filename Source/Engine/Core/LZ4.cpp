@@ -0,0 +1,185 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+
+#include "LZ4.h"
+
+#include <cstring>
+#include <vector>
+
+namespace LZ4
+{
+	constexpr size_t MIN_MATCH     = 4;
+	constexpr size_t LAST_LITERALS = 5;  // the last 5 bytes are always literals
+	constexpr size_t MF_LIMIT      = 12; // a match can't start in the last 12 bytes
+	constexpr size_t MAX_OFFSET    = 65535;
+	constexpr uint32 HASH_LOG      = 16;
+	constexpr uint32 RUN_MASK      = 15;
+	constexpr uint32 SKIP_TRIGGER  = 6;  // step up the search stride every 2^6 misses: incompressible data is skipped faster
+
+	static inline uint32 Read32(const uint8* p) { uint32 v; memcpy(&v, p, sizeof(v)); return v; }
+	static inline uint32 HashSequence(uint32 Sequence) { return (Sequence * 2654435761u) >> (32 - HASH_LOG); }
+
+	static inline uint8* WriteLength(uint8* op, size_t Length)
+	{
+		for (; Length >= 255; Length -= 255)
+			*op++ = 255;
+		*op++ = static_cast<uint8>(Length);
+		return op;
+	}
+
+	// MatchLength excludes MIN_MATCH, Offset 0 writes the last sequence
+	static uint8* WriteSequence(uint8* op, const uint8* oend, const uint8* pLiterals, size_t NumLiterals, size_t Offset, size_t MatchLength)
+	{
+		const size_t WorstCase = 1 + NumLiterals / 255 + 1 + NumLiterals + 2 + MatchLength / 255 + 1;
+		if (WorstCase > static_cast<size_t>(oend - op))
+			return nullptr;
+
+		uint8* pToken = op++;
+		*pToken = static_cast<uint8>((NumLiterals >= RUN_MASK ? RUN_MASK : NumLiterals) << 4);
+		if (NumLiterals >= RUN_MASK)
+			op = WriteLength(op, NumLiterals - RUN_MASK);
+		if (NumLiterals > 0)
+			memcpy(op, pLiterals, NumLiterals);
+		op += NumLiterals;
+
+		if (Offset == 0)
+			return op;
+
+		*op++ = static_cast<uint8>(Offset & 0xFF);
+		*op++ = static_cast<uint8>(Offset >> 8);
+		*pToken |= static_cast<uint8>(MatchLength >= RUN_MASK ? RUN_MASK : MatchLength);
+		if (MatchLength >= RUN_MASK)
+			op = WriteLength(op, MatchLength - RUN_MASK);
+		return op;
+	}
+
+	size_t Compress(const uint8* pSrc, size_t SrcSize, uint8* pDst, size_t DstCapacity)
+	{
+		const uint8* ip     = pSrc;
+		const uint8* anchor = pSrc;
+		const uint8* iend   = pSrc + SrcSize;
+		uint8*       op     = pDst;
+		uint8* const oend   = pDst + DstCapacity;
+
+		if (SrcSize > MF_LIMIT)
+		{
+			std::vector<uint32> HashTable(size_t(1) << HASH_LOG, 0); // positions in pSrc, the matches are verified
+			const uint8* const mflimit    = iend - MF_LIMIT;
+			const uint8* const matchlimit = iend - LAST_LITERALS;
+			uint32 NumMisses = 0;
+
+			while (ip < mflimit)
+			{
+				const uint32 Sequence = Read32(ip);
+				const uint32 h = HashSequence(Sequence);
+				const uint8* ref = pSrc + HashTable[h];
+				HashTable[h] = static_cast<uint32>(ip - pSrc);
+
+				if (ref >= ip || static_cast<size_t>(ip - ref) > MAX_OFFSET || Read32(ref) != Sequence)
+				{
+					ip += 1 + (NumMisses++ >> SKIP_TRIGGER);
+					continue;
+				}
+				NumMisses = 0;
+
+				// extend the match backwards into the pending literals & forwards up to the last literals
+				while (ip > anchor && ref > pSrc && ip[-1] == ref[-1]) { --ip; --ref; }
+				const uint8* pMatchEnd = ip + MIN_MATCH;
+				const uint8* pRefEnd   = ref + MIN_MATCH;
+				while (pMatchEnd < matchlimit && *pMatchEnd == *pRefEnd) { ++pMatchEnd; ++pRefEnd; }
+
+				op = WriteSequence(op, oend, anchor, ip - anchor, ip - ref, (pMatchEnd - ip) - MIN_MATCH);
+				if (!op)
+					return 0;
+
+				ip = anchor = pMatchEnd;
+				if (ip < mflimit) // index a position inside the match for the next search
+					HashTable[HashSequence(Read32(ip - 2))] = static_cast<uint32>(ip - 2 - pSrc);
+			}
+		}
+
+		op = WriteSequence(op, oend, anchor, iend - anchor, 0, 0);
+		return op ? static_cast<size_t>(op - pDst) : 0;
+	}
+
+	static inline bool ReadLength(const uint8*& ip, const uint8* iend, size_t& Length)
+	{
+		uint8 b;
+		do
+		{
+			if (ip >= iend)
+				return false;
+			b = *ip++;
+			Length += b;
+		} while (b == 255);
+		return true;
+	}
+
+	bool Decompress(const uint8* pSrc, size_t SrcSize, uint8* pDst, size_t DstSize)
+	{
+		const uint8* ip   = pSrc;
+		const uint8* iend = pSrc + SrcSize;
+		uint8*       op   = pDst;
+		uint8* const oend = pDst + DstSize;
+
+		while (ip < iend)
+		{
+			const uint32 Token = *ip++;
+
+			size_t NumLiterals = Token >> 4;
+			if (NumLiterals == RUN_MASK && !ReadLength(ip, iend, NumLiterals))
+				return false;
+			if (NumLiterals > static_cast<size_t>(iend - ip) || NumLiterals > static_cast<size_t>(oend - op))
+				return false;
+			if (NumLiterals > 0)
+				memcpy(op, ip, NumLiterals);
+			op += NumLiterals;
+			ip += NumLiterals;
+
+			if (ip == iend) // last sequence
+				break;
+
+			if (iend - ip < 2)
+				return false;
+			const size_t Offset = static_cast<size_t>(ip[0]) | (static_cast<size_t>(ip[1]) << 8);
+			ip += 2;
+			if (Offset == 0 || Offset > static_cast<size_t>(op - pDst))
+				return false;
+
+			size_t MatchLength = Token & RUN_MASK;
+			if (MatchLength == RUN_MASK && !ReadLength(ip, iend, MatchLength))
+				return false;
+			MatchLength += MIN_MATCH;
+			if (MatchLength > static_cast<size_t>(oend - op))
+				return false;
+
+			const uint8* pMatch = op - Offset;
+			if (Offset >= MatchLength)
+			{
+				memcpy(op, pMatch, MatchLength);
+				op += MatchLength;
+			}
+			else // overlapping copy repeats the last Offset bytes
+			{
+				for (size_t i = 0; i < MatchLength; ++i)
+					*op++ = pMatch[i];
+			}
+		}
+		return op == oend;
+	}
+}
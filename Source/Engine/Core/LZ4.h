@@ -0,0 +1,46 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+#pragma once
+
+#include "Types.h"
+
+#include <cstddef>
+
+//
+// LZ4
+//
+// Block format compressor & decompressor, compatible with the reference LZ4 block format:
+// a stream of sequences, each a token (4 bit literal length | 4 bit match length - 4), the
+// literals and a 16-bit little-endian match offset. Lengths of 15 and above continue in
+// 255-terminated extra bytes and the last sequence has only literals.
+//
+// The compressor is the greedy single-probe hash variant: fast enough to pack thousands of files,
+// the ratio is a few percent behind the reference high compression mode. The decompressor
+// checks every length & offset against the buffers, corrupt input fails instead of overrunning.
+//
+namespace LZ4
+{
+	// worst case compressed size of an incompressible input
+	inline size_t CompressBound(size_t SrcSize) { return SrcSize + SrcSize / 255 + 16; }
+
+	// returns the compressed size, 0 if the output doesn't fit in DstCapacity
+	size_t Compress(const uint8* pSrc, size_t SrcSize, uint8* pDst, size_t DstCapacity);
+
+	// DstSize is the exact decompressed size, returns false if the input is malformed or doesn't decode to DstSize bytes
+	bool Decompress(const uint8* pSrc, size_t SrcSize, uint8* pDst, size_t DstSize);
+}
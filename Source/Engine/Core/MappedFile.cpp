@@ -0,0 +1,124 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+
+#include "MappedFile.h"
+
+#include "Libs/VQUtils/Include/Log.h"
+
+#include <Windows.h>
+#include <utility>
+
+FMappedFile::FMappedFile(FMappedFile&& Other) noexcept
+	: mpData(std::exchange(Other.mpData, nullptr))
+	, mSize(std::exchange(Other.mSize, 0))
+	, mhFile(std::exchange(Other.mhFile, nullptr))
+	, mhMapping(std::exchange(Other.mhMapping, nullptr))
+{}
+
+FMappedFile& FMappedFile::operator=(FMappedFile&& Other) noexcept
+{
+	if (this != &Other)
+	{
+		Close();
+		mpData    = std::exchange(Other.mpData, nullptr);
+		mSize     = std::exchange(Other.mSize, 0);
+		mhFile    = std::exchange(Other.mhFile, nullptr);
+		mhMapping = std::exchange(Other.mhMapping, nullptr);
+	}
+	return *this;
+}
+
+bool FMappedFile::Open(const std::string& FilePath)
+{
+	Close();
+
+	HANDLE hFile = CreateFileA(FilePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (hFile == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER FileSize = {};
+	if (!GetFileSizeEx(hFile, &FileSize) || FileSize.QuadPart == 0)
+	{
+		CloseHandle(hFile); // empty files can't be mapped
+		return false;
+	}
+
+	HANDLE hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!hMapping)
+	{
+		Log::Error("FMappedFile: CreateFileMapping failed for %s (err=%d)", FilePath.c_str(), static_cast<int>(GetLastError()));
+		CloseHandle(hFile);
+		return false;
+	}
+
+	const void* pData = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+	if (!pData)
+	{
+		Log::Error("FMappedFile: MapViewOfFile failed for %s (err=%d)", FilePath.c_str(), static_cast<int>(GetLastError()));
+		CloseHandle(hMapping);
+		CloseHandle(hFile);
+		return false;
+	}
+
+	mpData = pData;
+	mSize = static_cast<size_t>(FileSize.QuadPart);
+	mhFile = hFile;
+	mhMapping = hMapping;
+	return true;
+}
+
+size_t FMappedFile::ReleasePages(const void* p, size_t Size) const
+{
+	if (!mpData || !Contains(p, Size))
+		return 0;
+
+	SYSTEM_INFO SysInfo = {};
+	GetSystemInfo(&SysInfo);
+	const uintptr_t PageSize = SysInfo.dwPageSize;
+	const uintptr_t Begin = (reinterpret_cast<uintptr_t>(p) + PageSize - 1) & ~(PageSize - 1);
+	const uintptr_t End   = (reinterpret_cast<uintptr_t>(p) + Size) & ~(PageSize - 1);
+	if (End <= Begin)
+		return 0;
+
+	// unlocking a range that isn't locked removes its pages from the working set, the call 'fails' with ERROR_NOT_LOCKED
+	VirtualUnlock(reinterpret_cast<void*>(Begin), End - Begin);
+	return End - Begin;
+}
+
+size_t FMappedFile::Prefetch() const
+{
+	if (!mpData)
+		return 0;
+
+	// a hint: the pages are still faulted in on access if the call fails
+	WIN32_MEMORY_RANGE_ENTRY Range = { const_cast<void*>(mpData), mSize };
+	if (!PrefetchVirtualMemory(GetCurrentProcess(), 1, &Range, 0))
+		return 0;
+	return mSize;
+}
+
+void FMappedFile::Close()
+{
+	if (mpData)    UnmapViewOfFile(mpData);
+	if (mhMapping) CloseHandle(mhMapping);
+	if (mhFile)    CloseHandle(mhFile);
+	mpData = nullptr;
+	mSize = 0;
+	mhFile = nullptr;
+	mhMapping = nullptr;
+}
@@ -0,0 +1,63 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+#pragma once
+
+#include "Types.h"
+
+#include <string>
+
+//
+// MAPPED FILE
+//
+// Read-only memory mapping of a whole file. The pages are brought in by the OS
+// on first access, so opening a large file is cheap and only the touched
+// ranges are read from disk. The view stays valid until Close() / destruction.
+// ReleasePages() trims a range from the working set once it's consumed: the pages
+// stay in the OS file cache and are faulted back in if they're accessed again.
+//
+class FMappedFile
+{
+public:
+	FMappedFile() = default;
+	~FMappedFile() { Close(); }
+	FMappedFile(const FMappedFile&) = delete;
+	FMappedFile& operator=(const FMappedFile&) = delete;
+	FMappedFile(FMappedFile&& Other) noexcept;
+	FMappedFile& operator=(FMappedFile&& Other) noexcept;
+
+	bool Open(const std::string& FilePath);
+	void Close();
+
+	inline bool        IsOpen()  const { return mpData != nullptr; }
+	inline const void* GetData() const { return mpData; }
+	inline size_t      GetSize() const { return mSize; }
+	template<class T> inline const T* GetDataAt(size_t Offset) const { return reinterpret_cast<const T*>(static_cast<const char*>(mpData) + Offset); }
+	inline bool        Contains(const void* p, size_t Size) const { return p >= mpData && static_cast<const char*>(p) + Size <= static_cast<const char*>(mpData) + mSize; }
+
+	// returns the number of bytes released: only the whole pages inside the range are released
+	size_t ReleasePages(const void* p, size_t Size) const;
+
+	// asks the OS to read the whole file in ahead of the accesses, returns the number of bytes requested
+	size_t Prefetch() const;
+
+private:
+	const void* mpData = nullptr;
+	size_t      mSize = 0;
+	void*       mhFile = nullptr;    // HANDLE, the header doesn't pull in Windows.h
+	void*       mhMapping = nullptr; // HANDLE
+};
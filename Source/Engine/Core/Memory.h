@@ -18,8 +18,10 @@
 #pragma once
 
 #include <vector>
+#include <algorithm>
 #include "Libs/VQUtils/Include/Log.h"
 #include "Libs/VQUtils/Include/utils.h"
+#include "MemoryTracking.h"
 
 //
 // Resources on memory management
@@ -73,6 +75,8 @@ public:
 private:
 	struct Block { Block* pNext; };
 
+	void BuildFreeList();
+
 	// memory
 	Block* mpNextFreeBlock = nullptr;
 	void*  mpAlloc         = nullptr;
@@ -109,21 +113,10 @@ inline MemoryPool<TObject>::MemoryPool(size_t NumBlocks, size_t Alignment)
 	assert(this->mpNextFreeBlock);
 	this->mpAlloc = this->mpNextFreeBlock;
 	this->mAllocSize = AllocSize;
+	MEMORY_TRACK_ALLOC(SCENE_POOLS, AllocSize);
 
 	// setup list structure
-	Block* pWalk = this->mpNextFreeBlock;
-	Block* pNextBlock = (Block*)(((unsigned char*)this->mpNextFreeBlock) + mAlignedObjSize);
-	for (size_t i = 0; i < NumBlocks; ++i)
-	{
-		if (i == NumBlocks - 1)
-		{
-			pWalk->pNext = nullptr;
-			break;
-		}
-		pWalk->pNext = pNextBlock;
-		pWalk = pNextBlock;
-		pNextBlock = (Block*)((unsigned char*)(pNextBlock) +mAlignedObjSize);
-	}
+	BuildFreeList();
 	
 
 #if MEMORY_POOL__ENABLE_DEBUG_LOG
@@ -153,7 +146,10 @@ inline MemoryPool<TObject>::~MemoryPool()
 	}
 
 	if (mpAlloc)
+	{
 		free(mpAlloc);
+		MEMORY_TRACK_FREE(SCENE_POOLS, mAllocSize);
+	}
 }
 
 template<class TObject>
@@ -216,8 +212,30 @@ template<class TObject>
 inline std::vector<size_t> MemoryPool<TObject>::Allocate(size_t NumBlocks)
 {
 	std::vector<size_t> Handles(NumBlocks, INVALID_HANDLE);
+	if (NumBlocks > this->mNumMaxBlocks - this->mNumUsedBlocks)
+	{
+		Log::Warning("MemoryPool is out of memory (%s) for allocating %d blocks, perhaps consider a larger initial size?", StrUtil::FormatByte(this->mAllocSize).c_str(), NumBlocks);
+		assert(false); // if you hit this, allocate a bigger pool on startup
+		return Handles;
+	}
+
+	// walk the free list once and grow the active handles once for the whole batch
+	size_t MaxHandle = 0;
 	for (size_t i = 0; i < NumBlocks; ++i)
-		Handles[i] = Allocate();
+	{
+		const size_t Handle = (reinterpret_cast<unsigned char*>(mpNextFreeBlock) - reinterpret_cast<unsigned char*>(mpAlloc)) / mAlignedObjSize;
+		Handles[i] = Handle;
+		MaxHandle = std::max(MaxHandle, Handle);
+		mpNextFreeBlock = mpNextFreeBlock->pNext;
+	}
+
+	if (NumBlocks > 0 && MaxHandle >= mActiveHandles.size()) {
+		mActiveHandles.resize(MaxHandle + 1, false);
+	}
+	for (size_t Handle : Handles)
+		mActiveHandles[Handle] = true;
+
+	this->mNumUsedBlocks += NumBlocks;
 	return Handles;
 }
 
@@ -250,9 +268,32 @@ inline void MemoryPool<TObject>::Free(const std::vector<size_t>& Handles)
 template<class TObject>
 inline void MemoryPool<TObject>::FreeAll()
 {
-	for (size_t handle = 0; handle < this->mActiveHandles.size(); ++handle)
-		if (this->mActiveHandles[handle])
-			Free(handle);
+	// instead of pushing each active block back onto the free list one by one,
+	// rebuild the list in address order: the pool is back to its initial state
+	// and the next Allocate(N) hands out handles [0, N) again.
+	BuildFreeList();
+	this->mActiveHandles.assign(this->mActiveHandles.size(), false);
+	this->mNumUsedBlocks = 0;
+}
+
+template<class TObject>
+inline void MemoryPool<TObject>::BuildFreeList()
+{
+	this->mpNextFreeBlock = reinterpret_cast<Block*>(this->mpAlloc);
+
+	Block* pWalk = this->mpNextFreeBlock;
+	Block* pNextBlock = (Block*)(((unsigned char*)this->mpNextFreeBlock) + mAlignedObjSize);
+	for (size_t i = 0; i < mNumMaxBlocks; ++i)
+	{
+		if (i == mNumMaxBlocks - 1)
+		{
+			pWalk->pNext = nullptr;
+			break;
+		}
+		pWalk->pNext = pNextBlock;
+		pWalk = pNextBlock;
+		pNextBlock = (Block*)((unsigned char*)(pNextBlock) +mAlignedObjSize);
+	}
 }
 
 template<class TObject> 
@@ -0,0 +1,122 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+
+#include "MemoryTracking.h"
+
+#include "Libs/VQUtils/Include/Log.h"
+
+#include <atomic>
+#include <fstream>
+#include <cassert>
+
+static const char* MEMORY_TAG_NAMES[static_cast<size_t>(EMemoryTag::NUM_MEMORY_TAGS)] =
+{
+	  "ScenePools"
+	, "Geometry"
+	, "TextureData"
+	, "RenderLists"
+	, "ShaderBlobs"
+};
+
+#if VQENGINE_MEMORY_TRACKING
+// one cache line per tag so that threads reporting to different tags don't contend
+struct alignas(64) FMemoryTagCounters
+{
+	std::atomic<int64_t> CurrentBytes = 0;
+	std::atomic<int64_t> PeakBytes = 0;
+	std::atomic<int64_t> NumAllocations = 0;
+	std::atomic<int64_t> NumLiveAllocations = 0;
+};
+static FMemoryTagCounters sCounters[static_cast<size_t>(EMemoryTag::NUM_MEMORY_TAGS)];
+
+void MemoryTracking::OnAllocate(EMemoryTag Tag, size_t NumBytes)
+{
+	FMemoryTagCounters& c = sCounters[static_cast<size_t>(Tag)];
+	const int64_t Current = c.CurrentBytes.fetch_add(static_cast<int64_t>(NumBytes), std::memory_order_relaxed) + static_cast<int64_t>(NumBytes);
+	c.NumAllocations.fetch_add(1, std::memory_order_relaxed);
+	c.NumLiveAllocations.fetch_add(1, std::memory_order_relaxed);
+
+	int64_t Peak = c.PeakBytes.load(std::memory_order_relaxed);
+	while (Current > Peak && !c.PeakBytes.compare_exchange_weak(Peak, Current, std::memory_order_relaxed));
+}
+
+void MemoryTracking::OnFree(EMemoryTag Tag, size_t NumBytes)
+{
+	FMemoryTagCounters& c = sCounters[static_cast<size_t>(Tag)];
+	c.CurrentBytes.fetch_sub(static_cast<int64_t>(NumBytes), std::memory_order_relaxed);
+	c.NumLiveAllocations.fetch_sub(1, std::memory_order_relaxed);
+}
+#endif // VQENGINE_MEMORY_TRACKING
+
+
+const char* MemoryTracking::GetTagName(EMemoryTag Tag)
+{
+	assert(Tag < EMemoryTag::NUM_MEMORY_TAGS);
+	return MEMORY_TAG_NAMES[static_cast<size_t>(Tag)];
+}
+
+FMemoryTagStats MemoryTracking::GetStats(EMemoryTag Tag)
+{
+	FMemoryTagStats Stats;
+#if VQENGINE_MEMORY_TRACKING
+	const FMemoryTagCounters& c = sCounters[static_cast<size_t>(Tag)];
+	Stats.CurrentBytes       = c.CurrentBytes.load(std::memory_order_relaxed);
+	Stats.PeakBytes          = c.PeakBytes.load(std::memory_order_relaxed);
+	Stats.NumAllocations     = c.NumAllocations.load(std::memory_order_relaxed);
+	Stats.NumLiveAllocations = c.NumLiveAllocations.load(std::memory_order_relaxed);
+#endif
+	return Stats;
+}
+
+std::string MemoryTracking::DumpJSON()
+{
+	std::string json = "{\n";
+	json += std::string("\t\"Enabled\": ") + (VQENGINE_MEMORY_TRACKING ? "true" : "false") + ",\n";
+	json += "\t\"Tags\": [\n";
+	for (size_t i = 0; i < static_cast<size_t>(EMemoryTag::NUM_MEMORY_TAGS); ++i)
+	{
+		const EMemoryTag Tag = static_cast<EMemoryTag>(i);
+		const FMemoryTagStats s = GetStats(Tag);
+
+		char buf[256];
+		snprintf(buf, sizeof(buf), "\t\t{ \"Name\": \"%s\", \"CurrentBytes\": %lld, \"PeakBytes\": %lld, \"NumAllocations\": %lld, \"NumLiveAllocations\": %lld }%s\n"
+			, GetTagName(Tag)
+			, static_cast<long long>(s.CurrentBytes)
+			, static_cast<long long>(s.PeakBytes)
+			, static_cast<long long>(s.NumAllocations)
+			, static_cast<long long>(s.NumLiveAllocations)
+			, (i == static_cast<size_t>(EMemoryTag::NUM_MEMORY_TAGS) - 1 ? "" : ",")
+		);
+		json += buf;
+	}
+	json += "\t]\n}\n";
+	return json;
+}
+
+bool MemoryTracking::DumpJSONToFile(const std::string& FilePath)
+{
+	std::ofstream file(FilePath);
+	if (!file.is_open())
+	{
+		Log::Error("MemoryTracking: couldn't open %s for writing", FilePath.c_str());
+		return false;
+	}
+	file << DumpJSON();
+	Log::Info("MemoryTracking: stats written to %s", FilePath.c_str());
+	return true;
+}
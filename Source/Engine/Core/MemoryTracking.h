@@ -0,0 +1,164 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+#pragma once
+
+#include <vector>
+#include <string>
+#include <new>
+#include <cstdint>
+
+// Set to 0 to compile the tracking out: the macros below expand to nothing
+// and the tracked containers/members alias to their untracked counterparts.
+#define VQENGINE_MEMORY_TRACKING 1
+
+//
+// MEMORY TRACKING
+//
+// Tagged CPU allocation accounting: allocation sites report the bytes they
+// allocate & free under a tag, and each tag keeps current/peak bytes and
+// allocation counts. The counters are lock-free atomics so the sites can
+// report from any thread.
+//
+// Reporting is done in 3 ways depending on the allocation site:
+//  - MEMORY_TRACK_ALLOC/FREE      : explicit pairs for raw allocations (e.g. MemoryPool)
+//  - MEMORY_TRACKED_BYTES         : a member that follows the lifetime of its owner (copy/move/destroy)
+//  - TrackedVector<T, Tag>        : std::vector w/ an allocator that reports its (re)allocations
+//
+enum class EMemoryTag : uint8_t
+{
+	SCENE_POOLS = 0,  // Scene's game object & transform MemoryPools
+	GEOMETRY,         // Mesh geometry data, until uploaded to the GPU
+	TEXTURE_DATA,     // TextureManager disk images & mip chains, until uploaded to the GPU
+	RENDER_LISTS,     // per-view culled mesh lists
+	SHADER_BLOBS,     // compiled shader bytecode
+
+	NUM_MEMORY_TAGS
+};
+
+struct FMemoryTagStats
+{
+	int64_t CurrentBytes = 0;
+	int64_t PeakBytes = 0;
+	int64_t NumAllocations = 0;     // cumulative
+	int64_t NumLiveAllocations = 0; // allocations - frees
+};
+
+namespace MemoryTracking
+{
+	const char*     GetTagName(EMemoryTag Tag);
+	FMemoryTagStats GetStats(EMemoryTag Tag);
+
+	// Dumps the stats of all tags as a JSON object:
+	// { "Tags": [ { "Name": "...", "CurrentBytes": 0, "PeakBytes": 0, "NumAllocations": 0, "NumLiveAllocations": 0 }, ... ] }
+	std::string     DumpJSON();
+	bool            DumpJSONToFile(const std::string& FilePath);
+
+#if VQENGINE_MEMORY_TRACKING
+	void OnAllocate(EMemoryTag Tag, size_t NumBytes);
+	void OnFree(EMemoryTag Tag, size_t NumBytes);
+#endif
+}
+
+
+
+#if VQENGINE_MEMORY_TRACKING
+
+#define MEMORY_TRACK_ALLOC(TAG, NumBytes)        MemoryTracking::OnAllocate(EMemoryTag::TAG, NumBytes)
+#define MEMORY_TRACK_FREE(TAG, NumBytes)         MemoryTracking::OnFree(EMemoryTag::TAG, NumBytes)
+#define MEMORY_TRACKED_BYTES(TAG, Name)          TTrackedBytes<EMemoryTag::TAG> Name
+#define MEMORY_TRACKED_BYTES_SET(Name, NumBytes) (Name).Set(NumBytes)
+
+// Reports a byte count that is owned by the enclosing object: the count is reported
+// again on copy, transferred on move and freed on destruction.
+template<EMemoryTag TAG>
+class TTrackedBytes
+{
+public:
+	TTrackedBytes() = default;
+	~TTrackedBytes() { Set(0); }
+	TTrackedBytes(const TTrackedBytes& Other) { Set(Other.mNumBytes); }
+	TTrackedBytes(TTrackedBytes&& Other) noexcept : mNumBytes(Other.mNumBytes) { Other.mNumBytes = 0; }
+	TTrackedBytes& operator=(const TTrackedBytes& Other) { if (this != &Other) Set(Other.mNumBytes); return *this; }
+	TTrackedBytes& operator=(TTrackedBytes&& Other) noexcept
+	{
+		if (this != &Other)
+		{
+			Set(0);
+			mNumBytes = Other.mNumBytes;
+			Other.mNumBytes = 0;
+		}
+		return *this;
+	}
+
+	inline void Set(size_t NumBytes)
+	{
+		if (NumBytes == mNumBytes)
+			return;
+		if (mNumBytes) MemoryTracking::OnFree(TAG, mNumBytes);
+		if (NumBytes)  MemoryTracking::OnAllocate(TAG, NumBytes);
+		mNumBytes = NumBytes;
+	}
+	inline size_t Get() const { return mNumBytes; }
+
+private:
+	size_t mNumBytes = 0;
+};
+
+// std allocator that reports to the given tag
+template<class T, EMemoryTag TAG>
+struct TTrackingAllocator
+{
+	using value_type = T;
+	template<class U> struct rebind { using other = TTrackingAllocator<U, TAG>; };
+
+	TTrackingAllocator() noexcept = default;
+	template<class U> TTrackingAllocator(const TTrackingAllocator<U, TAG>&) noexcept {}
+
+	T* allocate(size_t NumElements)
+	{
+		const size_t NumBytes = NumElements * sizeof(T);
+		MemoryTracking::OnAllocate(TAG, NumBytes);
+		if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+			return static_cast<T*>(::operator new(NumBytes, std::align_val_t(alignof(T))));
+		else
+			return static_cast<T*>(::operator new(NumBytes));
+	}
+	void deallocate(T* p, size_t NumElements) noexcept
+	{
+		MemoryTracking::OnFree(TAG, NumElements * sizeof(T));
+		if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+			::operator delete(p, std::align_val_t(alignof(T)));
+		else
+			::operator delete(p);
+	}
+
+	template<class U> bool operator==(const TTrackingAllocator<U, TAG>&) const noexcept { return true; }
+	template<class U> bool operator!=(const TTrackingAllocator<U, TAG>&) const noexcept { return false; }
+};
+template<class T, EMemoryTag TAG> using TrackedVector = std::vector<T, TTrackingAllocator<T, TAG>>;
+
+#else // VQENGINE_MEMORY_TRACKING
+
+#define MEMORY_TRACK_ALLOC(TAG, NumBytes)
+#define MEMORY_TRACK_FREE(TAG, NumBytes)
+#define MEMORY_TRACKED_BYTES(TAG, Name)
+#define MEMORY_TRACKED_BYTES_SET(Name, NumBytes)
+
+template<class T, EMemoryTag TAG> using TrackedVector = std::vector<T>;
+
+#endif // VQENGINE_MEMORY_TRACKING
@@ -0,0 +1,411 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+
+#include "PakFile.h"
+#include "LZ4.h"
+
+#include "Libs/VQUtils/Include/Log.h"
+#include "Libs/VQUtils/Include/Multithreading/ThreadPool.h"
+
+#include <filesystem>
+#include <fstream>
+#include <algorithm>
+#include <future>
+#include <cstring>
+
+using namespace Pak;
+
+static inline uint64 AlignUp(uint64 Value, uint64 Alignment) { return (Value + Alignment - 1) & ~(Alignment - 1); }
+static inline char ToLowerASCII(char c) { return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c; }
+
+
+
+std::string Pak::NormalizePath(const std::string& Path)
+{
+	std::vector<std::string> Components;
+	size_t Begin = 0;
+	while (Begin <= Path.size())
+	{
+		size_t End = Path.find_first_of("/\\", Begin);
+		if (End == std::string::npos)
+			End = Path.size();
+
+		const std::string Component = Path.substr(Begin, End - Begin);
+		if (Component == "..")
+		{
+			if (!Components.empty() && Components.back() != "..")
+				Components.pop_back();
+			else
+				Components.push_back(Component);
+		}
+		else if (!Component.empty() && Component != ".")
+		{
+			Components.push_back(Component);
+		}
+		Begin = End + 1;
+	}
+
+	std::string Normalized;
+	for (const std::string& Component : Components)
+	{
+		if (!Normalized.empty())
+			Normalized += '/';
+		Normalized += Component;
+	}
+	return Normalized;
+}
+
+int Pak::ComparePaths(const char* a, size_t LenA, const char* b, size_t LenB)
+{
+	const size_t Len = std::min(LenA, LenB);
+	for (size_t i = 0; i < Len; ++i)
+	{
+		const unsigned char ca = static_cast<unsigned char>(ToLowerASCII(a[i]));
+		const unsigned char cb = static_cast<unsigned char>(ToLowerASCII(b[i]));
+		if (ca != cb)
+			return ca < cb ? -1 : 1;
+	}
+	return LenA == LenB ? 0 : (LenA < LenB ? -1 : 1);
+}
+
+
+
+//
+// READ
+//
+bool FPakArchive::Open(const std::string& PakFilePath)
+{
+	mFilePath = PakFilePath;
+	if (!mFile.Open(PakFilePath))
+		return false;
+
+	if (!Validate())
+	{
+		mFile.Close();
+		return false;
+	}
+	return true;
+}
+
+bool FPakArchive::Validate() const
+{
+	if (mFile.GetSize() < sizeof(FPakHeader))
+	{
+		Log::Warning("Pak: %s is truncated", mFilePath.c_str());
+		return false;
+	}
+	const FPakHeader& Header = GetHeader();
+	if (Header.Magic != PAK_MAGIC || Header.FormatVersion != PAK_FORMAT_VERSION)
+	{
+		Log::Warning("Pak: %s has an unknown format (version %u, expected %u)", mFilePath.c_str(), Header.FormatVersion, PAK_FORMAT_VERSION);
+		return false;
+	}
+
+	const uint64 FileSize = mFile.GetSize();
+	const bool bTablesInFile = Header.FileSize == FileSize
+		&& Header.BlockSize > 0
+		&& Header.OffsetEntries + static_cast<uint64>(Header.NumEntries) * sizeof(FPakEntry) <= FileSize
+		&& Header.OffsetBlocks  + static_cast<uint64>(Header.NumBlocks)  * sizeof(FPakBlock) <= FileSize
+		&& Header.OffsetStrings + Header.StringTableSize <= FileSize
+		&& (Header.StringTableSize == 0 || *mFile.GetDataAt<char>(Header.OffsetStrings + Header.StringTableSize - 1) == '\0');
+	if (!bTablesInFile)
+	{
+		Log::Warning("Pak: %s is corrupt", mFilePath.c_str());
+		return false;
+	}
+
+	for (uint32 i = 0; i < Header.NumEntries; ++i)
+	{
+		const FPakEntry& Entry = GetEntry(i);
+		bool bValid = static_cast<uint64>(Entry.PathOffset) + Entry.PathLength < Header.StringTableSize && Entry.Codec < NUM_PAK_CODECS;
+		if (bValid && Entry.Codec == PAK_CODEC_NONE)
+		{
+			bValid = Entry.DataOffset + Entry.Size <= FileSize;
+		}
+		if (bValid && Entry.Codec == PAK_CODEC_LZ4)
+		{
+			bValid = static_cast<uint64>(Entry.FirstBlock) + Entry.NumBlocks <= Header.NumBlocks
+				&& Entry.NumBlocks == (Entry.Size + Header.BlockSize - 1) / Header.BlockSize;
+			for (uint32 iBlock = 0; bValid && iBlock < Entry.NumBlocks; ++iBlock)
+			{
+				const FPakBlock& Block = GetBlock(Entry.FirstBlock + iBlock);
+				bValid = Block.Offset + Block.StoredSize <= FileSize && Block.Codec < NUM_PAK_CODECS;
+			}
+		}
+		if (!bValid)
+		{
+			Log::Warning("Pak: %s is corrupt (entry %u)", mFilePath.c_str(), i);
+			return false;
+		}
+	}
+	return true;
+}
+
+const FPakEntry* FPakArchive::Find(const std::string& NormalizedPath) const
+{
+	const uint32 NumEntries = GetNumEntries();
+	if (NumEntries == 0)
+		return nullptr;
+
+	const FPakEntry* pBegin = &GetEntry(0);
+	const FPakEntry* pEnd   = pBegin + NumEntries;
+	const FPakEntry* pEntry = std::lower_bound(pBegin, pEnd, NormalizedPath, [this](const FPakEntry& Entry, const std::string& Path)
+	{
+		return ComparePaths(GetPath(Entry), Entry.PathLength, Path.data(), Path.size()) < 0;
+	});
+	if (pEntry == pEnd || ComparePaths(GetPath(*pEntry), pEntry->PathLength, NormalizedPath.data(), NormalizedPath.size()) != 0)
+		return nullptr;
+	return pEntry;
+}
+
+std::vector<const FPakEntry*> FPakArchive::FindInDirectory(const std::string& NormalizedDirectory) const
+{
+	std::vector<const FPakEntry*> Entries;
+	const uint32 NumEntries = GetNumEntries();
+	if (NumEntries == 0)
+		return Entries;
+
+	// the paths under a directory are a contiguous range of the sorted index
+	const std::string Prefix = NormalizedDirectory.empty() ? std::string() : NormalizedDirectory + '/';
+	const FPakEntry* pBegin = &GetEntry(0);
+	const FPakEntry* pEnd   = pBegin + NumEntries;
+	const FPakEntry* pEntry = std::lower_bound(pBegin, pEnd, Prefix, [this](const FPakEntry& Entry, const std::string& Path)
+	{
+		return ComparePaths(GetPath(Entry), Entry.PathLength, Path.data(), Path.size()) < 0;
+	});
+	for (; pEntry != pEnd; ++pEntry)
+	{
+		const char* pPath = GetPath(*pEntry);
+		if (pEntry->PathLength < Prefix.size() || ComparePaths(pPath, Prefix.size(), Prefix.data(), Prefix.size()) != 0)
+			break;
+		if (strchr(pPath + Prefix.size(), '/') == nullptr)
+			Entries.push_back(pEntry);
+	}
+	return Entries;
+}
+
+size_t FPakArchive::GetBlockSize(const FPakEntry& Entry, uint32 iBlock) const
+{
+	const uint64 Begin = static_cast<uint64>(iBlock) * GetHeader().BlockSize;
+	return static_cast<size_t>(std::min<uint64>(Entry.Size - Begin, GetHeader().BlockSize));
+}
+
+bool FPakArchive::DecompressBlock(const FPakEntry& Entry, uint32 iBlock, uint8* pDst) const
+{
+	const FPakBlock& Block = GetBlock(Entry.FirstBlock + iBlock);
+	const size_t BlockSize = GetBlockSize(Entry, iBlock);
+	uint8* pBlockDst = pDst + static_cast<size_t>(iBlock) * GetHeader().BlockSize;
+	const uint8* pStored = mFile.GetDataAt<uint8>(static_cast<size_t>(Block.Offset));
+
+	if (Block.Codec == PAK_CODEC_NONE)
+	{
+		if (Block.StoredSize != BlockSize)
+			return false;
+		memcpy(pBlockDst, pStored, BlockSize);
+		return true;
+	}
+	return LZ4::Decompress(pStored, Block.StoredSize, pBlockDst, BlockSize);
+}
+
+
+
+//
+// WRITE
+//
+static bool ReadSourceFile(const std::string& FilePath, std::vector<uint8>& Data, int64& WriteTime)
+{
+	std::error_code ec;
+	const uint64 FileSize = std::filesystem::file_size(FilePath, ec);
+	if (ec)
+		return false;
+	WriteTime = static_cast<int64>(std::filesystem::last_write_time(FilePath, ec).time_since_epoch().count());
+
+	std::ifstream File(FilePath, std::ios::binary);
+	if (!File)
+		return false;
+	Data.resize(static_cast<size_t>(FileSize));
+	File.read(reinterpret_cast<char*>(Data.data()), static_cast<std::streamsize>(Data.size()));
+	return static_cast<uint64>(File.gcount()) == FileSize;
+}
+
+bool Pak::WritePakFile(const std::string& PakFilePath, std::vector<FPakInputFile> Files, const FPakWriteParams& Params, ThreadPool* pWorkers, FPakWriteStats* pStats)
+{
+	if (Params.BlockSize == 0)
+		return false;
+
+	for (FPakInputFile& File : Files)
+		File.Path = NormalizePath(File.Path);
+	auto fnCompare = [](const FPakInputFile& a, const FPakInputFile& b) { return ComparePaths(a.Path.data(), a.Path.size(), b.Path.data(), b.Path.size()); };
+	std::stable_sort(Files.begin(), Files.end(), [&](const FPakInputFile& a, const FPakInputFile& b) { return fnCompare(a, b) < 0; });
+	Files.erase(std::unique(Files.begin(), Files.end(), [&](const FPakInputFile& a, const FPakInputFile& b) { return fnCompare(a, b) == 0; }), Files.end());
+
+	std::error_code ec;
+	const std::filesystem::path ParentDirectory = std::filesystem::path(PakFilePath).parent_path();
+	if (!ParentDirectory.empty())
+		std::filesystem::create_directories(ParentDirectory, ec);
+
+	const std::string TempFilePath = PakFilePath + ".tmp";
+	std::ofstream Out(TempFilePath, std::ios::binary | std::ios::trunc);
+	if (!Out)
+	{
+		Log::Error("Pak: couldn't open %s for writing", TempFilePath.c_str());
+		return false;
+	}
+
+	FPakHeader Header = {};
+	Out.write(reinterpret_cast<const char*>(&Header), sizeof(Header)); // written again at the end
+	uint64 Offset = sizeof(Header);
+	auto fnWrite = [&](const void* pData, size_t Size)
+	{
+		Out.write(static_cast<const char*>(pData), static_cast<std::streamsize>(Size));
+		Offset += Size;
+	};
+	auto fnAlign = [&](uint64 Alignment)
+	{
+		static const char ZEROS[PAK_DATA_ALIGNMENT] = {};
+		fnWrite(ZEROS, static_cast<size_t>(AlignUp(Offset, Alignment) - Offset));
+	};
+
+	FPakWriteStats Stats;
+	std::vector<FPakEntry> Entries;
+	std::vector<FPakBlock> Blocks;
+	std::string Strings;
+	std::vector<uint8> Data;
+	for (const FPakInputFile& File : Files)
+	{
+		FPakEntry Entry = {};
+		if (!ReadSourceFile(File.SourcePath, Data, Entry.WriteTime))
+		{
+			Log::Error("Pak: couldn't read %s", File.SourcePath.c_str());
+			Out.close();
+			std::filesystem::remove(TempFilePath, ec);
+			return false;
+		}
+		Entry.PathOffset = static_cast<uint32>(Strings.size());
+		Entry.PathLength = static_cast<uint32>(File.Path.size());
+		Entry.Size = Data.size();
+		Strings.append(File.Path.c_str(), File.Path.size() + 1);
+
+		// compress the blocks independently: they're decompressed in parallel on load
+		const uint32 NumBlocks = static_cast<uint32>((Entry.Size + Params.BlockSize - 1) / Params.BlockSize);
+		std::vector<std::vector<uint8>> CompressedBlocks(Params.bCompress ? NumBlocks : 0); // empty: stored as-is
+		auto fnCompressBlock = [&](uint32 iBlock)
+		{
+			const size_t Begin = static_cast<size_t>(iBlock) * Params.BlockSize;
+			const size_t Size = std::min<size_t>(Data.size() - Begin, Params.BlockSize);
+			std::vector<uint8>& Compressed = CompressedBlocks[iBlock];
+			Compressed.resize(LZ4::CompressBound(Size));
+			const size_t CompressedSize = LZ4::Compress(Data.data() + Begin, Size, Compressed.data(), Compressed.size());
+			Compressed.resize(CompressedSize < Size ? CompressedSize : 0);
+		};
+		if (pWorkers && CompressedBlocks.size() > 1)
+		{
+			std::vector<std::future<void>> Tasks;
+			for (uint32 iBlock = 0; iBlock < NumBlocks; ++iBlock)
+				Tasks.push_back(pWorkers->AddTask([&fnCompressBlock, iBlock]() { fnCompressBlock(iBlock); }));
+			for (std::future<void>& Task : Tasks)
+				Task.wait();
+		}
+		else
+		{
+			for (uint32 iBlock = 0; iBlock < CompressedBlocks.size(); ++iBlock)
+				fnCompressBlock(iBlock);
+		}
+
+		uint64 CompressedSize = 0;
+		for (uint32 iBlock = 0; iBlock < CompressedBlocks.size(); ++iBlock)
+		{
+			const size_t Size = std::min<size_t>(Data.size() - static_cast<size_t>(iBlock) * Params.BlockSize, Params.BlockSize);
+			CompressedSize += CompressedBlocks[iBlock].empty() ? Size : CompressedBlocks[iBlock].size();
+		}
+
+		const bool bCompressed = !CompressedBlocks.empty() && static_cast<double>(CompressedSize) < static_cast<double>(Entry.Size) * Params.MaxCompressionRatio;
+		if (bCompressed)
+		{
+			Entry.Codec = PAK_CODEC_LZ4;
+			Entry.FirstBlock = static_cast<uint32>(Blocks.size());
+			Entry.NumBlocks = NumBlocks;
+			for (uint32 iBlock = 0; iBlock < NumBlocks; ++iBlock)
+			{
+				fnAlign(PAK_BLOCK_ALIGNMENT);
+				const std::vector<uint8>& Compressed = CompressedBlocks[iBlock];
+				const size_t Begin = static_cast<size_t>(iBlock) * Params.BlockSize;
+				const size_t Size = std::min<size_t>(Data.size() - Begin, Params.BlockSize);
+
+				FPakBlock Block = {};
+				Block.Offset = Offset;
+				Block.Codec = Compressed.empty() ? PAK_CODEC_NONE : PAK_CODEC_LZ4;
+				Block.StoredSize = static_cast<uint32>(Compressed.empty() ? Size : Compressed.size());
+				fnWrite(Compressed.empty() ? Data.data() + Begin : Compressed.data(), Block.StoredSize);
+				Blocks.push_back(Block);
+				Entry.StoredSize += Block.StoredSize;
+			}
+			++Stats.NumCompressedEntries;
+		}
+		else
+		{
+			fnAlign(PAK_DATA_ALIGNMENT); // mapped as-is
+			Entry.Codec = PAK_CODEC_NONE;
+			Entry.DataOffset = Offset;
+			Entry.StoredSize = Entry.Size;
+			fnWrite(Data.data(), Data.size());
+		}
+
+		Entries.push_back(Entry);
+		++Stats.NumEntries;
+		Stats.NumSourceBytes += Entry.Size;
+		Stats.NumStoredBytes += Entry.StoredSize;
+	}
+
+	fnAlign(PAK_BLOCK_ALIGNMENT);
+	Header.OffsetEntries = Offset;
+	fnWrite(Entries.data(), Entries.size() * sizeof(FPakEntry));
+	Header.OffsetBlocks = Offset;
+	fnWrite(Blocks.data(), Blocks.size() * sizeof(FPakBlock));
+	Header.OffsetStrings = Offset;
+	fnWrite(Strings.data(), Strings.size());
+
+	Header.Magic = PAK_MAGIC;
+	Header.FormatVersion = PAK_FORMAT_VERSION;
+	Header.NumEntries = static_cast<uint32>(Entries.size());
+	Header.NumBlocks = static_cast<uint32>(Blocks.size());
+	Header.FileSize = Offset;
+	Header.StringTableSize = static_cast<uint32>(Strings.size());
+	Header.BlockSize = Params.BlockSize;
+	Out.seekp(0);
+	Out.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+	Out.close();
+	if (!Out)
+	{
+		Log::Error("Pak: failed writing %s", TempFilePath.c_str());
+		std::filesystem::remove(TempFilePath, ec);
+		return false;
+	}
+
+	std::filesystem::rename(TempFilePath, PakFilePath, ec);
+	if (ec)
+	{
+		Log::Error("Pak: couldn't replace %s: %s", PakFilePath.c_str(), ec.message().c_str());
+		std::filesystem::remove(TempFilePath, ec);
+		return false;
+	}
+
+	if (pStats)
+		*pStats = Stats;
+	return true;
+}
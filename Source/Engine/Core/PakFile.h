@@ -0,0 +1,158 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+#pragma once
+
+#include "Types.h"
+#include "MappedFile.h"
+
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+//
+// PAK FILE
+//
+// Archive of asset files for deployments: one memory-mapped file replaces the thousands
+// of loose textures, models and materials a scene load would otherwise open & read at
+// random. Entries are looked up in an index sorted by path (case-insensitive, '/' separated,
+// relative to the working directory like the loose asset paths) with a binary search.
+//
+// An entry is either stored as-is (PAK_CODEC_NONE), page aligned so its data can be used
+// straight from the mapping, or split into fixed size blocks that are LZ4 compressed
+// independently and can be decompressed in parallel. A block that doesn't compress is
+// stored as-is, and an entry whose blocks don't compress well enough is stored whole:
+// already compressed formats (.png/.jpg) end up mapped instead of copied.
+//
+// File layout, offsets are from the beginning of the file:
+//
+//   FPakHeader
+//   entry data      PAK_DATA_ALIGNMENT aligned if stored, PAK_BLOCK_ALIGNMENT aligned blocks otherwise
+//   FPakEntry [NumEntries]        sorted by path
+//   FPakBlock [NumBlocks]
+//   char      [StringTableSize]   null-terminated paths
+//
+namespace Pak
+{
+	constexpr uint32 PAK_MAGIC              = 0x4B505156; // "VQPK"
+	constexpr uint32 PAK_FORMAT_VERSION     = 1;
+	constexpr uint32 PAK_DATA_ALIGNMENT     = 4096;
+	constexpr uint32 PAK_BLOCK_ALIGNMENT    = 16;
+	constexpr uint32 PAK_DEFAULT_BLOCK_SIZE = 256 << 10;
+
+	enum EPakCodec : uint32
+	{
+		PAK_CODEC_NONE = 0,
+		PAK_CODEC_LZ4,
+
+		NUM_PAK_CODECS
+	};
+
+	struct FPakHeader
+	{
+		uint32 Magic;
+		uint32 FormatVersion;
+		uint32 NumEntries;
+		uint32 NumBlocks;
+		uint64 FileSize;
+		uint64 OffsetEntries;
+		uint64 OffsetBlocks;
+		uint64 OffsetStrings;
+		uint32 StringTableSize;
+		uint32 BlockSize; // uncompressed size of the blocks, except for the last block of an entry
+	};
+	struct FPakEntry
+	{
+		uint32 PathOffset; // into the string table
+		uint32 PathLength;
+		uint32 Codec;      // EPakCodec
+		uint32 FirstBlock; // PAK_CODEC_LZ4 only
+		uint32 NumBlocks;
+		uint32 Reserved;
+		uint64 Size;       // uncompressed
+		uint64 StoredSize; // in the pak file
+		uint64 DataOffset; // PAK_CODEC_NONE only
+		int64  WriteTime;  // of the source file, std::filesystem::file_time_type ticks
+	};
+	struct FPakBlock
+	{
+		uint64 Offset;     // from the beginning of the file
+		uint32 StoredSize;
+		uint32 Codec;      // EPakCodec, PAK_CODEC_NONE if the block didn't compress
+	};
+	static_assert(sizeof(FPakHeader) == 56, "pak file layout changed, bump PAK_FORMAT_VERSION");
+	static_assert(sizeof(FPakEntry)  == 56, "pak file layout changed, bump PAK_FORMAT_VERSION");
+	static_assert(sizeof(FPakBlock)  == 16, "pak file layout changed, bump PAK_FORMAT_VERSION");
+
+	// '\' -> '/', drops "./" & empty components, resolves "dir/..": the form the paths are stored & looked up with
+	std::string NormalizePath(const std::string& Path);
+	int ComparePaths(const char* a, size_t LenA, const char* b, size_t LenB); // case-insensitive, ASCII
+
+	// Read-only view over a memory-mapped pak file
+	class FPakArchive
+	{
+	public:
+		bool Open(const std::string& PakFilePath); // returns false if the file doesn't exist or is corrupt
+
+		inline const std::string& GetFilePath() const { return mFilePath; }
+		inline const FMappedFile& GetFile() const { return mFile; }
+		inline const FPakHeader&  GetHeader() const { return *mFile.GetDataAt<FPakHeader>(0); }
+		inline const FPakEntry&   GetEntry(uint32 i) const { return mFile.GetDataAt<FPakEntry>(GetHeader().OffsetEntries)[i]; }
+		inline const FPakBlock&   GetBlock(uint32 i) const { return mFile.GetDataAt<FPakBlock>(GetHeader().OffsetBlocks)[i]; }
+		inline const char*        GetPath(const FPakEntry& Entry) const { return mFile.GetDataAt<char>(GetHeader().OffsetStrings + Entry.PathOffset); }
+		inline uint32             GetNumEntries() const { return GetHeader().NumEntries; }
+
+		const FPakEntry* Find(const std::string& NormalizedPath) const;
+		std::vector<const FPakEntry*> FindInDirectory(const std::string& NormalizedDirectory) const; // direct children, not recursive
+
+		inline const void* GetStoredData(const FPakEntry& Entry) const { return mFile.GetDataAt<void>(Entry.DataOffset); } // PAK_CODEC_NONE
+		size_t GetBlockSize(const FPakEntry& Entry, uint32 iBlock) const; // uncompressed
+
+		// iBlock is relative to the entry, pDst points to the beginning of the entry's decompressed data
+		bool DecompressBlock(const FPakEntry& Entry, uint32 iBlock, uint8* pDst) const;
+
+	private:
+		bool Validate() const;
+		FMappedFile mFile;
+		std::string mFilePath;
+	};
+
+	//
+	// WRITE
+	//
+	struct FPakInputFile
+	{
+		std::string Path;       // stored path, normalized
+		std::string SourcePath; // to read from
+	};
+	struct FPakWriteParams
+	{
+		uint32 BlockSize = PAK_DEFAULT_BLOCK_SIZE;
+		bool   bCompress = true;
+		float  MaxCompressionRatio = 0.9f; // entries that compress worse than this are stored as-is
+	};
+	struct FPakWriteStats
+	{
+		uint32 NumEntries = 0;
+		uint32 NumCompressedEntries = 0;
+		uint64 NumSourceBytes = 0;
+		uint64 NumStoredBytes = 0;
+	};
+	// blocks are compressed on pWorkers if given, the input is sorted & deduplicated by path
+	bool WritePakFile(const std::string& PakFilePath, std::vector<FPakInputFile> Files, const FPakWriteParams& Params, ThreadPool* pWorkers = nullptr, FPakWriteStats* pStats = nullptr);
+}
@@ -58,6 +58,13 @@ struct FStartupParameters
 	uint8 bOverrideENGSetting_bAutomatedTest : 1;
 	uint8 bOverrideENGSetting_bTestFrames : 1;
 	uint8 bOverrideENGSetting_StartupScene : 1;
+	uint8 bOverrideENGSetting_bHotReloadScenes : 1;
+	uint8 bOverrideENGSetting_AssetRetentionBudgetMB : 1;
+	uint8 bOverrideENGSetting_ScenePreloadBudgetMB : 1;
+	uint8 bOverrideENGSetting_StartupSnapshot : 1;
+
+	uint8 bCookScenesAndExit : 1; // -CookScenes: see SceneCache::CookSceneFiles()
+	uint8 bTraceCollection : 1;   // -Trace: see Core/Trace.h
 };
 
 LRESULT __stdcall WndProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
@@ -0,0 +1,268 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+#pragma once
+
+#include "Types.h"
+#include "Libs/VQUtils/Include/Log.h"
+
+#include <vector>
+#include <cassert>
+
+//
+// SLOT MAP
+//
+// Resources on slot maps / generational handles
+//
+// - https://seanmiddleditch.github.io/data-structures-for-game-developers-the-slot-map/
+// - https://floooh.github.io/2018/06/17/handles-vs-pointers.html
+//
+// Objects are stored contiguously (dense) and addressed through a handle that
+// encodes a slot index and a generation counter. Handle lookup is two array
+// reads, and a handle that outlived its object is detected by the generation
+// mismatch instead of silently aliasing a newer object.
+//
+// Handles are packed into ID_TYPE (int) so they can be used as MeshID/ModelID/MaterialID:
+//
+//   Bits[ 0 - 15] : slot index  (64K objects max, the Scene pool sizes)
+//   Bits[16 - 29] : generation  (16K reuses of a slot)
+//   Bits[30 - 31] : unused, keeps handles positive & within the 30-bit masks of MeshSorting.h
+//
+// A slot whose generation is used up is retired instead of wrapping around to 0,
+// which would let the stale handles alias the new object. Retired slots aren't reused.
+//
+// Remove() moves the last object into the freed dense index to keep the objects
+// contiguous: pointers & references from Get() and the dense iterators are invalidated
+// by Remove() & Clear(), handles stay valid. Hold on to handles, not pointers.
+//
+// The storage is reserved on construction and never grows: worker threads
+// read from the map while loader threads insert into it (under the Scene locks),
+// hence the memory must stay put. Exceeding the capacity asserts, similar to MemoryPool.
+//
+template<class TObject>
+class SlotMap
+{
+public:
+	static constexpr int HANDLE_INDEX_BITS      = 16;
+	static constexpr int HANDLE_GENERATION_BITS = 14;
+	static constexpr int HANDLE_INDEX_MASK      = (1 << HANDLE_INDEX_BITS) - 1;
+	static constexpr int HANDLE_GENERATION_MASK = (1 << HANDLE_GENERATION_BITS) - 1;
+
+	static inline int MakeHandle(int Index, int Generation) { return ((Generation & HANDLE_GENERATION_MASK) << HANDLE_INDEX_BITS) | (Index & HANDLE_INDEX_MASK); }
+	static inline int GetHandleIndex(int Handle)            { return Handle & HANDLE_INDEX_MASK; }
+	static inline int GetHandleGeneration(int Handle)       { return (Handle >> HANDLE_INDEX_BITS) & HANDLE_GENERATION_MASK; }
+
+public:
+	SlotMap(size_t Capacity);
+
+	int Insert(TObject&& obj);
+	int Insert(const TObject& obj);
+	std::vector<int> Insert(size_t NumObjects); // default-constructs NumObjects
+	bool Remove(int Handle); // invalidates the pointers to the last dense object, see above
+	void Clear();
+
+	inline bool IsValid(int Handle) const { return GetSlot(Handle) != nullptr; }
+	inline const TObject* Get(int Handle) const { const FSlot* pSlot = GetSlot(Handle); return pSlot ? &mObjects[pSlot->DenseIndex] : nullptr; }
+	inline       TObject* Get(int Handle)       { const FSlot* pSlot = GetSlot(Handle); return pSlot ? &mObjects[pSlot->DenseIndex] : nullptr; }
+
+	inline size_t size() const { return mObjects.size(); }
+	inline bool empty() const { return mObjects.empty(); }
+	inline size_t GetCapacity() const { return mCapacity; }
+
+	// dense iteration, order changes on Remove()
+	inline typename std::vector<TObject>::iterator       begin()       { return mObjects.begin(); }
+	inline typename std::vector<TObject>::iterator       end()         { return mObjects.end(); }
+	inline typename std::vector<TObject>::const_iterator begin() const { return mObjects.begin(); }
+	inline typename std::vector<TObject>::const_iterator end()   const { return mObjects.end(); }
+	inline int GetHandleOfDenseIndex(size_t i) const { const int iSlot = mDenseToSlot[i]; return MakeHandle(iSlot, mSlots[iSlot].Generation); }
+	std::vector<int> GetAllAliveObjectHandles() const;
+
+private:
+	struct FSlot
+	{
+		int DenseIndex = -1; // -1: slot is free
+		int Generation = 0;  // > HANDLE_GENERATION_MASK: retired
+	};
+
+	inline const FSlot* GetSlot(int Handle) const
+	{
+		if (Handle < 0)
+			return nullptr;
+		const int iSlot = GetHandleIndex(Handle);
+		if (iSlot >= mNumSlotsUsed)
+			return nullptr;
+		const FSlot& slot = mSlots[iSlot];
+		if (slot.DenseIndex < 0 || slot.Generation != GetHandleGeneration(Handle))
+			return nullptr;
+		return &slot;
+	}
+	int AllocateSlot();
+	void FreeSlot(int iSlot);
+
+private:
+	std::vector<TObject> mObjects;     // dense
+	std::vector<int>     mDenseToSlot; // dense index -> slot index
+	std::vector<FSlot>   mSlots;       // sparse, sized to capacity up front
+	std::vector<int>     mFreeSlots;
+	int                  mNumSlotsUsed = 0;
+	size_t               mCapacity = 0;
+};
+
+
+
+//
+// SlotMap Template Implementation
+//
+template<class TObject>
+inline SlotMap<TObject>::SlotMap(size_t Capacity)
+	: mCapacity(Capacity)
+{
+	assert(Capacity <= static_cast<size_t>(HANDLE_INDEX_MASK) + 1);
+	mObjects.reserve(Capacity);
+	mDenseToSlot.reserve(Capacity);
+	mSlots.resize(Capacity);
+	mFreeSlots.reserve(Capacity);
+}
+
+template<class TObject>
+inline int SlotMap<TObject>::AllocateSlot()
+{
+	if (!mFreeSlots.empty())
+	{
+		const int iSlot = mFreeSlots.back();
+		mFreeSlots.pop_back();
+		return iSlot;
+	}
+	if (static_cast<size_t>(mNumSlotsUsed) == mCapacity)
+	{
+		Log::Warning("SlotMap is out of slots (capacity=%d), perhaps consider a larger initial size?", static_cast<int>(mCapacity));
+		assert(false); // if you hit this, reserve a bigger slot map on startup
+		return -1;
+	}
+	return mNumSlotsUsed++;
+}
+
+template<class TObject>
+inline void SlotMap<TObject>::FreeSlot(int iSlot)
+{
+	// invalidate outstanding handles to this slot
+	FSlot& slot = mSlots[iSlot];
+	slot.DenseIndex = -1;
+	if (++slot.Generation > HANDLE_GENERATION_MASK)
+		return; // retired: a wrapped generation would match the stale handles again
+	mFreeSlots.push_back(iSlot);
+}
+
+template<class TObject>
+inline int SlotMap<TObject>::Insert(TObject&& obj)
+{
+	const int iSlot = AllocateSlot();
+	if (iSlot < 0)
+		return INVALID_ID;
+
+	FSlot& slot = mSlots[iSlot];
+	slot.DenseIndex = static_cast<int>(mObjects.size());
+	mObjects.push_back(std::move(obj));
+	mDenseToSlot.push_back(iSlot);
+	return MakeHandle(iSlot, slot.Generation);
+}
+
+template<class TObject>
+inline int SlotMap<TObject>::Insert(const TObject& obj)
+{
+	TObject copy = obj;
+	return Insert(std::move(copy));
+}
+
+template<class TObject>
+inline std::vector<int> SlotMap<TObject>::Insert(size_t NumObjects)
+{
+	std::vector<int> Handles(NumObjects, INVALID_ID);
+	if (mFreeSlots.size() + (mCapacity - static_cast<size_t>(mNumSlotsUsed)) < NumObjects) // retired slots aren't available
+	{
+		Log::Warning("SlotMap is out of slots (capacity=%d) for inserting %d objects, perhaps consider a larger initial size?", static_cast<int>(mCapacity), static_cast<int>(NumObjects));
+		assert(false); // if you hit this, reserve a bigger slot map on startup
+		return Handles;
+	}
+
+	const size_t iDenseBegin = mObjects.size();
+	mObjects.resize(iDenseBegin + NumObjects);
+	mDenseToSlot.resize(iDenseBegin + NumObjects);
+	for (size_t i = 0; i < NumObjects; ++i)
+	{
+		const int iSlot = AllocateSlot();
+		FSlot& slot = mSlots[iSlot];
+		slot.DenseIndex = static_cast<int>(iDenseBegin + i);
+		mDenseToSlot[iDenseBegin + i] = iSlot;
+		Handles[i] = MakeHandle(iSlot, slot.Generation);
+	}
+	return Handles;
+}
+
+template<class TObject>
+inline bool SlotMap<TObject>::Remove(int Handle)
+{
+	if (!IsValid(Handle))
+		return false;
+
+	const int iSlot = GetHandleIndex(Handle);
+	FSlot& slot = mSlots[iSlot];
+	const int iDense = slot.DenseIndex;
+	const int iDenseLast = static_cast<int>(mObjects.size()) - 1;
+
+	// swap with last to keep the objects contiguous
+	if (iDense != iDenseLast)
+	{
+		mObjects[iDense] = std::move(mObjects[iDenseLast]);
+		mDenseToSlot[iDense] = mDenseToSlot[iDenseLast];
+		mSlots[mDenseToSlot[iDense]].DenseIndex = iDense;
+	}
+	mObjects.pop_back();
+	mDenseToSlot.pop_back();
+
+	FreeSlot(iSlot);
+	return true;
+}
+
+template<class TObject>
+inline void SlotMap<TObject>::Clear()
+{
+	// bump the generation of the live slots so the handles from before Clear() are detected as stale
+	for (int iSlot : mDenseToSlot)
+	{
+		mSlots[iSlot].DenseIndex = -1;
+		++mSlots[iSlot].Generation;
+	}
+	mObjects.clear();
+	mDenseToSlot.clear();
+
+	mFreeSlots.clear();
+	for (int iSlot = mNumSlotsUsed - 1; iSlot >= 0; --iSlot)
+	{
+		if (mSlots[iSlot].Generation <= HANDLE_GENERATION_MASK)
+			mFreeSlots.push_back(iSlot);
+	}
+}
+
+template<class TObject>
+inline std::vector<int> SlotMap<TObject>::GetAllAliveObjectHandles() const
+{
+	std::vector<int> Handles(mObjects.size(), INVALID_ID);
+	for (size_t i = 0; i < mObjects.size(); ++i)
+		Handles[i] = GetHandleOfDenseIndex(i);
+	return Handles;
+}
@@ -0,0 +1,126 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+
+#include "StringInterner.h"
+#include "FlatHashMap.h"
+
+#include <atomic>
+#include <memory>
+#include <shared_mutex>
+#include <cassert>
+
+// The strings live in fixed-size pages that are never reallocated: the map keys (string_views) and the
+// references GetString() hands out point into them. The page table has a fixed capacity so that GetString()
+// can index it w/o the lock, a page pointer is published before any ID it holds is returned.
+static constexpr uint32 STRING_PAGE_SHIFT = 12;
+static constexpr uint32 STRING_PAGE_SIZE  = 1u << STRING_PAGE_SHIFT;
+static constexpr uint32 STRING_PAGE_MASK  = STRING_PAGE_SIZE - 1;
+static constexpr uint32 MAX_STRING_PAGES  = 1024; // 4M strings
+
+namespace
+{
+	struct FStringTable
+	{
+		FStringTable()
+		{
+			for (std::atomic<std::string*>& pPage : Pages)
+				pPage.store(nullptr, std::memory_order_relaxed);
+			Pages[0].store(new std::string[STRING_PAGE_SIZE], std::memory_order_relaxed);
+			NumStrings = 1; // EMPTY_STRING_ID
+		}
+		~FStringTable()
+		{
+			for (std::atomic<std::string*>& pPage : Pages)
+				delete[] pPage.load(std::memory_order_relaxed);
+		}
+
+		mutable std::shared_mutex             Mtx;
+		FlatHashMap<std::string_view, StringID> Lookup; // w/o the empty string
+		std::atomic<std::string*>             Pages[MAX_STRING_PAGES];
+		uint32                                NumStrings = 0;
+	};
+
+	FStringTable& GetTable()
+	{
+		static FStringTable Table; // constructed on first use: static initializers may intern names too
+		return Table;
+	}
+}
+
+StringID StringInterner::Intern(std::string_view Str)
+{
+	if (Str.empty())
+		return EMPTY_STRING_ID;
+
+	FStringTable& Table = GetTable();
+	{
+		std::shared_lock<std::shared_mutex> lk(Table.Mtx);
+		if (const auto it = Table.Lookup.find(Str); it != Table.Lookup.end())
+			return it->second;
+	}
+
+	std::unique_lock<std::shared_mutex> lk(Table.Mtx);
+	if (const auto it = Table.Lookup.find(Str); it != Table.Lookup.end())
+		return it->second; // interned by another thread in the meantime
+
+	const StringID ID = Table.NumStrings;
+	const uint32 iPage = ID >> STRING_PAGE_SHIFT;
+	if (iPage >= MAX_STRING_PAGES)
+	{
+		assert(false && "StringInterner: out of string pages, bump MAX_STRING_PAGES");
+		return EMPTY_STRING_ID;
+	}
+	std::string* pPage = Table.Pages[iPage].load(std::memory_order_relaxed);
+	if (!pPage)
+	{
+		pPage = new std::string[STRING_PAGE_SIZE];
+		Table.Pages[iPage].store(pPage, std::memory_order_release);
+	}
+
+	std::string& Stored = pPage[ID & STRING_PAGE_MASK];
+	Stored.assign(Str.data(), Str.size());
+	Table.Lookup.try_emplace(std::string_view(Stored), ID);
+	++Table.NumStrings;
+	return ID;
+}
+
+StringID StringInterner::Find(std::string_view Str)
+{
+	if (Str.empty())
+		return EMPTY_STRING_ID;
+
+	const FStringTable& Table = GetTable();
+	std::shared_lock<std::shared_mutex> lk(Table.Mtx);
+	const auto it = Table.Lookup.find(Str);
+	return it != Table.Lookup.end() ? it->second : EMPTY_STRING_ID;
+}
+
+const std::string& StringInterner::GetString(StringID ID)
+{
+	const FStringTable& Table = GetTable();
+	const std::string* pPage = Table.Pages[ID >> STRING_PAGE_SHIFT].load(std::memory_order_acquire);
+	assert(pPage && "StringInterner: invalid StringID");
+	return pPage[ID & STRING_PAGE_MASK];
+}
+
+size_t StringInterner::GetNumStrings()
+{
+	const FStringTable& Table = GetTable();
+	std::shared_lock<std::shared_mutex> lk(Table.Mtx);
+	return Table.NumStrings;
+}
@@ -0,0 +1,47 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+#pragma once
+
+#include "Types.h"
+
+#include <string>
+#include <string_view>
+
+//
+// STRING INTERNER
+//
+// Process-wide table of unique strings for the asset names & paths (material names, texture & model paths):
+// a string is hashed & copied once when it's interned, the maps along the load path are keyed by the 32-bit
+// StringID from there on, and comparing two names is an integer compare.
+//
+// IDs are stable for the lifetime of the process and the strings are never released: the table only grows
+// with the distinct asset names & paths seen across the scene loads. 0 is the empty string.
+//
+// Thread-safe: lookups of already interned strings take a shared lock, GetString() is lock-free.
+//
+using StringID = uint32;
+constexpr StringID EMPTY_STRING_ID = 0;
+
+namespace StringInterner
+{
+	StringID           Intern(std::string_view Str);
+	StringID           Find(std::string_view Str); // EMPTY_STRING_ID if Str isn't interned, doesn't insert
+	const std::string& GetString(StringID ID);     // the reference stays valid, the string is never moved
+
+	size_t             GetNumStrings();
+}
@@ -0,0 +1,311 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+
+#include "Trace.h"
+
+#include "Libs/VQUtils/Include/Log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using Clock_t = std::chrono::steady_clock;
+static const Clock_t::time_point sTraceClockStart = Clock_t::now();
+
+enum EEventType : uint8_t
+{
+	SCOPE_BEGIN = 0,
+	SCOPE_END,
+	COUNTER
+};
+struct FTraceEvent
+{
+	uint64_t Timestamp;
+	double   Value; // COUNTER
+	uint8_t  Type;  // EEventType
+	char     Name[Trace::MAX_EVENT_NAME_LENGTH + 1];
+};
+static_assert(sizeof(FTraceEvent) == 64, "trace event should fill a cache line");
+static_assert((Trace::NUM_EVENTS_PER_THREAD & (Trace::NUM_EVENTS_PER_THREAD - 1)) == 0, "ring buffer size must be a power of two");
+
+// written by its thread only, read by the exporter
+struct FThreadTraceBuffer
+{
+	std::atomic<uint64_t>          NumWritten{ 0 };
+	std::unique_ptr<FTraceEvent[]> Events;
+	uint32_t                       ThreadID = 0; // OS thread ID
+
+	std::mutex  MtxName;
+	std::string Name;                   // last known name of the thread
+	bool        bExplicitName = false;  // SetThreadName()
+};
+
+// buffers are never freed: the events of the exited threads are still exported
+static std::mutex                                       sMtxThreadBuffers;
+static std::vector<std::unique_ptr<FThreadTraceBuffer>> sThreadBuffers;
+static thread_local FThreadTraceBuffer*                 tlsThreadBuffer = nullptr;
+
+static uint32_t GetCurrentOSThreadID()
+{
+#ifdef _WIN32
+	return static_cast<uint32_t>(GetCurrentThreadId());
+#else
+	return static_cast<uint32_t>(syscall(SYS_gettid));
+#endif
+}
+
+// the OS thread description: ThreadPool names its threads after the pool. Empty if the thread is gone.
+static std::string QueryOSThreadName(uint32_t ThreadID)
+{
+	std::string Name;
+#ifdef _WIN32
+	HANDLE hThread = OpenThread(THREAD_QUERY_LIMITED_INFORMATION, FALSE, ThreadID);
+	if (!hThread)
+		return Name;
+	PWSTR pDescription = nullptr;
+	if (SUCCEEDED(GetThreadDescription(hThread, &pDescription)) && pDescription)
+	{
+		const int Length = WideCharToMultiByte(CP_UTF8, 0, pDescription, -1, nullptr, 0, nullptr, nullptr);
+		if (Length > 1)
+		{
+			Name.resize(Length - 1);
+			WideCharToMultiByte(CP_UTF8, 0, pDescription, -1, Name.data(), Length, nullptr, nullptr);
+		}
+		LocalFree(pDescription);
+	}
+	CloseHandle(hThread);
+#else
+	std::ifstream f("/proc/self/task/" + std::to_string(ThreadID) + "/comm");
+	std::getline(f, Name);
+#endif
+	return Name;
+}
+
+static FThreadTraceBuffer& GetThreadBuffer()
+{
+	if (tlsThreadBuffer)
+		return *tlsThreadBuffer;
+
+	std::unique_ptr<FThreadTraceBuffer> pBuffer = std::make_unique<FThreadTraceBuffer>();
+	pBuffer->Events = std::make_unique<FTraceEvent[]>(Trace::NUM_EVENTS_PER_THREAD);
+	pBuffer->ThreadID = GetCurrentOSThreadID();
+	pBuffer->Name = QueryOSThreadName(pBuffer->ThreadID);
+
+	tlsThreadBuffer = pBuffer.get();
+	std::lock_guard<std::mutex> lk(sMtxThreadBuffers);
+	sThreadBuffers.push_back(std::move(pBuffer));
+	return *tlsThreadBuffer;
+}
+
+static inline void WriteEvent(EEventType Type, const char* pName, double Value)
+{
+	FThreadTraceBuffer& Buffer = GetThreadBuffer();
+	const uint64_t Index = Buffer.NumWritten.load(std::memory_order_relaxed);
+	FTraceEvent& Event = Buffer.Events[Index & (Trace::NUM_EVENTS_PER_THREAD - 1)];
+	Event.Timestamp = Trace::GetTimestamp();
+	Event.Value = Value;
+	Event.Type = Type;
+	size_t i = 0;
+	if (pName)
+	{
+		for (; i < Trace::MAX_EVENT_NAME_LENGTH && pName[i]; ++i)
+			Event.Name[i] = pName[i];
+	}
+	Event.Name[i] = '\0';
+	Buffer.NumWritten.store(Index + 1, std::memory_order_release); // publishes the event to the exporter
+}
+
+void Trace::SetEnabled(bool bEnabled)
+{
+	if (Internal::gbEnabled.exchange(bEnabled) != bEnabled)
+	{
+		Log::Info("Trace collection %s", bEnabled ? "enabled" : "disabled");
+	}
+}
+
+uint64_t Trace::GetTimestamp()
+{
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock_t::now() - sTraceClockStart).count());
+}
+
+void Trace::SetThreadName(const char* pName)
+{
+	FThreadTraceBuffer& Buffer = GetThreadBuffer();
+	std::lock_guard<std::mutex> lk(Buffer.MtxName);
+	Buffer.Name = pName;
+	Buffer.bExplicitName = true;
+}
+
+#if VQENGINE_TRACE_COLLECTOR
+void Trace::BeginScope(const char* pName)           { WriteEvent(SCOPE_BEGIN, pName, 0.0); }
+void Trace::EndScope()                              { WriteEvent(SCOPE_END, nullptr, 0.0); }
+void Trace::Counter(const char* pName, double Value) { WriteEvent(COUNTER, pName, Value); }
+#endif
+
+
+static void WriteFormatted(std::ofstream& f, const char* pFormat, ...)
+{
+	char buf[256];
+	va_list args;
+	va_start(args, pFormat);
+	const int Length = vsnprintf(buf, sizeof(buf), pFormat, args);
+	va_end(args);
+	if (Length > 0)
+		f.write(buf, std::min<size_t>(static_cast<size_t>(Length), sizeof(buf) - 1));
+}
+
+static void WriteJSONString(std::ofstream& f, const char* pStr)
+{
+	f.put('"');
+	for (const char* p = pStr; *p; ++p)
+	{
+		const unsigned char c = static_cast<unsigned char>(*p);
+		if (c == '"' || c == '\\') { f.put('\\'); f.put(static_cast<char>(c)); }
+		else if (c < 0x20)         { WriteFormatted(f, "\\u%04x", c); }
+		else                       { f.put(static_cast<char>(c)); }
+	}
+	f.put('"');
+}
+
+bool Trace::ExportChromeJSON(const std::string& FilePath, uint64_t BeginTimestamp)
+{
+	std::vector<FThreadTraceBuffer*> Buffers;
+	{
+		std::lock_guard<std::mutex> lk(sMtxThreadBuffers);
+		for (const std::unique_ptr<FThreadTraceBuffer>& pBuffer : sThreadBuffers)
+			Buffers.push_back(pBuffer.get());
+	}
+
+	std::error_code ec;
+	const std::filesystem::path ParentPath = std::filesystem::path(FilePath).parent_path();
+	if (!ParentPath.empty())
+		std::filesystem::create_directories(ParentPath, ec);
+
+	std::ofstream f(FilePath, std::ios::out | std::ios::trunc);
+	if (!f.is_open())
+	{
+		Log::Error("Trace: couldn't open %s for writing", FilePath.c_str());
+		return false;
+	}
+
+	size_t NumEvents = 0;
+	bool bFirst = true;
+	auto fnBeginEvent = [&](const char* pPhase, uint32_t ThreadID)
+	{
+		WriteFormatted(f, "%s\n{\"ph\":\"%s\",\"pid\":1,\"tid\":%u", bFirst ? "" : ",", pPhase, ThreadID);
+		bFirst = false;
+	};
+
+	WriteFormatted(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+	fnBeginEvent("M", 0);
+	WriteFormatted(f, ",\"name\":\"process_name\",\"args\":{\"name\":\"VQEngine\"}}");
+
+	std::vector<FTraceEvent> Events(NUM_EVENTS_PER_THREAD);
+	std::vector<bool> ScopeStack; // whether the open scopes were exported
+	for (FThreadTraceBuffer* pBuffer : Buffers)
+	{
+		// thread name
+		std::string Name;
+		{
+			std::lock_guard<std::mutex> lk(pBuffer->MtxName);
+			if (!pBuffer->bExplicitName)
+			{
+				std::string OSName = QueryOSThreadName(pBuffer->ThreadID); // may have been named after its first event
+				if (!OSName.empty())
+					pBuffer->Name = std::move(OSName);
+			}
+			Name = pBuffer->Name.empty() ? "Thread " + std::to_string(pBuffer->ThreadID) : pBuffer->Name;
+		}
+		fnBeginEvent("M", pBuffer->ThreadID);
+		WriteFormatted(f, ",\"name\":\"thread_name\",\"args\":{\"name\":");
+		WriteJSONString(f, Name.c_str());
+		WriteFormatted(f, "}}");
+
+		// copy the ring, then drop what the thread overwrote in the meantime
+		const uint64_t End = pBuffer->NumWritten.load(std::memory_order_acquire);
+		const uint64_t First = End > NUM_EVENTS_PER_THREAD ? End - NUM_EVENTS_PER_THREAD : 0;
+		for (uint64_t i = First; i < End; ++i)
+			Events[i - First] = pBuffer->Events[i & (NUM_EVENTS_PER_THREAD - 1)];
+		const uint64_t EndAfterCopy = pBuffer->NumWritten.load(std::memory_order_acquire);
+		const uint64_t FirstValid = std::max(First, EndAfterCopy > NUM_EVENTS_PER_THREAD ? EndAfterCopy - NUM_EVENTS_PER_THREAD : 0);
+
+		ScopeStack.clear();
+		for (uint64_t i = FirstValid; i < End; ++i)
+		{
+			const FTraceEvent& Event = Events[i - First];
+			const bool bInRange = Event.Timestamp >= BeginTimestamp;
+			switch (Event.Type)
+			{
+			case SCOPE_BEGIN:
+				ScopeStack.push_back(bInRange);
+				if (!bInRange)
+					continue;
+				fnBeginEvent("B", pBuffer->ThreadID);
+				WriteFormatted(f, ",\"ts\":%.3f,\"name\":", Event.Timestamp / 1000.0);
+				WriteJSONString(f, Event.Name);
+				WriteFormatted(f, "}");
+				break;
+			case SCOPE_END:
+			{
+				if (ScopeStack.empty())
+					continue; // the begin event was overwritten
+				const bool bBeginExported = ScopeStack.back();
+				ScopeStack.pop_back();
+				if (!bBeginExported)
+					continue;
+				fnBeginEvent("E", pBuffer->ThreadID);
+				WriteFormatted(f, ",\"ts\":%.3f}", Event.Timestamp / 1000.0);
+			}	break;
+			case COUNTER:
+				if (!bInRange)
+					continue;
+				fnBeginEvent("C", pBuffer->ThreadID);
+				WriteFormatted(f, ",\"ts\":%.3f,\"name\":", Event.Timestamp / 1000.0);
+				WriteJSONString(f, Event.Name);
+				WriteFormatted(f, ",\"args\":{\"value\":%.6g}}", Event.Value);
+				break;
+			}
+			++NumEvents;
+		}
+	}
+	WriteFormatted(f, "\n]}\n");
+	f.close();
+	const bool bSuccess = !f.fail();
+
+	if (bSuccess)
+		Log::Info("Trace: exported %zu events of %zu threads to %s", NumEvents, Buffers.size(), FilePath.c_str());
+	else
+		Log::Error("Trace: couldn't write %s", FilePath.c_str());
+	return bSuccess;
+}
@@ -0,0 +1,71 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Set to 0 to compile the collector out: the trace calls of the CPU markers & the counter macro expand to nothing
+#define VQENGINE_TRACE_COLLECTOR 1
+
+//
+// TRACE COLLECTOR
+//
+// Platform independent recording of the CPU marker scopes (SCOPED_CPU_MARKER*, see GPUMarker.h) for offline
+// analysis, next to PIX. Collection is off by default (-Trace command line option or Trace::SetEnabled()):
+// a disabled collector costs the markers a relaxed atomic load.
+//
+// Each thread writes its events into its own ring buffer which is allocated on the first event of the thread,
+// the writes don't take locks: the exporter copies the rings and drops the entries that were overwritten while
+// copying. When a ring is full the oldest events are overwritten.
+//
+// Threads are named after their OS thread description, which ThreadPool sets from the pool's name, or
+// explicitly with SetThreadName().
+//
+// ExportChromeJSON() writes the Chrome trace event format, which chrome://tracing and ui.perfetto.dev open:
+//   { "traceEvents": [ { "name": "...", "ph": "B"|"E"|"C"|"M", "ts": <us>, "pid": 1, "tid": <id>, ... }, ... ] }
+//
+namespace Trace
+{
+	constexpr size_t NUM_EVENTS_PER_THREAD = 1 << 15; // ring buffer size, 64B per event
+	constexpr size_t MAX_EVENT_NAME_LENGTH = 46;      // longer names are truncated
+
+	namespace Internal { inline std::atomic<bool> gbEnabled{ false }; }
+
+	void        SetEnabled(bool bEnabled);
+	inline bool IsEnabled() { return Internal::gbEnabled.load(std::memory_order_relaxed); }
+	uint64_t    GetTimestamp(); // ns since the process start, same clock as the events
+
+	void        SetThreadName(const char* pName); // overrides the OS thread description for the calling thread
+
+#if VQENGINE_TRACE_COLLECTOR
+	void BeginScope(const char* pName);
+	void EndScope();
+	void Counter(const char* pName, double Value);
+#endif
+
+	// Writes the events recorded at or after BeginTimestamp (see GetTimestamp()), returns false if the file can't be written
+	bool ExportChromeJSON(const std::string& FilePath, uint64_t BeginTimestamp = 0);
+}
+
+#if VQENGINE_TRACE_COLLECTOR
+#define TRACE_COUNTER(pName, Value) do { if (Trace::IsEnabled()) Trace::Counter(pName, static_cast<double>(Value)); } while(0)
+#else
+#define TRACE_COUNTER(pName, Value) do{}while(0)
+#endif
@@ -0,0 +1,332 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+
+#include "VirtualFileSystem.h"
+#include "PakFile.h"
+
+#include "Engine/GPUMarker.h"
+
+#include "Libs/VQUtils/Include/Log.h"
+#include "Libs/VQUtils/Include/Multithreading/ThreadPool.h"
+#include "Libs/VQUtils/Libs/stb/stb_image.h" // implemented in VQUtils' Image.cpp
+
+#include <filesystem>
+#include <shared_mutex>
+#include <memory>
+#include <atomic>
+#include <algorithm>
+#include <cstring>
+
+using namespace Pak;
+
+static std::vector<std::unique_ptr<FPakArchive>> sMountedPaks; // searched back to front
+static std::shared_mutex                         sMtxMountedPaks;
+static std::atomic<ThreadPool*>                  spDecompressionWorkers = nullptr;
+
+// caller holds sMtxMountedPaks
+static const FPakEntry* FindPakEntry(const std::string& NormalizedPath, const FPakArchive** ppArchive)
+{
+	for (auto it = sMountedPaks.rbegin(); it != sMountedPaks.rend(); ++it)
+	{
+		if (const FPakEntry* pEntry = (*it)->Find(NormalizedPath))
+		{
+			*ppArchive = it->get();
+			return pEntry;
+		}
+	}
+	return nullptr;
+}
+
+static std::string GetLowercaseExtension(const std::string& FileName)
+{
+	const size_t iDot = FileName.find_last_of('.');
+	std::string Extension = iDot == std::string::npos ? std::string() : FileName.substr(iDot + 1);
+	std::transform(Extension.begin(), Extension.end(), Extension.begin(), [](char c) { return static_cast<char>(tolower(static_cast<unsigned char>(c))); });
+	return Extension;
+}
+
+
+//
+// DECOMPRESSION
+//
+// The caller & the helper tasks take the blocks from a shared counter: the caller never waits
+// on a busy pool, e.g. when it's a disk worker itself, and the helpers that start after all
+// the blocks are taken return right away. The job outlives the call through the helpers.
+//
+struct FDecompressionJob
+{
+	const FPakArchive*  pArchive = nullptr;
+	const FPakEntry*    pEntry = nullptr;
+	uint8*              pDst = nullptr;
+	uint32              NumBlocks = 0;
+	std::atomic<uint32> iNextBlock = 0;
+	std::atomic<uint32> NumDecompressed = 0;
+	std::atomic<bool>   bFailed = false;
+
+	void Run()
+	{
+		for (uint32 iBlock = iNextBlock.fetch_add(1); iBlock < NumBlocks; iBlock = iNextBlock.fetch_add(1))
+		{
+			if (!pArchive->DecompressBlock(*pEntry, iBlock, pDst))
+				bFailed.store(true);
+			if (NumDecompressed.fetch_add(1) + 1 == NumBlocks)
+				NumDecompressed.notify_all();
+		}
+	}
+};
+
+static bool DecompressBlocks(const FPakArchive& Archive, const FPakEntry& Entry, uint8* pDst)
+{
+	SCOPED_CPU_MARKER("VFS::DecompressBlocks");
+	std::shared_ptr<FDecompressionJob> pJob = std::make_shared<FDecompressionJob>();
+	pJob->pArchive = &Archive;
+	pJob->pEntry = &Entry;
+	pJob->pDst = pDst;
+	pJob->NumBlocks = Entry.NumBlocks;
+
+	ThreadPool* pWorkers = spDecompressionWorkers.load();
+	if (pWorkers && Entry.NumBlocks > 1)
+	{
+		const size_t NumHelpers = std::min<size_t>(Entry.NumBlocks - 1, ThreadPool::sHardwareThreadCount);
+		for (size_t i = 0; i < NumHelpers; ++i)
+		{
+			pWorkers->AddTask([pJob]()
+			{
+				SCOPED_CPU_MARKER("VFS::DecompressBlocks_Helper");
+				pJob->Run();
+			});
+		}
+	}
+
+	pJob->Run();
+	for (uint32 NumDecompressed = pJob->NumDecompressed.load(); NumDecompressed < pJob->NumBlocks; NumDecompressed = pJob->NumDecompressed.load())
+		pJob->NumDecompressed.wait(NumDecompressed);
+	return !pJob->bFailed.load();
+}
+
+
+
+size_t VFS::FFile::ReleasePages(const void* p, size_t Size) const
+{
+	return mpMapping ? mpMapping->ReleasePages(p, Size) : 0;
+}
+
+bool VFS::Mount(const std::string& PakFilePath)
+{
+	SCOPED_CPU_MARKER("VFS::Mount");
+	std::unique_ptr<FPakArchive> pArchive = std::make_unique<FPakArchive>();
+	if (!pArchive->Open(PakFilePath))
+	{
+		Log::Error("VFS: couldn't mount %s", PakFilePath.c_str());
+		return false;
+	}
+
+	Log::Info("VFS: mounted %s (%u files)", PakFilePath.c_str(), pArchive->GetNumEntries());
+	std::unique_lock<std::shared_mutex> lk(sMtxMountedPaks);
+	sMountedPaks.push_back(std::move(pArchive));
+	return true;
+}
+
+size_t VFS::MountPakFiles(const std::string& Directory)
+{
+#if VFS_MOUNT_PAK_FILES
+	std::error_code ec;
+	std::vector<std::string> PakFiles;
+	for (const std::filesystem::directory_entry& Entry : std::filesystem::directory_iterator(Directory, ec))
+	{
+		if (Entry.is_regular_file(ec) && GetLowercaseExtension(Entry.path().filename().string()) == "pak")
+			PakFiles.push_back(Entry.path().generic_string());
+	}
+	std::sort(PakFiles.begin(), PakFiles.end()); // later paks override the earlier ones, e.g. patches
+
+	size_t NumMounted = 0;
+	for (const std::string& PakFile : PakFiles)
+		NumMounted += VFS::Mount(PakFile) ? 1 : 0;
+	return NumMounted;
+#else
+	return 0;
+#endif
+}
+
+void VFS::UnmountAll()
+{
+	std::unique_lock<std::shared_mutex> lk(sMtxMountedPaks);
+	sMountedPaks.clear();
+}
+
+void VFS::SetDecompressionWorkers(ThreadPool* pWorkers)
+{
+	spDecompressionWorkers.store(pWorkers);
+}
+
+bool VFS::Exists(const std::string& Path)
+{
+	if (IsInPak(Path))
+		return true;
+	std::error_code ec;
+	return std::filesystem::is_regular_file(Path, ec);
+}
+
+bool VFS::IsInPak(const std::string& Path)
+{
+	std::shared_lock<std::shared_mutex> lk(sMtxMountedPaks);
+	if (sMountedPaks.empty())
+		return false;
+	const FPakArchive* pArchive = nullptr;
+	return FindPakEntry(NormalizePath(Path), &pArchive) != nullptr;
+}
+
+bool VFS::GetFileInfo(const std::string& Path, FFileInfo& Info)
+{
+	{
+		std::shared_lock<std::shared_mutex> lk(sMtxMountedPaks);
+		const FPakArchive* pArchive = nullptr;
+		if (const FPakEntry* pEntry = sMountedPaks.empty() ? nullptr : FindPakEntry(NormalizePath(Path), &pArchive))
+		{
+			Info.Size = pEntry->Size;
+			Info.WriteTime = pEntry->WriteTime;
+			Info.bInPak = true;
+			return true;
+		}
+	}
+
+	std::error_code ec;
+	Info.Size = static_cast<uint64>(std::filesystem::file_size(Path, ec));
+	if (ec)
+		return false;
+	Info.WriteTime = static_cast<int64>(std::filesystem::last_write_time(Path, ec).time_since_epoch().count());
+	Info.bInPak = false;
+	return true;
+}
+
+bool VFS::ReadFile(const std::string& Path, FFile& File)
+{
+	File.mpData = nullptr;
+	File.mSize = 0;
+	File.mbFromPak = false;
+	File.mpMapping = nullptr;
+	File.mLooseFile.Close();
+	File.mDecompressed.clear();
+
+	{
+		std::shared_lock<std::shared_mutex> lk(sMtxMountedPaks);
+		const FPakArchive* pArchive = nullptr;
+		if (const FPakEntry* pEntry = sMountedPaks.empty() ? nullptr : FindPakEntry(NormalizePath(Path), &pArchive))
+		{
+			File.mbFromPak = true;
+			if (pEntry->Codec == PAK_CODEC_NONE)
+			{
+				File.mpData = pArchive->GetStoredData(*pEntry);
+				File.mSize = static_cast<size_t>(pEntry->Size);
+				File.mpMapping = &pArchive->GetFile();
+				return true;
+			}
+
+			File.mDecompressed.resize(static_cast<size_t>(pEntry->Size));
+			if (!DecompressBlocks(*pArchive, *pEntry, File.mDecompressed.data()))
+			{
+				Log::Error("VFS: %s is corrupt in %s", Path.c_str(), pArchive->GetFilePath().c_str());
+				File.mDecompressed.clear();
+				return false;
+			}
+			File.mpData = File.mDecompressed.data();
+			File.mSize = File.mDecompressed.size();
+			return true;
+		}
+	}
+
+	if (File.mLooseFile.Open(Path))
+	{
+		File.mpData = File.mLooseFile.GetData();
+		File.mSize = File.mLooseFile.GetSize();
+		File.mpMapping = &File.mLooseFile;
+		return true;
+	}
+	std::error_code ec;
+	return std::filesystem::is_regular_file(Path, ec); // empty files can't be mapped
+}
+
+std::vector<std::string> VFS::ListFiles(const std::string& Directory, const std::string& Extension)
+{
+	const std::string NormalizedDirectory = NormalizePath(Directory);
+	const std::string Prefix = NormalizedDirectory.empty() ? std::string() : NormalizedDirectory + '/';
+	const std::string MatchExtension = GetLowercaseExtension(Extension.find('.') == std::string::npos ? "." + Extension : Extension);
+
+	std::vector<std::string> Files;
+	auto fnAdd = [&](const std::string& FileName)
+	{
+		if (GetLowercaseExtension(FileName) != MatchExtension)
+			return;
+		const std::string FilePath = Prefix + FileName;
+		const bool bListed = std::any_of(Files.begin(), Files.end(), [&](const std::string& f) { return ComparePaths(f.data(), f.size(), FilePath.data(), FilePath.size()) == 0; });
+		if (!bListed)
+			Files.push_back(FilePath);
+	};
+
+	{
+		std::shared_lock<std::shared_mutex> lk(sMtxMountedPaks);
+		for (auto it = sMountedPaks.rbegin(); it != sMountedPaks.rend(); ++it)
+			for (const FPakEntry* pEntry : (*it)->FindInDirectory(NormalizedDirectory))
+				fnAdd(std::string((*it)->GetPath(*pEntry) + Prefix.size(), pEntry->PathLength - Prefix.size()));
+	}
+
+	std::error_code ec;
+	for (const std::filesystem::directory_entry& Entry : std::filesystem::directory_iterator(Directory, ec))
+	{
+		if (Entry.is_regular_file(ec))
+			fnAdd(Entry.path().filename().string());
+	}
+
+	std::sort(Files.begin(), Files.end());
+	return Files;
+}
+
+Image VFS::LoadImageFile(const std::string& Path)
+{
+	if (!IsInPak(Path))
+		return Image::LoadFromFile(Path.c_str());
+
+	SCOPED_CPU_MARKER("VFS::LoadImageFile");
+	FFile File;
+	if (!ReadFile(Path, File) || File.GetSize() == 0)
+		return Image();
+
+	// same output as Image::LoadFromFile(): RGBA8, or RGBA32F for the HDR formats
+	const stbi_uc* pEncoded = static_cast<const stbi_uc*>(File.GetData());
+	const int EncodedSize = static_cast<int>(File.GetSize());
+	const bool bHDR = stbi_is_hdr_from_memory(pEncoded, EncodedSize) != 0;
+	int Width = 0, Height = 0, NumChannels = 0;
+	void* pDecoded = bHDR
+		? static_cast<void*>(stbi_loadf_from_memory(pEncoded, EncodedSize, &Width, &Height, &NumChannels, 4))
+		: static_cast<void*>(stbi_load_from_memory (pEncoded, EncodedSize, &Width, &Height, &NumChannels, 4));
+	if (!pDecoded)
+	{
+		Log::Error("VFS: couldn't decode %s: %s", Path.c_str(), stbi_failure_reason());
+		return Image();
+	}
+
+	const int BytesPerPixel = bHDR ? static_cast<int>(4 * sizeof(float)) : 4;
+	const size_t NumBytes = static_cast<size_t>(Width) * Height * BytesPerPixel;
+	Image Img = Image::CreateEmptyImage(NumBytes); // allocated the way Image::Destroy() releases it
+	memcpy(Img.pData, pDecoded, NumBytes);
+	stbi_image_free(pDecoded);
+	Img.Width = Width;
+	Img.Height = Height;
+	Img.BytesPerPixel = BytesPerPixel;
+	return Img;
+}
@@ -0,0 +1,99 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+#pragma once
+
+#include "Types.h"
+#include "MappedFile.h"
+
+#include "Libs/VQUtils/Include/Image.h"
+
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+// Set to 0 to ignore the pak files in the data directory and read the loose files only
+#define VFS_MOUNT_PAK_FILES 1
+
+//
+// VIRTUAL FILE SYSTEM
+//
+// The asset reads (images, glTF files & buffers, scene & material XMLs) go through here with
+// the same relative paths whether the files are loose or packed: the mounted pak files are
+// searched first, the most recently mounted one first, then the disk. Stored pak entries and
+// loose files are memory-mapped; compressed entries are decompressed into memory with their
+// blocks spread over the decompression workers, the calling thread decompresses blocks too.
+//
+// The paks are mounted at startup and stay mounted until shutdown: the entries returned by
+// the queries point into the mapped pak files. Settings (*.ini) and the caches the engine
+// writes (Cache/) are read from the disk directly.
+//
+namespace VFS
+{
+	// contents of a file, valid for the lifetime of the object
+	class FFile
+	{
+	public:
+		FFile() = default;
+		FFile(const FFile&) = delete;
+		FFile& operator=(const FFile&) = delete;
+
+		inline const void* GetData() const { return mpData; }
+		inline size_t      GetSize() const { return mSize; }
+		inline bool        IsFromPak() const { return mbFromPak; }
+		inline bool        IsMapped() const { return mpMapping != nullptr; }
+		inline bool        Contains(const void* p, size_t Size) const { return p >= mpData && static_cast<const char*>(p) + Size <= static_cast<const char*>(mpData) + mSize; }
+
+		// see FMappedFile::ReleasePages(), decompressed files aren't released
+		size_t ReleasePages(const void* p, size_t Size) const;
+
+	private:
+		friend bool ReadFile(const std::string& Path, FFile& File);
+		const void*        mpData = nullptr;
+		size_t             mSize = 0;
+		bool               mbFromPak = false;
+		const FMappedFile* mpMapping = nullptr; // mLooseFile or the pak file the stored entry is in
+		FMappedFile        mLooseFile;
+		std::vector<uint8> mDecompressed;
+	};
+
+	struct FFileInfo
+	{
+		uint64 Size = 0;
+		int64  WriteTime = 0; // std::filesystem::file_time_type ticks, of the source file for the pak entries
+		bool   bInPak = false;
+	};
+
+	bool   Mount(const std::string& PakFilePath);
+	size_t MountPakFiles(const std::string& Directory); // mounts the *.pak files in the directory in name order, returns the number mounted
+	void   UnmountAll();
+
+	// blocks of the compressed entries are decompressed on pWorkers if set, nullptr decompresses on the calling thread
+	void SetDecompressionWorkers(ThreadPool* pWorkers);
+
+	bool Exists(const std::string& Path);
+	bool IsInPak(const std::string& Path);
+	bool GetFileInfo(const std::string& Path, FFileInfo& Info);
+	bool ReadFile(const std::string& Path, FFile& File);
+
+	// files directly in Directory with the given extension (w/o the dot, case-insensitive), packed & loose, sorted
+	std::vector<std::string> ListFiles(const std::string& Directory, const std::string& Extension);
+
+	// Image::LoadFromFile() for the loose files, decodes the packed ones from memory
+	Image LoadImageFile(const std::string& Path);
+}
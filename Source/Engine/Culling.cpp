@@ -150,6 +150,105 @@ bool IsFrustumIntersectingFrustum(const FFrustumPlaneset& FrustumPlanes0, const
 	return true;
 }
 
+// the normal cones keep their angles in model space only under rotation & uniform scale: a non-uniform scale
+// (or shear) skews the normals and a mirroring transform flips the winding, the cones can't be used then.
+static bool IsAngleAndWindingPreserving(const XMMATRIX& matWorld)
+{
+	constexpr float TOLERANCE = 1e-3f;
+	const float sx = XMVectorGetX(XMVector3LengthSq(matWorld.r[0]));
+	const float sy = XMVectorGetX(XMVector3LengthSq(matWorld.r[1]));
+	const float sz = XMVectorGetX(XMVector3LengthSq(matWorld.r[2]));
+	const float sMax = std::max(sx, std::max(sy, sz));
+	const bool bUniformScale = std::abs(sx - sy) <= TOLERANCE * sMax && std::abs(sx - sz) <= TOLERANCE * sMax;
+	const bool bOrthogonal = std::abs(XMVectorGetX(XMVector3Dot(matWorld.r[0], matWorld.r[1]))) <= TOLERANCE * sMax
+		&& std::abs(XMVectorGetX(XMVector3Dot(matWorld.r[0], matWorld.r[2]))) <= TOLERANCE * sMax
+		&& std::abs(XMVectorGetX(XMVector3Dot(matWorld.r[1], matWorld.r[2]))) <= TOLERANCE * sMax;
+	return bUniformScale && bOrthogonal && XMVectorGetX(XMMatrixDeterminant(matWorld)) > 0.0f;
+}
+
+void CullMeshlets(
+	const FMeshlet* pMeshlets,
+	size_t NumMeshlets,
+	const XMMATRIX& matWorld,
+	const XMMATRIX& matViewProj,
+	const XMVECTOR& vCameraPosition,
+	size_t MaxRanges,
+	std::vector<FIndexRange>& OutRanges,
+	FMeshletCullStats* pStats
+)
+{
+	const FFrustumPlaneset LocalFrustumPlanes = FFrustumPlaneset::ExtractFromMatrix(matWorld * matViewProj); // model space planes, valid for any affine matWorld
+	const bool bConeCulling = IsAngleAndWindingPreserving(matWorld); // frustum test only otherwise
+	XMFLOAT3 f3CameraPosition;
+	XMStoreFloat3(&f3CameraPosition, XMVector3TransformCoord(vCameraPosition, XMMatrixInverse(nullptr, matWorld)));
+
+	FMeshletCullStats Stats;
+	const size_t iFirstRange = OutRanges.size();
+	for (const FMeshlet* pMeshlet = pMeshlets; pMeshlet != pMeshlets + NumMeshlets; ++pMeshlet)
+	{
+		const FMeshlet& m = *pMeshlet;
+		Stats.NumIndices += m.NumIndices;
+
+		// backface: the camera sees the back of all the triangles if it's inside the cone opposite to the
+		// normal cone, with the apex moved back to contain the bounding sphere
+		const float d[3] = { m.Center[0] - f3CameraPosition.x, m.Center[1] - f3CameraPosition.y, m.Center[2] - f3CameraPosition.z };
+		const float Dist = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+		if (bConeCulling && d[0] * m.ConeAxis[0] + d[1] * m.ConeAxis[1] + d[2] * m.ConeAxis[2] >= m.ConeCutoff * Dist + m.Radius)
+		{
+			++Stats.NumBackfaceCulled;
+			continue;
+		}
+
+		FBoundingBox BBox;
+		BBox.ExtentMin = XMFLOAT3(m.BoundsMin[0], m.BoundsMin[1], m.BoundsMin[2]);
+		BBox.ExtentMax = XMFLOAT3(m.BoundsMax[0], m.BoundsMax[1], m.BoundsMax[2]);
+		if (!IsBoundingBoxIntersectingFrustum2(LocalFrustumPlanes, BBox))
+		{
+			++Stats.NumFrustumCulled;
+			continue;
+		}
+
+		FIndexRange* pLast = OutRanges.size() > iFirstRange ? &OutRanges.back() : nullptr;
+		if (pLast && pLast->IndexOffset + pLast->NumIndices == m.IndexOffset)
+			pLast->NumIndices += m.NumIndices;
+		else
+			OutRanges.push_back({ m.IndexOffset, m.NumIndices });
+	}
+
+	// too many ranges: split at the largest MaxRanges-1 gaps only
+	const size_t NumRanges = OutRanges.size() - iFirstRange;
+	if (MaxRanges > 0 && NumRanges > MaxRanges)
+	{
+		FIndexRange* pRanges = &OutRanges[iFirstRange];
+		std::vector<std::pair<uint32, size_t>> Gaps(NumRanges - 1); // <gap size, index of the range after the gap>
+		for (size_t i = 1; i < NumRanges; ++i)
+			Gaps[i - 1] = { pRanges[i].IndexOffset - (pRanges[i - 1].IndexOffset + pRanges[i - 1].NumIndices), i };
+		std::nth_element(Gaps.begin(), Gaps.begin() + (MaxRanges - 1), Gaps.end(), std::greater<std::pair<uint32, size_t>>());
+
+		std::vector<char> bSplit(NumRanges, 0);
+		for (size_t i = 0; i < MaxRanges - 1; ++i)
+			bSplit[Gaps[i].second] = 1;
+
+		size_t iMerged = 0;
+		for (size_t i = 1; i < NumRanges; ++i)
+		{
+			if (bSplit[i])
+				pRanges[++iMerged] = pRanges[i];
+			else
+				pRanges[iMerged].NumIndices = pRanges[i].IndexOffset + pRanges[i].NumIndices - pRanges[iMerged].IndexOffset;
+		}
+		OutRanges.resize(iFirstRange + iMerged + 1);
+	}
+
+	if (pStats)
+	{
+		Stats.NumMeshlets = static_cast<uint>(NumMeshlets);
+		for (size_t i = iFirstRange; i < OutRanges.size(); ++i)
+			Stats.NumVisibleIndices += OutRanges[i].NumIndices;
+		*pStats += Stats;
+	}
+}
+
 float CalculateProjectedBoundingBoxArea(const FBoundingBox& BBox, const XMMATRIX& ViewProjectionMatrix) 
 {
 	auto corners = BBox.GetCornerPointsF4();
@@ -330,7 +429,7 @@ void FFrustumCullWorkerContext::Process(size_t iRangeBegin, size_t iRangeEnd, Th
 
 #define DEBUG_LOG_SORT 0
 	const MeshLookup_t& MeshLookupCopy = mMeshes;
-	const MemoryPool<Material>& MaterialPool = mMaterials;
+	const MaterialLookup_t& MaterialLookup = mMaterials;
 	const std::vector<MeshID>& MeshBB_MeshID	= BBH.GetMeshesIDs();
 	const std::vector<MaterialID>& MeshBB_MatID = BBH.GetMeshMaterialIDs();
 	const std::vector<size_t>& MeshBB_GameObjHandles = BBH.GetMeshGameObjectHandles();
@@ -420,18 +519,35 @@ static int GetLODFromProjectedScreenArea(float fArea, int NumMaxLODs)
 	assert(CurrLOD < NumMaxLODs && CurrLOD >= 0);
 	return CurrLOD;
 }
+static int GetLODFromProjectedError(float fArea, const Mesh& mesh)
+{
+	if (!mesh.HasLODErrors())
+		return GetLODFromProjectedScreenArea(fArea, mesh.GetNumLODs());
+
+	// pick the coarsest LOD whose simplification error stays under ~1px at 1080p.
+	// LOD errors are relative to the mesh extents, scale them with the projected size.
+	constexpr float MAX_PROJECTED_ERROR_NDC = 2.0f / 1080.0f;
+	const float fProjectedSize = sqrtf(fArea); // NDC
+	const int NumLODs = static_cast<int>(mesh.GetNumLODs());
+	int CurrLOD = 0;
+	while (CurrLOD < NumLODs - 1 && mesh.GetLODError(CurrLOD + 1) * fProjectedSize <= MAX_PROJECTED_ERROR_NDC)
+	{
+		++CurrLOD;
+	}
+	return CurrLOD;
+}
 void FFrustumCullWorkerContext::SortMeshData(size_t iWork, ThreadPool* pWorkerThreadPool)
 {
 	SCOPED_CPU_MARKER_C("SortMeshData", 0xFFAA00AA);
 	const MeshLookup_t& MeshLookupCopy = mMeshes;
-	const MemoryPool<Material>& MaterialPool = mMaterials;
+	const MaterialLookup_t& MaterialLookup = mMaterials;
 	const std::vector<MeshID>& MeshBB_MeshID = BBH.GetMeshesIDs();
 	const std::vector<MaterialID>& MeshBB_MatID = BBH.GetMeshMaterialIDs();
 	const std::vector<size_t>& MeshBB_GameObjHandles = BBH.GetMeshGameObjectHandles();
 	const std::vector<const Transform*>& MeshBB_Transforms = BBH.GetMeshTransforms();
 
-	const size_t NumVisibleItems = vVisibleBBIndicesPerView[iWork].size();
 	std::vector<FVisibleMeshSortData>& sortData = vSortData[iWork];
+	size_t NumVisibleItems = 0;
 	{
 		SCOPED_CPU_MARKER_C("Set", 0xFFAA00AA);
 		int ii = 0;
@@ -441,19 +557,25 @@ void FFrustumCullWorkerContext::SortMeshData(size_t iWork, ThreadPool* pWorkerTh
 			const float fBBArea = CalculateProjectedBoundingBoxArea(vBoundingBoxList[bb], matVP);
 			const MeshID meshID = MeshBB_MeshID[bb];
 			const MaterialID matID = MeshBB_MatID[bb];
-			const Material& mat = *MaterialPool.Get(matID);
-			const Mesh& mesh = MeshLookupCopy.at(meshID);
+			const Material* pMat = MaterialLookup.Get(matID);
+			const Mesh* pMesh = MeshLookupCopy.Get(meshID);
+			assert(pMat && pMesh); // stale handle in the BVH
+			if (!pMat || !pMesh)
+				continue;
 
 			sortData[ii].iBB = (int32)bb;
 			sortData[ii].fBBArea = fBBArea;
 			sortData[ii].matID = matID;
 			sortData[ii].meshID = meshID;
-			sortData[ii].bTess = mat.IsTessellationEnabled() ? 1 : 0;
-			sortData[ii].iLOD = vForceLOD0[iWork] ? 0 : GetLODFromProjectedScreenArea(fBBArea, mesh.GetNumLODs());
+			sortData[ii].bTess = pMat->IsTessellationEnabled() ? 1 : 0;
+			sortData[ii].iLOD = vForceLOD0[iWork] ? 0 : GetLODFromProjectedError(fBBArea, *pMesh);
 
 			assert(sortData[ii].iLOD < 256);
 			++ii;
 		}
+		// the skipped items are dropped: the count is signaled & gathered from the visible list's size
+		NumVisibleItems = static_cast<size_t>(ii);
+		vVisibleBBIndicesPerView[iWork].resize(NumVisibleItems);
 	}
 	if (pWorkerThreadPool)
 	{
@@ -492,7 +614,7 @@ void FFrustumCullWorkerContext::GatherVisibleMeshData(size_t iWork)
 	SCOPED_CPU_MARKER_C("GatherMeshData", 0xFFFF5500);
 
 	const MeshLookup_t& MeshLookupCopy = mMeshes;
-	const MemoryPool<Material>& MaterialPool = mMaterials;
+	const MaterialLookup_t& MaterialLookup = mMaterials;
 	const std::vector<MeshID>& MeshBB_MeshID = BBH.GetMeshesIDs();
 	const std::vector<MaterialID>& MeshBB_MatID = BBH.GetMeshMaterialIDs();
 	const std::vector<size_t>& MeshBB_GameObjHandles = BBH.GetMeshGameObjectHandles();
@@ -502,7 +624,7 @@ void FFrustumCullWorkerContext::GatherVisibleMeshData(size_t iWork)
 	const std::vector<FVisibleMeshSortData>& sortData = vSortData[iWork];
 	const size_t NumVisibleItems = vVisibleBBIndicesPerView[iWork].size();
 	FVisibleMeshDataSoA& vVisibleMeshListSoA = FrustumRenderList.Data;
-	vVisibleMeshListSoA.pMaterialPool = &this->mMaterials;
+	vVisibleMeshListSoA.pMaterials = &this->mMaterials;
 	{
 		SCOPED_CPU_MARKER("SortKey");
 		for (size_t i = 0; i < NumVisibleItems; ++i)
@@ -526,13 +648,18 @@ void FFrustumCullWorkerContext::GatherVisibleMeshData(size_t iWork)
 	for (size_t i = 0; i < NumVisibleItems; ++i)
 	{
 		const FVisibleMeshSortData& d = sortData[i];
-		const Mesh& mesh = MeshLookupCopy.at(d.meshID);
+		const Mesh& mesh = *MeshLookupCopy.Get(d.meshID); // validated by SortMeshData()
+		const std::vector<FMeshlet>& Meshlets = mesh.GetMeshlets(d.iLOD);
 		vVisibleMeshListSoA.PerDrawData[i] = FPerDrawData{
 			.hMaterial = d.matID,
 			.hMesh = d.meshID,
 			.VBIB = mesh.GetIABufferIDs(d.iLOD),
 			.NumIndices = mesh.GetNumIndices(d.iLOD),
 			.SelectedLOD = d.iLOD,
+			.iVertexFormat = static_cast<uint8>(GetVertexFormatOption(mesh.GetVertexFormat())),
+			.UVScaleBias = mesh.GetUVScaleBias(),
+			.pMeshlets = Meshlets.data(),
+			.NumMeshlets = static_cast<uint>(Meshlets.size()),
 		};
 	}
 	{
@@ -860,13 +987,13 @@ void SceneBoundingBoxHierarchy::BuildGameObjectBoundingBox(const Scene* pScene,
 	mGameObjectBoundingBoxes[iBB] = CalculateAxisAlignedBoundingBox(matWorld, pObj->mLocalSpaceBoundingBox);
 	mGameObjectHandles[iBB] = ObjectHandle;
 	
-	auto it = mModels.find(pObj->mModelID);
-	if (it == mModels.end())
+	const Model* pModel = mModels.Get(pObj->mModelID);
+	if (!pModel)
 	{
 		return;
 	}
 
-	const Model& model = it->second;
+	const Model& model = *pModel;
 	mGameObjectNumMeshes[iBB] = model.mData.GetNumMeshesOfAllTypes();
 }
 
@@ -895,7 +1022,11 @@ void SceneBoundingBoxHierarchy::BuildMeshBoundingBox(const Scene* pScene, size_t
 	const GameObject* pObj = pScene->GetGameObject(ObjectHandle);
 	assert(pObj);
 
-	const Model& model = mModels.at(pObj->mModelID);
+	const Model* pModel = mModels.Get(pObj->mModelID);
+	assert(pModel); // the callers skip objects w/o a model
+	if (!pModel)
+		return;
+	const Model& model = *pModel;
 
 	const XMMATRIX matWorld = pTF->matWorldTransformation();
 
@@ -909,11 +1040,15 @@ void SceneBoundingBoxHierarchy::BuildMeshBoundingBox(const Scene* pScene, size_t
 		for (const std::pair<MeshID, MaterialID>& meshMaterialIDPair : meshIDs)
 		{
 			MeshID meshID = meshMaterialIDPair.first;
-			const Mesh& mesh = mMeshes.at(meshID);
+			const Mesh* pMesh = mMeshes.Get(meshID);
+			assert(pMesh);
 			MaterialID mat = meshMaterialIDPair.second;
-			const int numMaxLODs = mesh.GetNumLODs();
+			const int numMaxLODs = pMesh ? pMesh->GetNumLODs() : 0;
 
-			mMeshBoundingBoxes[iMesh] = CalculateAxisAlignedBoundingBox(matWorld, mesh.GetLocalSpaceBoundingBox());
+			// a stale mesh keeps its slot w/ an empty box & an invalid ID, the culling skips it
+			mMeshBoundingBoxes[iMesh] = pMesh ? CalculateAxisAlignedBoundingBox(matWorld, pMesh->GetLocalSpaceBoundingBox()) : FBoundingBox{};
+			if (!pMesh)
+				meshID = INVALID_ID;
 			mMeshIDs[iMesh] = meshID;
 			mNumMeshLODs[iMesh] = numMaxLODs;
 			mMeshMaterials[iMesh] = mat;
@@ -938,8 +1073,10 @@ void SceneBoundingBoxHierarchy::BuildMeshBoundingBoxes(const Scene* pScene, cons
 		const GameObject* pObj = pScene->GetGameObject(ObjectHandle);
 		assert(pObj);
 
-		const Model& model = mModels.at(pObj->mModelID);
-		const size_t NumMeshes = model.mData.GetNumMeshesOfAllTypes();
+		const Model* pModel = mModels.Get(pObj->mModelID);
+		if (!pModel)
+			continue;
+		const size_t NumMeshes = pModel->mData.GetNumMeshesOfAllTypes();
 		BuildMeshBoundingBox(pScene, ObjectHandle, i, i + NumMeshes);
 		i += NumMeshes;
 	}
@@ -954,13 +1091,13 @@ void SceneBoundingBoxHierarchy::BuildMeshBoundingBoxes_Range(const Scene* pScene
 		const GameObject* pObj = pScene->GetGameObject(GameObjectHandles[i]);
 		assert(pObj);
 
-		auto it = mModels.find(pObj->mModelID);
-		if (it == mModels.end())
+		const Model* pModel = mModels.Get(pObj->mModelID);
+		if (!pModel)
 		{
 			continue;
 		}
 
-		const Model& model = it->second;
+		const Model& model = *pModel;
 		const size_t NumMeshes = model.mData.GetNumMeshesOfAllTypes();
 		BuildMeshBoundingBox(pScene, GameObjectHandles[i], iMeshBB + iMeshBBOffset, 0);
 		iMeshBBOffset += NumMeshes;
@@ -1000,9 +1137,10 @@ static size_t CountGameObjectMeshes(const Scene* pScene, const std::vector<size_
 		const GameObject* pObj = pScene->GetGameObject(ObjectHandle);
 		assert(pObj);
 
-		const Model& model = Models.at(pObj->mModelID);
-		const size_t NumMeshes = model.mData.GetNumMeshesOfAllTypes();
-		count += NumMeshes;
+		const Model* pModel = Models.Get(pObj->mModelID);
+		if (!pModel)
+			continue; // BuildMeshBoundingBoxes() skips it too
+		count += pModel->mData.GetNumMeshesOfAllTypes();
 	}
 	return count;
 }
@@ -19,6 +19,7 @@
 
 #include "Core/Types.h"
 #include "Core/Memory.h"
+#include "Core/SlotMap.h"
 #include "Scene/Mesh.h"
 #include "Scene/Material.h"
 #include "Scene/SceneViews.h"
@@ -32,8 +33,8 @@ class ThreadPool;
 class Scene;
 struct Transform;
 class SceneBoundingBoxHierarchy;
-using MeshLookup_t = std::unordered_map<MeshID, Mesh>;
-using MaterialLookup_t = std::unordered_map<MaterialID, Material>;
+using MeshLookup_t = SlotMap<Mesh>;
+using MaterialLookup_t = SlotMap<Material>;
 
 //------------------------------------------------------------------------------------------------------------------------------
 //
@@ -45,6 +46,42 @@ bool IsBoundingBoxIntersectingFrustum(const FFrustumPlaneset FrustumPlanes, cons
 bool IsFrustumIntersectingFrustum(const FFrustumPlaneset& FrustumPlanes0, const FFrustumPlaneset& FrustumPlanes1);
 
 
+//------------------------------------------------------------------------------------------------------------------------------
+//
+// MESHLET CULLING
+//
+//------------------------------------------------------------------------------------------------------------------------------
+struct FIndexRange
+{
+	uint32 IndexOffset;
+	uint32 NumIndices;
+};
+struct FMeshletCullStats
+{
+	uint NumMeshlets = 0;
+	uint NumFrustumCulled = 0;
+	uint NumBackfaceCulled = 0;
+	uint NumIndices = 0;        // of the culled LODs
+	uint NumVisibleIndices = 0; // of the culled LODs, including the indices drawn to merge ranges
+	void operator+=(const FMeshletCullStats& o) { NumMeshlets += o.NumMeshlets; NumFrustumCulled += o.NumFrustumCulled; NumBackfaceCulled += o.NumBackfaceCulled; NumIndices += o.NumIndices; NumVisibleIndices += o.NumVisibleIndices; }
+};
+
+// Culls the meshlets of a mesh LOD against the view frustum & their normal cones, in the local space of the mesh.
+// The normal cones are skipped if matWorld has a non-uniform or negative scale, the frustum test still applies.
+// Appends the index ranges of the visible meshlets to OutRanges, the adjacent ones merged. If there are more than
+// MaxRanges ranges, the smallest gaps between them are drawn as well to stay within the limit.
+void CullMeshlets(
+	const FMeshlet* pMeshlets,
+	size_t NumMeshlets,
+	const DirectX::XMMATRIX& matWorld,
+	const DirectX::XMMATRIX& matViewProj,
+	const DirectX::XMVECTOR& vCameraPosition,
+	size_t MaxRanges,
+	std::vector<FIndexRange>& OutRanges,
+	FMeshletCullStats* pStats
+);
+
+
 //------------------------------------------------------------------------------------------------------------------------------
 //
 // THREADING
@@ -84,14 +121,14 @@ struct FFrustumCullWorkerContext : public FThreadWorkerContext
 	size_t NumValidInputElements = 0;
 	const SceneBoundingBoxHierarchy& BBH;
 	const MeshLookup_t& mMeshes;
-	const MemoryPool<Material>& mMaterials;
+	const MaterialLookup_t& mMaterials;
 
 	// ====================================================================================
 	FFrustumCullWorkerContext() = delete;
 	FFrustumCullWorkerContext(
 		const SceneBoundingBoxHierarchy& BBH, 
 		const MeshLookup_t& mMeshes, 
-		const MemoryPool<Material>& mMaterials
+		const MaterialLookup_t& mMaterials
 	) 
 		: BBH(BBH)
 		, mMeshes(mMeshes)
@@ -21,6 +21,7 @@
 #include "Renderer/Renderer.h"
 #include "Engine/Scene/Scene.h"
 #include "Engine/Core/Window.h"
+#include "Engine/Core/VirtualFileSystem.h"
 
 #include "Libs/VQUtils/Include/utils.h"
 #include "Libs/VQUtils/Include/Image.h"
@@ -229,7 +230,7 @@ void VQEngine::LoadEnvironmentMap(const std::string& EnvMapName, int SpecularMap
 		return;
 	}
 	
-	if (!DirectoryUtil::FileExists(desc.FilePath)) // check whether the env map was found or not
+	if (!VFS::Exists(desc.FilePath)) // check whether the env map was found or not
 	{
 		Log::Error("Couldn't find Environment Map %s: %s", EnvMapName.c_str(), desc.FilePath.c_str());
 		Log::Warning("Have you run Scripts/DownloadAssets.bat?");
@@ -248,7 +249,7 @@ void VQEngine::LoadEnvironmentMap(const std::string& EnvMapName, int SpecularMap
 	Log::Info("Loading Environment Map: %s (%s | Diff:%dx%d | Spec:%dx%d)", EnvMapName.c_str(), EnvMapResolution.c_str(), DIFFUSE_IRRADIANCE_CUBEMAP_RESOLUTION, DIFFUSE_IRRADIANCE_CUBEMAP_RESOLUTION, SpecularMapMip0Resolution, SpecularMapMip0Resolution);
 
 	// if the lowres texture doesn't exist, run a downsample pass (on CPU) on the available texture and save to disk
-	if (!DirectoryUtil::FileExists(desc.FilePath)) // desc.FilePath: "FolderPath/file_name_4k.hdr"
+	if (!VFS::Exists(desc.FilePath)) // desc.FilePath: "FolderPath/file_name_4k.hdr"
 	{
 		Log::Info("[EnvironmentMap] Target resolution texture (%s) doesn't exist on disk. ", desc.FilePath.c_str());
 
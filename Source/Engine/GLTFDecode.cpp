@@ -0,0 +1,236 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+
+#include "GLTFDecode.h"
+
+#ifdef matrix
+#undef matrix
+#endif
+#pragma warning (disable: 4996)
+#include "Libs/cgltf/cgltf.h"
+
+#include <immintrin.h>
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+// returns the first byte of the accessor's first element & validates that Count elements of ElementSize fit in the buffer view
+static const uint8* GetAccessorData(const cgltf_accessor* pAccessor, size_t ElementSize, size_t Count)
+{
+	const cgltf_buffer_view* pView = pAccessor->buffer_view;
+	if (!pView || pAccessor->is_sparse)
+		return nullptr;
+
+	const uint8* pViewData = pView->data // meshopt-decompressed views carry their own data
+		? static_cast<const uint8*>(pView->data)
+		: (pView->buffer && pView->buffer->data ? static_cast<const uint8*>(pView->buffer->data) + pView->offset : nullptr);
+	if (!pViewData)
+		return nullptr;
+
+	if (Count > 0 && pAccessor->offset + (Count - 1) * pAccessor->stride + ElementSize > pView->size)
+		return nullptr;
+
+	return pViewData + pAccessor->offset;
+}
+
+//
+// Vertex attributes
+//
+template<class TComponent> static constexpr float GetNormalizationScale()
+{
+	if constexpr (std::is_same_v<TComponent, int8  >) return 1.0f / 127.0f;
+	if constexpr (std::is_same_v<TComponent, uint8 >) return 1.0f / 255.0f;
+	if constexpr (std::is_same_v<TComponent, int16 >) return 1.0f / 32767.0f;
+	if constexpr (std::is_same_v<TComponent, uint16>) return 1.0f / 65535.0f;
+	return 1.0f;
+}
+
+template<size_t NUM_BYTES> static __m128i LoadBytes(const uint8* pSrc)
+{
+	static_assert(NUM_BYTES == 4 || NUM_BYTES == 8 || NUM_BYTES == 16);
+	if constexpr (NUM_BYTES == 4)  { int32 v; memcpy(&v, pSrc, 4); return _mm_cvtsi32_si128(v); }
+	if constexpr (NUM_BYTES == 8)  return _mm_loadl_epi64(reinterpret_cast<const __m128i*>(pSrc));
+	if constexpr (NUM_BYTES == 16) return _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc));
+}
+
+template<size_t NUM_COMPONENTS, class TComponent, bool bNormalized>
+static inline __m128 DecodeElement(__m128i Raw, __m128 Scale, __m128 SignMask)
+{
+	__m128 v;
+	if constexpr (std::is_same_v<TComponent, float>)
+	{
+		v = _mm_castsi128_ps(Raw);
+	}
+	else if constexpr (std::is_same_v<TComponent, uint32>)
+	{
+		alignas(16) uint32 u[4]; // no unsigned 32-bit conversion in SSE
+		_mm_store_si128(reinterpret_cast<__m128i*>(u), Raw);
+		v = _mm_set_ps(static_cast<float>(u[3]), static_cast<float>(u[2]), static_cast<float>(u[1]), static_cast<float>(u[0]));
+	}
+	else
+	{
+		__m128i Widened;
+		if constexpr (std::is_same_v<TComponent, int8  >) Widened = _mm_cvtepi8_epi32(Raw);
+		if constexpr (std::is_same_v<TComponent, uint8 >) Widened = _mm_cvtepu8_epi32(Raw);
+		if constexpr (std::is_same_v<TComponent, int16 >) Widened = _mm_cvtepi16_epi32(Raw);
+		if constexpr (std::is_same_v<TComponent, uint16>) Widened = _mm_cvtepu16_epi32(Raw);
+		v = _mm_cvtepi32_ps(Widened);
+		if constexpr (bNormalized)
+		{
+			v = _mm_mul_ps(v, Scale);
+			if constexpr (std::is_signed_v<TComponent>)
+				v = _mm_max_ps(v, _mm_set1_ps(-1.0f)); // -128 & -32768 map to -1 as well
+		}
+	}
+	return _mm_xor_ps(v, SignMask);
+}
+
+template<size_t NUM_COMPONENTS> static inline void StoreElement(uint8* pDst, __m128 v)
+{
+	float* pOut = reinterpret_cast<float*>(pDst);
+	if constexpr (NUM_COMPONENTS == 4) _mm_storeu_ps(pOut, v);
+	if constexpr (NUM_COMPONENTS <= 3) _mm_storel_pi(reinterpret_cast<__m64*>(pOut), v);
+	if constexpr (NUM_COMPONENTS == 3) _mm_store_ss(pOut + 2, _mm_movehl_ps(v, v)); // don't touch the next vertex member
+}
+
+template<size_t NUM_COMPONENTS, class TComponent, bool bNormalized>
+static void UnpackElements(const uint8* pSrc, size_t SrcStride, uint8* pDst, size_t DstStride, size_t NumElements, bool bNegateZ)
+{
+	static_assert(NUM_COMPONENTS >= 2 && NUM_COMPONENTS <= 4);
+	constexpr size_t SRC_ELEMENT_SIZE = NUM_COMPONENTS * sizeof(TComponent);
+	constexpr size_t LOAD_SIZE = SRC_ELEMENT_SIZE <= 4 ? 4 : (SRC_ELEMENT_SIZE <= 8 ? 8 : 16);
+	static_assert(LOAD_SIZE <= 2 * SRC_ELEMENT_SIZE);
+
+	const __m128 SignMask = _mm_castsi128_ps(_mm_set_epi32(0, bNegateZ ? static_cast<int>(0x80000000) : 0, 0, 0));
+	const __m128 Scale    = _mm_set1_ps(GetNormalizationScale<TComponent>());
+	if (NumElements == 0)
+		return;
+
+	// The loads are rounded up to 4/8/16 bytes and may read into the next element,
+	// which is in bounds for all but the last one. The extra lanes are never stored.
+	for (size_t i = 0; i + 1 < NumElements; ++i, pSrc += SrcStride, pDst += DstStride)
+	{
+		StoreElement<NUM_COMPONENTS>(pDst, DecodeElement<NUM_COMPONENTS, TComponent, bNormalized>(LoadBytes<LOAD_SIZE>(pSrc), Scale, SignMask));
+	}
+
+	alignas(16) uint8 Last[16] = {};
+	memcpy(Last, pSrc, SRC_ELEMENT_SIZE);
+	StoreElement<NUM_COMPONENTS>(pDst, DecodeElement<NUM_COMPONENTS, TComponent, bNormalized>(LoadBytes<16>(Last), Scale, SignMask));
+}
+
+template<size_t NUM_COMPONENTS>
+static bool UnpackFloatsN(const cgltf_accessor* pAccessor, uint8* pDst, size_t DstStride, size_t NumElements, bool bNegateZ)
+{
+	const size_t ElementSize = cgltf_num_components(pAccessor->type) * cgltf_component_size(pAccessor->component_type);
+	const uint8* pSrc = GetAccessorData(pAccessor, ElementSize, NumElements);
+	if (!pSrc)
+		return false;
+
+	const size_t SrcStride = pAccessor->stride;
+	const bool bNormalized = pAccessor->normalized;
+	switch (pAccessor->component_type)
+	{
+	case cgltf_component_type_r_32f: UnpackElements<NUM_COMPONENTS, float, false>(pSrc, SrcStride, pDst, DstStride, NumElements, bNegateZ); return true;
+	case cgltf_component_type_r_32u: UnpackElements<NUM_COMPONENTS, uint32, false>(pSrc, SrcStride, pDst, DstStride, NumElements, bNegateZ); return true;
+	case cgltf_component_type_r_16u:
+		if (bNormalized) UnpackElements<NUM_COMPONENTS, uint16, true >(pSrc, SrcStride, pDst, DstStride, NumElements, bNegateZ);
+		else             UnpackElements<NUM_COMPONENTS, uint16, false>(pSrc, SrcStride, pDst, DstStride, NumElements, bNegateZ);
+		return true;
+	case cgltf_component_type_r_16:
+		if (bNormalized) UnpackElements<NUM_COMPONENTS, int16, true >(pSrc, SrcStride, pDst, DstStride, NumElements, bNegateZ);
+		else             UnpackElements<NUM_COMPONENTS, int16, false>(pSrc, SrcStride, pDst, DstStride, NumElements, bNegateZ);
+		return true;
+	case cgltf_component_type_r_8u:
+		if (bNormalized) UnpackElements<NUM_COMPONENTS, uint8, true >(pSrc, SrcStride, pDst, DstStride, NumElements, bNegateZ);
+		else             UnpackElements<NUM_COMPONENTS, uint8, false>(pSrc, SrcStride, pDst, DstStride, NumElements, bNegateZ);
+		return true;
+	case cgltf_component_type_r_8:
+		if (bNormalized) UnpackElements<NUM_COMPONENTS, int8, true >(pSrc, SrcStride, pDst, DstStride, NumElements, bNegateZ);
+		else             UnpackElements<NUM_COMPONENTS, int8, false>(pSrc, SrcStride, pDst, DstStride, NumElements, bNegateZ);
+		return true;
+	default:
+		return false;
+	}
+}
+
+size_t GLTFDecode::UnpackFloats(const cgltf_accessor* pAccessor, size_t NumComponents, void* pDst, size_t DstStride, size_t MaxElements, bool bNegateZ)
+{
+	if (!pAccessor || cgltf_num_components(pAccessor->type) < NumComponents)
+		return 0;
+
+	const size_t NumElements = std::min<size_t>(pAccessor->count, MaxElements);
+	uint8* pDstBytes = static_cast<uint8*>(pDst);
+	bool bSuccess = false;
+	switch (NumComponents)
+	{
+	case 2: bSuccess = UnpackFloatsN<2>(pAccessor, pDstBytes, DstStride, NumElements, bNegateZ); break;
+	case 3: bSuccess = UnpackFloatsN<3>(pAccessor, pDstBytes, DstStride, NumElements, bNegateZ); break;
+	case 4: bSuccess = UnpackFloatsN<4>(pAccessor, pDstBytes, DstStride, NumElements, bNegateZ); break;
+	}
+	return bSuccess ? NumElements : 0;
+}
+
+//
+// Indices
+//
+template<class TIndex>
+static void UnpackIndicesT(const uint8* pSrc, size_t SrcStride, uint32* pDst, size_t NumIndices, bool bFlipWinding)
+{
+	auto Read = [&](size_t i) -> uint32
+	{
+		TIndex Index;
+		memcpy(&Index, pSrc + i * SrcStride, sizeof(TIndex));
+		return static_cast<uint32>(Index);
+	};
+
+	size_t i = 0;
+	if (bFlipWinding)
+	{
+		for (; i + 3 <= NumIndices; i += 3)
+		{
+			pDst[i + 0] = Read(i + 0);
+			pDst[i + 1] = Read(i + 2);
+			pDst[i + 2] = Read(i + 1);
+		}
+	}
+	for (; i < NumIndices; ++i)
+	{
+		pDst[i] = Read(i);
+	}
+}
+
+size_t GLTFDecode::UnpackIndices(const cgltf_accessor* pAccessor, uint32* pDst, size_t MaxElements, bool bFlipWinding)
+{
+	if (!pAccessor)
+		return 0;
+
+	const size_t NumIndices = std::min<size_t>(pAccessor->count, MaxElements);
+	const uint8* pSrc = GetAccessorData(pAccessor, cgltf_component_size(pAccessor->component_type), NumIndices);
+	if (!pSrc)
+		return 0;
+
+	switch (pAccessor->component_type)
+	{
+	case cgltf_component_type_r_8u : UnpackIndicesT<uint8 >(pSrc, pAccessor->stride, pDst, NumIndices, bFlipWinding); break;
+	case cgltf_component_type_r_16u: UnpackIndicesT<uint16>(pSrc, pAccessor->stride, pDst, NumIndices, bFlipWinding); break;
+	case cgltf_component_type_r_32u: UnpackIndicesT<uint32>(pSrc, pAccessor->stride, pDst, NumIndices, bFlipWinding); break;
+	default:
+		return 0; // not a valid index type in glTF 2.0
+	}
+	return NumIndices;
+}
@@ -0,0 +1,46 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+#pragma once
+
+#include "Core/Types.h"
+
+#include <cstddef>
+
+struct cgltf_accessor;
+
+//
+// GLTF ACCESSOR DECODING
+//
+// Unpacks whole glTF accessors in one go instead of going through
+// cgltf_accessor_read_float()/cgltf_accessor_read_index() per element.
+// The component type is dispatched once per accessor, each element is read
+// with a single SSE load: float streams are copied as-is, normalized and
+// integer formats are widened to float with SSE4.1.
+//
+namespace GLTFDecode
+{
+	// Decodes the first NumComponents (2-4) components of each accessor element into
+	// floats written to pDst + i * DstStride, for at most MaxElements elements.
+	// bNegateZ flips the sign of the 3rd component (right-handed -> left-handed).
+	// Returns the number of decoded elements, 0 if the accessor can't be decoded (sparse, no data, unsupported format).
+	size_t UnpackFloats(const cgltf_accessor* pAccessor, size_t NumComponents, void* pDst, size_t DstStride, size_t MaxElements, bool bNegateZ);
+
+	// Decodes at most MaxElements indices into pDst. bFlipWinding swaps the last two indices of each triangle.
+	// Returns the number of decoded indices.
+	size_t UnpackIndices(const cgltf_accessor* pAccessor, uint32* pDst, size_t MaxElements, bool bFlipWinding);
+}
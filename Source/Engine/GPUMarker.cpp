@@ -19,21 +19,41 @@
 #define VC_EXTRALEAN
 #define WIN32_LEAN_AND_MEAN
 #define NOMINMAX
+#ifdef _WIN32
 #include <d3d12.h>
+#endif
 #include "GPUMarker.h"
 
 ScopedMarker::ScopedMarker(const char* pLabel, unsigned PIXColor)
 {
+	Begin(pLabel, PIXColor);
+}
+void ScopedMarker::Begin(const char* pLabel, unsigned PIXColor)
+{
+#if USE_PIX
 	PIXBeginEvent(PIXColor, pLabel);
+#endif
+#if VQENGINE_TRACE_COLLECTOR
+	mbTraced = Trace::IsEnabled();
+	if (mbTraced)
+		Trace::BeginScope(pLabel);
+#endif
 }
 ScopedMarker::~ScopedMarker()
 {
+#if USE_PIX
 	PIXEndEvent();
+#endif
+#if VQENGINE_TRACE_COLLECTOR
+	if (mbTraced)
+		Trace::EndScope();
+#endif
 }
 
 // https://devblogs.microsoft.com/pix/winpixeventruntime/#:~:text=An%20%E2%80%9Cevent%E2%80%9D%20represents%20a%20region,a%20single%20point%20in%20time.
 // https://devblogs.microsoft.com/pix/pix-2008-26-new-capture-layer/
 
+#if USE_PIX
 ScopedGPUMarker::ScopedGPUMarker(ID3D12GraphicsCommandList* pCmdList, const char* pLabel, unsigned PIXColor)
 	: mpCmdList(pCmdList)
 {
@@ -50,3 +70,4 @@ ScopedGPUMarker::~ScopedGPUMarker()
 {
 	PIXEndEvent(mpCmdList);
 }
+#endif
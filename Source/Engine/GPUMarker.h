@@ -18,12 +18,17 @@
 
 #pragma once
 
+#ifdef _WIN32
 #define USE_PIX 1
+#else
+#define USE_PIX 0 // the CPU markers still feed the trace collector, see Core/Trace.h
+#endif
 #if USE_PIX 
 	// Enable PIX markers for RGP, must be included before pix3.h
 	#define VQE_ENABLE_RGP_PIX 0
 #endif
 
+#if USE_PIX
 #define VC_EXTRALEAN
 #define WIN32_LEAN_AND_MEAN
 #define NOMINMAX
@@ -32,6 +37,12 @@
 #ifdef max
 #error "max macro is defined"
 #endif
+#else
+#define PIX_COLOR_DEFAULT 0
+#endif
+
+#include "Core/Trace.h"
+#include <cstdio>
 
 #if 0 // Disable markers for ASAN builds, as it causes issues with memory tracking
 #define SCOPED_GPU_MARKER(pCmd, pStr)             do{}while(0)
@@ -55,6 +66,9 @@ public:
 	template<class ... Args>
 	ScopedMarker(unsigned PIXColor, const char* pLabel, Args&&... args);
 	~ScopedMarker();
+private:
+	void Begin(const char* pLabel, unsigned PIXColor);
+	bool mbTraced = false; // the collector may be toggled while the scope is open
 };
 
 
@@ -62,8 +76,8 @@ template<class ...Args>
 inline ScopedMarker::ScopedMarker(unsigned PIXColor, const char* pFormat, Args && ...args)
 {
 	char buf[256];
-	sprintf_s(buf, pFormat, args...);
-	PIXBeginEvent(PIXColor, buf);
+	snprintf(buf, sizeof(buf), pFormat, args...);
+	Begin(buf, PIXColor);
 }
 
 
@@ -0,0 +1,173 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+
+#include "LoadTimeline.h"
+#include "GPUMarker.h"
+
+#include "Libs/VQUtils/Include/Log.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+const char* FLoadTimeline::GetStageName(EStage Stage)
+{
+	static const char* STAGE_NAMES[NUM_STAGES] = { "Parse", "Materials", "Textures", "Meshes", "Buffers", "TexAssign", "Ready" };
+	return Stage < NUM_STAGES ? STAGE_NAMES[Stage] : "?";
+}
+
+FLoadTimeline::FScopedStage::FScopedStage(FLoadTimeline& Timeline, const std::string& Asset, EStage Stage)
+	: mTimeline(Timeline)
+	, mAsset(Asset)
+	, mStage(Stage)
+{
+	mTimeline.BeginStage(mAsset, mStage);
+}
+FLoadTimeline::FScopedStage::~FScopedStage()
+{
+	mTimeline.EndStage(mAsset, mStage);
+}
+
+float FLoadTimeline::GetElapsedMs() const
+{
+	return std::chrono::duration<float, std::milli>(Clock_t::now() - mStart).count();
+}
+
+void FLoadTimeline::Reset()
+{
+	std::lock_guard<std::mutex> lk(mMtx);
+	mSpans.clear();
+	mStart = Clock_t::now();
+}
+
+void FLoadTimeline::BeginStage(const std::string& Asset, EStage Stage)
+{
+#if LOAD_TIMELINE_ENABLED
+	std::lock_guard<std::mutex> lk(mMtx);
+	mSpans.push_back({ Asset, Stage, GetElapsedMs(), -1.0f });
+#endif
+}
+
+void FLoadTimeline::EndStage(const std::string& Asset, EStage Stage)
+{
+#if LOAD_TIMELINE_ENABLED
+	std::lock_guard<std::mutex> lk(mMtx);
+	const float NowMs = GetElapsedMs();
+	for (auto it = mSpans.rbegin(); it != mSpans.rend(); ++it) // the open span is most likely a recent one
+	{
+		if (it->EndMs < 0.0f && it->Stage == Stage && it->Asset == Asset)
+		{
+			it->EndMs = NowMs;
+			return;
+		}
+	}
+#endif
+}
+
+void FLoadTimeline::MarkStage(const std::string& Asset, EStage Stage)
+{
+#if LOAD_TIMELINE_ENABLED
+	std::lock_guard<std::mutex> lk(mMtx);
+	const float NowMs = GetElapsedMs();
+	mSpans.push_back({ Asset, Stage, NowMs, NowMs });
+#endif
+}
+
+void FLoadTimeline::LogSummary(const std::string& LoadName) const
+{
+#if LOAD_TIMELINE_ENABLED
+	SCOPED_CPU_MARKER("FLoadTimeline::LogSummary()");
+	struct FAsset
+	{
+		std::string Name;
+		float BeginMs = 0.0f;
+		float EndMs = 0.0f;
+		std::vector<const FSpan*> Spans;
+	};
+
+	std::vector<FSpan> Spans;
+	{
+		std::lock_guard<std::mutex> lk(mMtx);
+		Spans = mSpans;
+	}
+	if (Spans.empty())
+		return;
+
+	// group the closed spans by asset
+	std::vector<FAsset> Assets;
+	std::unordered_map<std::string, size_t> AssetIndices;
+	for (const FSpan& Span : Spans)
+	{
+		if (Span.EndMs < 0.0f)
+			continue;
+		auto it = AssetIndices.find(Span.Asset);
+		if (it == AssetIndices.end())
+		{
+			it = AssetIndices.emplace(Span.Asset, Assets.size()).first;
+			Assets.push_back({ Span.Asset, Span.BeginMs, Span.EndMs });
+		}
+		FAsset& Asset = Assets[it->second];
+		Asset.BeginMs = std::min(Asset.BeginMs, Span.BeginMs);
+		Asset.EndMs = std::max(Asset.EndMs, Span.EndMs);
+		Asset.Spans.push_back(&Span);
+	}
+	if (Assets.empty())
+		return;
+
+	std::sort(Assets.begin(), Assets.end(), [](const FAsset& a, const FAsset& b) { return a.EndMs < b.EndMs; });
+	for (FAsset& Asset : Assets)
+	{
+		std::stable_sort(Asset.Spans.begin(), Asset.Spans.end(), [](const FSpan* a, const FSpan* b) { return a->BeginMs < b->BeginMs; });
+	}
+
+	size_t NameWidth = 0;
+	for (const FAsset& Asset : Assets)
+		NameWidth = std::max(NameWidth, Asset.Name.size());
+
+	Log::Info("[Timeline] %s: %zu assets, last one done @ %.2fms (begin -> end ms, stages as begin+duration)", LoadName.c_str(), Assets.size(), Assets.back().EndMs);
+	for (const FAsset& Asset : Assets)
+	{
+		std::string StageLog;
+		for (const FSpan* pSpan : Asset.Spans)
+		{
+			char buf[96];
+			if (pSpan->EndMs == pSpan->BeginMs)
+				snprintf(buf, sizeof(buf), "%s%s@%.1f", (StageLog.empty() ? "" : " | "), GetStageName(pSpan->Stage), pSpan->BeginMs);
+			else
+				snprintf(buf, sizeof(buf), "%s%s %.1f+%.1f", (StageLog.empty() ? "" : " | "), GetStageName(pSpan->Stage), pSpan->BeginMs, pSpan->EndMs - pSpan->BeginMs);
+			StageLog += buf;
+		}
+		Log::Info("   %-*s %9.2f -> %9.2f : %s", static_cast<int>(NameWidth), Asset.Name.c_str(), Asset.BeginMs, Asset.EndMs, StageLog.c_str());
+	}
+
+	// critical path: the asset that finished last bounds the load, its longest stage is the one to shorten
+	const FAsset& Critical = Assets.back();
+	const FSpan* pLongest = nullptr;
+	for (const FSpan* pSpan : Critical.Spans)
+	{
+		if (!pLongest || (pSpan->EndMs - pSpan->BeginMs) > (pLongest->EndMs - pLongest->BeginMs))
+			pLongest = pSpan;
+	}
+	Log::Info("[Timeline] Critical path: '%s' [%.2f -> %.2fms], longest stage: %s (%.2fms)"
+		, Critical.Name.c_str()
+		, Critical.BeginMs
+		, Critical.EndMs
+		, GetStageName(pLongest->Stage)
+		, pLongest->EndMs - pLongest->BeginMs
+	);
+#endif
+}
@@ -0,0 +1,86 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Set to 0 to skip recording the scene load timeline
+#define LOAD_TIMELINE_ENABLED 1
+
+//
+// LOAD TIMELINE
+//
+// Records when each asset of a scene load goes through its load stages, relative to the start of the load:
+// the model loads record their parse, material, mesh, buffer & texture stages from the model workers, the
+// scene records its own material textures. Stages of the same asset may overlap, e.g. the textures of a
+// model decode on the TextureManager workers while its meshes are processed & uploaded.
+//
+// LogSummary() prints the stages of each asset in completion order and the critical path: the asset that
+// finished last and its longest stage, which is where a shorter scene load has to start from.
+//
+class FLoadTimeline
+{
+public:
+	enum EStage
+	{
+		PARSE = 0,          // source file read & parse, or cooked file open
+		MATERIALS,          // material creation, queues the texture loads
+		TEXTURES,           // texture dispatch -> textures ready (observed when they're assigned)
+		MESHES,             // mesh import / processing
+		BUFFERS,            // vertex & index buffer creation and upload
+		TEXTURE_ASSIGNMENT, // waiting for the textures & assigning them to the materials
+		READY,              // buffers & textures done: the game objects get the model on the next loading update
+
+		NUM_STAGES
+	};
+	static const char* GetStageName(EStage Stage);
+
+	struct FScopedStage
+	{
+		FScopedStage(FLoadTimeline& Timeline, const std::string& Asset, EStage Stage);
+		~FScopedStage();
+		FLoadTimeline& mTimeline;
+		std::string    mAsset;
+		EStage mStage;
+	};
+
+	void Reset(); // clears the recorded stages and restarts the clock
+	void BeginStage(const std::string& Asset, EStage Stage);
+	void EndStage(const std::string& Asset, EStage Stage); // no-op if the stage wasn't started
+	void MarkStage(const std::string& Asset, EStage Stage); // zero-length stage, e.g. READY
+
+	void LogSummary(const std::string& LoadName) const;
+
+private:
+	using Clock_t = std::chrono::steady_clock;
+	struct FSpan
+	{
+		std::string Asset;
+		EStage      Stage;
+		float       BeginMs;
+		float       EndMs; // < 0: still open
+	};
+	float GetElapsedMs() const;
+
+	mutable std::mutex  mMtx;
+	Clock_t::time_point mStart = Clock_t::now();
+	std::vector<FSpan>  mSpans;
+};
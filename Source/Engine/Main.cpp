@@ -26,6 +26,7 @@
 #include "Core/Window.h"
 #include "Scene/SceneViews.h"
 #include "Scene/Scene.h"
+#include "SceneCache.h"
 
 #include <Windows.h>
 #include <ShellScalingAPI.h>
@@ -170,6 +171,38 @@ static void ParseCommandLineParameters(FStartupParameters& refStartupParams, PST
 			refStartupParams.bOverrideENGSetting_StartupScene = true;
 			strncpy_s(refStartupParams.EngineSettings.StartupScene, paramValue.c_str(), sizeof(refStartupParams.EngineSettings.StartupScene));
 		}
+		if (paramName == "-Snapshot")
+		{
+			refStartupParams.bOverrideENGSetting_StartupSnapshot = true;
+			strncpy_s(refStartupParams.EngineSettings.StartupSnapshot, paramValue.c_str(), sizeof(refStartupParams.EngineSettings.StartupSnapshot));
+		}
+		if (paramName == "-HotReloadScenes")
+		{
+			refStartupParams.bOverrideENGSetting_bHotReloadScenes = true;
+			refStartupParams.EngineSettings.bHotReloadScenes = paramValue.empty() ? true : StrUtil::ParseBool(paramValue);
+		}
+		if (paramName == "-AssetRetentionBudgetMB")
+		{
+			refStartupParams.bOverrideENGSetting_AssetRetentionBudgetMB = true;
+			refStartupParams.EngineSettings.AssetRetentionBudgetMB = StrUtil::ParseInt(paramValue);
+		}
+		if (paramName == "-ScenePreloadBudgetMB")
+		{
+			refStartupParams.bOverrideENGSetting_ScenePreloadBudgetMB = true;
+			refStartupParams.EngineSettings.ScenePreloadBudgetMB = StrUtil::ParseInt(paramValue);
+		}
+
+		//
+		// Tools
+		//
+		if (paramName == "-CookScenes")
+		{
+			refStartupParams.bCookScenesAndExit = true;
+		}
+		if (paramName == "-Trace")
+		{
+			refStartupParams.bTraceCollection = true;
+		}
 	}
 }
 
@@ -191,6 +224,18 @@ int WINAPI WinMain(HINSTANCE hInst, HINSTANCE hPrevInst, PSTR pScmdl, int iCmdSh
 		SCOPED_CPU_MARKER("Log::Initialize");
 		Log::Initialize(StartupParameters.LogInitParams.bLogConsole, StartupParameters.LogInitParams.bLogFile, StartupParameters.LogInitParams.LogFilePath);
 	}
+	if (StartupParameters.bTraceCollection)
+	{
+		Trace::SetEnabled(true);
+	}
+
+	if (StartupParameters.bCookScenesAndExit)
+	{
+		const size_t NumCookedScenes = SceneCache::CookSceneFiles("Data/Levels/");
+		Log::Info("Cooked %zu scenes", NumCookedScenes);
+		Log::Destroy();
+		return 0;
+	}
 
 	{
 		VQEngine Engine = {};
@@ -0,0 +1,444 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+
+#include "MeshCache.h"
+#include "GPUMarker.h"
+#include "Core/Hash.h"
+#include "Core/VirtualFileSystem.h"
+#include "Scene/IndexCompression.h"
+
+#include "Libs/VQUtils/Include/utils.h"
+#include "Libs/VQUtils/Include/Log.h"
+
+#include <filesystem>
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <cstddef>
+
+static const std::string MESH_CACHE_DIRECTORY = "Cache/Meshes";
+static constexpr size_t  STREAM_ALIGNMENT = 16;
+
+using Hash::HashBytes;
+static inline uint64 AlignUp(uint64 Value, uint64 Alignment) { return (Value + Alignment - 1) & ~(Alignment - 1); }
+
+
+
+std::string MeshCache::GetCookedFilePath(const std::string& ModelFilePath)
+{
+	const uint64 PathHash = HashBytes(ModelFilePath.data(), ModelFilePath.size());
+	char HashStr[17]; snprintf(HashStr, sizeof(HashStr), "%016llx", PathHash);
+	return MESH_CACHE_DIRECTORY + "/" + DirectoryUtil::GetFileNameWithoutExtension(ModelFilePath) + "_" + HashStr + ".vqmesh";
+}
+
+// buffer files: size & write time, reading them would cost as much as the import we're trying to skip.
+// the pak entries keep the size & write time of their source files: packing doesn't invalidate the cooked files
+static uint64 HashBufferFileStamps(const std::string& ModelFilePath, uint64 Hash)
+{
+	for (const std::string& BufferFile : VFS::ListFiles(std::filesystem::path(ModelFilePath).parent_path().string(), "bin"))
+	{
+		VFS::FFileInfo Info;
+		VFS::GetFileInfo(BufferFile, Info);
+		const std::string FileName = std::filesystem::path(BufferFile).filename().string();
+		Hash = HashBytes(FileName.data(), FileName.size(), Hash);
+		Hash = HashBytes(&Info.Size, sizeof(Info.Size), Hash);
+		Hash = HashBytes(&Info.WriteTime, sizeof(Info.WriteTime), Hash);
+	}
+	return Hash;
+}
+
+uint64 MeshCache::ComputeSourceHash(const std::string& ModelFilePath)
+{
+	SCOPED_CPU_MARKER("MeshCache::ComputeSourceHash");
+	VFS::FFile ModelFile;
+	if (!VFS::ReadFile(ModelFilePath, ModelFile) || ModelFile.GetSize() == 0)
+		return 0;
+	return HashBufferFileStamps(ModelFilePath, HashBytes(ModelFile.GetData(), ModelFile.GetSize()));
+}
+
+uint64 MeshCache::ComputeSourceStamp(const std::string& ModelFilePath)
+{
+	SCOPED_CPU_MARKER("MeshCache::ComputeSourceStamp");
+	VFS::FFileInfo Info;
+	if (!VFS::GetFileInfo(ModelFilePath, Info) || Info.Size == 0)
+		return 0;
+	uint64 Stamp = HashBytes(&Info.Size, sizeof(Info.Size));
+	Stamp = HashBytes(&Info.WriteTime, sizeof(Info.WriteTime), Stamp);
+	return HashBufferFileStamps(ModelFilePath, Stamp);
+}
+
+// the source was touched w/o changing (hash match, stamp mismatch): store the new stamp so the next loads skip the hash.
+// Best effort, fails while the file is mapped elsewhere, e.g. by a preloaded FCookedModel.
+static bool WriteSourceStamp(const std::string& CookedFilePath, uint64 SourceStamp)
+{
+	std::fstream File(CookedFilePath, std::ios::binary | std::ios::in | std::ios::out);
+	if (!File.is_open())
+		return false;
+	File.seekp(offsetof(MeshCache::FCookedModelHeader, SourceStamp));
+	File.write(reinterpret_cast<const char*>(&SourceStamp), sizeof(SourceStamp));
+	return File.good();
+}
+
+
+
+//
+// WRITE
+//
+bool MeshCache::WriteCookedModel(const std::string& CookedFilePath, uint64 SourceHash, uint64 SourceStamp, uint32 ImporterVersion, const FCookedModelDesc& Desc)
+{
+	SCOPED_CPU_MARKER("MeshCache::WriteCookedModel");
+
+	std::vector<FCookedMesh>     Meshes(Desc.Meshes.size());
+	std::vector<FCookedMeshLOD>  LODs;
+	std::vector<FCookedMaterial> Materials(Desc.Materials.size());
+	std::vector<FCookedTexture>  Textures;
+	std::string                  Strings;
+	std::vector<std::vector<uint8>> EncodedIndices; // [NumLODs], empty for the uncompressed streams
+
+	auto fnAddString = [&Strings](const std::string& s)
+	{
+		const uint32 Offset = static_cast<uint32>(Strings.size());
+		Strings.append(s.c_str(), s.size() + 1);
+		return Offset;
+	};
+
+	// tables
+	for (size_t iMat = 0; iMat < Desc.Materials.size(); ++iMat)
+	{
+		const FCookedModelDesc::FMaterial& mat = Desc.Materials[iMat];
+		FCookedMaterial& cooked = Materials[iMat];
+		cooked.NameOffset = fnAddString(mat.Name);
+		cooked.Flags = mat.Flags;
+		memcpy(cooked.Diffuse, mat.Diffuse, sizeof(cooked.Diffuse));
+		cooked.Alpha = mat.Alpha;
+		cooked.Metalness = mat.Metalness;
+		cooked.Roughness = mat.Roughness;
+		cooked.EmissiveIntensity = mat.EmissiveIntensity;
+		cooked.FirstTexture = static_cast<uint32>(Textures.size());
+		cooked.NumTextures = static_cast<uint32>(mat.Textures.size());
+		for (const auto& [TexType, TexPath] : mat.Textures)
+			Textures.push_back({ fnAddString(TexPath), TexType });
+	}
+	for (size_t iMesh = 0; iMesh < Desc.Meshes.size(); ++iMesh)
+	{
+		const FCookedModelDesc::FMesh& mesh = Desc.Meshes[iMesh];
+		FCookedMesh& cooked = Meshes[iMesh];
+		cooked.NameOffset = fnAddString(mesh.Name);
+		cooked.MaterialIndex = mesh.MaterialIndex;
+		cooked.FirstLOD = static_cast<uint32>(LODs.size());
+		cooked.NumLODs = static_cast<uint32>(mesh.LODs.size());
+		memcpy(cooked.BoundsMin, &mesh.LocalSpaceBoundingBox.ExtentMin, sizeof(cooked.BoundsMin));
+		memcpy(cooked.BoundsMax, &mesh.LocalSpaceBoundingBox.ExtentMax, sizeof(cooked.BoundsMax));
+		cooked.VertexFormat = static_cast<uint32>(mesh.VertexFormat);
+		memcpy(cooked.UVScaleBias, &mesh.UVScaleBias, sizeof(cooked.UVScaleBias));
+		for (const Mesh::FLODView& lod : mesh.LODs)
+		{
+			FCookedMeshLOD cookedLOD = {};
+			cookedLOD.NumVertices = lod.NumVertices;
+			cookedLOD.NumIndices = lod.NumIndices;
+			cookedLOD.VertexStride = lod.VertexStride;
+			cookedLOD.IndexStride = lod.IndexStride;
+			cookedLOD.Error = lod.Error;
+			cookedLOD.NumMeshlets = lod.NumMeshlets;
+			cookedLOD.IndexCodec = COOKED_INDEX_CODEC_NONE;
+			cookedLOD.IndexDataSize = lod.NumIndices * lod.IndexStride;
+
+			std::vector<uint8>& Encoded = EncodedIndices.emplace_back();
+#if MESH_CACHE_COMPRESS_INDICES
+			Encoded = IndexCompression::EncodeIndexBuffer(lod.pIndices, lod.NumIndices, lod.IndexStride);
+			if (Encoded.size() < cookedLOD.IndexDataSize)
+			{
+				cookedLOD.IndexCodec = COOKED_INDEX_CODEC_FIFO_VARINT;
+				cookedLOD.IndexDataSize = static_cast<uint32>(Encoded.size());
+			}
+			else
+			{
+				Encoded.clear(); // doesn't pay off, e.g. tiny meshes
+			}
+#endif
+			LODs.push_back(cookedLOD);
+		}
+	}
+
+	// layout
+	FCookedModelHeader Header = {};
+	Header.Magic           = COOKED_MODEL_MAGIC;
+	Header.FormatVersion   = COOKED_MODEL_FORMAT_VERSION;
+	Header.ImporterVersion = ImporterVersion;
+	Header.SourceHash      = SourceHash;
+	Header.SourceStamp     = SourceStamp;
+	Header.NumMeshes       = static_cast<uint32>(Meshes.size());
+	Header.NumLODs         = static_cast<uint32>(LODs.size());
+	Header.NumMaterials    = static_cast<uint32>(Materials.size());
+	Header.NumTextures     = static_cast<uint32>(Textures.size());
+	Header.StringTableSize = static_cast<uint32>(Strings.size());
+	Header.OffsetMeshes    = sizeof(FCookedModelHeader);
+	Header.OffsetLODs      = Header.OffsetMeshes    + sizeof(FCookedMesh)     * Meshes.size();
+	Header.OffsetMaterials = Header.OffsetLODs      + sizeof(FCookedMeshLOD)  * LODs.size();
+	Header.OffsetTextures  = Header.OffsetMaterials + sizeof(FCookedMaterial) * Materials.size();
+	Header.OffsetStrings   = Header.OffsetTextures  + sizeof(FCookedTexture)  * Textures.size();
+	uint64 Offset          = Header.OffsetStrings   + Strings.size();
+	{
+		size_t iLOD = 0;
+		for (const FCookedModelDesc::FMesh& mesh : Desc.Meshes)
+		for (const Mesh::FLODView& lod : mesh.LODs)
+		{
+			FCookedMeshLOD& cookedLOD = LODs[iLOD++];
+			cookedLOD.VertexDataOffset = Offset = AlignUp(Offset, STREAM_ALIGNMENT);
+			Offset += static_cast<uint64>(lod.NumVertices) * lod.VertexStride;
+			cookedLOD.IndexDataOffset = Offset = AlignUp(Offset, STREAM_ALIGNMENT);
+			Offset += cookedLOD.IndexDataSize;
+			cookedLOD.MeshletDataOffset = Offset = AlignUp(Offset, STREAM_ALIGNMENT);
+			Offset += static_cast<uint64>(lod.NumMeshlets) * sizeof(FMeshlet);
+		}
+	}
+	Header.FileSize = Offset;
+
+	// write to a temp file and rename it at the end so that a cooked file is either complete or absent
+	DirectoryUtil::CreateFolderIfItDoesntExist(MESH_CACHE_DIRECTORY);
+	const std::string TempFilePath = CookedFilePath + ".tmp";
+	{
+		std::ofstream File(TempFilePath, std::ios::binary | std::ios::trunc);
+		if (!File.is_open())
+		{
+			Log::Error("MeshCache: couldn't open %s for writing", TempFilePath.c_str());
+			return false;
+		}
+
+		static const char PADDING[STREAM_ALIGNMENT] = {};
+		auto fnWrite = [&File](const void* pData, uint64 NumBytes) { File.write(static_cast<const char*>(pData), static_cast<std::streamsize>(NumBytes)); };
+		auto fnPadTo = [&File, &fnWrite](uint64 TargetOffset) { const uint64 Pos = static_cast<uint64>(File.tellp()); if (TargetOffset > Pos) fnWrite(PADDING, TargetOffset - Pos); };
+
+		fnWrite(&Header, sizeof(Header));
+		fnWrite(Meshes.data(), sizeof(FCookedMesh) * Meshes.size());
+		fnWrite(LODs.data(), sizeof(FCookedMeshLOD) * LODs.size());
+		fnWrite(Materials.data(), sizeof(FCookedMaterial) * Materials.size());
+		fnWrite(Textures.data(), sizeof(FCookedTexture) * Textures.size());
+		fnWrite(Strings.data(), Strings.size());
+		size_t iLOD = 0;
+		for (const FCookedModelDesc::FMesh& mesh : Desc.Meshes)
+		for (const Mesh::FLODView& lod : mesh.LODs)
+		{
+			const std::vector<uint8>& Encoded = EncodedIndices[iLOD];
+			const FCookedMeshLOD& cookedLOD = LODs[iLOD++];
+			fnPadTo(cookedLOD.VertexDataOffset);
+			fnWrite(lod.pVertices, static_cast<uint64>(lod.NumVertices) * lod.VertexStride);
+			fnPadTo(cookedLOD.IndexDataOffset);
+			fnWrite(Encoded.empty() ? lod.pIndices : Encoded.data(), cookedLOD.IndexDataSize);
+			fnPadTo(cookedLOD.MeshletDataOffset);
+			fnWrite(lod.pMeshlets, static_cast<uint64>(lod.NumMeshlets) * sizeof(FMeshlet));
+		}
+
+		if (!File.good())
+		{
+			Log::Error("MeshCache: error writing %s", TempFilePath.c_str());
+			File.close();
+			std::remove(TempFilePath.c_str());
+			return false;
+		}
+	}
+
+	std::error_code ec;
+	std::filesystem::rename(TempFilePath, CookedFilePath, ec);
+	if (ec)
+	{
+		Log::Error("MeshCache: couldn't move %s to %s: %s", TempFilePath.c_str(), CookedFilePath.c_str(), ec.message().c_str());
+		std::remove(TempFilePath.c_str());
+		return false;
+	}
+	return true;
+}
+
+
+
+//
+// READ
+//
+std::shared_ptr<MeshCache::FCookedModel> MeshCache::FCookedModel::Open(const std::string& CookedFilePath, const std::string& ModelFilePath, uint64 SourceStamp, uint32 ImporterVersion)
+{
+	SCOPED_CPU_MARKER("MeshCache::Open");
+	std::shared_ptr<FCookedModel> pModel = std::make_shared<FCookedModel>();
+	if (!pModel->mFile.Open(CookedFilePath))
+		return nullptr;
+
+	if (!pModel->Validate(CookedFilePath))
+		return nullptr;
+
+	if (pModel->GetHeader().ImporterVersion != ImporterVersion)
+	{
+		Log::Info("MeshCache: %s is stale (importer version %u -> %u)", CookedFilePath.c_str(), pModel->GetHeader().ImporterVersion, ImporterVersion);
+		return nullptr;
+	}
+
+	// the stamp changes w/ the size or write time of the source, hash the contents only then
+	if (SourceStamp == 0 || pModel->GetHeader().SourceStamp != SourceStamp)
+	{
+		if (pModel->GetHeader().SourceHash != ComputeSourceHash(ModelFilePath))
+		{
+			Log::Info("MeshCache: %s is stale (source changed)", CookedFilePath.c_str());
+			return nullptr;
+		}
+		if (SourceStamp != 0)
+		{
+			pModel->mFile.Close();
+			WriteSourceStamp(CookedFilePath, SourceStamp);
+			if (!pModel->mFile.Open(CookedFilePath) || !pModel->Validate(CookedFilePath))
+				return nullptr;
+		}
+	}
+	pModel->mSourceStamp = SourceStamp;
+
+	if (!pModel->DecodeIndexStreams(CookedFilePath))
+		return nullptr;
+	return pModel;
+}
+
+bool MeshCache::FCookedModel::Validate(const std::string& CookedFilePath) const
+{
+	if (mFile.GetSize() < sizeof(FCookedModelHeader))
+	{
+		Log::Warning("MeshCache: %s is truncated", CookedFilePath.c_str());
+		return false;
+	}
+	const FCookedModelHeader& Header = GetHeader();
+	if (Header.Magic != COOKED_MODEL_MAGIC || Header.FormatVersion != COOKED_MODEL_FORMAT_VERSION)
+	{
+		Log::Info("MeshCache: %s has an unknown format (version %u, expected %u)", CookedFilePath.c_str(), Header.FormatVersion, COOKED_MODEL_FORMAT_VERSION);
+		return false;
+	}
+	const bool bTablesFit = Header.FileSize == mFile.GetSize()
+		&& Header.OffsetMeshes    + sizeof(FCookedMesh)     * Header.NumMeshes    <= Header.OffsetLODs
+		&& Header.OffsetLODs      + sizeof(FCookedMeshLOD)  * Header.NumLODs      <= Header.OffsetMaterials
+		&& Header.OffsetMaterials + sizeof(FCookedMaterial) * Header.NumMaterials <= Header.OffsetTextures
+		&& Header.OffsetTextures  + sizeof(FCookedTexture)  * Header.NumTextures  <= Header.OffsetStrings
+		&& Header.OffsetStrings   + Header.StringTableSize                        <= Header.FileSize;
+	if (!bTablesFit)
+	{
+		Log::Warning("MeshCache: %s is corrupt", CookedFilePath.c_str());
+		return false;
+	}
+	bool bRangesValid = true;
+	for (uint32 iMesh = 0; iMesh < Header.NumMeshes && bRangesValid; ++iMesh)
+	{
+		const FCookedMesh& mesh = GetMesh(iMesh);
+		bRangesValid = static_cast<uint64>(mesh.FirstLOD) + mesh.NumLODs <= Header.NumLODs
+			&& mesh.MaterialIndex < static_cast<int32>(Header.NumMaterials)
+			&& mesh.NameOffset < Header.StringTableSize
+			&& mesh.VertexFormat < NUM_VERTEX_BUFFER_TYPES;
+	}
+	for (uint32 iLOD = 0; iLOD < Header.NumLODs && bRangesValid; ++iLOD)
+	{
+		const FCookedMeshLOD& lod = GetLOD(iLOD);
+		bRangesValid = lod.VertexDataOffset + static_cast<uint64>(lod.NumVertices) * lod.VertexStride <= Header.FileSize
+			&&         lod.IndexDataOffset  + lod.IndexDataSize                                        <= Header.FileSize
+			&&       lod.MeshletDataOffset  + static_cast<uint64>(lod.NumMeshlets) * sizeof(FMeshlet) <= Header.FileSize
+			&& (lod.IndexStride == sizeof(uint16) || lod.IndexStride == sizeof(uint32))
+			&& lod.IndexCodec < NUM_COOKED_INDEX_CODECS
+			&& (lod.IndexCodec != COOKED_INDEX_CODEC_NONE || lod.IndexDataSize == static_cast<uint64>(lod.NumIndices) * lod.IndexStride);
+		const FMeshlet* pMeshlets = mFile.GetDataAt<FMeshlet>(lod.MeshletDataOffset);
+		for (uint32 i = 0; i < lod.NumMeshlets && bRangesValid; ++i) // the culling draws these ranges
+			bRangesValid = static_cast<uint64>(pMeshlets[i].IndexOffset) + pMeshlets[i].NumIndices <= lod.NumIndices;
+	}
+	for (uint32 iMat = 0; iMat < Header.NumMaterials && bRangesValid; ++iMat)
+	{
+		const FCookedMaterial& mat = GetMaterial(iMat);
+		bRangesValid = static_cast<uint64>(mat.FirstTexture) + mat.NumTextures <= Header.NumTextures
+			&& mat.NameOffset < Header.StringTableSize;
+	}
+	for (uint32 iTex = 0; iTex < Header.NumTextures && bRangesValid; ++iTex)
+	{
+		bRangesValid = GetTexture(iTex).PathOffset < Header.StringTableSize;
+	}
+	if (!bRangesValid || (Header.StringTableSize > 0 && *GetString(Header.StringTableSize - 1) != '\0'))
+	{
+		Log::Warning("MeshCache: %s is corrupt", CookedFilePath.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool MeshCache::FCookedModel::DecodeIndexStreams(const std::string& CookedFilePath)
+{
+	SCOPED_CPU_MARKER("MeshCache::DecodeIndexStreams");
+	const FCookedModelHeader& Header = GetHeader();
+	mDecodedIndexOffsets.assign(Header.NumLODs, 0);
+
+	uint64 NumDecodedBytes = 0;
+	for (uint32 iLOD = 0; iLOD < Header.NumLODs; ++iLOD)
+	{
+		const FCookedMeshLOD& lod = GetLOD(iLOD);
+		if (lod.IndexCodec == COOKED_INDEX_CODEC_NONE)
+			continue;
+		mDecodedIndexOffsets[iLOD] = NumDecodedBytes;
+		NumDecodedBytes = AlignUp(NumDecodedBytes + static_cast<uint64>(lod.NumIndices) * lod.IndexStride, sizeof(uint32));
+	}
+	if (NumDecodedBytes == 0)
+		return true;
+
+	mDecodedIndices.resize(NumDecodedBytes);
+	for (uint32 iLOD = 0; iLOD < Header.NumLODs; ++iLOD)
+	{
+		const FCookedMeshLOD& lod = GetLOD(iLOD);
+		if (lod.IndexCodec == COOKED_INDEX_CODEC_NONE)
+			continue;
+		if (!IndexCompression::DecodeIndexBuffer(mFile.GetDataAt<uint8>(lod.IndexDataOffset), lod.IndexDataSize
+			, mDecodedIndices.data() + mDecodedIndexOffsets[iLOD], lod.NumIndices, lod.IndexStride, lod.NumVertices))
+		{
+			Log::Warning("MeshCache: %s is corrupt (index stream of LOD %u)", CookedFilePath.c_str(), iLOD);
+			return false;
+		}
+	}
+	return true;
+}
+
+std::vector<Mesh::FLODView> MeshCache::FCookedModel::GetMeshLODViews(uint32 iMesh) const
+{
+	const FCookedMesh& mesh = GetMesh(iMesh);
+	std::vector<Mesh::FLODView> LODs(mesh.NumLODs);
+	for (uint32 i = 0; i < mesh.NumLODs; ++i)
+	{
+		const FCookedMeshLOD& lod = GetLOD(mesh.FirstLOD + i);
+		LODs[i].pVertices    = mFile.GetDataAt<char>(lod.VertexDataOffset);
+		LODs[i].pIndices     = lod.IndexCodec == COOKED_INDEX_CODEC_NONE
+			? mFile.GetDataAt<char>(lod.IndexDataOffset)
+			: mDecodedIndices.data() + mDecodedIndexOffsets[mesh.FirstLOD + i];
+		LODs[i].NumVertices  = lod.NumVertices;
+		LODs[i].NumIndices   = lod.NumIndices;
+		LODs[i].VertexStride = lod.VertexStride;
+		LODs[i].IndexStride  = lod.IndexStride;
+		LODs[i].Error        = lod.Error;
+		LODs[i].pMeshlets    = mFile.GetDataAt<FMeshlet>(lod.MeshletDataOffset);
+		LODs[i].NumMeshlets  = lod.NumMeshlets;
+	}
+	return LODs;
+}
+
+FBoundingBox MeshCache::FCookedModel::GetMeshBoundingBox(uint32 iMesh) const
+{
+	const FCookedMesh& mesh = GetMesh(iMesh);
+	FBoundingBox bb;
+	bb.ExtentMin = DirectX::XMFLOAT3(mesh.BoundsMin[0], mesh.BoundsMin[1], mesh.BoundsMin[2]);
+	bb.ExtentMax = DirectX::XMFLOAT3(mesh.BoundsMax[0], mesh.BoundsMax[1], mesh.BoundsMax[2]);
+	return bb;
+}
+
+DirectX::XMFLOAT4 MeshCache::FCookedModel::GetMeshUVScaleBias(uint32 iMesh) const
+{
+	const FCookedMesh& mesh = GetMesh(iMesh);
+	return DirectX::XMFLOAT4(mesh.UVScaleBias[0], mesh.UVScaleBias[1], mesh.UVScaleBias[2], mesh.UVScaleBias[3]);
+}
@@ -0,0 +1,216 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+#pragma once
+
+#include "Core/Types.h"
+#include "Core/MappedFile.h"
+#include "Scene/Mesh.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+
+// Set to 0 to always import models from source
+#define MESH_CACHE_ENABLED 1
+// Set to 0 to store the index streams uncompressed, see IndexCompression.h for the codec
+#define MESH_CACHE_COMPRESS_INDICES 1
+
+//
+// MESH CACHE
+//
+// Cooked binary representation of an imported model: the final vertex & index
+// streams of every mesh LOD (after winding flip, tangent generation etc.), the
+// local space bounds and the material bindings. The file is written on the first
+// import of a model and memory-mapped on the next loads: the streams are handed
+// to the buffer creation as-is, skipping the source parsing & processing entirely.
+//
+// A cooked file is used only if its source hash and importer version match,
+// otherwise the model is re-imported and the file is overwritten. The source is
+// hashed only when its stamp (size & write time of the model & buffer files) differs
+// from the one the file was cooked with, similar to VQCook's manifest: a warm load
+// doesn't read the source file.
+//
+// Index streams can be compressed (ECookedIndexCodec): those are decoded once when the
+// file is opened and the views point to the decoded indices instead of the mapped file.
+//
+// File layout, offsets are from the beginning of the file:
+//
+//   FCookedModelHeader
+//   FCookedMesh     [NumMeshes]
+//   FCookedMeshLOD  [NumLODs]
+//   FCookedMaterial [NumMaterials]
+//   FCookedTexture  [NumTextures]
+//   char            [StringTableSize]  null-terminated strings
+//   vertex, index & meshlet streams, each 16-byte aligned
+//
+namespace MeshCache
+{
+	constexpr uint32 COOKED_MODEL_MAGIC          = 0x434D5156; // "VQMC"
+	constexpr uint32 COOKED_MODEL_FORMAT_VERSION = 6;          // bump when the layout below changes
+
+	struct FCookedModelHeader
+	{
+		uint32 Magic;
+		uint32 FormatVersion;
+		uint32 ImporterVersion;
+		uint32 NumMeshes;
+		uint64 SourceHash;
+		uint64 SourceStamp; // ComputeSourceStamp()
+		uint64 FileSize;
+		uint32 NumLODs;
+		uint32 NumMaterials;
+		uint32 NumTextures;
+		uint32 StringTableSize;
+		uint64 OffsetMeshes;
+		uint64 OffsetLODs;
+		uint64 OffsetMaterials;
+		uint64 OffsetTextures;
+		uint64 OffsetStrings;
+	};
+	struct FCookedMesh
+	{
+		uint32 NameOffset;    // into the string table
+		int32  MaterialIndex; // -1: no material
+		uint32 FirstLOD;
+		uint32 NumLODs;
+		float  BoundsMin[3];
+		float  BoundsMax[3];
+		uint32 VertexFormat;   // EVertexBufferType
+		float  UVScaleBias[4]; // Mesh::GetUVScaleBias()
+		uint32 Reserved;
+	};
+	enum ECookedIndexCodec : uint32
+	{
+		COOKED_INDEX_CODEC_NONE = 0,
+		COOKED_INDEX_CODEC_FIFO_VARINT, // IndexCompression::EncodeIndexBuffer()
+
+		NUM_COOKED_INDEX_CODECS
+	};
+	struct FCookedMeshLOD
+	{
+		uint64 VertexDataOffset;
+		uint64 IndexDataOffset;
+		uint64 MeshletDataOffset; // FMeshlet[NumMeshlets]
+		uint32 NumVertices;
+		uint32 NumIndices;
+		uint32 VertexStride;
+		uint32 IndexStride;   // of the decoded indices
+		float  Error;         // Mesh::FLODView::Error
+		uint32 NumMeshlets;
+		uint32 IndexCodec;    // ECookedIndexCodec
+		uint32 IndexDataSize; // bytes in the file
+	};
+	enum ECookedMaterialFlags : uint32
+	{
+		COOKED_MATERIAL_HAS_PBR_PARAMS = 1 << 0,
+		COOKED_MATERIAL_HAS_EMISSIVE   = 1 << 1,
+	};
+	struct FCookedMaterial
+	{
+		uint32 NameOffset;
+		uint32 Flags; // ECookedMaterialFlags
+		float  Diffuse[3];
+		float  Alpha;
+		float  Metalness;
+		float  Roughness;
+		float  EmissiveIntensity;
+		uint32 FirstTexture;
+		uint32 NumTextures;
+	};
+	struct FCookedTexture
+	{
+		uint32 PathOffset;  // path relative to the model directory
+		uint32 TextureType; // AssetLoader::ETextureType
+	};
+	static_assert(sizeof(FCookedModelHeader) == 96, "cooked file layout changed, bump COOKED_MODEL_FORMAT_VERSION");
+	static_assert(sizeof(FCookedMesh)        == 64, "cooked file layout changed, bump COOKED_MODEL_FORMAT_VERSION");
+	static_assert(sizeof(FCookedMeshLOD)     == 56, "cooked file layout changed, bump COOKED_MODEL_FORMAT_VERSION");
+	static_assert(sizeof(FCookedMaterial)    == 44, "cooked file layout changed, bump COOKED_MODEL_FORMAT_VERSION");
+	static_assert(sizeof(FCookedTexture)     == 8 , "cooked file layout changed, bump COOKED_MODEL_FORMAT_VERSION");
+
+	// input for writing a cooked model
+	struct FCookedModelDesc
+	{
+		struct FMesh
+		{
+			std::string                 Name;
+			int                         MaterialIndex = -1;
+			FBoundingBox                LocalSpaceBoundingBox;
+			EVertexBufferType           VertexFormat = NORMAL_AND_TANGENT;
+			DirectX::XMFLOAT4           UVScaleBias = DirectX::XMFLOAT4(1.0f, 1.0f, 0.0f, 0.0f);
+			std::vector<Mesh::FLODView> LODs;
+		};
+		struct FMaterial
+		{
+			std::string Name;
+			uint32 Flags = 0;
+			float Diffuse[3] = { 1.0f, 1.0f, 1.0f };
+			float Alpha = 1.0f;
+			float Metalness = 0.0f;
+			float Roughness = 0.8f;
+			float EmissiveIntensity = 0.0f;
+			std::vector<std::pair<uint32, std::string>> Textures; // <TextureType, RelativePath>
+		};
+		std::vector<FMesh>     Meshes;
+		std::vector<FMaterial> Materials;
+	};
+
+	// Read-only view over a memory-mapped cooked model file
+	class FCookedModel
+	{
+	public:
+		// returns nullptr if the file doesn't exist, is corrupt or is stale w.r.t. the model file & importer version.
+		// The model file is hashed only if SourceStamp doesn't match the cooked one.
+		static std::shared_ptr<FCookedModel> Open(const std::string& CookedFilePath, const std::string& ModelFilePath, uint64 SourceStamp, uint32 ImporterVersion);
+
+		inline const FCookedModelHeader& GetHeader() const { return *mFile.GetDataAt<FCookedModelHeader>(0); }
+		inline const FCookedMesh&        GetMesh(uint32 i)     const { return mFile.GetDataAt<FCookedMesh>    (GetHeader().OffsetMeshes)[i]; }
+		inline const FCookedMeshLOD&     GetLOD(uint32 i)      const { return mFile.GetDataAt<FCookedMeshLOD> (GetHeader().OffsetLODs)[i]; }
+		inline const FCookedMaterial&    GetMaterial(uint32 i) const { return mFile.GetDataAt<FCookedMaterial>(GetHeader().OffsetMaterials)[i]; }
+		inline const FCookedTexture&     GetTexture(uint32 i)  const { return mFile.GetDataAt<FCookedTexture> (GetHeader().OffsetTextures)[i]; }
+		inline const char*               GetString(uint32 Offset) const { return mFile.GetDataAt<char>(GetHeader().OffsetStrings + Offset); }
+
+		inline size_t               Prefetch() const { return mFile.Prefetch(); } // see FMappedFile::Prefetch()
+		inline uint64               GetSourceStamp() const { return mSourceStamp; } // the source stamp the file was validated against
+
+		std::vector<Mesh::FLODView> GetMeshLODViews(uint32 iMesh) const; // points into the mapped file & the decoded indices
+		FBoundingBox                GetMeshBoundingBox(uint32 iMesh) const;
+		DirectX::XMFLOAT4           GetMeshUVScaleBias(uint32 iMesh) const;
+		inline EVertexBufferType    GetMeshVertexFormat(uint32 iMesh) const { return static_cast<EVertexBufferType>(GetMesh(iMesh).VertexFormat); }
+
+	private:
+		bool Validate(const std::string& CookedFilePath) const;
+		bool DecodeIndexStreams(const std::string& CookedFilePath);
+		FMappedFile mFile;
+		uint64              mSourceStamp = 0;
+		std::vector<char>   mDecodedIndices;       // compressed index streams, decoded
+		std::vector<uint64> mDecodedIndexOffsets;  // [NumLODs], into mDecodedIndices
+	};
+
+	// Cache/Meshes/<ModelFileName>_<PathHash>.vqmesh
+	std::string GetCookedFilePath(const std::string& ModelFilePath);
+
+	// Hashes the model file contents & the size/write time of the buffer files (.bin) next to it:
+	// the .gltf JSON references the buffers by URI, hence they're expected in the same directory.
+	uint64 ComputeSourceHash(const std::string& ModelFilePath);
+
+	// Hashes the size/write time of the model & buffer files w/o reading them, 0 if the model file doesn't exist
+	uint64 ComputeSourceStamp(const std::string& ModelFilePath);
+
+	bool WriteCookedModel(const std::string& CookedFilePath, uint64 SourceHash, uint64 SourceStamp, uint32 ImporterVersion, const FCookedModelDesc& Desc);
+}
@@ -25,5 +25,6 @@ class GameObject
 {
 public:
 	ModelID      mModelID     = INVALID_ID;
+	size_t       mTransformHandle = INVALID_HANDLE; // into Scene::mGameObjectTransformPool, see Scene::GetGameObjectTransform()
 	FBoundingBox mLocalSpaceBoundingBox;
 };
@@ -0,0 +1,166 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+
+#include "IndexCompression.h"
+
+#include "Engine/GPUMarker.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace IndexCompression
+{
+	constexpr uint32 FIFO_SIZE = 16;
+	constexpr uint32 CODE_NEW_VERTEX = 0;
+	constexpr uint64 CODE_DELTA_BASE = FIFO_SIZE + 1;
+	constexpr size_t MAX_VARINT_BYTES = 10; // 64 bits in 7 bit groups
+
+	// encoder & decoder update the state identically
+	struct FCodecState
+	{
+		uint32 Fifo[FIFO_SIZE] = {};
+		uint32 iFifoHead = 0; // next slot to write
+		uint32 NumFifo = 0;
+		uint64 Next = 0;      // max index so far + 1
+		uint32 Prev = 0;
+
+		inline uint32 GetFifo(uint32 Code) const { return Fifo[(iFifoHead + FIFO_SIZE - Code) % FIFO_SIZE]; } // Code in [1, NumFifo]
+		inline void Update(uint32 Index, bool bFifoHit)
+		{
+			if (!bFifoHit)
+			{
+				Fifo[iFifoHead] = Index;
+				iFifoHead = (iFifoHead + 1) % FIFO_SIZE;
+				NumFifo = std::min(NumFifo + 1, FIFO_SIZE);
+			}
+			Next = std::max<uint64>(Next, static_cast<uint64>(Index) + 1);
+			Prev = Index;
+		}
+	};
+
+	static inline uint64 ZigZag(int64 v) { return (static_cast<uint64>(v) << 1) ^ static_cast<uint64>(v >> 63); }
+	static inline int64 UnZigZag(uint64 v) { return static_cast<int64>(v >> 1) ^ -static_cast<int64>(v & 1); }
+
+	static inline void WriteVarint(std::vector<uint8>& Out, uint64 v)
+	{
+		while (v >= 0x80)
+		{
+			Out.push_back(static_cast<uint8>(v | 0x80));
+			v >>= 7;
+		}
+		Out.push_back(static_cast<uint8>(v));
+	}
+	static inline bool ReadVarint(const uint8*& p, const uint8* pEnd, uint64& v)
+	{
+		v = 0;
+		for (size_t i = 0; i < MAX_VARINT_BYTES && p != pEnd; ++i)
+		{
+			const uint8 Byte = *p++;
+			v |= static_cast<uint64>(Byte & 0x7F) << (7 * i);
+			if ((Byte & 0x80) == 0)
+				return true;
+		}
+		return false;
+	}
+
+	static inline uint32 ReadIndex(const void* pIndices, size_t i, size_t IndexStride)
+	{
+		return IndexStride == sizeof(uint16) ? static_cast<const uint16*>(pIndices)[i] : static_cast<const uint32*>(pIndices)[i];
+	}
+
+	void NarrowIndices(const uint32* pIndices, size_t NumIndices, uint16* pOut)
+	{
+		for (size_t i = 0; i < NumIndices; ++i)
+		{
+			assert(pIndices[i] < MAX_VERTICES_16BIT_INDICES);
+			pOut[i] = static_cast<uint16>(pIndices[i]);
+		}
+	}
+
+	std::vector<uint8> EncodeIndexBuffer(const void* pIndices, size_t NumIndices, size_t IndexStride)
+	{
+		SCOPED_CPU_MARKER("IndexCompression::Encode");
+		assert(IndexStride == sizeof(uint16) || IndexStride == sizeof(uint32));
+		std::vector<uint8> Encoded;
+		Encoded.reserve(NumIndices + NumIndices / 4);
+
+		FCodecState s;
+		for (size_t i = 0; i < NumIndices; ++i)
+		{
+			const uint32 Index = ReadIndex(pIndices, i, IndexStride);
+			bool bFifoHit = false;
+			uint64 Code = CODE_NEW_VERTEX;
+			if (Index != s.Next)
+			{
+				for (uint32 c = 1; c <= s.NumFifo && !bFifoHit; ++c)
+				{
+					bFifoHit = s.GetFifo(c) == Index;
+					Code = c;
+				}
+				if (!bFifoHit)
+					Code = CODE_DELTA_BASE + ZigZag(static_cast<int64>(Index) - static_cast<int64>(s.Prev));
+			}
+			WriteVarint(Encoded, Code);
+			s.Update(Index, bFifoHit);
+		}
+		return Encoded;
+	}
+
+	bool DecodeIndexBuffer(const uint8* pEncoded, size_t NumEncodedBytes, void* pIndices, size_t NumIndices, size_t IndexStride, size_t NumVertices)
+	{
+		SCOPED_CPU_MARKER("IndexCompression::Decode");
+		assert(IndexStride == sizeof(uint16) || IndexStride == sizeof(uint32));
+		const uint8* p = pEncoded;
+		const uint8* pEnd = pEncoded + NumEncodedBytes;
+		uint16* pOut16 = static_cast<uint16*>(pIndices);
+		uint32* pOut32 = static_cast<uint32*>(pIndices);
+
+		FCodecState s;
+		for (size_t i = 0; i < NumIndices; ++i)
+		{
+			uint64 Code;
+			if (!ReadVarint(p, pEnd, Code))
+				return false;
+
+			const bool bFifoHit = Code != CODE_NEW_VERTEX && Code < CODE_DELTA_BASE;
+			int64 Index;
+			if (Code == CODE_NEW_VERTEX)
+			{
+				Index = static_cast<int64>(s.Next);
+			}
+			else if (bFifoHit)
+			{
+				if (Code > s.NumFifo)
+					return false;
+				Index = s.GetFifo(static_cast<uint32>(Code));
+			}
+			else
+			{
+				Index = static_cast<int64>(s.Prev) + UnZigZag(Code - CODE_DELTA_BASE);
+			}
+
+			if (Index < 0 || static_cast<uint64>(Index) >= NumVertices)
+				return false;
+
+			if (IndexStride == sizeof(uint16)) pOut16[i] = static_cast<uint16>(Index);
+			else                               pOut32[i] = static_cast<uint32>(Index);
+			s.Update(static_cast<uint32>(Index), bFifoHit);
+		}
+		return p == pEnd;
+	}
+}
@@ -0,0 +1,52 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+#pragma once
+
+#include "../Core/Types.h"
+
+#include <vector>
+
+//
+// INDEX COMPRESSION
+//
+// 16-bit indices: a LOD with up to 65536 vertices is stored & drawn with 16-bit indices,
+// regardless of the index type it was built with (see the Mesh constructor).
+//
+// Index codec: a byte-oriented encoding of triangle list indices for the mesh cache, one
+// LEB128 varint code per index against a small FIFO of the recently seen vertices:
+//
+//   code 0                 : next new vertex (max index so far + 1)
+//   code [1, FIFO_SIZE]    : FIFO entry, 1 is the most recently added
+//   code > FIFO_SIZE       : zigzag delta from the previous index, + FIFO_SIZE + 1
+//
+// The geometry is optimized for the vertex cache & fetch order at import, so most codes are
+// new vertices or FIFO hits and take a single byte. Decoding is a single pass without tables.
+//
+namespace IndexCompression
+{
+	constexpr size_t MAX_VERTICES_16BIT_INDICES = 65536;
+	inline bool Fits16BitIndices(size_t NumVertices) { return NumVertices <= MAX_VERTICES_16BIT_INDICES; }
+
+	void NarrowIndices(const uint32* pIndices, size_t NumIndices, uint16* pOut);
+
+	// IndexStride is 2 or 4 bytes
+	std::vector<uint8> EncodeIndexBuffer(const void* pIndices, size_t NumIndices, size_t IndexStride);
+
+	// returns false if the encoded data is truncated, malformed or references vertices outside [0, NumVertices)
+	bool DecodeIndexBuffer(const uint8* pEncoded, size_t NumEncodedBytes, void* pIndices, size_t NumIndices, size_t IndexStride, size_t NumVertices);
+}
@@ -17,6 +17,7 @@
 //	Contact: volkanilbeyli@gmail.com
 
 #include "Mesh.h"
+#include "../Core/Hash.h"
 
 #include "Renderer/Renderer.h"
 #include <cassert>
@@ -60,35 +61,156 @@ BufferID Mesh::CreateBuffer(VQRenderer* pRenderer, const FBufferDesc& desc)
 	return pRenderer->CreateBuffer(desc); 
 }
 
-void Mesh::CreateBuffers(VQRenderer* pRenderer)
+Mesh::Mesh(const std::vector<FLODView>& LODs, const FBoundingBox& LocalSpaceBoundingBox, EVertexBufferType VertexFormat, const DirectX::XMFLOAT4& UVScaleBias, std::shared_ptr<const void> pStorage, const std::string& name)
+	: mLocalSpaceBoundingBox(LocalSpaceBoundingBox)
+	, mVertexFormat(VertexFormat)
+	, mUVScaleBias(UVScaleBias)
+{
+	mGeometryData.Name = name;
+	mGeometryData.ExternalLODs = LODs;
+	mGeometryData.pExternalStorage = std::move(pStorage);
+	bool bHasMeshlets = false;
+	for (const FLODView& LOD : LODs)
+	{
+		mLODErrors.push_back(LOD.Error);
+		bHasMeshlets = bHasMeshlets || LOD.NumMeshlets > 0;
+	}
+
+	// meshlets are used for culling after the geometry is uploaded: copy them out of the external storage
+	if (bHasMeshlets)
+	{
+		mLODMeshlets.resize(LODs.size());
+		for (size_t LOD = 0; LOD < LODs.size(); ++LOD)
+			mLODMeshlets[LOD].assign(LODs[LOD].pMeshlets, LODs[LOD].pMeshlets + LODs[LOD].NumMeshlets);
+	}
+}
+
+const std::vector<FMeshlet>& Mesh::GetMeshlets(int lod /*= 0*/) const
+{
+	static const std::vector<FMeshlet> NO_MESHLETS;
+	if (mLODMeshlets.empty())
+		return NO_MESHLETS;
+	return lod < mLODMeshlets.size() ? mLODMeshlets[lod] : mLODMeshlets.back(); // same fallback as GetIABufferIDs()
+}
+
+std::vector<Mesh::FLODView> Mesh::GetLODViews() const
+{
+	std::vector<FLODView> LODs = mGeometryData.ExternalLODs;
+	if (LODs.empty())
+	{
+		LODs.resize(mGeometryData.LODVertices.size());
+		for (size_t LOD = 0; LOD < LODs.size(); ++LOD)
+		{
+			FLODView& v = LODs[LOD];
+			v.pVertices    = mGeometryData.LODVertices[LOD].data();
+			v.pIndices     = mGeometryData.LODIndices[LOD].data();
+			v.VertexStride = mGeometryData.VertexStrides[LOD];
+			v.IndexStride  = mGeometryData.IndexStrides[LOD];
+			v.NumVertices  = static_cast<uint>(mGeometryData.LODVertices[LOD].size() / v.VertexStride);
+			v.NumIndices   = mGeometryData.NumIndices[LOD];
+			v.Error        = LOD < mLODErrors.size() ? mLODErrors[LOD] : 0.0f;
+		}
+	}
+	for (size_t LOD = 0; LOD < LODs.size(); ++LOD)
+	{
+		LODs[LOD].pMeshlets   = LOD < mLODMeshlets.size() ? mLODMeshlets[LOD].data() : nullptr;
+		LODs[LOD].NumMeshlets = LOD < mLODMeshlets.size() ? static_cast<uint>(mLODMeshlets[LOD].size()) : 0;
+	}
+	return LODs;
+}
+
+uint64 Mesh::ComputeGeometryHash() const
+{
+	const std::vector<FLODView> LODs = GetLODViews();
+	if (LODs.empty())
+		return 0;
+
+	uint64 h = Hash::HashBytes(&mVertexFormat, sizeof(mVertexFormat));
+	h = Hash::HashBytes(&mUVScaleBias, sizeof(mUVScaleBias), h);
+	for (const FLODView& LOD : LODs)
+	{
+		const uint32 Sizes[5] = { LOD.NumVertices, LOD.NumIndices, LOD.VertexStride, LOD.IndexStride, LOD.NumMeshlets };
+		h = Hash::HashBytes(Sizes, sizeof(Sizes), h);
+		h = Hash::HashBytes(&LOD.Error, sizeof(LOD.Error), h);
+		h = Hash::HashBytes(LOD.pVertices, static_cast<size_t>(LOD.NumVertices) * LOD.VertexStride, h);
+		h = Hash::HashBytes(LOD.pIndices, static_cast<size_t>(LOD.NumIndices) * LOD.IndexStride, h);
+		h = Hash::HashBytes(LOD.pMeshlets, LOD.NumMeshlets * sizeof(FMeshlet), h);
+	}
+	return h;
+}
+
+bool Mesh::HasSameGeometry(const Mesh& Other) const
+{
+	const std::vector<FLODView> LODs = GetLODViews();
+	const std::vector<FLODView> OtherLODs = Other.GetLODViews();
+	if (LODs.empty() || LODs.size() != OtherLODs.size())
+		return false;
+	if (mVertexFormat != Other.mVertexFormat || memcmp(&mUVScaleBias, &Other.mUVScaleBias, sizeof(mUVScaleBias)) != 0)
+		return false;
+
+	for (size_t LOD = 0; LOD < LODs.size(); ++LOD)
+	{
+		const FLODView& a = LODs[LOD];
+		const FLODView& b = OtherLODs[LOD];
+		if (a.NumVertices != b.NumVertices || a.NumIndices != b.NumIndices || a.VertexStride != b.VertexStride
+			|| a.IndexStride != b.IndexStride || a.NumMeshlets != b.NumMeshlets || memcmp(&a.Error, &b.Error, sizeof(a.Error)) != 0)
+			return false;
+		if (memcmp(a.pVertices, b.pVertices, static_cast<size_t>(a.NumVertices) * a.VertexStride) != 0
+			|| memcmp(a.pIndices, b.pIndices, static_cast<size_t>(a.NumIndices) * a.IndexStride) != 0)
+			return false;
+		if (a.NumMeshlets > 0 && memcmp(a.pMeshlets, b.pMeshlets, a.NumMeshlets * sizeof(FMeshlet)) != 0)
+			return false;
+	}
+	return true;
+}
+
+uint64 Mesh::GetGeometrySize() const
+{
+	uint64 Size = 0;
+	for (const FLODView& LOD : GetLODViews())
+		Size += static_cast<uint64>(LOD.NumVertices) * LOD.VertexStride + static_cast<uint64>(LOD.NumIndices) * LOD.IndexStride;
+	return Size;
+}
+
+void Mesh::CreateBuffers(VQRenderer* pRenderer, bool bReleaseGeometry)
 {
 	if (!this->mLODBufferPairs.empty() || !mGeometryData.IsValid())
 		return;
 
-	for (size_t LOD = 0; LOD < mGeometryData.LODVertices.size(); ++LOD)
+	const std::vector<FLODView> LODs = GetLODViews();
+	for (size_t LOD = 0; LOD < LODs.size(); ++LOD)
 	{
 		FBufferDesc bufferDesc = {};
 		char VBName[128]; _snprintf_s(VBName, sizeof(VBName), "%s_LOD[%zu]_VB", mGeometryData.Name.c_str(), LOD);
 		char IBName[128]; _snprintf_s(IBName, sizeof(IBName), "%s_LOD[%zu]_IB", mGeometryData.Name.c_str(), LOD);
 
 		bufferDesc.Type = VERTEX_BUFFER;
-		bufferDesc.NumElements = static_cast<unsigned>(mGeometryData.LODVertices[LOD].size() / mGeometryData.VertexStrides[LOD]);
-		bufferDesc.pData = mGeometryData.LODVertices[LOD].data();
-		bufferDesc.Stride = mGeometryData.VertexStrides[LOD];
+		bufferDesc.NumElements = LODs[LOD].NumVertices;
+		bufferDesc.pData = LODs[LOD].pVertices;
+		bufferDesc.Stride = LODs[LOD].VertexStride;
 		bufferDesc.Name = VBName;
 		BufferID vertexBufferID = CreateBuffer(pRenderer, bufferDesc);
 
 		bufferDesc.Type = INDEX_BUFFER;
-		bufferDesc.NumElements = mGeometryData.NumIndices[LOD];
-		bufferDesc.pData = mGeometryData.LODIndices[LOD].data();
-		bufferDesc.Stride = mGeometryData.IndexStrides[LOD];
+		bufferDesc.NumElements = LODs[LOD].NumIndices;
+		bufferDesc.pData = LODs[LOD].pIndices;
+		bufferDesc.Stride = LODs[LOD].IndexStride;
 		bufferDesc.Name = IBName;
 		BufferID indexBufferID = CreateBuffer(pRenderer, bufferDesc);
 
 		mLODBufferPairs.push_back({ vertexBufferID, indexBufferID });
 		mNumIndicesPerLODLevel.push_back(bufferDesc.NumElements);
+		mIndexBufferBytes += static_cast<uint64>(bufferDesc.NumElements) * bufferDesc.Stride;
 	}
 
-	// Clear geometry data
+	if (bReleaseGeometry)
+	{
+		ReleaseGeometry();
+	}
+}
+
+void Mesh::ReleaseGeometry()
+{
+	// Clear geometry data, releases the external storage reference too
 	mGeometryData = GeometryDataStorage();
 }
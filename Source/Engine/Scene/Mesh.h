@@ -18,12 +18,15 @@
 #pragma once
 
 #include "../Core/Types.h"
+#include "../Core/MemoryTracking.h"
 #include "../CullingData.h"
 #include "MeshGeometryData.h"
+#include "IndexCompression.h"
 #include "Renderer/Resources/Buffer.h"
 
 #include <limits>
 #include <cstdio>
+#include <memory>
 
 struct FBufferDesc;
 class VQRenderer;
@@ -81,24 +84,74 @@ struct Mesh
 public:
 	static EBuiltInMeshes GetBuiltInMeshType(const std::string& MeshTypeStr);
 
+	// non-owning view of a LOD's vertex & index streams
+	struct FLODView
+	{
+		const void* pVertices = nullptr;
+		const void* pIndices = nullptr;
+		uint NumVertices = 0;
+		uint NumIndices = 0;
+		uint VertexStride = 0;
+		uint IndexStride = 0;
+		float Error = 0.0f; // simplification error w.r.t. LOD0, relative to the mesh extents
+		const FMeshlet* pMeshlets = nullptr;
+		uint NumMeshlets = 0;
+	};
+
 	// init
 	template<class TVertex, class TIndex>
 	Mesh(VQRenderer* pRenderer, GeometryData<TVertex, TIndex>&& meshLODData, const std::string& name);
+	// init from geometry in external memory (e.g. a memory-mapped cooked mesh file): nothing is copied,
+	// pStorage keeps the memory alive until the buffers are created.
+	Mesh(const std::vector<FLODView>& LODs, const FBoundingBox& LocalSpaceBoundingBox, EVertexBufferType VertexFormat, const DirectX::XMFLOAT4& UVScaleBias, std::shared_ptr<const void> pStorage, const std::string& name);
 	Mesh() = default;
 
-	// Creates GPU buffers, needs renderer heaps initialized (used for deferred initialization)
-	void CreateBuffers(VQRenderer* pRenderer);
+	// Creates GPU buffers, needs renderer heaps initialized (used for deferred initialization).
+	// The CPU-side geometry is released unless bReleaseGeometry is false, see ReleaseGeometry().
+	void CreateBuffers(VQRenderer* pRenderer, bool bReleaseGeometry = true);
+	void ReleaseGeometry();
 
 	// getters
 	std::pair<BufferID, BufferID> GetIABufferIDs(int lod = 0) const;
 	inline uint GetNumIndices(int lod = 0) const { assert(mNumIndicesPerLODLevel.size()>lod); return mNumIndicesPerLODLevel[lod]; }
 	inline uint GetNumLODs() const { return static_cast<uint>(mLODBufferPairs.size()); }
+	// GPU index memory of all LODs, known after CreateBuffers()
+	inline uint64 GetIndexBufferBytes() const { return mIndexBufferBytes; }
+	// simplification errors are only known for generated LOD chains (see MeshSimplifier)
+	inline bool  HasLODErrors() const { return !mLODErrors.empty(); }
+	inline float GetLODError(int lod) const { assert(mLODErrors.size() > lod); return mLODErrors[lod]; }
 	const FBoundingBox GetLocalSpaceBoundingBox() const { return mLocalSpaceBoundingBox; }
+	inline EVertexBufferType GetVertexFormat() const { return mVertexFormat; }
+	inline const DirectX::XMFLOAT4& GetUVScaleBias() const { return mUVScaleBias; }
+	// meshlets are only built for the large LODs of imported meshes (see MeshletBuilder), empty otherwise
+	const std::vector<FMeshlet>& GetMeshlets(int lod = 0) const;
+	// applies the material's uv tiling & bias on top of the vertex uv remap (see VertexQuantization)
+	static inline DirectX::XMFLOAT4 ComposeUVScaleBias(const DirectX::XMFLOAT4& MeshUVScaleBias, const DirectX::XMFLOAT2& MaterialTiling, const DirectX::XMFLOAT2& MaterialBias)
+	{
+		return DirectX::XMFLOAT4(
+			MeshUVScaleBias.x * MaterialTiling.x,
+			MeshUVScaleBias.y * MaterialTiling.y,
+			MeshUVScaleBias.z * MaterialTiling.x + MaterialBias.x,
+			MeshUVScaleBias.w * MaterialTiling.y + MaterialBias.y
+		);
+	}
+	// CPU-side geometry, empty once released
+	std::vector<FLODView> GetLODViews() const;
+	// content hash of the CPU-side geometry (all LODs' streams, meshlets & vertex format), 0 once released
+	uint64 ComputeGeometryHash() const;
+	// byte-wise comparison of the CPU-side geometry & LOD layout, false if either one's geometry is released
+	bool HasSameGeometry(const Mesh& Other) const;
+	uint64 GetGeometrySize() const; // bytes of the CPU-side vertex & index streams
 	
 private:
 	std::vector<VertexIndexBufferIDPair> mLODBufferPairs;
 	std::vector<uint> mNumIndicesPerLODLevel;
+	uint64 mIndexBufferBytes = 0;
+	std::vector<float> mLODErrors; // empty if unknown
 	FBoundingBox mLocalSpaceBoundingBox;
+	EVertexBufferType mVertexFormat = DEFAULT;
+	DirectX::XMFLOAT4 mUVScaleBias = DirectX::XMFLOAT4(1.0f, 1.0f, 0.0f, 0.0f); // uv = uv_vertex * scale + bias
+	std::vector<std::vector<FMeshlet>> mLODMeshlets; // empty if none of the LODs have meshlets
 
 	struct GeometryDataStorage
 	{
@@ -108,7 +161,13 @@ private:
 		std::vector<uint> IndexStrides;
 		std::vector<unsigned> NumIndices;
 		std::string Name;
-		bool IsValid() const { return !LODVertices.empty(); }
+		MEMORY_TRACKED_BYTES(GEOMETRY, TrackedBytes);
+
+		// external geometry, used instead of LODVertices/LODIndices when pExternalStorage is set
+		std::vector<FLODView> ExternalLODs;
+		std::shared_ptr<const void> pExternalStorage;
+
+		bool IsValid() const { return !LODVertices.empty() || !ExternalLODs.empty(); }
 	};
 	GeometryDataStorage mGeometryData; // temporary, until uploaded to GPU
 
@@ -131,28 +190,56 @@ Mesh::Mesh(VQRenderer* pRenderer, GeometryData<TVertex, TIndex>&& meshLODData, c
 	//SCOPED_CPU_MARKER("Mesh::Mesh");
 
 	mGeometryData.Name = name;
+	mVertexFormat = GetVertexBufferType<TVertex>();
+	mUVScaleBias = DirectX::XMFLOAT4(meshLODData.UVScaleBias[0], meshLODData.UVScaleBias[1], meshLODData.UVScaleBias[2], meshLODData.UVScaleBias[3]);
 
 	// Move and serialize geometry data
+	size_t GeometryBytes = 0;
 	for (size_t LOD = 0; LOD < meshLODData.LODVertices.size(); ++LOD)
 	{
 		// Move vertex and index data
 		std::vector<TVertex> vertices = std::move(meshLODData.LODVertices[LOD]);
 		std::vector<TIndex> indices = std::move(meshLODData.LODIndices[LOD]);
 
-		// Serialize
+		// Serialize, 32-bit indices are narrowed to 16-bit where the LOD's vertex count allows
 		std::vector<char> vertexData(reinterpret_cast<char*>(vertices.data()), reinterpret_cast<char*>(vertices.data() + vertices.size()));
-		std::vector<char>  indexData(reinterpret_cast<char*>( indices.data()), reinterpret_cast<char*>( indices.data()  + indices.size()));
+		std::vector<char>  indexData;
+		uint IndexStride = sizeof(TIndex);
+		if constexpr (sizeof(TIndex) == sizeof(uint32))
+		{
+			if (IndexCompression::Fits16BitIndices(vertices.size()))
+			{
+				IndexStride = sizeof(uint16);
+				indexData.resize(indices.size() * sizeof(uint16));
+				IndexCompression::NarrowIndices(reinterpret_cast<const uint32*>(indices.data()), indices.size(), reinterpret_cast<uint16*>(indexData.data()));
+			}
+		}
+		if (indexData.empty())
+		{
+			indexData.assign(reinterpret_cast<char*>(indices.data()), reinterpret_cast<char*>(indices.data() + indices.size()));
+		}
 		mGeometryData.LODVertices.push_back(std::move(vertexData));
 		mGeometryData.LODIndices.push_back(std::move(indexData));
 		mGeometryData.VertexStrides.push_back(sizeof(TVertex));
-		mGeometryData.IndexStrides.push_back(sizeof(TIndex));
+		mGeometryData.IndexStrides.push_back(IndexStride);
 		mGeometryData.NumIndices.push_back(static_cast<unsigned>(indices.size()));
+		GeometryBytes += mGeometryData.LODVertices.back().size() + mGeometryData.LODIndices.back().size();
 
 		if (LOD == 0)
 		{
 			mLocalSpaceBoundingBox = CalculateBoundingBox(vertices);
 		}
 	}
+	MEMORY_TRACKED_BYTES_SET(mGeometryData.TrackedBytes, GeometryBytes);
+
+	if (meshLODData.LODErrors.size() == meshLODData.LODVertices.size())
+	{
+		mLODErrors = std::move(meshLODData.LODErrors);
+	}
+	if (meshLODData.LODMeshlets.size() == meshLODData.LODVertices.size())
+	{
+		mLODMeshlets = std::move(meshLODData.LODMeshlets);
+	}
 
 	if (pRenderer) // Create buffers if renderer is provided
 	{
@@ -19,12 +19,30 @@
 
 #include <vector>
 
+// A cluster of triangles that are contiguous in the index buffer of a mesh LOD, see MeshletBuilder
+struct FMeshlet
+{
+	unsigned       IndexOffset;  // first index of the meshlet in the LOD's index buffer
+	unsigned short NumIndices;
+	unsigned short NumVertices;  // unique vertices referenced by the meshlet
+	float          Center[3];    // bounding sphere, local space
+	float          Radius;
+	float          BoundsMin[3]; // bounding box, local space
+	float          BoundsMax[3];
+	float          ConeAxis[3];  // normal cone of the front faces
+	float          ConeCutoff;   // sin(cone half angle), 1: the cone is too wide for backface culling
+};
+static_assert(sizeof(FMeshlet) == 64, "FMeshlet is cooked as-is into the MeshCache");
+
 template<class TVertex, class TIndex = unsigned>
 struct GeometryData
 {
 	static_assert(std::is_same<TIndex, unsigned>() || std::is_same<TIndex, unsigned short>()); // ensure UINT32 or UINT16 indices
 	std::vector<std::vector<TVertex>>  LODVertices;
 	std::vector<std::vector<TIndex> >  LODIndices;
+	std::vector<float>                 LODErrors; // optional: simplification error per LOD, relative to the mesh extents
+	float                              UVScaleBias[4] = { 1.0f, 1.0f, 0.0f, 0.0f }; // uv = uv_vertex * scale + bias, see VertexQuantization
+	std::vector<std::vector<FMeshlet>> LODMeshlets; // optional: clusters of each LOD for culling, see MeshletBuilder
 	GeometryData(size_t NumLODs) : LODVertices(NumLODs), LODIndices(NumLODs) {}
 	GeometryData() = delete;
 };
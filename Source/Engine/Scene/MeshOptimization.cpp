@@ -0,0 +1,297 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+
+#include "MeshOptimization.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace
+{
+	constexpr uint32 NONE = ~0u;
+
+	// FIFO cache emulated with timestamps: a vertex is in the cache if it was
+	// inserted less than CacheSize insertions ago.
+	struct FFIFOCache
+	{
+		std::vector<uint32> InsertTime;
+		uint32 Timestamp;
+		uint32 Size;
+
+		FFIFOCache(size_t NumVertices, uint32 CacheSize) : InsertTime(NumVertices, 0), Timestamp(CacheSize + 1), Size(CacheSize) {}
+		inline bool Contains(uint32 v) const { return Timestamp - InsertTime[v] < Size; }
+		inline uint32 Access(uint32 v) // returns 1 on a miss
+		{
+			if (Contains(v))
+				return 0;
+			InsertTime[v] = ++Timestamp;
+			return 1;
+		}
+		inline uint32 AccessTriangle(const uint32* pTri) { return Access(pTri[0]) + Access(pTri[1]) + Access(pTri[2]); }
+		inline void Flush() { Timestamp += Size + 1; }
+	};
+
+	// vertex -> triangles
+	struct FVertexTriangles
+	{
+		std::vector<uint32> Offsets;
+		std::vector<uint32> Triangles;
+
+		FVertexTriangles(const std::vector<uint32>& Indices, size_t NumVertices)
+			: Offsets(NumVertices + 1, 0)
+			, Triangles(Indices.size())
+		{
+			for (uint32 i : Indices)
+				++Offsets[i + 1];
+			for (size_t v = 0; v < NumVertices; ++v)
+				Offsets[v + 1] += Offsets[v];
+			std::vector<uint32> Fill(Offsets.begin(), Offsets.end() - 1);
+			for (size_t i = 0; i < Indices.size(); ++i)
+				Triangles[Fill[Indices[i]]++] = static_cast<uint32>(i / 3);
+		}
+		inline uint32 Count(uint32 v) const { return Offsets[v + 1] - Offsets[v]; }
+	};
+
+	struct FVec3
+	{
+		double x = 0, y = 0, z = 0;
+	};
+}
+
+MeshOptimization::FVertexCacheStats MeshOptimization::AnalyzeVertexCache(const std::vector<uint32>& Indices, size_t NumVertices, uint32 CacheSize)
+{
+	FVertexCacheStats Stats;
+	Stats.NumTriangles = Indices.size() / 3;
+
+	FFIFOCache Cache(NumVertices, CacheSize);
+	std::vector<uint8> bReferenced(NumVertices, 0);
+	for (uint32 v : Indices)
+	{
+		Stats.NumCacheMisses += Cache.Access(v);
+		Stats.NumVertices += bReferenced[v] ? 0 : 1;
+		bReferenced[v] = 1;
+	}
+	return Stats;
+}
+
+// Tipsify: fans around a vertex, then moves to the neighbor vertex that is most
+// likely to still be in the cache once its remaining triangles are emitted.
+void MeshOptimization::OptimizeVertexCache(std::vector<uint32>& Indices, size_t NumVertices, uint32 CacheSize)
+{
+	const size_t NumTriangles = Indices.size() / 3;
+	if (NumTriangles < 2)
+		return;
+
+	const FVertexTriangles Adjacency(Indices, NumVertices);
+	std::vector<uint32> LiveTriangles(NumVertices);
+	for (uint32 v = 0; v < NumVertices; ++v)
+		LiveTriangles[v] = Adjacency.Count(v);
+
+	std::vector<uint32> CacheTime(NumVertices, 0);
+	std::vector<uint8>  bEmitted(NumTriangles, 0);
+	std::vector<uint32> DeadEnds; // recently referenced vertices, to resume from when the fan runs out
+	std::vector<uint32> Candidates;
+	std::vector<uint32> Output;
+	Output.reserve(Indices.size());
+	DeadEnds.reserve(Indices.size());
+
+	uint32 Timestamp = CacheSize + 1;
+	uint32 Cursor = 0; // next vertex to try when there are no dead-ends left
+	auto fnSkipDeadEnd = [&]() -> uint32
+	{
+		while (!DeadEnds.empty())
+		{
+			const uint32 v = DeadEnds.back();
+			DeadEnds.pop_back();
+			if (LiveTriangles[v] > 0)
+				return v;
+		}
+		for (; Cursor < NumVertices; ++Cursor)
+		{
+			if (LiveTriangles[Cursor] > 0)
+				return Cursor;
+		}
+		return NONE;
+	};
+
+	uint32 Fan = fnSkipDeadEnd();
+	while (Fan != NONE)
+	{
+		Candidates.clear();
+		for (uint32 i = Adjacency.Offsets[Fan]; i < Adjacency.Offsets[Fan + 1]; ++i)
+		{
+			const uint32 t = Adjacency.Triangles[i];
+			if (bEmitted[t])
+				continue;
+			bEmitted[t] = 1;
+			for (int k = 0; k < 3; ++k)
+			{
+				const uint32 v = Indices[t * 3 + k];
+				Output.push_back(v);
+				DeadEnds.push_back(v);
+				Candidates.push_back(v);
+				--LiveTriangles[v];
+				if (Timestamp - CacheTime[v] > CacheSize)
+					CacheTime[v] = Timestamp++;
+			}
+		}
+
+		// next fan: the candidate that stays in the cache after emitting its live triangles, the oldest one of those
+		uint32 Next = NONE;
+		int64 BestPriority = -1;
+		for (uint32 v : Candidates)
+		{
+			if (LiveTriangles[v] == 0)
+				continue;
+			int64 Priority = 0;
+			if (Timestamp - CacheTime[v] + 2 * LiveTriangles[v] <= CacheSize)
+				Priority = Timestamp - CacheTime[v];
+			if (Priority > BestPriority)
+			{
+				BestPriority = Priority;
+				Next = v;
+			}
+		}
+		Fan = Next != NONE ? Next : fnSkipDeadEnd();
+	}
+
+	Indices = std::move(Output);
+}
+
+void MeshOptimization::OptimizeOverdraw(std::vector<uint32>& Indices, const float* pPositions, size_t NumVertices, size_t PositionStride, float Threshold, uint32 CacheSize)
+{
+	const size_t NumTriangles = Indices.size() / 3;
+	if (NumTriangles < 2)
+		return;
+
+	// hard boundaries: the vertex cache order restarts where a triangle misses on all of its vertices
+	std::vector<uint32> HardClusters;
+	{
+		FFIFOCache Cache(NumVertices, CacheSize);
+		for (uint32 t = 0; t < NumTriangles; ++t)
+		{
+			if (Cache.AccessTriangle(&Indices[t * 3]) == 3)
+				HardClusters.push_back(t);
+		}
+		if (HardClusters.empty() || HardClusters[0] != 0)
+			HardClusters.insert(HardClusters.begin(), 0);
+	}
+
+	// soft boundaries: split the hard clusters further as long as the ACMR stays within the threshold
+	std::vector<uint32> Clusters;
+	{
+		FFIFOCache Cache(NumVertices, CacheSize);
+		for (size_t i = 0; i < HardClusters.size(); ++i)
+		{
+			const uint32 Begin = HardClusters[i];
+			const uint32 End = i + 1 < HardClusters.size() ? HardClusters[i + 1] : static_cast<uint32>(NumTriangles);
+
+			Cache.Flush();
+			size_t ClusterMisses = 0;
+			for (uint32 t = Begin; t < End; ++t)
+				ClusterMisses += Cache.AccessTriangle(&Indices[t * 3]);
+			const float MaxMissesPerTriangle = Threshold * float(ClusterMisses) / float(End - Begin);
+
+			Cache.Flush();
+			Clusters.push_back(Begin);
+			size_t RunningMisses = 0;
+			size_t RunningTriangles = 0;
+			for (uint32 t = Begin; t < End; ++t)
+			{
+				RunningMisses += Cache.AccessTriangle(&Indices[t * 3]);
+				++RunningTriangles;
+				if (t + 1 < End && RunningMisses <= MaxMissesPerTriangle * RunningTriangles)
+				{
+					Clusters.push_back(t + 1);
+					Cache.Flush();
+					RunningMisses = RunningTriangles = 0;
+				}
+			}
+		}
+	}
+
+	// sort the clusters by how much they face away from the mesh centroid: outer surfaces occlude inner ones
+	auto fnPosition = [&](uint32 v) -> const float* { return reinterpret_cast<const float*>(reinterpret_cast<const uint8*>(pPositions) + v * PositionStride); };
+	const size_t NumClusters = Clusters.size();
+	std::vector<FVec3> ClusterCentroids(NumClusters);
+	std::vector<FVec3> ClusterNormals(NumClusters);
+	std::vector<double> ClusterAreas(NumClusters, 0.0);
+	FVec3 MeshCentroid;
+	double MeshArea = 0.0;
+	for (size_t c = 0; c < NumClusters; ++c)
+	{
+		const uint32 End = c + 1 < NumClusters ? Clusters[c + 1] : static_cast<uint32>(NumTriangles);
+		for (uint32 t = Clusters[c]; t < End; ++t)
+		{
+			const float* p0 = fnPosition(Indices[t * 3 + 0]);
+			const float* p1 = fnPosition(Indices[t * 3 + 1]);
+			const float* p2 = fnPosition(Indices[t * 3 + 2]);
+			const double e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+			const double e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+			const FVec3 n = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+			const double Area = sqrt(n.x * n.x + n.y * n.y + n.z * n.z) * 0.5;
+
+			FVec3& Centroid = ClusterCentroids[c];
+			Centroid.x += Area * (p0[0] + p1[0] + p2[0]) / 3.0;
+			Centroid.y += Area * (p0[1] + p1[1] + p2[1]) / 3.0;
+			Centroid.z += Area * (p0[2] + p1[2] + p2[2]) / 3.0;
+			ClusterNormals[c].x += n.x;
+			ClusterNormals[c].y += n.y;
+			ClusterNormals[c].z += n.z;
+			ClusterAreas[c] += Area;
+		}
+		MeshCentroid.x += ClusterCentroids[c].x;
+		MeshCentroid.y += ClusterCentroids[c].y;
+		MeshCentroid.z += ClusterCentroids[c].z;
+		MeshArea += ClusterAreas[c];
+	}
+	if (MeshArea == 0.0)
+		return;
+	MeshCentroid = { MeshCentroid.x / MeshArea, MeshCentroid.y / MeshArea, MeshCentroid.z / MeshArea };
+
+	std::vector<double> SortKeys(NumClusters, 0.0);
+	for (size_t c = 0; c < NumClusters; ++c)
+	{
+		if (ClusterAreas[c] == 0.0)
+			continue;
+		const FVec3& n = ClusterNormals[c];
+		const double NormalLength = sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+		if (NormalLength == 0.0)
+			continue;
+		const FVec3 d = {
+			ClusterCentroids[c].x / ClusterAreas[c] - MeshCentroid.x,
+			ClusterCentroids[c].y / ClusterAreas[c] - MeshCentroid.y,
+			ClusterCentroids[c].z / ClusterAreas[c] - MeshCentroid.z
+		};
+		SortKeys[c] = (d.x * n.x + d.y * n.y + d.z * n.z) / NormalLength;
+	}
+
+	std::vector<uint32> ClusterOrder(NumClusters);
+	std::iota(ClusterOrder.begin(), ClusterOrder.end(), 0u);
+	std::stable_sort(ClusterOrder.begin(), ClusterOrder.end(), [&](uint32 a, uint32 b) { return SortKeys[a] > SortKeys[b]; });
+
+	std::vector<uint32> Output;
+	Output.reserve(Indices.size());
+	for (uint32 c : ClusterOrder)
+	{
+		const uint32 End = c + 1 < NumClusters ? Clusters[c + 1] : static_cast<uint32>(NumTriangles);
+		Output.insert(Output.end(), Indices.begin() + Clusters[c] * 3, Indices.begin() + End * 3);
+	}
+	Indices = std::move(Output);
+}
@@ -0,0 +1,123 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+#pragma once
+
+#include "../Core/Types.h"
+#include "MeshGeometryData.h"
+
+#include <vector>
+
+//
+// MESH OPTIMIZATION
+//
+// Reorders imported geometry for the GPU, in this order:
+//  1. triangles, for post-transform vertex cache locality (Tipsify)
+//  2. triangle clusters, for reduced overdraw: outward facing clusters first
+//  3. vertices, in the order of first use, for vertex fetch locality
+// Pure CPU & deterministic: the same input always produces the same output.
+//
+// Ref: Sander, Nehab, Barczak - Fast Triangle Reordering for Vertex Locality and Reduced Overdraw (2007)
+//
+namespace MeshOptimization
+{
+	constexpr uint32 DEFAULT_CACHE_SIZE = 16; // FIFO post-transform cache entries
+
+	struct FVertexCacheStats
+	{
+		size_t NumTriangles   = 0;
+		size_t NumVertices    = 0; // referenced vertices
+		size_t NumCacheMisses = 0; // vertex shader invocations
+
+		inline float ACMR() const { return NumTriangles ? float(NumCacheMisses) / NumTriangles : 0.0f; } // average cache miss ratio: [0.5, 3], lower is better
+		inline float ATVR() const { return NumVertices  ? float(NumCacheMisses) / NumVertices  : 0.0f; } // average transform to vertex ratio: [1, 6], 1 is ideal
+		void operator+=(const FVertexCacheStats& o) { NumTriangles += o.NumTriangles; NumVertices += o.NumVertices; NumCacheMisses += o.NumCacheMisses; }
+	};
+
+	struct FOptimizationParams
+	{
+		uint32 CacheSize          = DEFAULT_CACHE_SIZE;
+		bool   bOptimizeOverdraw  = true;
+		float  OverdrawThreshold  = 1.05f; // max. ACMR degradation allowed for splitting clusters, 1: no degradation
+	};
+
+	// Simulates a FIFO post-transform cache of CacheSize entries
+	FVertexCacheStats AnalyzeVertexCache(const std::vector<uint32>& Indices, size_t NumVertices, uint32 CacheSize = DEFAULT_CACHE_SIZE);
+
+	void OptimizeVertexCache(std::vector<uint32>& Indices, size_t NumVertices, uint32 CacheSize = DEFAULT_CACHE_SIZE);
+
+	// Expects vertex cache optimized indices: sorts the triangle clusters the vertex cache order forms
+	// so that the clusters facing away from the mesh center are drawn first, while keeping the
+	// ACMR within Threshold of the input.
+	void OptimizeOverdraw(std::vector<uint32>& Indices, const float* pPositions, size_t NumVertices, size_t PositionStride, float Threshold, uint32 CacheSize = DEFAULT_CACHE_SIZE);
+
+	// Reorders the vertices in the order of first use in Indices, drops unreferenced vertices and rewrites Indices
+	template<class TVertex>
+	std::vector<TVertex> OptimizeVertexFetch(const std::vector<TVertex>& Vertices, std::vector<uint32>& Indices);
+
+	// Runs all the optimizations on every LOD. pStatsBefore/pStatsAfter receive the LOD0 vertex cache stats if provided.
+	template<class TVertex>
+	void OptimizeGeometry(GeometryData<TVertex, uint32>& Data, const FOptimizationParams& Params, FVertexCacheStats* pStatsBefore, FVertexCacheStats* pStatsAfter);
+
+
+	// --------------------------------------------------------------------------------------------------------------------------------------------
+	// TEMPLATE DEFINITIONS
+	// --------------------------------------------------------------------------------------------------------------------------------------------
+	template<class TVertex>
+	std::vector<TVertex> OptimizeVertexFetch(const std::vector<TVertex>& Vertices, std::vector<uint32>& Indices)
+	{
+		constexpr uint32 UNUSED = ~0u;
+		std::vector<uint32> Remap(Vertices.size(), UNUSED);
+		std::vector<TVertex> Reordered;
+		Reordered.reserve(Vertices.size());
+		for (uint32& Index : Indices)
+		{
+			if (Remap[Index] == UNUSED)
+			{
+				Remap[Index] = static_cast<uint32>(Reordered.size());
+				Reordered.push_back(Vertices[Index]);
+			}
+			Index = Remap[Index];
+		}
+		return Reordered;
+	}
+
+	template<class TVertex>
+	void OptimizeGeometry(GeometryData<TVertex, uint32>& Data, const FOptimizationParams& Params, FVertexCacheStats* pStatsBefore, FVertexCacheStats* pStatsAfter)
+	{
+		for (size_t LOD = 0; LOD < Data.LODVertices.size(); ++LOD)
+		{
+			std::vector<TVertex>& Vertices = Data.LODVertices[LOD];
+			std::vector<uint32>& Indices = Data.LODIndices[LOD];
+			if (Indices.empty() || Vertices.empty())
+				continue;
+
+			if (LOD == 0 && pStatsBefore)
+				*pStatsBefore = AnalyzeVertexCache(Indices, Vertices.size(), Params.CacheSize);
+
+			OptimizeVertexCache(Indices, Vertices.size(), Params.CacheSize);
+			if (Params.bOptimizeOverdraw)
+			{
+				OptimizeOverdraw(Indices, Vertices[0].position, Vertices.size(), sizeof(TVertex), Params.OverdrawThreshold, Params.CacheSize);
+			}
+			Vertices = OptimizeVertexFetch(Vertices, Indices);
+
+			if (LOD == 0 && pStatsAfter)
+				*pStatsAfter = AnalyzeVertexCache(Indices, Vertices.size(), Params.CacheSize);
+		}
+	}
+}
@@ -0,0 +1,458 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <tuple>
+
+namespace
+{
+	constexpr uint32 NONE     = ~0u; // no open edge
+	constexpr uint32 MULTIPLE = ~1u; // more than one open edge
+
+	constexpr int   MAX_PASSES = 100;
+	constexpr float MIN_NORMAL_COS = 0.25f; // reject collapses that rotate a triangle more than ~75deg
+
+	enum EVertexKind : uint8
+	{
+		MANIFOLD, // can collapse onto any neighbor
+		SEAM,     // shares its position with one other vertex, collapses with it along the seam
+		LOCKED,   // open border, complex seam or non-manifold: never moves
+	};
+
+	struct FVec3
+	{
+		float x, y, z;
+		FVec3 operator-(const FVec3& o) const { return { x - o.x, y - o.y, z - o.z }; }
+	};
+	static inline FVec3 Cross(const FVec3& a, const FVec3& b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+	static inline float Dot(const FVec3& a, const FVec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+	static inline float Length(const FVec3& a) { return sqrtf(Dot(a, a)); }
+
+	// Symmetric 4x4 matrix of the sum of squared distances to a set of weighted planes
+	struct FQuadric
+	{
+		float a00, a11, a22;
+		float a10, a20, a21;
+		float b0, b1, b2;
+		float c;
+		float w;
+
+		static FQuadric FromPlane(const FVec3& n, float d, float Weight)
+		{
+			FQuadric Q;
+			Q.a00 = n.x * n.x * Weight; Q.a11 = n.y * n.y * Weight; Q.a22 = n.z * n.z * Weight;
+			Q.a10 = n.y * n.x * Weight; Q.a20 = n.z * n.x * Weight; Q.a21 = n.z * n.y * Weight;
+			Q.b0  = n.x * d * Weight;   Q.b1  = n.y * d * Weight;   Q.b2  = n.z * d * Weight;
+			Q.c   = d * d * Weight;
+			Q.w   = Weight;
+			return Q;
+		}
+		void operator+=(const FQuadric& Q)
+		{
+			a00 += Q.a00; a11 += Q.a11; a22 += Q.a22;
+			a10 += Q.a10; a20 += Q.a20; a21 += Q.a21;
+			b0 += Q.b0; b1 += Q.b1; b2 += Q.b2;
+			c += Q.c;
+			w += Q.w;
+		}
+		// weighted mean of the squared distances of p to the planes
+		float Error(const FVec3& p) const
+		{
+			const float rx = a00 * p.x + a10 * p.y + a20 * p.z + b0;
+			const float ry = a10 * p.x + a11 * p.y + a21 * p.z + b1;
+			const float rz = a20 * p.x + a21 * p.y + a22 * p.z + b2;
+			const float r = rx * p.x + ry * p.y + rz * p.z + b0 * p.x + b1 * p.y + b2 * p.z + c; // p'Ap + 2b'p + c
+			return w > 0.0f ? fabsf(r) / w : 0.0f;
+		}
+	};
+
+	struct FHalfEdge
+	{
+		uint32 Next; // v -> Next is an edge of the triangle (v, Next, Prev)
+		uint32 Prev;
+	};
+
+	// Outgoing half-edges per vertex, rebuilt every pass
+	struct FAdjacency
+	{
+		std::vector<uint32>    Offsets; // NumVertices + 1
+		std::vector<FHalfEdge> Edges;
+
+		void Build(const std::vector<uint32>& Indices, size_t NumVertices)
+		{
+			Offsets.assign(NumVertices + 1, 0);
+			for (uint32 i : Indices)
+				++Offsets[i + 1];
+			for (size_t v = 0; v < NumVertices; ++v)
+				Offsets[v + 1] += Offsets[v];
+
+			Edges.resize(Indices.size());
+			std::vector<uint32> Fill(Offsets.begin(), Offsets.end() - 1);
+			for (size_t i = 0; i < Indices.size(); i += 3)
+			{
+				const uint32 a = Indices[i + 0], b = Indices[i + 1], c = Indices[i + 2];
+				Edges[Fill[a]++] = { b, c };
+				Edges[Fill[b]++] = { c, a };
+				Edges[Fill[c]++] = { a, b };
+			}
+		}
+		inline const FHalfEdge* Begin(uint32 v) const { return Edges.data() + Offsets[v]; }
+		inline const FHalfEdge* End  (uint32 v) const { return Edges.data() + Offsets[v + 1]; }
+		inline bool IsUsed(uint32 v) const { return Offsets[v] != Offsets[v + 1]; }
+		bool HasEdge(uint32 a, uint32 b) const
+		{
+			for (const FHalfEdge* e = Begin(a); e != End(a); ++e)
+				if (e->Next == b)
+					return true;
+			return false;
+		}
+	};
+
+	struct FCollapse
+	{
+		uint32 v;  // vertex that moves
+		uint32 t;  // target vertex
+		float  Error;
+	};
+}
+
+// Links the vertices with bitwise identical positions: Remap[v] is the first vertex of the group
+// and Wedge[v] is the next vertex of the group in a circular list.
+static void BuildPositionGroups(const std::vector<FVec3>& Positions, std::vector<uint32>& Remap, std::vector<uint32>& Wedge)
+{
+	const size_t NumVertices = Positions.size();
+	std::vector<uint32> Order(NumVertices);
+	std::iota(Order.begin(), Order.end(), 0u);
+	auto fnKey = [&](uint32 v)
+	{
+		uint32 k[3];
+		memcpy(k, &Positions[v], sizeof(k));
+		return std::make_tuple(k[0], k[1], k[2], v);
+	};
+	std::sort(Order.begin(), Order.end(), [&](uint32 a, uint32 b) { return fnKey(a) < fnKey(b); });
+
+	Remap.resize(NumVertices);
+	Wedge.resize(NumVertices);
+	for (size_t i = 0; i < NumVertices; )
+	{
+		size_t j = i + 1;
+		while (j < NumVertices && memcmp(&Positions[Order[i]], &Positions[Order[j]], sizeof(FVec3)) == 0)
+			++j;
+		for (size_t k = i; k < j; ++k)
+		{
+			Remap[Order[k]] = Order[i];
+			Wedge[Order[k]] = Order[k + 1 < j ? k + 1 : i];
+		}
+		i = j;
+	}
+}
+
+// Open edges are half-edges without a twin in index space: mesh borders and attribute seams
+static void FindOpenEdges(const FAdjacency& Adjacency, size_t NumVertices, std::vector<uint32>& OpenOut, std::vector<uint32>& OpenIn)
+{
+	OpenOut.assign(NumVertices, NONE);
+	OpenIn.assign(NumVertices, NONE);
+	for (uint32 v = 0; v < NumVertices; ++v)
+	{
+		for (const FHalfEdge* e = Adjacency.Begin(v); e != Adjacency.End(v); ++e)
+		{
+			if (Adjacency.HasEdge(e->Next, v))
+				continue;
+			OpenOut[v]       = OpenOut[v]       == NONE ? e->Next : MULTIPLE;
+			OpenIn[e->Next]  = OpenIn[e->Next]  == NONE ? v       : MULTIPLE;
+		}
+	}
+}
+
+static void ClassifyVertices(
+	const FAdjacency& Adjacency,
+	const std::vector<uint32>& Remap, const std::vector<uint32>& Wedge,
+	const std::vector<uint32>& OpenOut, const std::vector<uint32>& OpenIn,
+	std::vector<uint8>& Kinds, std::vector<uint32>& Siblings
+)
+{
+	const size_t NumVertices = Remap.size();
+	Kinds.assign(NumVertices, LOCKED);
+	Siblings.assign(NumVertices, NONE);
+	auto fnIsSingle = [](uint32 e) { return e != NONE && e != MULTIPLE; };
+
+	for (uint32 v = 0; v < NumVertices; ++v)
+	{
+		if (!Adjacency.IsUsed(v))
+			continue;
+
+		// other vertices at the same position that are still referenced
+		uint32 NumSiblings = 0;
+		uint32 Sibling = NONE;
+		for (uint32 w = Wedge[v]; w != v; w = Wedge[w])
+		{
+			if (Adjacency.IsUsed(w))
+			{
+				++NumSiblings;
+				Sibling = w;
+			}
+		}
+
+		if (NumSiblings == 0)
+		{
+			Kinds[v] = (OpenOut[v] == NONE && OpenIn[v] == NONE) ? MANIFOLD : LOCKED; // open border
+		}
+		else if (NumSiblings == 1)
+		{
+			// a seam runs through the vertex: one open edge in & out on each side, pointing to the same positions in opposite directions
+			const uint32 s = Sibling;
+			const bool bSeam = fnIsSingle(OpenOut[v]) && fnIsSingle(OpenIn[v]) && fnIsSingle(OpenOut[s]) && fnIsSingle(OpenIn[s])
+				&& Remap[OpenOut[v]] == Remap[OpenIn[s]]
+				&& Remap[OpenIn[v]]  == Remap[OpenOut[s]];
+			if (bSeam)
+			{
+				Kinds[v] = SEAM;
+				Siblings[v] = s;
+			}
+		}
+	}
+}
+
+static inline bool CanCollapse(uint32 v, uint32 t, const std::vector<uint8>& Kinds, const std::vector<uint32>& OpenOut, const std::vector<uint32>& OpenIn)
+{
+	if (Kinds[v] == MANIFOLD)
+		return true;
+	if (Kinds[v] == SEAM) // only along the seam, the sibling follows on the other side
+		return (t == OpenOut[v] || t == OpenIn[v]) && Kinds[t] != MANIFOLD;
+	return false;
+}
+
+// the target of the seam sibling: the vertex on the other side of the seam at the same position as t
+static inline uint32 GetSiblingTarget(uint32 v, uint32 t, const std::vector<uint32>& Siblings, const std::vector<uint32>& OpenOut, const std::vector<uint32>& OpenIn)
+{
+	const uint32 s = Siblings[v];
+	return t == OpenOut[v] ? OpenIn[s] : OpenOut[s];
+}
+
+// moving v onto t must not flip or strongly rotate the triangles that survive the collapse
+static bool HasTriangleFlips(const FAdjacency& Adjacency, const std::vector<FVec3>& Positions, const std::vector<uint32>& Remap, uint32 v, uint32 t)
+{
+	const FVec3& pv = Positions[v];
+	const FVec3& pt = Positions[t];
+	for (const FHalfEdge* e = Adjacency.Begin(v); e != Adjacency.End(v); ++e)
+	{
+		const uint32 a = e->Next;
+		const uint32 b = e->Prev;
+		if (Remap[a] == Remap[t] || Remap[b] == Remap[t])
+			continue; // collapses into a degenerate triangle
+
+		const FVec3 n0 = Cross(Positions[a] - pv, Positions[b] - pv);
+		const FVec3 n1 = Cross(Positions[a] - pt, Positions[b] - pt);
+		if (Dot(n0, n1) < MIN_NORMAL_COS * Length(n0) * Length(n1))
+			return true;
+	}
+	return false;
+}
+
+static void ComputeQuadrics(
+	const std::vector<FVec3>& Positions, const std::vector<uint32>& Indices,
+	const std::vector<uint32>& Remap,
+	const std::vector<uint8>& Kinds, const std::vector<uint32>& OpenOut,
+	std::vector<FQuadric>& Quadrics
+)
+{
+	Quadrics.assign(Positions.size(), FQuadric{});
+	for (size_t i = 0; i < Indices.size(); i += 3)
+	{
+		const uint32 i0 = Indices[i + 0], i1 = Indices[i + 1], i2 = Indices[i + 2];
+		const FVec3& p0 = Positions[i0];
+		FVec3 n = Cross(Positions[i1] - p0, Positions[i2] - p0);
+		const float DoubleArea = Length(n);
+		if (DoubleArea == 0.0f)
+			continue;
+		n = { n.x / DoubleArea, n.y / DoubleArea, n.z / DoubleArea };
+
+		const FQuadric Q = FQuadric::FromPlane(n, -Dot(n, p0), DoubleArea * 0.5f);
+		Quadrics[Remap[i0]] += Q;
+		Quadrics[Remap[i1]] += Q;
+		Quadrics[Remap[i2]] += Q;
+
+		// seam edges: a plane through the edge, perpendicular to the triangle keeps the seam in place
+		const uint32 Tri[3] = { i0, i1, i2 };
+		for (int e = 0; e < 3; ++e)
+		{
+			const uint32 a = Tri[e];
+			const uint32 b = Tri[(e + 1) % 3];
+			if (Kinds[a] != SEAM || OpenOut[a] != b)
+				continue;
+
+			const FVec3 Edge = Positions[b] - Positions[a];
+			const float EdgeLength = Length(Edge);
+			FVec3 k = Cross(Edge, n);
+			const float kLength = Length(k);
+			if (kLength == 0.0f)
+				continue;
+			k = { k.x / kLength, k.y / kLength, k.z / kLength };
+
+			const FQuadric QEdge = FQuadric::FromPlane(k, -Dot(k, Positions[a]), EdgeLength * EdgeLength);
+			Quadrics[Remap[a]] += QEdge;
+			Quadrics[Remap[b]] += QEdge;
+		}
+	}
+}
+
+std::vector<uint32> MeshSimplifier::Simplify(
+	const float* pPositions, size_t NumVertices, size_t PositionStride,
+	const std::vector<uint32>& InputIndices,
+	size_t TargetIndexCount,
+	float MaxError,
+	float* pOutError
+)
+{
+	if (pOutError)
+		*pOutError = 0.0f;
+
+	// normalize positions to the unit cube so the errors are relative to the mesh extents
+	std::vector<FVec3> Positions(NumVertices);
+	FVec3 Min = {  FLT_MAX,  FLT_MAX,  FLT_MAX };
+	FVec3 Max = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	for (size_t v = 0; v < NumVertices; ++v)
+	{
+		const float* p = reinterpret_cast<const float*>(reinterpret_cast<const uint8*>(pPositions) + v * PositionStride);
+		Positions[v] = { p[0], p[1], p[2] };
+		Min = { std::min(Min.x, p[0]), std::min(Min.y, p[1]), std::min(Min.z, p[2]) };
+		Max = { std::max(Max.x, p[0]), std::max(Max.y, p[1]), std::max(Max.z, p[2]) };
+	}
+	const float Extent = std::max({ Max.x - Min.x, Max.y - Min.y, Max.z - Min.z });
+	const float InvExtent = Extent > 0.0f ? 1.0f / Extent : 0.0f;
+	for (FVec3& p : Positions)
+		p = { (p.x - Min.x) * InvExtent, (p.y - Min.y) * InvExtent, (p.z - Min.z) * InvExtent };
+
+	std::vector<uint32> Remap, Wedge;
+	BuildPositionGroups(Positions, Remap, Wedge);
+
+	// drop degenerate input triangles
+	std::vector<uint32> Indices;
+	Indices.reserve(InputIndices.size());
+	for (size_t i = 0; i + 2 < InputIndices.size(); i += 3)
+	{
+		const uint32 a = InputIndices[i + 0], b = InputIndices[i + 1], c = InputIndices[i + 2];
+		if (Remap[a] != Remap[b] && Remap[b] != Remap[c] && Remap[c] != Remap[a])
+			Indices.insert(Indices.end(), { a, b, c });
+	}
+
+	FAdjacency Adjacency;
+	std::vector<uint32> OpenOut, OpenIn, Siblings;
+	std::vector<uint8> Kinds;
+	std::vector<FQuadric> Quadrics;
+	Adjacency.Build(Indices, NumVertices);
+	FindOpenEdges(Adjacency, NumVertices, OpenOut, OpenIn);
+	ClassifyVertices(Adjacency, Remap, Wedge, OpenOut, OpenIn, Kinds, Siblings);
+	ComputeQuadrics(Positions, Indices, Remap, Kinds, OpenOut, Quadrics); // accumulated on collapse from here on
+
+	const float MaxErrorSq = MaxError * MaxError;
+	float ResultErrorSq = 0.0f;
+
+	std::vector<FCollapse> Collapses;
+	std::vector<uint32> CollapseRemap(NumVertices);
+	std::vector<uint8> Touched(NumVertices);
+	for (int Pass = 0; Pass < MAX_PASSES && Indices.size() > TargetIndexCount; ++Pass)
+	{
+		if (Pass > 0)
+		{
+			Adjacency.Build(Indices, NumVertices);
+			FindOpenEdges(Adjacency, NumVertices, OpenOut, OpenIn);
+			ClassifyVertices(Adjacency, Remap, Wedge, OpenOut, OpenIn, Kinds, Siblings);
+		}
+
+		// gather the edges with their cheapest allowed collapse direction
+		Collapses.clear();
+		for (size_t i = 0; i < Indices.size(); ++i)
+		{
+			const uint32 a = Indices[i];
+			const uint32 b = Indices[i % 3 == 2 ? i - 2 : i + 1];
+			if (a > b && Adjacency.HasEdge(b, a))
+				continue; // visit interior edges once
+
+			const bool bAB = CanCollapse(a, b, Kinds, OpenOut, OpenIn);
+			const bool bBA = CanCollapse(b, a, Kinds, OpenOut, OpenIn);
+			if (!bAB && !bBA)
+				continue;
+
+			const float ErrorAB = bAB ? Quadrics[Remap[a]].Error(Positions[b]) : FLT_MAX;
+			const float ErrorBA = bBA ? Quadrics[Remap[b]].Error(Positions[a]) : FLT_MAX;
+			Collapses.push_back(ErrorAB <= ErrorBA ? FCollapse{ a, b, ErrorAB } : FCollapse{ b, a, ErrorBA });
+		}
+		std::sort(Collapses.begin(), Collapses.end(), [](const FCollapse& l, const FCollapse& r) { return l.Error < r.Error; });
+
+		// perform the cheapest collapses, at most one per vertex neighborhood per pass
+		std::iota(CollapseRemap.begin(), CollapseRemap.end(), 0u);
+		std::fill(Touched.begin(), Touched.end(), uint8(0));
+		const size_t NumTrianglesToRemove = (Indices.size() - TargetIndexCount) / 3;
+		size_t NumTrianglesRemoved = 0;
+		size_t NumCollapses = 0;
+		for (const FCollapse& c : Collapses)
+		{
+			if (c.Error > MaxErrorSq || NumTrianglesRemoved >= NumTrianglesToRemove)
+				break;
+			if (Touched[Remap[c.v]] || Touched[Remap[c.t]])
+				continue;
+
+			const bool bSeam = Kinds[c.v] == SEAM;
+			const uint32 s  = bSeam ? Siblings[c.v] : NONE;
+			const uint32 st = bSeam ? GetSiblingTarget(c.v, c.t, Siblings, OpenOut, OpenIn) : NONE;
+			if (bSeam && (st == NONE || st == MULTIPLE || Remap[st] != Remap[c.t]))
+				continue;
+			if (HasTriangleFlips(Adjacency, Positions, Remap, c.v, c.t) || (bSeam && HasTriangleFlips(Adjacency, Positions, Remap, s, st)))
+				continue;
+
+			CollapseRemap[c.v] = c.t;
+			if (bSeam)
+				CollapseRemap[s] = st;
+			Quadrics[Remap[c.t]] += Quadrics[Remap[c.v]];
+			Touched[Remap[c.v]] = Touched[Remap[c.t]] = 1;
+
+			// a manifold edge collapse removes 2 triangles, a seam collapse removes 1 on each side
+			NumTrianglesRemoved += 2;
+			ResultErrorSq = std::max(ResultErrorSq, c.Error);
+			++NumCollapses;
+		}
+		if (NumCollapses == 0)
+			break;
+
+		// apply the collapses and drop the triangles that became degenerate
+		size_t iWrite = 0;
+		for (size_t i = 0; i < Indices.size(); i += 3)
+		{
+			const uint32 a = CollapseRemap[Indices[i + 0]];
+			const uint32 b = CollapseRemap[Indices[i + 1]];
+			const uint32 c = CollapseRemap[Indices[i + 2]];
+			if (Remap[a] == Remap[b] || Remap[b] == Remap[c] || Remap[c] == Remap[a])
+				continue;
+			Indices[iWrite++] = a;
+			Indices[iWrite++] = b;
+			Indices[iWrite++] = c;
+		}
+		Indices.resize(iWrite);
+	}
+
+	if (pOutError)
+		*pOutError = sqrtf(ResultErrorSq);
+	return Indices;
+}
@@ -0,0 +1,103 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+#pragma once
+
+#include "../Core/Types.h"
+#include "MeshGeometryData.h"
+#include "MeshOptimization.h"
+
+#include <vector>
+
+//
+// MESH SIMPLIFIER
+//
+// Edge collapse simplification driven by quadric error metrics (Garland & Heckbert '97).
+// Collapses move a vertex onto one of its neighbors, so the vertex data of the input is
+// reused as-is: only the index buffer changes, the unreferenced vertices are dropped after.
+//
+// Vertices that share a position but not the other attributes (UV / normal seams) are
+// collapsed together and only along the seam. Vertices on open borders are locked: a
+// glTF primitive has a single material, hence its borders are the material boundaries
+// and are kept intact to avoid cracks between neighboring primitives.
+//
+// Errors are reported relative to the largest extent of the mesh bounding box.
+//
+namespace MeshSimplifier
+{
+	struct FLODChainParams
+	{
+		int    NumMaxLODs          = 4;     // including LOD0
+		float  IndexRatioPerLOD    = 0.5f;  // target index count of a LOD w.r.t. the previous one
+		float  MinReductionPerLOD  = 0.85f; // stop the chain when a LOD can't get below this ratio of the previous one
+		float  MaxError            = 0.05f; // accumulated error limit of the last LOD, relative to the mesh extents
+		size_t MinIndexCount       = 384;   // meshes smaller than this don't get LODs
+	};
+
+	// Simplifies the indexed triangle list towards TargetIndexCount without exceeding MaxError.
+	// pPositions points to the float3 position of the first vertex, PositionStride is the vertex size in bytes.
+	// Returns the new index list, referencing the same vertices. pOutError receives the achieved error.
+	std::vector<uint32> Simplify(
+		const float* pPositions, size_t NumVertices, size_t PositionStride,
+		const std::vector<uint32>& Indices,
+		size_t TargetIndexCount,
+		float MaxError,
+		float* pOutError
+	);
+
+	// Fills LOD[1..N] and the LODErrors of Data from its LOD0. Every LOD is simplified from the
+	// previous one and the errors accumulate, so LODErrors is an upper bound w.r.t. LOD0.
+	template<class TVertex>
+	void GenerateLODChain(GeometryData<TVertex, uint32>& Data, const FLODChainParams& Params);
+
+
+	// --------------------------------------------------------------------------------------------------------------------------------------------
+	// TEMPLATE DEFINITIONS
+	// --------------------------------------------------------------------------------------------------------------------------------------------
+	template<class TVertex>
+	void GenerateLODChain(GeometryData<TVertex, uint32>& Data, const FLODChainParams& Params)
+	{
+		Data.LODErrors.assign(Data.LODVertices.size(), 0.0f);
+		if (Data.LODVertices.size() != 1 || Data.LODVertices[0].empty() || Data.LODIndices[0].size() < Params.MinIndexCount)
+			return;
+
+		Data.LODVertices.reserve(Params.NumMaxLODs); // keep the LOD0 reference below valid
+		Data.LODIndices.reserve(Params.NumMaxLODs);
+		const std::vector<TVertex>& Vertices = Data.LODVertices[0];
+		std::vector<uint32> PrevIndices = Data.LODIndices[0]; // indexes into LOD0 vertices
+		float PrevError = 0.0f;
+		for (int LOD = 1; LOD < Params.NumMaxLODs; ++LOD)
+		{
+			const size_t TargetIndexCount = static_cast<size_t>(PrevIndices.size() * Params.IndexRatioPerLOD) / 3 * 3;
+			const float ErrorBudget = Params.MaxError - PrevError;
+			if (ErrorBudget <= 0.0f)
+				break;
+
+			float LODError = 0.0f;
+			std::vector<uint32> LODIndices = Simplify(Vertices[0].position, Vertices.size(), sizeof(TVertex), PrevIndices, TargetIndexCount, ErrorBudget, &LODError);
+			if (LODIndices.empty() || LODIndices.size() > PrevIndices.size() * Params.MinReductionPerLOD)
+				break; // can't simplify any further within the budget
+
+			PrevError += LODError;
+			PrevIndices = LODIndices;
+
+			Data.LODVertices.push_back(MeshOptimization::OptimizeVertexFetch(Vertices, LODIndices)); // drops the collapsed vertices
+			Data.LODIndices.push_back(std::move(LODIndices));
+			Data.LODErrors.push_back(PrevError);
+		}
+	}
+}
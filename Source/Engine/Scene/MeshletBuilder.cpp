@@ -0,0 +1,307 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+
+#include "MeshletBuilder.h"
+
+#include "Engine/GPUMarker.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+
+namespace
+{
+	constexpr uint32 NONE = ~0u;
+
+	inline const float* GetAttribute(const float* pFirst, size_t Stride, uint32 i) { return reinterpret_cast<const float*>(reinterpret_cast<const char*>(pFirst) + Stride * i); }
+	inline float Dot(const float a[3], const float b[3]) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+	inline float Length(const float a[3]) { return std::sqrt(Dot(a, a)); }
+
+	// vertex -> triangles
+	struct FVertexTriangles
+	{
+		std::vector<uint32> Offsets;
+		std::vector<uint32> Triangles;
+
+		FVertexTriangles(const std::vector<uint32>& Indices, size_t NumVertices)
+			: Offsets(NumVertices + 1, 0)
+			, Triangles(Indices.size())
+		{
+			for (uint32 i : Indices)
+				++Offsets[i + 1];
+			for (size_t v = 0; v < NumVertices; ++v)
+				Offsets[v + 1] += Offsets[v];
+			std::vector<uint32> Fill(Offsets.begin(), Offsets.end() - 1);
+			for (size_t i = 0; i < Indices.size(); ++i)
+				Triangles[Fill[Indices[i]]++] = static_cast<uint32>(i / 3);
+		}
+		inline const uint32* begin(uint32 v) const { return Triangles.data() + Offsets[v]; }
+		inline const uint32* end(uint32 v) const { return Triangles.data() + Offsets[v + 1]; }
+	};
+
+	// triangle centroids & unit front face normals, zero for degenerate triangles
+	struct FTriangleData
+	{
+		std::vector<float> Centroids;
+		std::vector<float> Normals;
+
+		FTriangleData(const std::vector<uint32>& Indices, const float* pPositions, const float* pNormals, size_t Stride)
+			: Centroids(Indices.size())
+			, Normals(Indices.size())
+		{
+			const size_t NumTriangles = Indices.size() / 3;
+			double WindingVote = 0.0; // > 0: the cross product of the edges points to the same side as the vertex normals
+			for (size_t t = 0; t < NumTriangles; ++t)
+			{
+				const float* p0 = GetAttribute(pPositions, Stride, Indices[t * 3 + 0]);
+				const float* p1 = GetAttribute(pPositions, Stride, Indices[t * 3 + 1]);
+				const float* p2 = GetAttribute(pPositions, Stride, Indices[t * 3 + 2]);
+				const float e0[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+				const float e1[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+				float n[3] = { e0[1] * e1[2] - e0[2] * e1[1], e0[2] * e1[0] - e0[0] * e1[2], e0[0] * e1[1] - e0[1] * e1[0] };
+
+				const float* n0 = GetAttribute(pNormals, Stride, Indices[t * 3 + 0]);
+				const float* n1 = GetAttribute(pNormals, Stride, Indices[t * 3 + 1]);
+				const float* n2 = GetAttribute(pNormals, Stride, Indices[t * 3 + 2]);
+				const float nv[3] = { n0[0] + n1[0] + n2[0], n0[1] + n1[1] + n2[1], n0[2] + n1[2] + n2[2] };
+				WindingVote += Dot(n, nv); // area weighted
+
+				const float Len = Length(n);
+				const float InvLen = Len > 0.0f ? 1.0f / Len : 0.0f;
+				for (int i = 0; i < 3; ++i)
+				{
+					Centroids[t * 3 + i] = (p0[i] + p1[i] + p2[i]) / 3.0f;
+					Normals[t * 3 + i] = n[i] * InvLen;
+				}
+			}
+			if (WindingVote < 0.0)
+			{
+				for (float& n : Normals)
+					n = -n;
+			}
+		}
+		inline const float* Centroid(uint32 t) const { return &Centroids[t * 3]; }
+		inline const float* Normal(uint32 t) const { return &Normals[t * 3]; }
+	};
+
+	void ComputeMeshletBounds(FMeshlet& m, const std::vector<uint32>& MeshletVertices, const uint32* pMeshletTriangles, const FTriangleData& Triangles, const float* pPositions, size_t Stride)
+	{
+		// bounding box & sphere around the box center
+		float Min[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+		float Max[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+		for (uint32 v : MeshletVertices)
+		{
+			const float* p = GetAttribute(pPositions, Stride, v);
+			for (int i = 0; i < 3; ++i)
+			{
+				Min[i] = std::min(Min[i], p[i]);
+				Max[i] = std::max(Max[i], p[i]);
+			}
+		}
+		float RadiusSq = 0.0f;
+		for (int i = 0; i < 3; ++i)
+		{
+			m.BoundsMin[i] = Min[i];
+			m.BoundsMax[i] = Max[i];
+			m.Center[i] = (Min[i] + Max[i]) * 0.5f;
+		}
+		for (uint32 v : MeshletVertices)
+		{
+			const float* p = GetAttribute(pPositions, Stride, v);
+			const float d[3] = { p[0] - m.Center[0], p[1] - m.Center[1], p[2] - m.Center[2] };
+			RadiusSq = std::max(RadiusSq, Dot(d, d));
+		}
+		m.Radius = std::sqrt(RadiusSq);
+
+		// normal cone: the cutoff is the sine of the cone half angle, i.e. the cosine of the angle between the
+		// axis and the widest view direction that sees the back faces of all the triangles
+		const uint32 NumTriangles = m.NumIndices / 3;
+		float Axis[3] = { 0.0f, 0.0f, 0.0f };
+		for (uint32 t = 0; t < NumTriangles; ++t)
+		{
+			const float* n = Triangles.Normal(pMeshletTriangles[t]);
+			Axis[0] += n[0]; Axis[1] += n[1]; Axis[2] += n[2];
+		}
+		const float AxisLen = Length(Axis);
+		float MinDot = -1.0f;
+		if (AxisLen > 0.0f)
+		{
+			Axis[0] /= AxisLen; Axis[1] /= AxisLen; Axis[2] /= AxisLen;
+			MinDot = 1.0f;
+			for (uint32 t = 0; t < NumTriangles; ++t)
+			{
+				const float* n = Triangles.Normal(pMeshletTriangles[t]);
+				if (n[0] != 0.0f || n[1] != 0.0f || n[2] != 0.0f) // degenerate triangles aren't rasterized
+					MinDot = std::min(MinDot, Dot(n, Axis));
+			}
+		}
+		m.ConeAxis[0] = Axis[0];
+		m.ConeAxis[1] = Axis[1];
+		m.ConeAxis[2] = Axis[2];
+		m.ConeCutoff = MinDot <= 0.1f ? 1.0f : std::sqrt(1.0f - MinDot * MinDot); // cones wider than ~84 degrees are never culled
+	}
+}
+
+std::vector<FMeshlet> MeshletBuilder::BuildMeshlets(
+	const float* pPositions,
+	const float* pNormals,
+	size_t NumVertices,
+	size_t VertexStride,
+	std::vector<uint32>& Indices,
+	const FParams& Params
+)
+{
+	SCOPED_CPU_MARKER("MeshletBuilder::BuildMeshlets");
+	assert(Params.MaxVertices >= 3 && Params.MaxVertices <= 0xFFFF);
+	assert(Params.MaxTriangles >= 1 && Params.MaxTriangles * 3 <= 0xFFFF); // FMeshlet::NumIndices
+
+	std::vector<FMeshlet> Meshlets;
+	const size_t NumTriangles = Indices.size() / 3;
+	if (NumTriangles == 0)
+		return Meshlets;
+
+	const FVertexTriangles Adjacency(Indices, NumVertices);
+	const FTriangleData Triangles(Indices, pPositions, pNormals, VertexStride);
+
+	std::vector<uint32> MeshletIndices; // output, in meshlet order
+	std::vector<uint32> TriangleOrder;  // output triangle -> input triangle
+	std::vector<uint8>  bEmitted(NumTriangles, 0);
+	std::vector<uint32> VertexMeshlet(NumVertices, NONE); // the last meshlet that referenced the vertex
+	std::vector<uint32> CandidateMeshlet(NumTriangles, NONE); // the last meshlet that had the triangle as a candidate
+	std::vector<uint32> MeshletVertices;
+	std::vector<uint32> Candidates;
+	MeshletIndices.reserve(Indices.size());
+	TriangleOrder.reserve(NumTriangles);
+	MeshletVertices.reserve(Params.MaxVertices);
+
+	size_t iNextTriangle = 0; // all the triangles before this one are emitted
+	size_t NumEmitted = 0;
+	while (NumEmitted < NumTriangles)
+	{
+		const uint32 iMeshlet = static_cast<uint32>(Meshlets.size());
+		MeshletVertices.clear();
+		Candidates.clear();
+		float CentroidSum[3] = { 0.0f, 0.0f, 0.0f };
+		float NormalSum[3] = { 0.0f, 0.0f, 0.0f };
+		uint32 NumMeshletTriangles = 0;
+
+		auto fnGetNumNewVertices = [&](uint32 t)
+		{
+			return (VertexMeshlet[Indices[t * 3 + 0]] != iMeshlet ? 1u : 0u)
+				+  (VertexMeshlet[Indices[t * 3 + 1]] != iMeshlet ? 1u : 0u)
+				+  (VertexMeshlet[Indices[t * 3 + 2]] != iMeshlet ? 1u : 0u);
+		};
+		auto fnAddTriangle = [&](uint32 t)
+		{
+			bEmitted[t] = 1;
+			for (int i = 0; i < 3; ++i)
+			{
+				const uint32 v = Indices[t * 3 + i];
+				MeshletIndices.push_back(v);
+				if (VertexMeshlet[v] == iMeshlet)
+					continue;
+				VertexMeshlet[v] = iMeshlet;
+				MeshletVertices.push_back(v);
+				for (const uint32* pTri = Adjacency.begin(v); pTri != Adjacency.end(v); ++pTri)
+				{
+					if (!bEmitted[*pTri] && CandidateMeshlet[*pTri] != iMeshlet)
+					{
+						CandidateMeshlet[*pTri] = iMeshlet;
+						Candidates.push_back(*pTri);
+					}
+				}
+			}
+			const float* c = Triangles.Centroid(t);
+			const float* n = Triangles.Normal(t);
+			for (int i = 0; i < 3; ++i)
+			{
+				CentroidSum[i] += c[i];
+				NormalSum[i] += n[i];
+			}
+			TriangleOrder.push_back(t);
+			++NumMeshletTriangles;
+			++NumEmitted;
+		};
+
+		while (bEmitted[iNextTriangle])
+			++iNextTriangle;
+		fnAddTriangle(static_cast<uint32>(iNextTriangle));
+
+		while (NumMeshletTriangles < Params.MaxTriangles)
+		{
+			const float Center[3] = { CentroidSum[0] / NumMeshletTriangles, CentroidSum[1] / NumMeshletTriangles, CentroidSum[2] / NumMeshletTriangles };
+			const float NormalLen = Length(NormalSum);
+			const float Axis[3] = { NormalLen > 0.0f ? NormalSum[0] / NormalLen : 0.0f, NormalLen > 0.0f ? NormalSum[1] / NormalLen : 0.0f, NormalLen > 0.0f ? NormalSum[2] / NormalLen : 0.0f };
+
+			// adjacent triangles: fewest new vertices first, then the closest & best aligned one
+			uint32 iBest = NONE;
+			uint32 BestNumNewVertices = 4;
+			float  BestScore = FLT_MAX;
+			for (size_t i = 0; i < Candidates.size(); )
+			{
+				const uint32 t = Candidates[i];
+				if (bEmitted[t])
+				{
+					Candidates[i] = Candidates.back();
+					Candidates.pop_back();
+					continue;
+				}
+				++i;
+
+				const uint32 NumNewVertices = fnGetNumNewVertices(t);
+				if (MeshletVertices.size() + NumNewVertices > Params.MaxVertices || NumNewVertices > BestNumNewVertices)
+					continue;
+
+				const float* c = Triangles.Centroid(t);
+				const float d[3] = { c[0] - Center[0], c[1] - Center[1], c[2] - Center[2] };
+				const float Score = Length(d) * (1.0f + Params.ConeWeight * (1.0f - Dot(Triangles.Normal(t), Axis)));
+				if (NumNewVertices < BestNumNewVertices || Score < BestScore)
+				{
+					iBest = t;
+					BestNumNewVertices = NumNewVertices;
+					BestScore = Score;
+				}
+			}
+
+			// no adjacent triangle fits: top up small meshlets (disconnected pieces) with the next triangles in the input
+			// order, which is vertex cache optimized and hence spatially coherent
+			if (iBest == NONE && NumMeshletTriangles < Params.MaxTriangles / 4)
+			{
+				while (iNextTriangle < NumTriangles && bEmitted[iNextTriangle])
+					++iNextTriangle;
+				if (iNextTriangle < NumTriangles && MeshletVertices.size() + fnGetNumNewVertices(static_cast<uint32>(iNextTriangle)) <= Params.MaxVertices)
+					iBest = static_cast<uint32>(iNextTriangle);
+			}
+			if (iBest == NONE)
+				break;
+
+			fnAddTriangle(iBest);
+		}
+
+		FMeshlet m = {};
+		m.IndexOffset = static_cast<uint32>(MeshletIndices.size() - NumMeshletTriangles * 3);
+		m.NumIndices  = static_cast<uint16>(NumMeshletTriangles * 3);
+		m.NumVertices = static_cast<uint16>(MeshletVertices.size());
+		Meshlets.push_back(m);
+		ComputeMeshletBounds(Meshlets.back(), MeshletVertices, &TriangleOrder[TriangleOrder.size() - NumMeshletTriangles], Triangles, pPositions, VertexStride);
+	}
+
+	Indices.swap(MeshletIndices);
+	return Meshlets;
+}
@@ -0,0 +1,111 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+#pragma once
+
+#include "../Core/Types.h"
+#include "MeshGeometryData.h"
+#include "MeshOptimization.h"
+
+#include <vector>
+
+//
+// MESHLET BUILDER
+//
+// Splits the triangles of a mesh LOD into clusters (meshlets) of bounded vertex & triangle
+// counts for culling at a finer granularity than the mesh bounding box. The index buffer is
+// reordered so that every meshlet is a contiguous index range: the culling outputs index
+// ranges to draw and the vertex & index formats stay the same.
+//
+// Meshlets are grown greedily over the triangle adjacency, preferring the triangles that
+// add the fewest new vertices and are closest to the meshlet, with a bias towards the
+// triangles facing the same direction to keep the normal cones narrow.
+//
+// The normal cone of a meshlet bounds the front face normals of its triangles. The winding
+// of the front faces is detected per mesh from the vertex normals.
+//
+namespace MeshletBuilder
+{
+	struct FParams
+	{
+		uint32 MaxVertices  = 64;
+		uint32 MaxTriangles = 124;
+		uint32 MinTriangles = 512;   // LODs with fewer triangles don't get meshlets, the mesh bounding box culling is enough for them
+		float  ConeWeight   = 0.5f;  // [0, 1]: 0 grows meshlets by proximity only, higher values favor narrower normal cones
+	};
+
+	struct FStats
+	{
+		size_t NumMeshlets         = 0; // all LODs
+		size_t NumTriangles        = 0;
+		size_t NumMeshletVertices  = 0; // sum of the unique vertices of the meshlets
+		size_t NumBackfaceCullable = 0; // meshlets with a normal cone narrow enough for backface culling
+
+		inline float AvgTrianglesPerMeshlet() const { return NumMeshlets ? float(NumTriangles) / NumMeshlets : 0.0f; }
+		inline float AvgVerticesPerMeshlet()  const { return NumMeshlets ? float(NumMeshletVertices) / NumMeshlets : 0.0f; }
+		void operator+=(const FStats& o) { NumMeshlets += o.NumMeshlets; NumTriangles += o.NumTriangles; NumMeshletVertices += o.NumMeshletVertices; NumBackfaceCullable += o.NumBackfaceCullable; }
+	};
+
+	// Reorders the triangles of Indices into meshlets and returns the meshlets in index buffer order.
+	// pPositions/pNormals point to the float3 position/normal of the first vertex, VertexStride is the vertex size in bytes.
+	std::vector<FMeshlet> BuildMeshlets(
+		const float* pPositions,
+		const float* pNormals,
+		size_t NumVertices,
+		size_t VertexStride,
+		std::vector<uint32>& Indices,
+		const FParams& Params
+	);
+
+	// Fills Data.LODMeshlets for the LODs with at least Params.MinTriangles triangles, the rest get no meshlets.
+	// The vertices are reordered for fetch locality after the triangles. pStats accumulates the stats if provided.
+	template<class TVertex>
+	void BuildMeshlets(GeometryData<TVertex, uint32>& Data, const FParams& Params, FStats* pStats);
+
+
+	// --------------------------------------------------------------------------------------------------------------------------------------------
+	// TEMPLATE DEFINITIONS
+	// --------------------------------------------------------------------------------------------------------------------------------------------
+	template<class TVertex>
+	void BuildMeshlets(GeometryData<TVertex, uint32>& Data, const FParams& Params, FStats* pStats)
+	{
+		Data.LODMeshlets.clear();
+		Data.LODMeshlets.resize(Data.LODVertices.size());
+		for (size_t LOD = 0; LOD < Data.LODVertices.size(); ++LOD)
+		{
+			std::vector<TVertex>& Vertices = Data.LODVertices[LOD];
+			std::vector<uint32>& Indices = Data.LODIndices[LOD];
+			if (Vertices.empty() || Indices.size() < static_cast<size_t>(Params.MinTriangles) * 3)
+				continue;
+
+			std::vector<FMeshlet>& Meshlets = Data.LODMeshlets[LOD];
+			Meshlets = BuildMeshlets(Vertices[0].position, Vertices[0].normal, Vertices.size(), sizeof(TVertex), Indices, Params);
+			Vertices = MeshOptimization::OptimizeVertexFetch(Vertices, Indices);
+
+			if (pStats)
+			{
+				pStats->NumMeshlets += Meshlets.size();
+				pStats->NumTriangles += Indices.size() / 3;
+				for (const FMeshlet& m : Meshlets)
+				{
+					pStats->NumMeshletVertices += m.NumVertices;
+					pStats->NumBackfaceCullable += m.ConeCutoff < 1.0f ? 1 : 0;
+				}
+			}
+		}
+	}
+}
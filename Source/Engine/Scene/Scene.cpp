@@ -21,6 +21,7 @@
 #include "Engine/GPUMarker.h"
 
 #include "Engine/Scene/SceneViews.h"
+#include "Engine/SceneSnapshot.h"
 #include "Engine/VQEngine.h"
 #include "Engine/Culling.h"
 #include "Renderer/Rendering/RenderPass/ObjectIDPass.h"
@@ -56,8 +57,6 @@
 
 using namespace DirectX;
 
-static MeshID LAST_USED_MESH_ID = EBuiltInMeshes::NUM_BUILTIN_MESHES;
-
 //-------------------------------------------------------------------------------
 //
 // RESOURCE MANAGEMENT
@@ -65,56 +64,127 @@ static MeshID LAST_USED_MESH_ID = EBuiltInMeshes::NUM_BUILTIN_MESHES;
 //-------------------------------------------------------------------------------
 MeshID Scene::AddMesh(Mesh&& mesh)
 {
+#if SCENE_DEDUPLICATE_MESHES
+	const uint64 GeometryHash = mesh.ComputeGeometryHash(); // outside the lock, this reads all the streams
+	const uint64 GeometrySize = mesh.GetGeometrySize();
 	std::lock_guard<std::mutex> lk(mMtx_Meshes);
-	MeshID id = LAST_USED_MESH_ID++;
-	mMeshes[id] = mesh;
-	return id;
+	++mMeshDeduplicationStats.NumAddedMeshes;
+	mMeshDeduplicationStats.NumAddedBytes += GeometrySize;
+	bool bRegisterHash = GeometryHash != 0;
+	if (GeometryHash != 0)
+	{
+		auto it = mMeshGeometryHashes.find(GeometryHash);
+		if (it != mMeshGeometryHashes.end())
+		{
+			// the hash only finds the candidate: the geometry is shared if the bytes match
+			const Mesh* pCandidate = mMeshes.Get(it->second);
+			if (pCandidate && pCandidate->HasSameGeometry(mesh))
+			{
+				mMeshDeduplicationStats.NumSharedBytes += GeometrySize;
+				return it->second; // the duplicate is dropped along with its CPU-side geometry
+			}
+			++mMeshDeduplicationStats.NumUnsharedMatches;
+			bRegisterHash = false;
+		}
+	}
+	const MeshID ID = mMeshes.Insert(std::move(mesh));
+	if (bRegisterHash)
+		mMeshGeometryHashes.emplace(GeometryHash, ID);
+	return ID;
+#else
+	std::lock_guard<std::mutex> lk(mMtx_Meshes);
+	return mMeshes.Insert(std::move(mesh));
+#endif
+}
+
+bool Scene::ClaimMeshBufferCreation(MeshID ID)
+{
+	std::lock_guard<std::mutex> lk(mMtx_Meshes);
+	return mMeshesWithBuffers.insert(ID).second;
+}
+
+Scene::FMeshDeduplicationStats Scene::GetMeshDeduplicationStats() const
+{
+	std::lock_guard<std::mutex> lk(mMtx_Meshes);
+	FMeshDeduplicationStats Stats = mMeshDeduplicationStats;
+	Stats.NumUniqueMeshes = static_cast<uint>(mMeshGeometryHashes.size()) + Stats.NumUnsharedMatches;
+	return Stats;
+}
+
+void Scene::ReleaseMeshGeometry()
+{
+#if SCENE_DEDUPLICATE_MESHES
+	SCOPED_CPU_MARKER("Scene::ReleaseMeshGeometry()");
+	std::lock_guard<std::mutex> lk(mMtx_Meshes);
+	for (Mesh& mesh : mMeshes)
+	{
+		if (mesh.GetNumLODs() > 0) // buffers created
+			mesh.ReleaseGeometry();
+	}
+#endif
 }
 
 MeshID Scene::AddMesh(const Mesh& mesh)
 {
 	std::lock_guard<std::mutex> lk(mMtx_Meshes);
-	MeshID id = LAST_USED_MESH_ID++;
-	mMeshes[id] = mesh;
-	return id;
+	return mMeshes.Insert(mesh);
 }
 
 ModelID Scene::CreateModel()
 {
 	std::unique_lock<std::mutex> lk(mMtx_Models);
-	static ModelID LAST_USED_MODEL_ID = 0;
-	ModelID id = LAST_USED_MODEL_ID++;
-	mModels[id] = Model();
-	return id;
+	return mModels.Insert(Model());
 }
 
-MaterialID Scene::CreateMaterial(const std::string& UniqueMaterialName)
+std::vector<ModelID> Scene::CreateModels(size_t NumModels)
 {
-	int iMat = -1;
-	for (auto it = mMaterialNames.begin(); it != mMaterialNames.end(); ++it)
+	SCOPED_CPU_MARKER_F("CreateModels(N=%d)", NumModels);
+	std::unique_lock<std::mutex> lk(mMtx_Models);
+	return mModels.Insert(NumModels);
+}
+
+std::vector<size_t> Scene::CreateGameObjects(size_t NumObjects)
+{
+	SCOPED_CPU_MARKER_F("CreateGameObjects(N=%d)", NumObjects);
+	std::vector<size_t> hTransforms;
 	{
-		if (it->second == UniqueMaterialName)
-		{
-			iMat = it->first;
-			break;
-		}
+		std::lock_guard<std::mutex> lk(mMtx_GameObjectTransforms);
+		hTransforms = mGameObjectTransformPool.Allocate(NumObjects);
+		mTransformHandles.insert(mTransformHandles.end(), hTransforms.begin(), hTransforms.end());
 	}
 
-	if( iMat != -1)
+	// the objects are published w/ their transform handle set, the two pools don't have to allocate in lockstep
+	std::vector<size_t> hObjects;
 	{
-#if LOG_CACHED_RESOURCES_ON_LOAD
-		Log::Info("Material already loaded: %s", UniqueMaterialName.c_str());
-#endif
-		return iMat;
+		std::lock_guard<std::mutex> lk(mMtx_GameObjects);
+		hObjects = mGameObjectPool.Allocate(NumObjects);
+		for (size_t i = 0; i < NumObjects; ++i)
+			mGameObjectPool.Get(hObjects[i])->mTransformHandle = hTransforms[i];
+		mGameObjectHandles.insert(mGameObjectHandles.end(), hObjects.begin(), hObjects.end());
 	}
+	return hObjects;
+}
+
+MaterialID Scene::CreateMaterial(const std::string& UniqueMaterialName)
+{
+	const StringID NameID = StringInterner::Intern(UniqueMaterialName);
 
 	MaterialID id = INVALID_ID;
 	// critical section
 	{
 		std::unique_lock<std::mutex> lk(mMtx_Materials);
-		id = (MaterialID)mMaterialPool.Allocate();
+		if (auto it = mMaterialIDs.find(NameID); it != mMaterialIDs.end())
+		{
+#if LOG_CACHED_RESOURCES_ON_LOAD
+			Log::Info("Material already loaded: %s", UniqueMaterialName.c_str());
+#endif
+			return it->second;
+		}
+
+		id = mMaterials.Insert(Material());
 		mLoadedMaterials.emplace(id);
-		mMaterialNames[id] = UniqueMaterialName;
+		mMaterialNames[id] = NameID;
+		mMaterialIDs[NameID] = id;
 		if (UniqueMaterialName == "")
 		{
 #if LOG_RESOURCE_CREATE
@@ -126,9 +196,6 @@ MaterialID Scene::CreateMaterial(const std::string& UniqueMaterialName)
 	Log::Info("Scene::CreateMaterial() ID=%d - %s", id, UniqueMaterialName.c_str());
 #endif
 
-	Material& mat = *mMaterialPool.Get(id);
-	mat = Material();
-
 	return id;
 }
 
@@ -222,7 +289,7 @@ const std::string& Scene::GetMaterialName(MaterialID ID) const
 	auto it = mMaterialNames.find(ID);
 	if (it != mMaterialNames.end())
 	{
-		return it->second;
+		return StringInterner::GetString(it->second);
 	}
 	return mInvalidMaterialName;
 }
@@ -232,7 +299,7 @@ const std::string& Scene::GetTexturePath(TextureID ID) const
 	auto it = mTexturePaths.find(ID);
 	if (it != mTexturePaths.end())
 	{
-		return it->second;
+		return StringInterner::GetString(it->second);
 	}
 	return mInvalidTexturePath;
 }
@@ -274,74 +341,78 @@ std::vector<Light*> Scene::GetLights()
 
 std::vector<MaterialID> Scene::GetMaterialIDs() const
 {
-	std::vector<size_t> vHandles = mMaterialPool.GetAllAliveObjectHandles();
-	std::vector<MaterialID> vIDs(vHandles.size());
-	size_t i = 0;
-	for (size_t h : vHandles)
-		vIDs[i++] = static_cast<MaterialID>(h);
-	return vIDs;
+	return mMaterials.GetAllAliveObjectHandles();
 }
 
 const Material& Scene::GetMaterial(MaterialID ID) const
 {
-	const Material* pMaterial = mMaterialPool.Get(ID);
+	const Material* pMaterial = mMaterials.Get(ID);
 	if (pMaterial == nullptr)
 	{
 		Log::Error("Material not created. Did you call Scene::CreateMaterial()? (matID=%d)", ID);
-		return *mMaterialPool.Get(0); // TODO: mDefaultMaterialID
+		pMaterial = mMaterials.Get(mDefaultMaterialID);
+		return pMaterial ? *pMaterial : mFallbackMaterial;
 	}
 	return *pMaterial;
 }
 
 Material& Scene::GetMaterial(MaterialID ID)
 {
-	Material* pMaterial = mMaterialPool.Get(ID);
+	Material* pMaterial = mMaterials.Get(ID);
 	if (pMaterial == nullptr)
 	{
 		Log::Error("Material not created. Did you call Scene::CreateMaterial()? (matID=%d)", ID);
-		return *mMaterialPool.Get(0); // TODO: mDefaultMaterialID
+		pMaterial = mMaterials.Get(mDefaultMaterialID);
+		if (pMaterial)
+			return *pMaterial;
+		mFallbackMaterial = Material(); // undo the caller's writes to the previous fallback
+		return mFallbackMaterial;
 	}
 	return *pMaterial;
 }
 
 const Mesh& Scene::GetMesh(MeshID ID) const
 {
-	if (mMeshes.find(ID) == mMeshes.end())
+	const Mesh* pMesh = mMeshes.Get(ID);
+	if (pMesh == nullptr)
 	{
 		Log::Error("Mesh not found. Did you call Scene::AddMesh()? (meshID=%d)", ID);
 		assert(false);
 	}
-	return mMeshes.at(ID);
+	return *pMesh;
 }
 
 Mesh& Scene::GetMesh(MeshID ID)
 {
-	if (mMeshes.find(ID) == mMeshes.end())
+	Mesh* pMesh = mMeshes.Get(ID);
+	if (pMesh == nullptr)
 	{
 		Log::Error("Mesh not found. Did you call Scene::AddMesh()? (meshID=%d)", ID);
 		assert(false);
 	}
-	return mMeshes.at(ID);
+	return *pMesh;
 }
 
 Model& Scene::GetModel(ModelID id)
 {
-	if (mModels.find(id) == mModels.end())
+	Model* pModel = mModels.Get(id);
+	if (pModel == nullptr)
 	{
 		Log::Error("Model not created. Did you call Scene::CreateModel()? (modelID=%d)", id);
 		assert(false);
 	}
-	return mModels.at(id);
+	return *pModel;
 }
 
 const Model& Scene::GetModel(ModelID id) const
 {
-	if (mModels.find(id) == mModels.end())
+	const Model* pModel = mModels.Get(id);
+	if (pModel == nullptr)
 	{
 		Log::Error("Model not created. Did you call Scene::CreateModel()? (modelID=%d)", id);
 		assert(false);
 	}
-	return mModels.at(id);
+	return *pModel;
 }
 
 FSceneStats Scene::GetSceneRenderStats(int FRAME_DATA_INDEX) const
@@ -389,7 +460,7 @@ FSceneStats Scene::GetSceneRenderStats(int FRAME_DATA_INDEX) const
 	
 	stats.NumMeshes    = static_cast<uint>(this->mMeshes.size());
 	stats.NumModels    = static_cast<uint>(this->mModels.size());
-	stats.NumMaterials = static_cast<uint>(this->mMaterialPool.GetAliveObjectCount());
+	stats.NumMaterials = static_cast<uint>(this->mMaterials.size());
 	stats.NumObjects   = static_cast<uint>(this->mGameObjectHandles.size());
 	stats.NumCameras   = static_cast<uint>(this->mCameras.size());
 
@@ -397,7 +468,11 @@ FSceneStats Scene::GetSceneRenderStats(int FRAME_DATA_INDEX) const
 }
 
 GameObject* Scene::GetGameObject(size_t hObject) const { return mGameObjectPool.Get(hObject); }
-Transform* Scene::GetGameObjectTransform(size_t hObject) const { return mGameObjectTransformPool.Get(hObject); }
+Transform* Scene::GetGameObjectTransform(size_t hObject) const
+{
+	const GameObject* pObj = mGameObjectPool.Get(hObject);
+	return pObj ? mGameObjectTransformPool.Get(pObj->mTransformHandle) : nullptr;
+}
 
 const Light* Scene::GetLight(Light::EMobility Mobility) const
 {
@@ -486,19 +561,36 @@ Scene::Scene(VQEngine& engine, int NumFrameBuffers, const Input& input, const st
 	, mFrameSceneViews(1)
 	, mFrameShadowViews(1)
 #endif
-	, mFrustumCullWorkerContext(mBoundingBoxHierarchy, mMeshes, mMaterialPool)
+	, mMeshes(NUM_MESH_POOL_SIZE)
+	, mModels(NUM_MODEL_POOL_SIZE)
+	, mFrustumCullWorkerContext(mBoundingBoxHierarchy, mMeshes, mMaterials)
 	, mIndex_SelectedCamera(0)
 	, mIndex_ActiveEnvironmentMapPreset(-1)
 	, mGameObjectPool(NUM_GAMEOBJECT_POOL_SIZE, GAMEOBJECT_BYTE_ALIGNMENT)
 	, mGameObjectTransformPool(NUM_GAMEOBJECT_POOL_SIZE, GAMEOBJECT_BYTE_ALIGNMENT)
-	, mMaterialPool(NUM_MATERIAL_POOL_SIZE, alignof(Material))
+	, mMaterials(NUM_MATERIAL_POOL_SIZE)
 	, mResourceNames(engine.GetResourceNames())
 	, mAssetLoader(engine.GetAssetLoader())
 	, mRenderer(renderer)
-	, mBoundingBoxHierarchy(mMeshes, mModels, mMaterialPool, mTransformHandles)
+	, mBoundingBoxHierarchy(mMeshes, mModels, mMaterials, mTransformHandles)
 	, mInvalidMaterialName("INVALID MATERIAL")
 	, mInvalidTexturePath("INVALID PATH")
-{}
+{
+	ReserveBuiltinMeshSlots();
+}
+
+// Builtin meshes are referenced by their EBuiltInMeshes value, so the first
+// NUM_BUILTIN_MESHES slots are reserved with placeholders which will be
+// filled in LoadBuiltinMeshes(). Their handles are at generation 0, so handle == enum.
+void Scene::ReserveBuiltinMeshSlots()
+{
+	assert(mMeshes.empty());
+	for (int i = 0; i < EBuiltInMeshes::NUM_BUILTIN_MESHES; ++i)
+	{
+		const MeshID id = mMeshes.Insert(Mesh());
+		assert(id == i);
+	}
+}
 
 void Scene::PreUpdate(int FRAME_DATA_INDEX, int FRAME_DATA_PREV_INDEX)
 {
@@ -590,7 +682,7 @@ static void CollectDebugVertexDrawParams(
 	const std::vector<size_t>& mSelectedObjects,
 	const Scene* pScene,
 	const ModelLookup_t& mModels,
-	const std::unordered_map<MeshID, Mesh>& mMeshes,
+	const MeshLookup_t& mMeshes,
 	const Camera& cam
 )
 {
@@ -604,8 +696,11 @@ static void CollectDebugVertexDrawParams(
 		if (!pObj)
 			continue;
 
-		const Model& m = mModels.at(pObj->mModelID);
-		NumMeshes += m.mData.GetNumMeshesOfAllTypes();
+		const Model* pModel = mModels.Get(pObj->mModelID);
+		assert(pModel);
+		if (!pModel)
+			continue;
+		NumMeshes += pModel->mData.GetNumMeshesOfAllTypes();
 	}
 	SceneDrawData.debugVertexAxesRenderParams.resize(NumMeshes);
 	
@@ -618,11 +713,19 @@ static void CollectDebugVertexDrawParams(
 		const Transform* pTf = pScene->GetGameObjectTransform(hObj);
 		assert(pTf);
 
-		const Model& m = mModels.at(pObj->mModelID);
-		for (const auto& pair : m.mData.GetMeshMaterialIDPairs(Model::Data::EMeshType::OPAQUE_MESH))
+		const Model* pModel = mModels.Get(pObj->mModelID);
+		if (!pModel)
+			continue;
+		for (const auto& pair : pModel->mData.GetMeshMaterialIDPairs(Model::Data::EMeshType::OPAQUE_MESH))
 		{
 			MeshID meshID = pair.first;
-			const Mesh& mesh = mMeshes.at(meshID);
+			const Mesh* pMesh = mMeshes.Get(meshID);
+			assert(pMesh);
+			if (!pMesh)
+				continue;
+			const Mesh& mesh = *pMesh;
+			if (GetVertexFormatOption(mesh.GetVertexFormat()) != 0)
+				continue; // the debug vertex axes PSO reads full precision vertices only
 
 			MeshRenderData_t& cmd = SceneDrawData.debugVertexAxesRenderParams[i];
 			cmd.matWorld.resize(1);
@@ -635,7 +738,8 @@ static void CollectDebugVertexDrawParams(
 			cmd.matNormal[0] = pTf->NormalMatrix(cmd.matWorld.back());
 			++i;
 		}
-	}	
+	}
+	SceneDrawData.debugVertexAxesRenderParams.resize(i);
 }
 
 
@@ -680,7 +784,7 @@ static void GatherOutlineMeshRenderData(
 			cmd.cb.matProj = matProj;
 			cmd.cb.matViewInverse = matViewInverse;
 			cmd.cb.color = SelectionColor;
-			cmd.cb.uvScaleBias = float4(mat.tiling.x, mat.tiling.y, mat.uv_bias.x, mat.uv_bias.y);
+			cmd.cb.uvScaleBias = Mesh::ComposeUVScaleBias(cmd.pMesh->GetUVScaleBias(), mat.tiling, mat.uv_bias);
 			cmd.cb.scale = 1.0f;
 			cmd.cb.heightDisplacement = mat.displacement;
 			cmds.push_back(cmd);
@@ -770,8 +874,8 @@ void Scene::PostUpdate(ThreadPool& UpdateWorkerThreadPool, const FUIState& UISta
 
 	mBoundingBoxHierarchy.Build(this, mGameObjectHandles, UpdateWorkerThreadPool);
 
-	ExtractSceneView(SceneView, mViewProjectionMatrixHistory, cam, this->mMeshes.at(EBuiltInMeshes::CUBE).GetIABufferIDs());
-	SceneView.pEnvironmentMapMesh        = &mMeshes.at((MeshID)EBuiltInMeshes::CUBE);
+	ExtractSceneView(SceneView, mViewProjectionMatrixHistory, cam, this->mMeshes.Get(EBuiltInMeshes::CUBE)->GetIABufferIDs());
+	SceneView.pEnvironmentMapMesh        = mMeshes.Get((MeshID)EBuiltInMeshes::CUBE);
 	SceneView.NumGameObjectBBRenderCmds  = (uint)(SceneView.sceneRenderOptions.bDrawGameObjectBoundingBoxes ? DIV_AND_ROUND_UP(mBoundingBoxHierarchy.mGameObjectBoundingBoxes.size(), MAX_INSTANCE_COUNT__UNLIT_SHADER) : 0);
 	SceneView.NumMeshBBRenderCmds        = (uint)(SceneView.sceneRenderOptions.bDrawMeshBoundingBoxes       ? DIV_AND_ROUND_UP(mBoundingBoxHierarchy.mMeshBoundingBoxes.size()      , MAX_INSTANCE_COUNT__UNLIT_SHADER) : 0);
 	SceneView.pGameObjectBoundingBoxList = &mBoundingBoxHierarchy.mGameObjectBoundingBoxes;
@@ -1310,6 +1414,208 @@ void Scene::CullFrustums(const FSceneView& SceneView, ThreadPool& UpdateWorkerTh
 
 
 
+//-------------------------------------------------------------------------------
+//
+// SNAPSHOT
+//
+//-------------------------------------------------------------------------------
+void Scene::CaptureSnapshot(SceneSnapshot::FSceneSnapshot& Snapshot, int FRAME_DATA_INDEX) const
+{
+	SCOPED_CPU_MARKER("Scene::CaptureSnapshot()");
+	using namespace SceneSnapshot;
+
+	Snapshot.ActiveCamera = mIndex_SelectedCamera;
+	Snapshot.Cameras.resize(mCameras.size());
+	for (size_t i = 0; i < mCameras.size(); ++i)
+	{
+		const Camera& cam = mCameras[i];
+		const FProjectionMatrixParameters& proj = cam.GetProjectionParameters();
+		const XMFLOAT3 pos = cam.GetPositionF();
+		FSnapshotCamera& snap = Snapshot.Cameras[i];
+		snap.Position[0] = pos.x;
+		snap.Position[1] = pos.y;
+		snap.Position[2] = pos.z;
+		snap.Yaw         = cam.GetYaw();
+		snap.Pitch       = cam.GetPitch();
+		snap.NearZ       = proj.NearZ;
+		snap.FarZ        = proj.FarZ;
+		snap.FieldOfView = proj.FieldOfView;
+		snap.bPerspectiveProjection = proj.bPerspectiveProjection ? 1 : 0;
+		snap.ControllerType         = static_cast<uint32>(cam.GetControllerType());
+	}
+
+	Snapshot.Lights[Light::EMobility::STATIC]     = mLightsStatic;
+	Snapshot.Lights[Light::EMobility::STATIONARY] = mLightsStationary;
+	Snapshot.Lights[Light::EMobility::DYNAMIC]    = mLightsDynamic;
+
+	Snapshot.Transforms.resize(mGameObjectHandles.size());
+	for (size_t i = 0; i < mGameObjectHandles.size(); ++i)
+	{
+		const Transform& tf = *GetGameObjectTransform(mGameObjectHandles[i]);
+		FSnapshotTransform& snap = Snapshot.Transforms[i];
+		memcpy(snap.Position, &tf._position, sizeof(snap.Position));
+		memcpy(snap.Rotation, &tf._rotation.V, sizeof(float) * 3);
+		snap.Rotation[3] = tf._rotation.S;
+		memcpy(snap.Scale, &tf._scale, sizeof(snap.Scale));
+	}
+
+	Snapshot.Materials.clear();
+	Snapshot.MaterialNames.clear();
+	Snapshot.Materials.reserve(mMaterialNames.size());
+	Snapshot.MaterialNames.reserve(mMaterialNames.size());
+	for (const auto& [MatID, NameID] : mMaterialNames)
+	{
+		const Material* pMaterial = mMaterials.Get(MatID);
+		if (!pMaterial)
+			continue;
+		Snapshot.Materials.push_back(*pMaterial);
+		Snapshot.MaterialNames.push_back(StringInterner::GetString(NameID));
+	}
+
+	const FSceneView& SceneView = GetSceneView(FRAME_DATA_INDEX);
+	const FPostProcessParameters& PPParams = GetPostProcessParameters(FRAME_DATA_INDEX);
+	FSnapshotPostProcess& PP = Snapshot.RenderSettings.PostProcess;
+	Snapshot.RenderSettings.SceneRenderOptions = SceneView.sceneRenderOptions;
+	PP.Tonemapper             = PPParams.TonemapperParams;
+	PP.VizParams              = PPParams.VizParams;
+	PP.UpscalingAlgorithm     = static_cast<int32>(PPParams.UpscalingAlgorithm);
+	PP.UpscalingQualityPreset = static_cast<int32>(PPParams.UpscalingQualityPresetEnum);
+	PP.DrawMode               = static_cast<int32>(PPParams.DrawModeEnum);
+	PP.ResolutionScale        = PPParams.ResolutionScale;
+	PP.Sharpness              = PPParams.Sharpness;
+	PP.RCASSharpnessStops     = PPParams.FSR_RCASParams.RCASSharpnessStops;
+	PP.bEnableGaussianBlur    = PPParams.bEnableGaussianBlur ? 1 : 0;
+#if !DISABLE_FIDELITYFX_CAS
+	PP.CASSharpen             = PPParams.FFXCASParams.CASSharpen;
+	PP.bEnableCAS             = PPParams.bEnableCAS ? 1 : 0;
+#endif
+}
+
+bool Scene::ApplySnapshot(const SceneSnapshot::FSceneSnapshot& Snapshot)
+{
+	SCOPED_CPU_MARKER("Scene::ApplySnapshot()");
+	using namespace SceneSnapshot;
+
+	// objects are matched by their order: a different object set means the scene has to be reloaded first
+	if (Snapshot.Transforms.size() != mGameObjectHandles.size())
+	{
+		Log::Warning("Scene snapshot has %zu objects, the scene has %zu", Snapshot.Transforms.size(), mGameObjectHandles.size());
+		return false;
+	}
+
+	// cameras: the controllers are kept, the viewport follows the window
+	const size_t NumCameras = std::min(Snapshot.Cameras.size(), mCameras.size());
+	for (size_t i = 0; i < NumCameras; ++i)
+	{
+		const FSnapshotCamera& snap = Snapshot.Cameras[i];
+		FCameraParameters param = {};
+		param.x = snap.Position[0];
+		param.y = snap.Position[1];
+		param.z = snap.Position[2];
+		param.Yaw   = snap.Yaw * RAD2DEG;
+		param.Pitch = snap.Pitch * RAD2DEG;
+		param.ProjectionParams.ViewportWidth  = static_cast<float>(mpWindow->GetWidth());
+		param.ProjectionParams.ViewportHeight = static_cast<float>(mpWindow->GetHeight());
+		param.ProjectionParams.NearZ          = snap.NearZ;
+		param.ProjectionParams.FarZ           = snap.FarZ;
+		param.ProjectionParams.FieldOfView    = snap.FieldOfView * RAD2DEG;
+		param.ProjectionParams.bPerspectiveProjection = snap.bPerspectiveProjection != 0;
+		mCameras[i].InitializeCamera(param);
+		if (snap.ControllerType < NUM_CAMERA_CONTROLLER_TYPES)
+			mCameras[i].SetControllerType(static_cast<ECameraControllerType>(snap.ControllerType));
+	}
+	if (Snapshot.Cameras.size() != mCameras.size())
+	{
+		Log::Warning("Scene snapshot has %zu cameras, the scene has %zu", Snapshot.Cameras.size(), mCameras.size());
+	}
+	if (Snapshot.ActiveCamera >= 0 && Snapshot.ActiveCamera < static_cast<int>(mCameras.size()))
+	{
+		mIndex_SelectedCamera = Snapshot.ActiveCamera;
+	}
+
+	// lights: the scene file lights stay at the front of each container, see ReloadSceneLights()
+	std::vector<Light>* pLightContainers[Light::EMobility::NUM_LIGHT_MOBILITY_TYPES] = { &mLightsStatic, &mLightsStationary, &mLightsDynamic };
+	for (int i = 0; i < Light::EMobility::NUM_LIGHT_MOBILITY_TYPES; ++i)
+	{
+		*pLightContainers[i] = Snapshot.Lights[i];
+		mNumSceneFileLights[i] = std::min(mNumSceneFileLights[i], Snapshot.Lights[i].size());
+	}
+
+	for (size_t i = 0; i < mGameObjectHandles.size(); ++i)
+	{
+		const FSnapshotTransform& snap = Snapshot.Transforms[i];
+		Transform& tf = *GetGameObjectTransform(mGameObjectHandles[i]);
+		tf._position     = XMFLOAT3(snap.Position[0], snap.Position[1], snap.Position[2]);
+		tf._rotation     = Quaternion(snap.Rotation[3], XMFLOAT3(snap.Rotation[0], snap.Rotation[1], snap.Rotation[2]));
+		tf._scale        = XMFLOAT3(snap.Scale[0], snap.Scale[1], snap.Scale[2]);
+		tf._positionPrev = tf._position;
+	}
+
+	// materials: parameters only, the textures & SRVs the scene created for them are kept
+	size_t NumMissingMaterials = 0;
+	{
+		std::lock_guard<std::mutex> lk(mMtx_Materials);
+		for (size_t i = 0; i < Snapshot.Materials.size(); ++i)
+		{
+			auto it = mMaterialIDs.find(StringInterner::Intern(Snapshot.MaterialNames[i]));
+			Material* pMaterial = it != mMaterialIDs.end() ? mMaterials.Get(it->second) : nullptr;
+			if (!pMaterial)
+			{
+				++NumMissingMaterials;
+				continue;
+			}
+			Material mat = Snapshot.Materials[i];
+			mat.SRVMaterialMaps                   = pMaterial->SRVMaterialMaps;
+			mat.SRVHeightMap                      = pMaterial->SRVHeightMap;
+			mat.TexDiffuseMap                     = pMaterial->TexDiffuseMap;
+			mat.TexNormalMap                      = pMaterial->TexNormalMap;
+			mat.TexEmissiveMap                    = pMaterial->TexEmissiveMap;
+			mat.TexAlphaMaskMap                   = pMaterial->TexAlphaMaskMap;
+			mat.TexMetallicMap                    = pMaterial->TexMetallicMap;
+			mat.TexRoughnessMap                   = pMaterial->TexRoughnessMap;
+			mat.TexOcclusionRoughnessMetalnessMap = pMaterial->TexOcclusionRoughnessMetalnessMap;
+			mat.TexAmbientOcclusionMap            = pMaterial->TexAmbientOcclusionMap;
+			mat.TexHeightMap                      = pMaterial->TexHeightMap;
+			mat.padding2                          = pMaterial->padding2;
+			*pMaterial = mat;
+		}
+	}
+	if (NumMissingMaterials)
+	{
+		Log::Warning("Scene snapshot: %zu materials not found in the scene", NumMissingMaterials);
+	}
+
+	// render options go to every frame's view so that the pipelined frames don't flip back
+	const FSnapshotPostProcess& PP = Snapshot.RenderSettings.PostProcess;
+	for (size_t i = 0; i < mFrameSceneViews.size(); ++i)
+	{
+		mFrameSceneViews[i].sceneRenderOptions = Snapshot.RenderSettings.SceneRenderOptions;
+
+		FPostProcessParameters& PPParams = mFrameSceneViews[i].postProcessParameters;
+		PPParams.TonemapperParams           = PP.Tonemapper;
+		PPParams.VizParams                  = PP.VizParams;
+		PPParams.UpscalingAlgorithm         = static_cast<FPostProcessParameters::EUpscalingAlgorithm>(PP.UpscalingAlgorithm);
+		PPParams.UpscalingQualityPresetEnum = static_cast<FPostProcessParameters::AMD_FSR1_Preset>(PP.UpscalingQualityPreset);
+		PPParams.DrawModeEnum               = static_cast<EDrawMode>(PP.DrawMode);
+		PPParams.ResolutionScale            = PP.ResolutionScale;
+		PPParams.Sharpness                  = PP.Sharpness;
+		PPParams.FSR_RCASParams.RCASSharpnessStops = PP.RCASSharpnessStops;
+		PPParams.bEnableGaussianBlur        = PP.bEnableGaussianBlur != 0;
+#if !DISABLE_FIDELITYFX_CAS
+		PPParams.FFXCASParams.CASSharpen    = PP.CASSharpen;
+		PPParams.bEnableCAS                 = PP.bEnableCAS != 0;
+#endif
+	}
+
+	// the cameras & objects jumped: no motion vectors from the previous state
+	mViewProjectionMatrixHistory.clear();
+	mSelectedObjects.clear();
+	return true;
+}
+
+
+
+
 //-------------------------------------------------------------------------------
 //
 // DRAW BATCHING
@@ -25,14 +25,20 @@
 #include "SceneBoundingBoxHierarchy.h"
 
 #include "../Core/Memory.h"
+#include "../Core/SlotMap.h"
+#include "../Core/StringInterner.h"
 #include "../AssetLoader.h"
 #include "../PostProcess/PostProcess.h"
 
 #include <algorithm>
 
 
-using MeshLookup_t = std::unordered_map<MeshID, Mesh>;
-using ModelLookup_t = std::unordered_map<ModelID, Model>;
+// Set to 0 to create a mesh for every imported occurrence of the same geometry
+#define SCENE_DEDUPLICATE_MESHES 1
+
+using MeshLookup_t = SlotMap<Mesh>;
+using ModelLookup_t = SlotMap<Model>;
+using MaterialLookup_t = SlotMap<Material>;
 
 // fwd decl
 class Input;
@@ -46,6 +52,7 @@ struct FSceneShadowViews;
 struct FShadowView;
 struct FRenderStats;
 class ThreadPool;
+namespace SceneSnapshot { struct FSceneSnapshot; }
 
 struct FSceneStats
 {
@@ -73,7 +80,24 @@ struct FSceneStats
 	uint NumCameras = 0;
 };
 
+// result of Scene::HotReload(), see SceneHotReload.cpp
+struct FSceneHotReloadStats
+{
+	uint NumObjectsAdded      = 0;
+	uint NumObjectsRemoved    = 0;
+	uint NumObjectsMoved      = 0; // transform-only changes, updated in place
+	uint NumObjectsUnchanged  = 0;
+	uint NumModelLoads        = 0; // added objects whose model isn't resident yet
+	uint NumMaterialsReloaded = 0;
+	uint NumLightsChanged     = 0;
+	bool bEnvironmentMapChanged = false;
+
+	inline bool HasChanges() const { return NumObjectsAdded || NumObjectsRemoved || NumObjectsMoved || NumMaterialsReloaded || NumLightsChanged || bEnvironmentMapChanged; }
+};
+
 constexpr size_t NUM_MATERIAL_POOL_SIZE = 1024 * 64;
+constexpr size_t NUM_MESH_POOL_SIZE = 1024 * 64;
+constexpr size_t NUM_MODEL_POOL_SIZE = 1024 * 64; // builtin mesh objects create a model per object
 constexpr size_t NUM_GAMEOBJECT_POOL_SIZE = 1024 * 64;
 constexpr size_t GAMEOBJECT_BYTE_ALIGNMENT = 64; // assumed typical cache-line size
 
@@ -92,6 +116,7 @@ class Scene
 	// Engine has easy access to the scene as scene is essentially a part of the engine.
 	friend class VQEngine;
 	friend class AssetLoader;
+	friend class AssetCache;
 
 //----------------------------------------------------------------------------------------------------------------
 // SCENE INTERFACE
@@ -130,8 +155,22 @@ private: // Derived Scenes shouldn't access these functions
 	void PostUpdate(ThreadPool& UpdateWorkerThreadPool, const FUIState& UIState, bool bAppInSimulationState, int FRAME_DATA_INDEX = 0);
 	
 	void StartLoading(FSceneRepresentation& scene, ThreadPool& UpdateWorkerThreadPool);
+	void AssignLoadedModels(); // polled while loading & after hot-reloads: hands the finished models to their game objects
 	void OnLoadComplete(const BuiltinMeshArray_t& builtinMeshes);
-	void Unload(); // serial-only for now. maybe MT later.
+	void Unload(ThreadPool* pWorkerThreadPool = nullptr, bool bKeepEnvironmentMap = false); // meshes & models are torn down on the workers if a pool is provided
+	
+	// Diffs the re-parsed scene file against the loaded one and only touches the objects, materials & lights that changed.
+	// Unchanged elements, resident models & textures are kept. The caller is expected to have synced w/ the render thread.
+	FSceneHotReloadStats HotReload(FSceneRepresentation& NewSceneRep, ThreadPool& UpdateWorkerThreadPool);
+	inline bool HasPendingModelLoads() const { return !mModelLoadResults.empty(); }
+	// The imported meshes keep their CPU-side geometry after their buffers are created so that AddMesh() can compare
+	// the bytes of deduplication candidates. Called once no model loads are in flight, later matches aren't shared.
+	void ReleaseMeshGeometry();
+
+	// Snapshot objects are matched w/ mGameObjectHandles by order, materials by name. ApplySnapshot() returns false
+	// w/o touching the scene if the object count differs. The caller is expected to have synced w/ the render thread.
+	void CaptureSnapshot(SceneSnapshot::FSceneSnapshot& Snapshot, int FRAME_DATA_INDEX) const;
+	bool ApplySnapshot(const SceneSnapshot::FSceneSnapshot& Snapshot);
 	
 	void RenderUI(FUIState& UIState, uint32_t W, uint32_t H);
 	void HandleInput(FSceneView& SceneView);
@@ -148,9 +187,10 @@ private: // Derived Scenes shouldn't access these functions
 	void GatherFrustumCullParameters(FSceneView& SceneView, FSceneShadowViews& SceneShadowView, ThreadPool& UpdateWorkerThreadPool);
 	void CullFrustums(const FSceneView& SceneView, ThreadPool& UpdateWorkerThreadPool);
 
-	void BuildGameObject(const FGameObjectRepresentation& rep, size_t iObj);
+	void BuildGameObject(const FGameObjectRepresentation& rep, size_t hObj, ModelID mID, MeshID meshID, MaterialID matID);
 	
 	void LoadBuiltinMaterials(TaskID taskID, const std::vector<FGameObjectRepresentation>& GameObjsToBeLoaded);
+	void ReserveBuiltinMeshSlots();
 	void LoadBuiltinMeshes(const BuiltinMeshArray_t& builtinMeshes);
 	void LoadGameObjects(std::vector<FGameObjectRepresentation>&& GameObjects, ThreadPool& WorkerThreadPool); // TODO: consider using FSceneRepresentation as the parameter and read the corresponding member
 	void LoadSceneMaterials(const std::vector<FMaterialRepresentation>& Materials, TaskID taskID);
@@ -158,7 +198,12 @@ private: // Derived Scenes shouldn't access these functions
 	void LoadCameras(std::vector<FCameraParameters>& CameraParams);
 	void LoadPostProcessSettings();
 
+	void ReloadSceneMaterials(const std::vector<FMaterialRepresentation>& Materials, const std::vector<FGameObjectRepresentation>& AddedObjects);
+	void ReloadSceneLights(const std::vector<Light>& SceneLights);
+	void RemoveGameObjects(const std::vector<size_t>& hObjects);
+
 	void CalculateGameObjectLocalSpaceBoundingBoxes();
+	void CalculateGameObjectLocalSpaceBoundingBox(GameObject* pGameObj);
 
 public:
 	Scene(VQEngine& engine
@@ -187,9 +232,26 @@ public:
 	//----------------------------------------------------------------------------------------------------------------
 	//TransformID CreateTransform(Transform** ppTransform);
 	//GameObject* CreateObject(TransformID tfID, ModelID modelID);
+	// returns the MeshID of an identical mesh added earlier in the scene load if there's one (SCENE_DEDUPLICATE_MESHES)
 	MeshID      AddMesh(Mesh&& mesh);
 	MeshID      AddMesh(const Mesh& mesh);
+	// deduplicated meshes are shared by models: returns true for the first caller only, who creates the buffers
+	bool        ClaimMeshBufferCreation(MeshID ID);
+	struct FMeshDeduplicationStats
+	{
+		uint   NumAddedMeshes  = 0; // AddMesh() calls
+		uint   NumUniqueMeshes = 0;
+		uint64 NumAddedBytes   = 0; // vertex + index bytes of all the added meshes
+		uint64 NumSharedBytes  = 0; // ... of the meshes replaced by an identical one
+		uint   NumUnsharedMatches = 0; // hash matches w/ different bytes, or w/ a candidate whose geometry was already released
+	};
+	FMeshDeduplicationStats GetMeshDeduplicationStats() const;
 	ModelID     CreateModel();
+	
+	// Batched creation: reserves all the objects at once, taking the container lock(s) a single time.
+	// Game objects are created along with their transforms, use GetGameObjectTransform(hObj) to access.
+	std::vector<size_t>  CreateGameObjects(size_t NumObjects);
+	std::vector<ModelID> CreateModels(size_t NumModels);
 	MaterialID  CreateMaterial(const std::string& UniqueMaterialName);
 	MaterialID  LoadMaterial(const FMaterialRepresentation& matRep, TaskID taskID);
 	int         CreateLight(Light::EType eType = Light::EType::POINT, Light::EMobility Mobility = Light::EMobility::DYNAMIC);
@@ -245,8 +307,8 @@ protected:
 	//
 	// SCENE ELEMENT CONTAINERS
 	//
-	std::unordered_map<MeshID, Mesh>         mMeshes;
-	std::unordered_map<ModelID, Model>       mModels;
+	MeshLookup_t                             mMeshes; // [0, NUM_BUILTIN_MESHES) are reserved for EBuiltInMeshes
+	ModelLookup_t                            mModels;
 	std::vector<size_t>                      mGameObjectHandles;
 	std::vector<size_t>                      mTransformHandles;
 	std::vector<Camera>                      mCameras;
@@ -307,23 +369,35 @@ protected:
 private:
 	MemoryPool<GameObject> mGameObjectPool;
 	MemoryPool<Transform>  mGameObjectTransformPool;
-	MemoryPool<Material>   mMaterialPool;
+	MaterialLookup_t       mMaterials;
 
 	std::mutex mMtx_GameObjects;
 	std::mutex mMtx_GameObjectTransforms;
-	std::mutex mMtx_Meshes;
+	mutable std::mutex mMtx_Meshes;
 	std::mutex mMtx_Models;
 	std::mutex mMtx_Materials;
 
 	AssetLoader::ModelLoadResults_t          mModelLoadResults;
 	AssetLoader::FMaterialTextureAssignments mMaterialAssignments;
+	uint64                                   mLoadTraceBeginTimestamp = 0; // Trace::GetTimestamp() @ StartLoading()
+
+	// hot-reload: elements created from the scene file, as opposed to the ones the derived scene adds
+	std::vector<size_t> mSceneFileObjectHandles; // [i] is created from mSceneRepresentation.Objects[i]
+	size_t              mNumSceneFileLights[Light::EMobility::NUM_LIGHT_MOBILITY_TYPES] = {}; // front of each light container
 	
+	// mesh deduplication, see AddMesh()
+	std::unordered_map<uint64, MeshID> mMeshGeometryHashes; // Mesh::ComputeGeometryHash() -> MeshID
+	std::unordered_set<MeshID>         mMeshesWithBuffers;
+	FMeshDeduplicationStats            mMeshDeduplicationStats;
+
 	// cache
 	std::unordered_set<MaterialID> mLoadedMaterials;
-	std::unordered_map<MaterialID, std::string> mMaterialNames;
-	std::unordered_map<TextureID, std::string> mTexturePaths;
+	std::unordered_map<MaterialID, StringID> mMaterialNames;
+	std::unordered_map<StringID, MaterialID> mMaterialIDs; // reverse of mMaterialNames, see CreateMaterial()
+	std::unordered_map<TextureID, StringID> mTexturePaths;
 	std::mutex mMtxTexturePaths;
 
 	const std::string mInvalidMaterialName;
 	const std::string mInvalidTexturePath;
+	Material          mFallbackMaterial; // GetMaterial() of a stale ID w/o a default material, reset on each use
 };
@@ -23,15 +23,16 @@
 #include "Transform.h"
 #include "GameObject.h"
 #include "../Core/Memory.h"
+#include "../Core/SlotMap.h"
 
 // For the time being, this is simply a flat list of bounding boxes -- there is not much of a hierarchy to speak of.
 class SceneBoundingBoxHierarchy
 {
 public:
 	SceneBoundingBoxHierarchy(
-		  const std::unordered_map<MeshID, Mesh>& Meshes
-		, const std::unordered_map<ModelID, Model>& Models
-		, const MemoryPool<Material>& Materials
+		  const SlotMap<Mesh>& Meshes
+		, const SlotMap<Model>& Models
+		, const SlotMap<Material>& Materials
 		, const std::vector<size_t>& TransformHandles
 	)
 		: mMeshes(Meshes)
@@ -89,8 +90,8 @@ private:
 	//------------------------------------------------------
 
 	// scene data container references
-	const std::unordered_map<MeshID, Mesh>& mMeshes;
-	const std::unordered_map<ModelID, Model>& mModels;
-	const MemoryPool<Material>& mMaterials;
+	const SlotMap<Mesh>& mMeshes;
+	const SlotMap<Model>& mModels;
+	const SlotMap<Material>& mMaterials;
 	const std::vector<size_t>& mTransformHandles;
 };
\ No newline at end of file
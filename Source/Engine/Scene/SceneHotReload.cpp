@@ -0,0 +1,416 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+
+#include "Scene.h"
+#include "Engine/Core/Window.h"
+#include "Engine/GPUMarker.h"
+
+#include "Renderer/Renderer.h"
+
+#include "Libs/VQUtils/Include/utils.h"
+#include "Libs/VQUtils/Include/Timer.h"
+
+#include <deque>
+#include <cstddef>
+#include <cstring>
+
+//
+// SCENE HOT-RELOAD
+//
+// The re-parsed scene file is diffed against mSceneRepresentation, which holds the scene file as it
+// was loaded (the derived scene's additions aren't part of it):
+//
+//  - Materials are matched by name, the new & changed ones are re-applied in place: their IDs & SRVs stay the same.
+//    The textures are requested by path, TextureManager returns the resident ones w/o loading them again.
+//  - Objects are matched by model/mesh & material in the order of appearance: a transform change is applied
+//    in place, everything else is a remove + add. Added objects reuse the resident models of the same file,
+//    the rest are loaded in the background & assigned by AssignLoadedModels().
+//  - Lights are compared by value, the scene file lights are replaced altogether if any of them changed.
+//  - Cameras are left alone so that the view doesn't jump around while editing.
+//
+// Removed materials and models stay resident until the scene is unloaded.
+//
+using namespace DirectX;
+
+static bool IsSameTransform(const Transform& a, const Transform& b)
+{
+	return memcmp(&a._position, &b._position, sizeof(a._position)) == 0
+		&& memcmp(&a._rotation, &b._rotation, sizeof(a._rotation)) == 0
+		&& memcmp(&a._scale   , &b._scale   , sizeof(a._scale   )) == 0;
+}
+
+static bool IsSameMaterial(const FMaterialRepresentation& a, const FMaterialRepresentation& b)
+{
+	// TessellationParams is padded to 16 bytes, compare up to its last member
+	constexpr size_t SZ_TESSELLATION_PARAMS = offsetof(VQ_SHADER_DATA::TessellationParams, bFrustumCull_FaceCull_AdaptiveTessellation) + sizeof(int);
+	return memcmp(&a.DiffuseColor , &b.DiffuseColor , sizeof(XMFLOAT3)) == 0
+		&& memcmp(&a.EmissiveColor, &b.EmissiveColor, sizeof(XMFLOAT3)) == 0
+		&& a.Alpha                      == b.Alpha
+		&& a.EmissiveIntensity          == b.EmissiveIntensity
+		&& a.Metalness                  == b.Metalness
+		&& a.Roughness                  == b.Roughness
+		&& a.Displacement               == b.Displacement
+		&& a.TilingX                    == b.TilingX
+		&& a.TilingY                    == b.TilingY
+		&& memcmp(&a.Tessellation, &b.Tessellation, SZ_TESSELLATION_PARAMS) == 0
+		&& a.TessellationDomain         == b.TessellationDomain
+		&& a.TessellationOutputTopology == b.TessellationOutputTopology
+		&& a.TessellationPartitioning   == b.TessellationPartitioning
+		&& a.TessellationEnabled        == b.TessellationEnabled
+		&& a.DiffuseMapFilePath         == b.DiffuseMapFilePath
+		&& a.NormalMapFilePath          == b.NormalMapFilePath
+		&& a.EmissiveMapFilePath        == b.EmissiveMapFilePath
+		&& a.AlphaMaskMapFilePath       == b.AlphaMaskMapFilePath
+		&& a.MetallicMapFilePath        == b.MetallicMapFilePath
+		&& a.RoughnessMapFilePath       == b.RoughnessMapFilePath
+		&& a.AOMapFilePath              == b.AOMapFilePath
+		&& a.HeightMapFilePath          == b.HeightMapFilePath;
+}
+
+static bool IsSameLight(const Light& a, const Light& b)
+{
+	// field by field: Light has padding between its members
+	return memcmp(&a.Position          , &b.Position          , sizeof(a.Position          )) == 0
+		&& memcmp(&a.RotationQuaternion, &b.RotationQuaternion, sizeof(a.RotationQuaternion)) == 0
+		&& memcmp(&a.RenderScale       , &b.RenderScale       , sizeof(a.RenderScale       )) == 0
+		&& memcmp(&a.Color             , &b.Color             , sizeof(a.Color             )) == 0
+		&& memcmp(&a.ShadowData        , &b.ShadowData        , sizeof(a.ShadowData        )) == 0
+		&& memcmp(&a.ViewportX         , &b.ViewportX         , sizeof(float) * 3          ) == 0 // light-specific data
+		&& a.Range           == b.Range
+		&& a.Brightness      == b.Brightness
+		&& a.bEnabled        == b.bEnabled
+		&& a.bCastingShadows == b.bCastingShadows
+		&& a.Mobility        == b.Mobility
+		&& a.Type            == b.Type;
+}
+
+static std::string GetObjectKey(const FGameObjectRepresentation& ObjRep)
+{
+	return ObjRep.ModelFilePath + '|' + ObjRep.ModelName + '|' + ObjRep.BuiltinMeshName + '|' + ObjRep.MaterialName;
+}
+
+
+FSceneHotReloadStats Scene::HotReload(FSceneRepresentation& NewSceneRep, ThreadPool& UpdateWorkerThreadPool)
+{
+	SCOPED_CPU_MARKER("Scene.HotReload");
+	const FSceneRepresentation& OldSceneRep = mSceneRepresentation;
+	assert(OldSceneRep.Objects.size() == mSceneFileObjectHandles.size());
+
+	FSceneHotReloadStats Stats;
+	Timer t; t.Start();
+
+	//
+	// DIFF
+	//
+	std::vector<FMaterialRepresentation> ChangedMaterials;
+	std::unordered_set<std::string> ChangedMaterialNames;
+	{
+		SCOPED_CPU_MARKER("DiffMaterials");
+		std::unordered_map<std::string, const FMaterialRepresentation*> OldMaterials;
+		for (const FMaterialRepresentation& matRep : OldSceneRep.Materials)
+			OldMaterials[matRep.Name] = &matRep;
+
+		for (const FMaterialRepresentation& matRep : NewSceneRep.Materials)
+		{
+			auto it = OldMaterials.find(matRep.Name);
+			if (it != OldMaterials.end() && IsSameMaterial(*it->second, matRep))
+				continue;
+			ChangedMaterials.push_back(matRep);
+			ChangedMaterialNames.insert(matRep.Name);
+		}
+	}
+
+	std::vector<size_t> hNewSceneFileObjects(NewSceneRep.Objects.size(), INVALID_ID);
+	std::vector<size_t> iAddedObjects; // into NewSceneRep.Objects
+	std::vector<size_t> hRemovedObjects;
+	std::vector<std::pair<size_t, size_t>> MovedObjects; // <hObj, index into NewSceneRep.Objects>
+	{
+		SCOPED_CPU_MARKER("DiffObjects");
+		std::unordered_map<std::string, std::deque<size_t>> OldObjectsByKey; // -> indices into OldSceneRep.Objects
+		for (size_t i = 0; i < OldSceneRep.Objects.size(); ++i)
+			OldObjectsByKey[GetObjectKey(OldSceneRep.Objects[i])].push_back(i);
+
+		for (size_t i = 0; i < NewSceneRep.Objects.size(); ++i)
+		{
+			const FGameObjectRepresentation& ObjRep = NewSceneRep.Objects[i];
+
+			// builtin mesh models are built w/ the alpha mode of their material, see BuildGameObject()
+			const bool bRebuild = !ObjRep.BuiltinMeshName.empty() && ChangedMaterialNames.count(ObjRep.MaterialName) != 0;
+
+			auto it = OldObjectsByKey.find(GetObjectKey(ObjRep));
+			if (bRebuild || it == OldObjectsByKey.end() || it->second.empty())
+			{
+				iAddedObjects.push_back(i);
+				continue;
+			}
+
+			const size_t iOld = it->second.front();
+			it->second.pop_front();
+			hNewSceneFileObjects[i] = mSceneFileObjectHandles[iOld];
+
+			if (IsSameTransform(OldSceneRep.Objects[iOld].tf, ObjRep.tf))
+				++Stats.NumObjectsUnchanged;
+			else
+				MovedObjects.push_back({ mSceneFileObjectHandles[iOld], i });
+		}
+
+		for (const auto& [Key, iOldObjects] : OldObjectsByKey)
+		{
+			for (size_t iOld : iOldObjects)
+				hRemovedObjects.push_back(mSceneFileObjectHandles[iOld]);
+		}
+	}
+
+	size_t NumChangedLights = 0;
+	for (size_t i = 0; i < NewSceneRep.Lights.size(); ++i)
+	{
+		if (i >= OldSceneRep.Lights.size() || !IsSameLight(OldSceneRep.Lights[i], NewSceneRep.Lights[i]))
+			++NumChangedLights;
+	}
+	if (OldSceneRep.Lights.size() > NewSceneRep.Lights.size())
+		NumChangedLights += OldSceneRep.Lights.size() - NewSceneRep.Lights.size();
+
+	Stats.NumObjectsAdded        = static_cast<uint>(iAddedObjects.size());
+	Stats.NumObjectsRemoved      = static_cast<uint>(hRemovedObjects.size());
+	Stats.NumObjectsMoved        = static_cast<uint>(MovedObjects.size());
+	Stats.NumMaterialsReloaded   = static_cast<uint>(ChangedMaterials.size());
+	Stats.NumLightsChanged       = static_cast<uint>(NumChangedLights);
+	Stats.bEnvironmentMapChanged = OldSceneRep.EnvironmentMapPreset != NewSceneRep.EnvironmentMapPreset;
+	if (!Stats.HasChanges())
+	{
+		return Stats;
+	}
+
+	//
+	// APPLY
+	//
+	// the GPU may still be reading the material descriptors & models of the last frames
+	if (!ChangedMaterials.empty() || !hRemovedObjects.empty())
+	{
+		SCOPED_CPU_MARKER("WaitForGPU");
+		mRenderer.GetWindowSwapChain(mpWindow->GetHWND()).WaitForGPU();
+	}
+
+	// collect the resident models before the removed objects are gone
+	std::unordered_map<std::string, ModelID> ResidentModels; // ModelFilePath -> ModelID
+	for (size_t i = 0; i < OldSceneRep.Objects.size(); ++i)
+	{
+		const FGameObjectRepresentation& ObjRep = OldSceneRep.Objects[i];
+		const GameObject* pObj = mGameObjectPool.Get(mSceneFileObjectHandles[i]);
+		if (!ObjRep.ModelFilePath.empty() && pObj->mModelID != INVALID_ID)
+			ResidentModels.emplace(ObjRep.ModelFilePath, pObj->mModelID);
+	}
+
+	std::vector<FGameObjectRepresentation> AddedObjects;
+	AddedObjects.reserve(iAddedObjects.size());
+	for (size_t i : iAddedObjects)
+		AddedObjects.push_back(NewSceneRep.Objects[i]);
+
+	// materials first: builtin mesh objects read them when they're built
+	if (!ChangedMaterials.empty() || !AddedObjects.empty())
+	{
+		ReloadSceneMaterials(ChangedMaterials, AddedObjects);
+	}
+
+	RemoveGameObjects(hRemovedObjects);
+
+	for (const auto& [hObj, iObj] : MovedObjects)
+	{
+		*GetGameObjectTransform(hObj) = NewSceneRep.Objects[iObj].tf;
+	}
+
+	if (!iAddedObjects.empty())
+	{
+		SCOPED_CPU_MARKER("AddObjects");
+		std::vector<size_t> iObjectsWithResidentModel;
+		std::vector<size_t> iObjectsToLoad;
+		std::vector<FGameObjectRepresentation> ObjectsToLoad;
+		for (size_t i : iAddedObjects)
+		{
+			const FGameObjectRepresentation& ObjRep = NewSceneRep.Objects[i];
+			if (!ObjRep.ModelFilePath.empty() && ResidentModels.find(ObjRep.ModelFilePath) != ResidentModels.end())
+			{
+				iObjectsWithResidentModel.push_back(i);
+				continue;
+			}
+			iObjectsToLoad.push_back(i);
+			ObjectsToLoad.push_back(ObjRep);
+			if (!ObjRep.ModelFilePath.empty())
+				++Stats.NumModelLoads;
+		}
+
+		if (!iObjectsWithResidentModel.empty())
+		{
+			const std::vector<size_t> hObjects = CreateGameObjects(iObjectsWithResidentModel.size());
+			for (size_t j = 0; j < hObjects.size(); ++j)
+			{
+				const FGameObjectRepresentation& ObjRep = NewSceneRep.Objects[iObjectsWithResidentModel[j]];
+				GameObject* pObj = mGameObjectPool.Get(hObjects[j]);
+				pObj->mModelID = ResidentModels.at(ObjRep.ModelFilePath);
+				*mGameObjectTransformPool.Get(pObj->mTransformHandle) = ObjRep.tf;
+				CalculateGameObjectLocalSpaceBoundingBox(pObj);
+				hNewSceneFileObjects[iObjectsWithResidentModel[j]] = hObjects[j];
+			}
+		}
+
+		if (!ObjectsToLoad.empty())
+		{
+			const size_t iFirstObject = mGameObjectHandles.size();
+			LoadGameObjects(std::move(ObjectsToLoad), UpdateWorkerThreadPool);
+			for (size_t j = 0; j < iObjectsToLoad.size(); ++j)
+			{
+				const size_t hObj = mGameObjectHandles[iFirstObject + j];
+				hNewSceneFileObjects[iObjectsToLoad[j]] = hObj;
+
+				// builtin mesh objects are ready, the model objects get their bounds in AssignLoadedModels()
+				if (!NewSceneRep.Objects[iObjectsToLoad[j]].BuiltinMeshName.empty())
+					CalculateGameObjectLocalSpaceBoundingBox(mGameObjectPool.Get(hObj));
+			}
+		}
+	}
+
+	if (NumChangedLights > 0)
+	{
+		ReloadSceneLights(NewSceneRep.Lights);
+	}
+
+	// the new representation becomes the baseline for the next reload
+	const char loadSuccess = mSceneRepresentation.loadSuccess;
+	mSceneRepresentation = std::move(NewSceneRep);
+	mSceneRepresentation.loadSuccess = loadSuccess;
+	mSceneFileObjectHandles = std::move(hNewSceneFileObjects);
+
+	Log::Info("[Scene] Hot-reloaded %s in %.2fms: Objects +%u -%u ~%u (%u unchanged, %u model loads) | Materials %u | Lights %u%s"
+		, mSceneRepresentation.SceneName.c_str()
+		, t.Tick() * 1000.0f
+		, Stats.NumObjectsAdded, Stats.NumObjectsRemoved, Stats.NumObjectsMoved, Stats.NumObjectsUnchanged, Stats.NumModelLoads
+		, Stats.NumMaterialsReloaded
+		, Stats.NumLightsChanged
+		, Stats.bEnvironmentMapChanged ? " | EnvironmentMap" : ""
+	);
+	return Stats;
+}
+
+void Scene::ReloadSceneMaterials(const std::vector<FMaterialRepresentation>& Materials, const std::vector<FGameObjectRepresentation>& AddedObjects)
+{
+	SCOPED_CPU_MARKER("Scene::ReloadSceneMaterials()");
+	const TaskID taskID = AssetLoader::GenerateModelLoadTaskID();
+
+	// builtin materials the added objects reference for the first time
+	{
+		std::vector<FGameObjectRepresentation> ObjectsWithNewMaterials;
+		for (const FGameObjectRepresentation& ObjRep : AddedObjects)
+		{
+			if (mMaterialIDs.find(StringInterner::Intern(ObjRep.MaterialName)) == mMaterialIDs.end())
+				ObjectsWithNewMaterials.push_back(ObjRep);
+		}
+		if (!ObjectsWithNewMaterials.empty())
+			LoadBuiltinMaterials(taskID, ObjectsWithNewMaterials);
+	}
+
+	// reset the changed materials to defaults, keeping their descriptors, and apply the new representation
+	for (const FMaterialRepresentation& matRep : Materials)
+	{
+		Material& mat = this->GetMaterial(this->CreateMaterial(matRep.Name));
+		const SRV_ID SRVMaterialMaps = mat.SRVMaterialMaps;
+		const SRV_ID SRVHeightMap = mat.SRVHeightMap;
+		mat = Material();
+		mat.SRVMaterialMaps = SRVMaterialMaps;
+		mat.SRVHeightMap = SRVHeightMap;
+
+		this->LoadMaterial(matRep, taskID);
+	}
+
+	if (mMaterialAssignments.mAssignments.empty())
+		return;
+
+	for (AssetLoader::FMaterialTextureAssignment& Assignment : mMaterialAssignments.mAssignments)
+		Assignment.bReinitializeSRVs = true;
+
+	mMaterialAssignments.mTextureLoadResults = mAssetLoader.StartLoadingTextures(taskID);
+	mMaterialAssignments.DoAssignments(this, this->mMtxTexturePaths, this->mTexturePaths, &mRenderer);
+	mMaterialAssignments = {};
+}
+
+void Scene::ReloadSceneLights(const std::vector<Light>& SceneLights)
+{
+	SCOPED_CPU_MARKER("Scene::ReloadSceneLights()");
+	std::vector<Light>* pLightContainers[Light::EMobility::NUM_LIGHT_MOBILITY_TYPES] = { &mLightsStatic, &mLightsStationary, &mLightsDynamic };
+
+	std::vector<Light> SceneFileLights[Light::EMobility::NUM_LIGHT_MOBILITY_TYPES];
+	for (const Light& l : SceneLights)
+	{
+		const bool bValidMobility = l.Mobility < Light::EMobility::NUM_LIGHT_MOBILITY_TYPES;
+		if (!bValidMobility)
+			Log::Warning("Invalid light mobility!");
+		SceneFileLights[bValidMobility ? l.Mobility : Light::EMobility::STATIONARY].push_back(l); // see LoadLights()
+	}
+
+	// the scene file lights are at the front of each container, followed by the derived scene's lights
+	for (int i = 0; i < Light::EMobility::NUM_LIGHT_MOBILITY_TYPES; ++i)
+	{
+		std::vector<Light>& Lights = *pLightContainers[i];
+		const size_t NumSceneFileLights = std::min(mNumSceneFileLights[i], Lights.size());
+		Lights.erase(Lights.begin(), Lights.begin() + NumSceneFileLights);
+		Lights.insert(Lights.begin(), SceneFileLights[i].begin(), SceneFileLights[i].end());
+		mNumSceneFileLights[i] = SceneFileLights[i].size();
+	}
+}
+
+void Scene::RemoveGameObjects(const std::vector<size_t>& hObjects)
+{
+	SCOPED_CPU_MARKER("Scene::RemoveGameObjects()");
+	if (hObjects.empty())
+		return;
+
+	const std::unordered_set<size_t> hRemovedObjects(hObjects.begin(), hObjects.end());
+	auto fnIsRemoved = [&hRemovedObjects](size_t h) { return hRemovedObjects.find(h) != hRemovedObjects.end(); };
+
+	std::vector<size_t> hTransforms;
+	hTransforms.reserve(hObjects.size());
+	for (size_t hObj : hObjects)
+	{
+		GameObject* pObj = mGameObjectPool.Get(hObj);
+		hTransforms.push_back(pObj->mTransformHandle);
+
+		// the model may still be loading: the load task doesn't reference the object, just drop the result
+		mModelLoadResults.erase(pObj);
+
+		// builtin mesh objects own their model, the models loaded from files are shared w/ other objects
+		const Model* pModel = mModels.Get(pObj->mModelID);
+		assert(pModel || pObj->mModelID == INVALID_ID);
+		if (pModel && pModel->mModelPath.empty())
+		{
+			std::lock_guard<std::mutex> lk(mMtx_Models);
+			mModels.Remove(pObj->mModelID);
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lk(mMtx_GameObjects);
+		mGameObjectPool.Free(hObjects);
+		mGameObjectHandles.erase(std::remove_if(mGameObjectHandles.begin(), mGameObjectHandles.end(), fnIsRemoved), mGameObjectHandles.end());
+	}
+	{
+		const std::unordered_set<size_t> hRemovedTransforms(hTransforms.begin(), hTransforms.end());
+		std::lock_guard<std::mutex> lk(mMtx_GameObjectTransforms);
+		mGameObjectTransformPool.Free(hTransforms);
+		mTransformHandles.erase(std::remove_if(mTransformHandles.begin(), mTransformHandles.end(), [&hRemovedTransforms](size_t h) { return hRemovedTransforms.find(h) != hRemovedTransforms.end(); }), mTransformHandles.end());
+	}
+	mSelectedObjects.erase(std::remove_if(mSelectedObjects.begin(), mSelectedObjects.end(), fnIsRemoved), mSelectedObjects.end());
+}
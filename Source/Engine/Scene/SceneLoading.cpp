@@ -19,14 +19,18 @@
 #include "Engine/Scene/SceneViews.h"
 #include "Engine/Core/Window.h"
 #include "Engine/Core/FileParser.h"
+#include "Engine/Core/MemoryTracking.h"
+#include "Engine/Core/VirtualFileSystem.h"
 #include "Engine/VQEngine.h"
 #include "Engine/GPUMarker.h"
 
 #include "Renderer/Renderer.h"
 
 #include "Libs/VQUtils/Include/utils.h"
+#include "Libs/VQUtils/Include/Timer.h"
 
 #include <fstream>
+#include <algorithm>
 
 #define LOG_CACHED_RESOURCES_ON_LOAD 0
 #define LOG_RESOURCE_CREATE          1
@@ -47,7 +51,7 @@ MaterialID Scene::LoadMaterial(const FMaterialRepresentation& matRep, TaskID tas
 
 		AssetLoader::FTextureLoadParams p = {};
 		p.MatID = matID;
-		p.TexturePath = path;
+		p.TexturePath = StringInterner::Intern(path);
 		p.TexType = type;
 		mAssetLoader.QueueTextureLoad(taskID, p);
 		return true;
@@ -101,6 +105,9 @@ void Scene::StartLoading(FSceneRepresentation& sceneRep, ThreadPool& UpdateWorke
 {
 	SCOPED_CPU_MARKER("SceneStartLoading");
 
+	mAssetLoader.mLoadTimeline.Reset();
+	mLoadTraceBeginTimestamp = Trace::GetTimestamp();
+
 	const TaskID taskID = AssetLoader::GenerateModelLoadTaskID();
 	LoadBuiltinMaterials(taskID, sceneRep.Objects);
 	
@@ -133,7 +140,17 @@ void Scene::StartLoading(FSceneRepresentation& sceneRep, ThreadPool& UpdateWorke
 	}
 	mFrustumCullWorkerContext.ClearMemory();
 
+	// the scene file elements come first, the derived scene appends its own in LoadScene(): keep track of them for HotReload()
+	for (const Light& l : mSceneRepresentation.Lights)
+	{
+		++mNumSceneFileLights[l.Mobility < Light::EMobility::NUM_LIGHT_MOBILITY_TYPES ? l.Mobility : Light::EMobility::STATIONARY]; // see LoadLights()
+	}
+	const size_t iFirstObject = mGameObjectHandles.size();
+
 	LoadGameObjects(std::move(sceneRep.Objects), UpdateWorkerThreadPool);
+
+	const auto itFirstObject = mGameObjectHandles.begin() + iFirstObject;
+	mSceneFileObjectHandles.assign(itFirstObject, itFirstObject + mSceneRepresentation.Objects.size());
 }
 
 
@@ -143,7 +160,7 @@ void Scene::LoadBuiltinMaterials(TaskID taskID, const std::vector<FGameObjectRep
 	SCOPED_CPU_MARKER("Scene.LoadBuiltinMaterials()");
 
 	const char* STR_MATERIALS_FOLDER = "Data/Materials/";
-	auto vMatFiles = DirectoryUtil::ListFilesInDirectory(STR_MATERIALS_FOLDER, "xml");
+	auto vMatFiles = VFS::ListFiles(STR_MATERIALS_FOLDER, "xml");
 
 	// Parse builtin materials and build material map
 	std::unordered_map<std::string, FMaterialRepresentation> MaterialMap;
@@ -191,11 +208,11 @@ void Scene::LoadBuiltinMeshes(const BuiltinMeshArray_t& builtinMeshes)
 	SCOPED_CPU_MARKER("Scene.LoadBuiltinMeshes()");
 
 	// register builtin meshes to scene mesh lookup
-	// @mMeshes[0-NUM_BUILTIN_MESHES] are assigned here directly while the rest
-	// of the meshes used in the scene must use this->AddMesh(Mesh&&) interface;
+	// @mMeshes[0-NUM_BUILTIN_MESHES] are assigned here directly into the slots reserved 
+	// on construction while the rest of the meshes used in the scene must use this->AddMesh(Mesh&&) interface;
 	for (size_t i = 0; i < builtinMeshes.size(); ++i)
 	{
-		this->mMeshes[(int)i] = builtinMeshes[i];
+		*this->mMeshes.Get((MeshID)i) = builtinMeshes[i];
 	}
 
 	// register builtin materials 
@@ -205,17 +222,19 @@ void Scene::LoadBuiltinMeshes(const BuiltinMeshArray_t& builtinMeshes)
 	}
 }
 
-// multi threaded code
-void Scene::BuildGameObject(const FGameObjectRepresentation& ObjRep, size_t iObj)
+// multi threaded code: 
+// the object, its transform and model (for builtin meshes) are already reserved, 
+// and mesh/material references resolved in LoadGameObjects() so no locks are taken here.
+void Scene::BuildGameObject(const FGameObjectRepresentation& ObjRep, size_t hObj, ModelID mID, MeshID meshID, MaterialID matID)
 {
 	SCOPED_CPU_MARKER("BuildGameObject");
 
 	// GameObject
-	GameObject* pObj = mGameObjectPool.Get(iObj);
+	GameObject* pObj = mGameObjectPool.Get(hObj);
 	pObj->mModelID = INVALID_ID;
 
 	// Transform
-	Transform* pTransform = mGameObjectTransformPool.Get(iObj);
+	Transform* pTransform = mGameObjectTransformPool.Get(pObj->mTransformHandle);
 	*pTransform = ObjRep.tf;
 
 	// Model
@@ -225,20 +244,9 @@ void Scene::BuildGameObject(const FGameObjectRepresentation& ObjRep, size_t iObj
 
 	if (bModelIsBuiltinMesh)
 	{
-		ModelID mID = this->CreateModel();
-
-		std::unique_lock<std::mutex> lk(mMtx_Models);
-		Model& model = mModels.at(mID);
-
-		// create/get mesh
-		MeshID meshID = mEngine.GetBuiltInMeshID(ObjRep.BuiltinMeshName);
+		Model& model = *mModels.Get(mID);
 
 		// material
-		MaterialID matID = this->mDefaultMaterialID;
-		if (!ObjRep.MaterialName.empty())
-		{
-			matID = this->CreateMaterial(ObjRep.MaterialName);
-		}
 		Material& mat = this->GetMaterial(matID);
 		//const bool bTransparentMesh = mat.IsTransparent();
 
@@ -272,50 +280,82 @@ void Scene::LoadGameObjects(std::vector<FGameObjectRepresentation>&& GameObjects
 	constexpr bool B_LOAD_GAMEOBJECTS_SERIAL = false;
 	constexpr size_t NUM_GAMEOBJECTS_THRESHOLD_FOR_THREADED_LOAD = 1024;
 
+	const std::vector<size_t> hObjects = CreateGameObjects(NumGameObjects);
+
+	// resolve the mesh & material names once per unique name on this thread and reserve 
+	// the models of builtin mesh objects in one go, so that BuildGameObject() doesn't 
+	// need to lock the model/material containers per object.
+	std::vector<ModelID>    vModelIDs(NumGameObjects, INVALID_ID);
+	std::vector<MeshID>     vMeshIDs(NumGameObjects, INVALID_ID);
+	std::vector<MaterialID> vMaterialIDs(NumGameObjects, INVALID_ID);
+	size_t NumBuiltinMeshObjects = 0;
 	{
-		SCOPED_CPU_MARKER("MemAlloc");
-		mGameObjectHandles.resize(NumGameObjects, INVALID_HANDLE);
-		mTransformHandles.resize(NumGameObjects, INVALID_HANDLE);
-		
-		mGameObjectHandles = mGameObjectPool.Allocate(NumGameObjects);
-		mTransformHandles = mGameObjectTransformPool.Allocate(NumGameObjects); 
+		SCOPED_CPU_MARKER("ResolveReferences");
+		std::unordered_map<std::string, MeshID> BuiltinMeshIDLookup;
+		std::unordered_map<std::string, MaterialID> MaterialIDLookup;
+		for (size_t i = 0; i < NumGameObjects; ++i)
+		{
+			const FGameObjectRepresentation& ObjRep = GameObjects[i];
+			if (ObjRep.BuiltinMeshName.empty())
+				continue;
+
+			auto itMesh = BuiltinMeshIDLookup.find(ObjRep.BuiltinMeshName);
+			if (itMesh == BuiltinMeshIDLookup.end())
+				itMesh = BuiltinMeshIDLookup.emplace(ObjRep.BuiltinMeshName, mEngine.GetBuiltInMeshID(ObjRep.BuiltinMeshName)).first;
+			vMeshIDs[i] = itMesh->second;
+
+			vMaterialIDs[i] = this->mDefaultMaterialID;
+			if (!ObjRep.MaterialName.empty())
+			{
+				auto itMat = MaterialIDLookup.find(ObjRep.MaterialName);
+				if (itMat == MaterialIDLookup.end())
+					itMat = MaterialIDLookup.emplace(ObjRep.MaterialName, this->CreateMaterial(ObjRep.MaterialName)).first;
+				vMaterialIDs[i] = itMat->second;
+			}
+			++NumBuiltinMeshObjects;
+		}
+
+		const std::vector<ModelID> vBuiltinMeshModelIDs = CreateModels(NumBuiltinMeshObjects);
+		size_t iModel = 0;
+		for (size_t i = 0; i < NumGameObjects; ++i)
+		{
+			if (!GameObjects[i].BuiltinMeshName.empty())
+				vModelIDs[i] = vBuiltinMeshModelIDs[iModel++];
+		}
 	}
 
-	size_t iObj = 0;
+	auto fnBuildGameObjects = [&](size_t iBegin, size_t iEnd)
+	{
+		for (size_t i = iBegin; i <= iEnd; ++i)
+			BuildGameObject(GameObjects[i], hObjects[i], vModelIDs[i], vMeshIDs[i], vMaterialIDs[i]);
+	};
+
 	if (B_LOAD_GAMEOBJECTS_SERIAL || NumGameObjects < NUM_GAMEOBJECTS_THRESHOLD_FOR_THREADED_LOAD)
 	{
-		for (FGameObjectRepresentation& ObjRep : GameObjects)
-		{
-			BuildGameObject(ObjRep, iObj++);
-		}
+		if (NumGameObjects > 0)
+			fnBuildGameObjects(0, NumGameObjects - 1);
 	}
 	else // THREADED LOAD
 	{
 		const size_t NumAvailableWorkers = WorkerThreadPool.GetThreadPoolSize();
 		const size_t NumThreads = NumAvailableWorkers + 1;
-		const std::vector<FGameObjectRepresentation>* pObjects = &GameObjects;
 
 		std::vector<std::pair<size_t, size_t>> ranges = PartitionWorkItemsIntoRanges(NumGameObjects, NumThreads);
 		const int NumTasks = static_cast<int>(ranges.size());
 		const int NumThreadTasks = NumTasks - 1;
 		EventSignal ThreadsDoneSignal;
-		std::atomic<bool> bThreadsDone = false;
+		std::atomic<bool> bThreadsDone = NumThreadTasks == 0;
+		std::atomic<int> NumThreadsDone = 0; // outlives the dispatch scope, workers signal through it
 		{
 			SCOPED_CPU_MARKER("DispatchThreads");
-			std::atomic<int> NumThreadsDone = 0;
 			for (size_t iRange = 1; iRange < ranges.size(); ++iRange)
 			{
-				WorkerThreadPool.AddTask([=, &NumThreadsDone, &ThreadsDoneSignal, &bThreadsDone]()
+				WorkerThreadPool.AddTask([=, &fnBuildGameObjects, &NumThreadsDone, &ThreadsDoneSignal, &bThreadsDone]()
 				{
 					SCOPED_CPU_MARKER_C("UpdateWorker", 0xFF0000FF);
 					{
 						SCOPED_CPU_MARKER_F("Range: [%d, %d]", ranges[iRange].first, ranges[iRange].second);
-						const size_t NumItems_PrevRange = (ranges[iRange - 1].second - ranges[iRange - 1].first + 1);
-						const size_t Offset = (ranges[iRange - 1].second - ranges[0].first + 1);
-						size_t iObj_Thread = iObj + Offset;
-
-						for (size_t i = ranges[iRange].first; i <= ranges[iRange].second; ++i)
-							BuildGameObject((*pObjects)[i], iObj_Thread++);
+						fnBuildGameObjects(ranges[iRange].first, ranges[iRange].second);
 
 						const int NumThreadsDoneBefore = NumThreadsDone.fetch_add(1);
 						if (NumThreadsDoneBefore + 1 == NumThreadTasks)
@@ -329,10 +369,7 @@ void Scene::LoadGameObjects(std::vector<FGameObjectRepresentation>&& GameObjects
 		}
 		{
 			SCOPED_CPU_MARKER_F("Range[%d,%d] ", ranges[0].first, ranges[0].second);
-			for (size_t i = ranges.front().first; i <= ranges.front().second; ++i)
-			{
-				BuildGameObject(GameObjects[i], iObj++);
-			}
+			fnBuildGameObjects(ranges.front().first, ranges.front().second);
 		}
 		if(!bThreadsDone.load())
 		{
@@ -342,7 +379,13 @@ void Scene::LoadGameObjects(std::vector<FGameObjectRepresentation>&& GameObjects
 	}
 
 	// kickoff workers for loading models
-	mModelLoadResults = mAssetLoader.StartLoadingModels(this);
+	if (NumBuiltinMeshObjects == NumGameObjects)
+		return;
+	AssetLoader::ModelLoadResults_t ModelLoadResults = mAssetLoader.StartLoadingModels(this);
+	if (mModelLoadResults.empty())
+		mModelLoadResults = std::move(ModelLoadResults);
+	else // hot-reload: models of the previous reload may still be in flight
+		mModelLoadResults.insert(ModelLoadResults.begin(), ModelLoadResults.end());
 	Log::Info("[Scene] Start loading models...");
 
 }
@@ -364,6 +407,7 @@ void Scene::LoadSceneMaterials(const std::vector<FMaterialRepresentation>& Mater
 	// kickoff background workers for texture loading
 	if (!mMaterialAssignments.mAssignments.empty())
 	{
+		mAssetLoader.mLoadTimeline.BeginStage(mSceneRepresentation.SceneName, FLoadTimeline::TEXTURES);
 		mMaterialAssignments.mTextureLoadResults = mAssetLoader.StartLoadingTextures(taskID);
 		Log::Info("[Scene] Start loading textures... (%u)", mMaterialAssignments.mTextureLoadResults.size());
 	}
@@ -448,6 +492,34 @@ void Scene::LoadPostProcessSettings(/*TODO: scene PP settings*/)
 	}
 }
 
+void Scene::AssignLoadedModels()
+{
+	SCOPED_CPU_MARKER("Scene.AssignLoadedModels");
+	// a model load task completes once the model's buffers & textures are done, see FinalizeModelImport():
+	// its game objects don't have to wait for the rest of the scene.
+	for (auto it = mModelLoadResults.begin(); it != mModelLoadResults.end(); )
+	{
+		const AssetLoader::ModelLoadResult_t& res = it->second;
+		assert(res.valid());
+		if (res.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			++it;
+			continue;
+		}
+		GameObject* pObj = it->first;
+		pObj->mModelID = res.get();
+		it = mModelLoadResults.erase(it);
+
+		// objects added by a hot-reload: OnLoadComplete() has already computed the bounds of the rest
+		if (mSceneRepresentation.loadSuccess)
+			CalculateGameObjectLocalSpaceBoundingBox(pObj);
+	}
+
+	TRACE_COUNTER("Load.PendingModelAssignments", mModelLoadResults.size());
+	TRACE_COUNTER("Memory.GeometryMB", MemoryTracking::GetStats(EMemoryTag::GEOMETRY).CurrentBytes / (1024.0 * 1024.0));
+	TRACE_COUNTER("Memory.TextureDataMB", MemoryTracking::GetStats(EMemoryTag::TEXTURE_DATA).CurrentBytes / (1024.0 * 1024.0));
+}
+
 void Scene::OnLoadComplete(const BuiltinMeshArray_t& builtinMeshes)
 {
 	SCOPED_CPU_MARKER("Scene.OnLoadComplete");
@@ -455,7 +527,7 @@ void Scene::OnLoadComplete(const BuiltinMeshArray_t& builtinMeshes)
 
 	{
 		SCOPED_CPU_MARKER("AssignModels");
-		// Assign model data to game objects
+		// Assign model data to the game objects that weren't assigned while loading
 		for (auto it = mModelLoadResults.begin(); it != mModelLoadResults.end(); ++it)
 		{
 			GameObject* pObj = it->first;
@@ -466,88 +538,273 @@ void Scene::OnLoadComplete(const BuiltinMeshArray_t& builtinMeshes)
 
 			pObj->mModelID = res.get();
 		}
+		mModelLoadResults.clear();
 	}
 
 	// assign material data
-	mMaterialAssignments.DoAssignments(this, this->mMtxTexturePaths, this->mTexturePaths, &mRenderer);
+	{
+		FLoadTimeline::FScopedStage Stage(mAssetLoader.mLoadTimeline, mSceneRepresentation.SceneName, FLoadTimeline::TEXTURE_ASSIGNMENT);
+		mMaterialAssignments.DoAssignments(this, this->mMtxTexturePaths, this->mTexturePaths, &mRenderer);
+		mMaterialAssignments = {};
+	}
+	mAssetLoader.mLoadTimeline.EndStage(mSceneRepresentation.SceneName, FLoadTimeline::TEXTURES);
 
 	mEngine.FinalizeBuiltinMeshes();
 	LoadBuiltinMeshes(builtinMeshes);
+	ReleaseMeshGeometry(); // the model loads are done, see AddMesh()
 
 	CalculateGameObjectLocalSpaceBoundingBoxes();
 
+	{
+		// index memory of the loaded meshes w.r.t. 32-bit indices, see IndexCompression
+		uint64 NumIndexBytes = 0;
+		uint64 NumIndexBytes32 = 0;
+		for (size_t i = 0; i < mMeshes.size(); ++i)
+		{
+			if (SlotMap<Mesh>::GetHandleIndex(mMeshes.GetHandleOfDenseIndex(i)) < EBuiltInMeshes::NUM_BUILTIN_MESHES)
+				continue;
+			const Mesh& mesh = *(mMeshes.begin() + i);
+			NumIndexBytes += mesh.GetIndexBufferBytes();
+			for (int lod = 0; lod < (int)mesh.GetNumLODs(); ++lod)
+				NumIndexBytes32 += static_cast<uint64>(mesh.GetNumIndices(lod)) * sizeof(uint32);
+		}
+		if (NumIndexBytes32 > 0)
+		{
+			Log::Info("[Scene] Index buffers: %s, %s saved by 16-bit indices (%.1f%%)"
+				, StrUtil::FormatByte(static_cast<size_t>(NumIndexBytes)).c_str()
+				, StrUtil::FormatByte(static_cast<size_t>(NumIndexBytes32 - NumIndexBytes)).c_str()
+				, 100.0 * (NumIndexBytes32 - NumIndexBytes) / NumIndexBytes32
+			);
+		}
+
+		const FMeshDeduplicationStats Dedup = GetMeshDeduplicationStats();
+		if (Dedup.NumAddedMeshes > 0)
+		{
+			Log::Info("[Scene] Geometry deduplication: %u meshes -> %u unique (%.2fx), %s of %s saved"
+				, Dedup.NumAddedMeshes
+				, Dedup.NumUniqueMeshes
+				, Dedup.NumUniqueMeshes > 0 ? static_cast<double>(Dedup.NumAddedMeshes) / Dedup.NumUniqueMeshes : 1.0
+				, StrUtil::FormatByte(static_cast<size_t>(Dedup.NumSharedBytes)).c_str()
+				, StrUtil::FormatByte(static_cast<size_t>(Dedup.NumAddedBytes)).c_str()
+			);
+		}
+	}
+
+	mAssetLoader.mLoadTimeline.LogSummary(mSceneRepresentation.SceneName);
+	if (Trace::IsEnabled())
+	{
+		Trace::ExportChromeJSON("Traces/" + mSceneRepresentation.SceneName + "_Load.json", mLoadTraceBeginTimestamp);
+	}
+
 	Log::Info("[Scene] %s loaded.", mSceneRepresentation.SceneName.c_str());
 	mSceneRepresentation.loadSuccess = 1;
 	this->InitializeScene();
 }
 
-void Scene::Unload()
+void Scene::Unload(ThreadPool* pWorkerThreadPool, bool bKeepEnvironmentMap)
 {
 	SCOPED_CPU_MARKER("Scene::Unload()");
+	enum EUnloadPhase
+	{
+		DERIVED_SCENE = 0,
+		GPU_SYNC,
+		RETAIN,
+		TEXTURES,
+		MATERIALS,
+		MESHES,
+		MODELS,
+		GAME_OBJECTS,
+		MISC,
+		TRIM,
+
+		NUM_UNLOAD_PHASES
+	};
+	static const char* PHASE_NAMES[NUM_UNLOAD_PHASES] = { "DerivedScene", "GPUSync", "Retain", "Textures", "Materials", "Meshes", "Models", "GameObjects", "Misc", "Trim" };
+	float PhaseTimes[NUM_UNLOAD_PHASES] = {};
+
+	Timer tTotal; tTotal.Start();
+	Timer t; t.Start();
 
 	this->UnloadScene();
+	PhaseTimes[DERIVED_SCENE] = t.Tick();
 
-	mSceneRepresentation = {};
+	// the GPU may still be reading material descriptors & textures of the last frames
+	{
+		SCOPED_CPU_MARKER("WaitForGPU");
+		mRenderer.GetWindowSwapChain(mpWindow->GetHWND()).WaitForGPU();
+	}
+	PhaseTimes[GPU_SYNC] = t.Tick();
 
-	const size_t sz = mFrameSceneViews.size();
-	mFrameSceneViews.clear();
-	mFrameShadowViews.clear();
-	mFrameSceneViews.resize(sz);
-	mFrameShadowViews.resize(sz);
+	// hand the loaded models over to the asset cache: their buffers, SRVs & textures survive the unload
+	AssetCache& Cache = mAssetLoader.mAssetCache;
+	Cache.RetainModels(this);
+	Cache.ReleaseSceneReferences(); // after retaining: the re-retained buffers & SRVs keep a reference
+	PhaseTimes[RETAIN] = t.Tick();
 
-	//mMeshes.clear(); // TODO
-	
-	mGameObjectTransformPool.FreeAll();
-	mGameObjectPool.FreeAll();
-	mTransformHandles.clear();
-	mGameObjectHandles.clear();
+	// textures: drop the scene's references, the unreferenced ones are released on the TextureManager workers
+	{
+		SCOPED_CPU_MARKER("Textures");
+		std::vector<TextureID> TextureIDs;
+		{
+			std::lock_guard<std::mutex> lk(mMtxTexturePaths);
+			TextureIDs.reserve(mTexturePaths.size());
+			for (const auto& [TexID, TexPath] : mTexturePaths)
+			{
+				if (StringInterner::GetString(TexPath).rfind("Procedural/", 0) == 0) // owned by the renderer
+					continue;
+				TextureIDs.push_back(TexID);
+			}
+			mTexturePaths.clear();
+		}
+		Cache.ReleaseTextures(TextureIDs);
+	}
+	PhaseTimes[TEXTURES] = t.Tick();
+
+	// meshes & models: the bulk of the container teardown, dispatch to workers if we have any
+	auto fnUnloadMeshes = [this, &Cache]() -> float
+	{
+		SCOPED_CPU_MARKER("Meshes");
+		Timer tWorker; tWorker.Start();
+		std::vector<BufferID> VBs, IBs;
+		VBs.reserve(mMeshes.size());
+		IBs.reserve(mMeshes.size());
+		for (size_t i = 0; i < mMeshes.size(); ++i)
+		{
+			if (SlotMap<Mesh>::GetHandleIndex(mMeshes.GetHandleOfDenseIndex(i)) < EBuiltInMeshes::NUM_BUILTIN_MESHES)
+				continue; // builtin mesh buffers are owned by the engine
+			const Mesh& mesh = *(mMeshes.begin() + i);
+			for (int lod = 0; lod < (int)mesh.GetNumLODs(); ++lod)
+			{
+				std::pair<BufferID, BufferID> VBIB = mesh.GetIABufferIDs(lod);
+				if (!Cache.IsBufferRetained(VBIB.first )) VBs.push_back(VBIB.first);
+				if (!Cache.IsBufferRetained(VBIB.second)) IBs.push_back(VBIB.second);
+			}
+		}
+		// meshes restored from the cache by several models share their buffers
+		std::sort(VBs.begin(), VBs.end()); VBs.erase(std::unique(VBs.begin(), VBs.end()), VBs.end());
+		std::sort(IBs.begin(), IBs.end()); IBs.erase(std::unique(IBs.begin(), IBs.end()), IBs.end());
+
+		// keep the builtin mesh slots so that their handles keep matching EBuiltInMeshes.
+		// builtin meshes are inserted first and never removed, so they occupy the front of the
+		// dense array: remove back to front, which makes every Remove() a pop_back() w/o moves.
+		std::vector<MeshID> MeshIDs = mMeshes.GetAllAliveObjectHandles();
+		for (auto it = MeshIDs.rbegin(); it != MeshIDs.rend(); ++it)
+		{
+			if (SlotMap<Mesh>::GetHandleIndex(*it) < EBuiltInMeshes::NUM_BUILTIN_MESHES)
+				continue;
+			mMeshes.Remove(*it);
+		}
+		mMeshGeometryHashes.clear();
+		mMeshesWithBuffers.clear();
+		mMeshDeduplicationStats = {};
+		mRenderer.DestroyVertexAndIndexBuffers(VBs, IBs);
+		return tWorker.Tick();
+	};
+	auto fnUnloadModels = [this]() -> float
+	{
+		SCOPED_CPU_MARKER("Models");
+		Timer tWorker; tWorker.Start();
+		mModels.Clear();
+		mModelLoadResults.clear();
+		return tWorker.Tick();
+	};
+	std::future<float> MeshesDone;
+	std::future<float> ModelsDone;
+	if (pWorkerThreadPool)
+	{
+		MeshesDone = pWorkerThreadPool->AddTask(fnUnloadMeshes);
+		ModelsDone = pWorkerThreadPool->AddTask(fnUnloadModels);
+	}
+	else
+	{
+		PhaseTimes[MESHES] = fnUnloadMeshes();
+		PhaseTimes[MODELS] = fnUnloadModels();
+	}
+	t.Tick();
+
+	{
+		SCOPED_CPU_MARKER("Materials");
+		std::vector<SRV_ID> SRVs;
+		SRVs.reserve(mMaterials.size() * 2);
+		for (const Material& material : mMaterials)
+		{
+			if (!Cache.IsSRVRetained(material.SRVHeightMap   )) SRVs.push_back(material.SRVHeightMap);
+			if (!Cache.IsSRVRetained(material.SRVMaterialMaps)) SRVs.push_back(material.SRVMaterialMaps);
+		}
+		mRenderer.DestroySRVs(SRVs);
+		mMaterials.Clear();
+		mMaterialNames.clear();
+		mMaterialIDs.clear();
+		mLoadedMaterials.clear();
+	}
+	PhaseTimes[MATERIALS] = t.Tick();
 
-	mCameras.clear();
-	
-	for (const Material* pMaterial : mMaterialPool.GetAllAliveObjects())
 	{
-		mRenderer.DestroySRV(pMaterial->SRVHeightMap);
-		mRenderer.DestroySRV(pMaterial->SRVMaterialMaps);
+		SCOPED_CPU_MARKER("GameObjects");
+		mGameObjectTransformPool.FreeAll();
+		mGameObjectPool.FreeAll();
+		mTransformHandles.clear();
+		mGameObjectHandles.clear();
 	}
-	mMaterialPool.FreeAll();
-	mMaterialNames.clear();
-	mLoadedMaterials.clear();
+	PhaseTimes[GAME_OBJECTS] = t.Tick();
 
-	for (const auto& pair : mMeshes)
 	{
-		const Mesh& mesh = pair.second;
-		for (int lod = 0; lod < (int)mesh.GetNumLODs(); ++lod)
+		SCOPED_CPU_MARKER("Misc");
+		mSceneRepresentation = {};
+		mSceneFileObjectHandles.clear();
+		std::fill(std::begin(mNumSceneFileLights), std::end(mNumSceneFileLights), 0);
+
+		const size_t sz = mFrameSceneViews.size();
+		mFrameSceneViews.clear();
+		mFrameShadowViews.clear();
+		mFrameSceneViews.resize(sz);
+		mFrameShadowViews.resize(sz);
+
+		mCameras.clear();
+
+		mLightsStatic.clear();
+		mLightsDynamic.clear();
+		mLightsStationary.clear();
+
+		mBoundingBoxHierarchy.Clear();
+		mFrustumCullWorkerContext.ClearMemory();
+
+		mIndex_SelectedCamera = 0;
+		mIndex_ActiveEnvironmentMapPreset = -1;
+		if (!bKeepEnvironmentMap) // the next scene uses the same preset
 		{
-			std::pair<BufferID, BufferID> VBIB = mesh.GetIABufferIDs(lod);
-			const VBV& VertexBufferView = mRenderer.GetVertexBufferView(VBIB.first);
-			const IBV& IndexBufferView = mRenderer.GetIndexBufferView(VBIB.second);
-			// TODO: release VB & IB	
+			mEngine.UnloadEnvironmentMap();
 		}
 	}
-	mMeshes.clear();
-	mModels.clear();
-	mModelLoadResults.clear();
-	mTexturePaths.clear();
+	PhaseTimes[MISC] = t.Tick();
 
-	mLightsStatic.clear();
-	mLightsDynamic.clear();
-	mLightsStationary.clear();
+	if (pWorkerThreadPool)
+	{
+		SCOPED_CPU_MARKER_C("WaitWorkers", 0xFFAA0000);
+		PhaseTimes[MESHES] = MeshesDone.get();
+		PhaseTimes[MODELS] = ModelsDone.get();
+	}
 
-	mBoundingBoxHierarchy.Clear();
-	mFrustumCullWorkerContext.ClearMemory();
+	// after the mesh teardown: it checks the retained buffers that Trim() may release
+	t.Tick();
+	Cache.Trim();
+	PhaseTimes[TRIM] = t.Tick();
 
-	mIndex_SelectedCamera = 0;
-	mIndex_ActiveEnvironmentMapPreset = -1;
-	mEngine.UnloadEnvironmentMap();
+	tTotal.Stop();
+	std::string PhaseLog;
+	for (int i = 0; i < NUM_UNLOAD_PHASES; ++i)
+	{
+		char buf[64];
+		snprintf(buf, sizeof(buf), "%s%s=%.2fms", (i == 0 ? "" : " | "), PHASE_NAMES[i], PhaseTimes[i] * 1000.0f);
+		PhaseLog += buf;
+	}
+	Log::Info("[Scene] Unloaded in %.2fms%s: %s", tTotal.DeltaTime() * 1000.0f, (pWorkerThreadPool ? " (MT)" : ""), PhaseLog.c_str());
 }
 
 
 void Scene::CalculateGameObjectLocalSpaceBoundingBoxes()
 {
 	SCOPED_CPU_MARKER("CalculateGameObjectLocalSpaceBoundingBoxes");
-	constexpr float max_f = std::numeric_limits<float>::max();
-	constexpr float min_f = -(max_f - 1.0f);
-	
 	size_t i = 0;
 	for (size_t hObj : mGameObjectHandles)
 	{
@@ -559,49 +816,66 @@ void Scene::CalculateGameObjectLocalSpaceBoundingBoxes()
 			continue;
 		}
 		++i;
-		assert(pGameObj);
-		FBoundingBox& AABB = pGameObj->mLocalSpaceBoundingBox;
+		CalculateGameObjectLocalSpaceBoundingBox(pGameObj);
+	}
+}
 
-		// reset AABB
-		AABB.ExtentMin = XMFLOAT3(max_f, max_f, max_f);
-		AABB.ExtentMax = XMFLOAT3(min_f, min_f, min_f);
+void Scene::CalculateGameObjectLocalSpaceBoundingBox(GameObject* pGameObj)
+{
+	constexpr float max_f = std::numeric_limits<float>::max();
+	constexpr float min_f = -(max_f - 1.0f);
 
-		// load
-		XMVECTOR vMins = XMLoadFloat3(&AABB.ExtentMin);
-		XMVECTOR vMaxs = XMLoadFloat3(&AABB.ExtentMax);
+	assert(pGameObj);
+	FBoundingBox& AABB = pGameObj->mLocalSpaceBoundingBox;
 
-		// go through all meshes and generate the AABB
-		if (pGameObj->mModelID == -1)
-		{
-			Log::Warning("Game object doesn't have a valid model ID!");
-			continue;
-		}
-		const Model& model = mModels.at(pGameObj->mModelID);
-		auto fnProcessMeshAABB = [&vMins, &vMaxs](const FBoundingBox& AABB_Mesh)
-		{
-			XMVECTOR vMinMesh = XMLoadFloat3(&AABB_Mesh.ExtentMin);
-			XMVECTOR vMaxMesh = XMLoadFloat3(&AABB_Mesh.ExtentMax);
-
-			vMins = XMVectorMin(vMins, vMinMesh);
-			vMins = XMVectorMin(vMins, vMaxMesh);
-			vMaxs = XMVectorMax(vMaxs, vMinMesh);
-			vMaxs = XMVectorMax(vMaxs, vMaxMesh);
-		};
-		for (std::pair<MeshID, MaterialID> meshMaterialIDPair : model.mData.GetMeshMaterialIDPairs(Model::Data::EMeshType::OPAQUE_MESH))
-		{
-			MeshID mesh = meshMaterialIDPair.first;
-			const FBoundingBox& AABB_Mesh = mMeshes.at(mesh).GetLocalSpaceBoundingBox();
-			fnProcessMeshAABB(AABB_Mesh);
-		}
-		for (std::pair<MeshID, MaterialID> meshMaterialIDPair : model.mData.GetMeshMaterialIDPairs(Model::Data::EMeshType::TRANSPARENT_MESH))
-		{
-			MeshID mesh = meshMaterialIDPair.first;
-			const FBoundingBox& AABB_Mesh = mMeshes.at(mesh).GetLocalSpaceBoundingBox();
-			fnProcessMeshAABB(AABB_Mesh);
-		}
+	// reset AABB
+	AABB.ExtentMin = XMFLOAT3(max_f, max_f, max_f);
+	AABB.ExtentMax = XMFLOAT3(min_f, min_f, min_f);
 
-		// store 
-		XMStoreFloat3(&AABB.ExtentMin, vMins);
-		XMStoreFloat3(&AABB.ExtentMax, vMaxs);
+	// load
+	XMVECTOR vMins = XMLoadFloat3(&AABB.ExtentMin);
+	XMVECTOR vMaxs = XMLoadFloat3(&AABB.ExtentMax);
+
+	// go through all meshes and generate the AABB
+	if (pGameObj->mModelID == -1)
+	{
+		Log::Warning("Game object doesn't have a valid model ID!");
+		return;
 	}
-}
\ No newline at end of file
+	const Model* pModel = mModels.Get(pGameObj->mModelID);
+	if (!pModel)
+	{
+		Log::Warning("Game object's model not found (modelID=%d)", pGameObj->mModelID);
+		assert(false);
+		return;
+	}
+	const Model& model = *pModel;
+	auto fnProcessMeshAABB = [&vMins, &vMaxs](const FBoundingBox& AABB_Mesh)
+	{
+		XMVECTOR vMinMesh = XMLoadFloat3(&AABB_Mesh.ExtentMin);
+		XMVECTOR vMaxMesh = XMLoadFloat3(&AABB_Mesh.ExtentMax);
+
+		vMins = XMVectorMin(vMins, vMinMesh);
+		vMins = XMVectorMin(vMins, vMaxMesh);
+		vMaxs = XMVectorMax(vMaxs, vMinMesh);
+		vMaxs = XMVectorMax(vMaxs, vMaxMesh);
+	};
+	for (std::pair<MeshID, MaterialID> meshMaterialIDPair : model.mData.GetMeshMaterialIDPairs(Model::Data::EMeshType::OPAQUE_MESH))
+	{
+		const Mesh* pMesh = mMeshes.Get(meshMaterialIDPair.first);
+		assert(pMesh);
+		if (pMesh)
+			fnProcessMeshAABB(pMesh->GetLocalSpaceBoundingBox());
+	}
+	for (std::pair<MeshID, MaterialID> meshMaterialIDPair : model.mData.GetMeshMaterialIDPairs(Model::Data::EMeshType::TRANSPARENT_MESH))
+	{
+		const Mesh* pMesh = mMeshes.Get(meshMaterialIDPair.first);
+		assert(pMesh);
+		if (pMesh)
+			fnProcessMeshAABB(pMesh->GetLocalSpaceBoundingBox());
+	}
+
+	// store 
+	XMStoreFloat3(&AABB.ExtentMin, vMins);
+	XMStoreFloat3(&AABB.ExtentMax, vMaxs);
+}
@@ -24,11 +24,13 @@
 #include "Engine/PostProcess/PostProcess.h"
 #include "Libs/VQUtils/Include/Multithreading/TaskSignal.h"
 #include "Engine/Core/Memory.h"
+#include "Engine/Core/SlotMap.h"
+#include "Engine/Core/MemoryTracking.h"
 
 // typedefs
-using MeshLookup_t = std::unordered_map<MeshID, Mesh>;
-using ModelLookup_t = std::unordered_map<ModelID, Model>;
-using MaterialLookup_t = std::unordered_map<MaterialID, Material>;
+using MeshLookup_t = SlotMap<Mesh>;
+using ModelLookup_t = SlotMap<Model>;
+using MaterialLookup_t = SlotMap<Material>;
 
 struct Transform;
 class Scene;
@@ -85,16 +87,20 @@ struct alignas(16) FPerDrawData // that fits in a cache line.
 	std::pair<BufferID, BufferID> VBIB;
 	unsigned NumIndices;
 	short SelectedLOD;
+	uint8 iVertexFormat; // GetVertexFormatOption()
+	DirectX::XMFLOAT4 UVScaleBias; // Mesh::GetUVScaleBias()
+	const FMeshlet* pMeshlets; // Mesh::GetMeshlets(SelectedLOD), owned by the mesh
+	uint NumMeshlets;
 };
 struct FVisibleMeshDataSoA
 {
-	const MemoryPool<Material>* pMaterialPool = nullptr;
+	const MaterialLookup_t* pMaterials = nullptr;
 
-	std::vector<uint64> SortKey;
-	std::vector<FPerDrawData> PerDrawData;
-	std::vector<Transform> Transform;
-	std::vector<FPerInstanceData> PerInstanceData;
-	std::vector<MaterialID> MaterialID;
+	TrackedVector<uint64          , EMemoryTag::RENDER_LISTS> SortKey;
+	TrackedVector<FPerDrawData    , EMemoryTag::RENDER_LISTS> PerDrawData;
+	TrackedVector<Transform       , EMemoryTag::RENDER_LISTS> Transform;
+	TrackedVector<FPerInstanceData, EMemoryTag::RENDER_LISTS> PerInstanceData;
+	TrackedVector<MaterialID      , EMemoryTag::RENDER_LISTS> MaterialID;
 	size_t NumValidElements;
 	inline void Reserve(size_t sz)
 	{
@@ -0,0 +1,358 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+
+#include "TangentSpace.h"
+
+#include "Engine/GPUMarker.h"
+
+#include "Libs/VQUtils/Include/Multithreading/ThreadPool.h"
+#include "Libs/VQUtils/Include/Timer.h"
+
+#include <immintrin.h>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cfloat>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <thread>
+
+namespace
+{
+	constexpr size_t MIN_TRIANGLES_PER_TASK = 16 * 1024;
+	constexpr size_t MIN_VERTICES_PER_TASK  = 16 * 1024;
+	constexpr size_t NUM_TASKS_PER_THREAD   = 4; // smaller ranges balance the load when the workers are busy with other meshes
+
+	inline const float* GetAttribute(const float* pFirst, size_t Stride, uint32 i) { return reinterpret_cast<const float*>(reinterpret_cast<const char*>(pFirst) + Stride * i); }
+	inline float Dot(const float a[3], const float b[3]) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+	inline bool  NotZero(float f) { return std::fabs(f) > FLT_MIN; } // same threshold as mikktspace.c
+
+	// v - n * dot(n, v), normalized if not zero
+	inline void ProjectToPlane(const float n[3], float v[3])
+	{
+		const float d = Dot(n, v);
+		v[0] -= n[0] * d; v[1] -= n[1] * d; v[2] -= n[2] * d;
+		const float Len = std::sqrt(Dot(v, v));
+		if (NotZero(Len))
+		{
+			v[0] /= Len; v[1] /= Len; v[2] /= Len;
+		}
+	}
+
+	enum ETriangleFlags : uint32
+	{
+		ORIENT_PRESERVING = 1 << 0, // positive UV area, 0 for mirrored UVs
+		DEGENERATE        = 1 << 1, // zero UV area or zero length dP/du
+	};
+	struct FTriangle
+	{
+		float  Os[3]; // unit dP/du
+		uint32 Flags;
+	};
+	static_assert(sizeof(FTriangle) == 16, "the SSE triangle pass stores a triangle per register");
+
+	// returns true if degenerate
+	bool ComputeTriangle(const TangentSpace::FVertexStreams& Streams, uint32 i0, uint32 i1, uint32 i2, FTriangle& Tri)
+	{
+		if (i0 >= Streams.NumVertices || i1 >= Streams.NumVertices || i2 >= Streams.NumVertices)
+		{
+			Tri = { { 0.0f, 0.0f, 0.0f }, DEGENERATE };
+			return true;
+		}
+
+		const float* p0 = GetAttribute(Streams.pPositions, Streams.Stride, i0); const float* t0 = GetAttribute(Streams.pUVs, Streams.Stride, i0);
+		const float* p1 = GetAttribute(Streams.pPositions, Streams.Stride, i1); const float* t1 = GetAttribute(Streams.pUVs, Streams.Stride, i1);
+		const float* p2 = GetAttribute(Streams.pPositions, Streams.Stride, i2); const float* t2 = GetAttribute(Streams.pUVs, Streams.Stride, i2);
+		const float d1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+		const float d2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+		const float t21x = t1[0] - t0[0], t21y = t1[1] - t0[1];
+		const float t31x = t2[0] - t0[0], t31y = t2[1] - t0[1];
+
+		const float SignedAreaSTx2 = t21x * t31y - t21y * t31x;
+		const float Os[3] = { t31y * d1[0] - t21y * d2[0], t31y * d1[1] - t21y * d2[1], t31y * d1[2] - t21y * d2[2] };
+		const float LenOs = std::sqrt(Dot(Os, Os));
+
+		Tri.Flags = SignedAreaSTx2 > 0.0f ? static_cast<uint32>(ORIENT_PRESERVING) : 0u;
+		if (!NotZero(SignedAreaSTx2) || !NotZero(LenOs))
+		{
+			Tri.Flags |= DEGENERATE;
+			Tri.Os[0] = Tri.Os[1] = Tri.Os[2] = 0.0f;
+			return true;
+		}
+		const float S = (Tri.Flags & ORIENT_PRESERVING) ? 1.0f : -1.0f;
+		Tri.Os[0] = Os[0] * S / LenOs;
+		Tri.Os[1] = Os[1] * S / LenOs;
+		Tri.Os[2] = Os[2] * S / LenOs;
+		return false;
+	}
+
+	// ComputeTriangle() for 4 triangles in the SSE lanes, same results bit for bit. The vertex attributes are gathered
+	// w/ scalar loads (no gather instruction in SSE), the math & the FTriangle stores are vectorized. Returns the degenerate triangle count.
+	uint32 ComputeTriangles4(const TangentSpace::FVertexStreams& Streams, const uint32* pIndices, FTriangle* pOut)
+	{
+		for (int i = 0; i < 12; ++i)
+		{
+			if (pIndices[i] >= Streams.NumVertices)
+			{
+				uint32 NumDegenerate = 0;
+				for (int iTri = 0; iTri < 4; ++iTri)
+					NumDegenerate += ComputeTriangle(Streams, pIndices[iTri * 3 + 0], pIndices[iTri * 3 + 1], pIndices[iTri * 3 + 2], pOut[iTri]) ? 1 : 0;
+				return NumDegenerate;
+			}
+		}
+
+		const float* P[3][4];
+		const float* T[3][4];
+		for (int iCorner = 0; iCorner < 3; ++iCorner)
+		for (int iTri = 0; iTri < 4; ++iTri)
+		{
+			P[iCorner][iTri] = GetAttribute(Streams.pPositions, Streams.Stride, pIndices[iTri * 3 + iCorner]);
+			T[iCorner][iTri] = GetAttribute(Streams.pUVs      , Streams.Stride, pIndices[iTri * 3 + iCorner]);
+		}
+		auto fnLoad = [](const float* const pp[4], int c) { return _mm_set_ps(pp[3][c], pp[2][c], pp[1][c], pp[0][c]); };
+
+		const __m128 p0x = fnLoad(P[0], 0), p0y = fnLoad(P[0], 1), p0z = fnLoad(P[0], 2);
+		const __m128 d1x = _mm_sub_ps(fnLoad(P[1], 0), p0x), d1y = _mm_sub_ps(fnLoad(P[1], 1), p0y), d1z = _mm_sub_ps(fnLoad(P[1], 2), p0z);
+		const __m128 d2x = _mm_sub_ps(fnLoad(P[2], 0), p0x), d2y = _mm_sub_ps(fnLoad(P[2], 1), p0y), d2z = _mm_sub_ps(fnLoad(P[2], 2), p0z);
+		const __m128 t0x = fnLoad(T[0], 0), t0y = fnLoad(T[0], 1);
+		const __m128 t21x = _mm_sub_ps(fnLoad(T[1], 0), t0x), t21y = _mm_sub_ps(fnLoad(T[1], 1), t0y);
+		const __m128 t31x = _mm_sub_ps(fnLoad(T[2], 0), t0x), t31y = _mm_sub_ps(fnLoad(T[2], 1), t0y);
+
+		const __m128 SignedAreaSTx2 = _mm_sub_ps(_mm_mul_ps(t21x, t31y), _mm_mul_ps(t21y, t31x));
+		__m128 Osx = _mm_sub_ps(_mm_mul_ps(t31y, d1x), _mm_mul_ps(t21y, d2x));
+		__m128 Osy = _mm_sub_ps(_mm_mul_ps(t31y, d1y), _mm_mul_ps(t21y, d2y));
+		__m128 Osz = _mm_sub_ps(_mm_mul_ps(t31y, d1z), _mm_mul_ps(t21y, d2z));
+		const __m128 LenOs = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(Osx, Osx), _mm_mul_ps(Osy, Osy)), _mm_mul_ps(Osz, Osz)));
+
+		// NotZero(): |x| > FLT_MIN, false for NaN
+		const __m128 SignMask = _mm_set1_ps(-0.0f);
+		const __m128 MinValue = _mm_set1_ps(FLT_MIN);
+		const __m128 bOrientPreserving = _mm_cmpgt_ps(SignedAreaSTx2, _mm_setzero_ps());
+		const __m128 bValid = _mm_and_ps(_mm_cmpgt_ps(_mm_andnot_ps(SignMask, SignedAreaSTx2), MinValue), _mm_cmpgt_ps(LenOs, MinValue));
+
+		// Os * S / LenOs, S = +/-1 flips the sign bit. Degenerate triangles are zeroed.
+		const __m128 S = _mm_andnot_ps(bOrientPreserving, SignMask);
+		Osx = _mm_and_ps(bValid, _mm_div_ps(_mm_xor_ps(Osx, S), LenOs));
+		Osy = _mm_and_ps(bValid, _mm_div_ps(_mm_xor_ps(Osy, S), LenOs));
+		Osz = _mm_and_ps(bValid, _mm_div_ps(_mm_xor_ps(Osz, S), LenOs));
+		__m128 Flags = _mm_castsi128_ps(_mm_or_si128(
+			  _mm_and_si128   (_mm_castps_si128(bOrientPreserving), _mm_set1_epi32(ORIENT_PRESERVING))
+			, _mm_andnot_si128(_mm_castps_si128(bValid)           , _mm_set1_epi32(DEGENERATE))
+		));
+
+		// SoA -> FTriangle
+		_MM_TRANSPOSE4_PS(Osx, Osy, Osz, Flags);
+		_mm_storeu_ps(reinterpret_cast<float*>(pOut + 0), Osx);
+		_mm_storeu_ps(reinterpret_cast<float*>(pOut + 1), Osy);
+		_mm_storeu_ps(reinterpret_cast<float*>(pOut + 2), Osz);
+		_mm_storeu_ps(reinterpret_cast<float*>(pOut + 3), Flags);
+		return static_cast<uint32>(std::popcount(static_cast<uint32>(~_mm_movemask_ps(bValid) & 0xF)));
+	}
+
+	// Runs Fn(iBegin, iEnd) over [0, NumItems) in ranges. The calling thread processes ranges until none are left, then waits
+	// only for the ranges other threads have started: tasks that start late find no work and return without touching Fn.
+	void ParallelFor(size_t NumItems, size_t MinItemsPerTask, ThreadPool* pWorkerThreadPool, const std::function<void(size_t, size_t)>& Fn)
+	{
+		const size_t NumThreads = pWorkerThreadPool ? pWorkerThreadPool->GetThreadPoolSize() + 1 : 1;
+		const size_t NumRanges = std::min(NumThreads * NUM_TASKS_PER_THREAD, NumItems / MinItemsPerTask);
+		if (NumRanges <= 1)
+		{
+			Fn(0, NumItems);
+			return;
+		}
+
+		struct FState
+		{
+			std::atomic<size_t> iNextRange = 0;
+			std::atomic<size_t> NumDoneRanges = 0;
+			size_t NumRanges = 0;
+			size_t NumItems = 0;
+			const std::function<void(size_t, size_t)>* pFn = nullptr;
+		};
+		std::shared_ptr<FState> pState = std::make_shared<FState>();
+		pState->NumRanges = NumRanges;
+		pState->NumItems = NumItems;
+		pState->pFn = &Fn;
+
+		auto fnProcessRanges = [](FState& s)
+		{
+			for (size_t iRange = s.iNextRange++; iRange < s.NumRanges; iRange = s.iNextRange++)
+			{
+				(*s.pFn)(iRange * s.NumItems / s.NumRanges, (iRange + 1) * s.NumItems / s.NumRanges);
+				s.NumDoneRanges.fetch_add(1, std::memory_order_release);
+			}
+		};
+
+		const size_t NumWorkerTasks = std::min(NumThreads - 1, NumRanges - 1);
+		for (size_t i = 0; i < NumWorkerTasks; ++i)
+		{
+			pWorkerThreadPool->AddTask([pState, fnProcessRanges]()
+			{
+				SCOPED_CPU_MARKER("TangentWorker");
+				fnProcessRanges(*pState);
+			});
+		}
+		fnProcessRanges(*pState);
+
+		SCOPED_CPU_MARKER("WaitTangentWorkers");
+		while (pState->NumDoneRanges.load(std::memory_order_acquire) < NumRanges)
+			std::this_thread::yield();
+	}
+}
+
+namespace TangentSpace
+{
+	void GenerateTangents(const FVertexStreams& Streams, std::vector<uint32>& Indices, std::vector<float>& OutTangents, std::vector<uint32>& OutSplitVertices, ThreadPool* pWorkerThreadPool, FStats* pStats)
+	{
+		SCOPED_CPU_MARKER("TangentSpace::GenerateTangents");
+		Timer t;
+		t.Start();
+
+		const size_t NumVertices = Streams.NumVertices;
+		const size_t NumTriangles = Indices.size() / 3;
+		auto fnPosition = [&](uint32 v) { return GetAttribute(Streams.pPositions, Streams.Stride, v); };
+		auto fnNormal   = [&](uint32 v) { return GetAttribute(Streams.pNormals  , Streams.Stride, v); };
+
+		// triangle tangents
+		std::vector<FTriangle> Triangles(NumTriangles);
+		std::atomic<size_t> NumDegenerateTriangles = 0;
+		ParallelFor(NumTriangles, MIN_TRIANGLES_PER_TASK, pWorkerThreadPool, [&](size_t iBegin, size_t iEnd)
+		{
+			SCOPED_CPU_MARKER("Triangles");
+			size_t NumDegenerate = 0;
+			size_t iTri = iBegin;
+			for (; iTri + 4 <= iEnd; iTri += 4)
+				NumDegenerate += ComputeTriangles4(Streams, &Indices[iTri * 3], &Triangles[iTri]);
+			for (; iTri < iEnd; ++iTri)
+				NumDegenerate += ComputeTriangle(Streams, Indices[iTri * 3 + 0], Indices[iTri * 3 + 1], Indices[iTri * 3 + 2], Triangles[iTri]) ? 1 : 0;
+			NumDegenerateTriangles += NumDegenerate;
+		});
+
+		// vertex -> corners
+		std::vector<uint32> CornerOffsets(NumVertices + 1, 0);
+		std::vector<uint32> Corners(NumTriangles * 3);
+		{
+			SCOPED_CPU_MARKER("VertexCorners");
+			for (size_t c = 0; c < Corners.size(); ++c)
+				if (Indices[c] < NumVertices)
+					++CornerOffsets[Indices[c] + 1];
+			for (size_t v = 0; v < NumVertices; ++v)
+				CornerOffsets[v + 1] += CornerOffsets[v];
+			std::vector<uint32> Fill(CornerOffsets.begin(), CornerOffsets.end() - 1);
+			for (size_t c = 0; c < Corners.size(); ++c)
+				if (Indices[c] < NumVertices)
+					Corners[Fill[Indices[c]]++] = static_cast<uint32>(c);
+		}
+
+		// reduction: each vertex sums its angle weighted corners, the mirrored corners into a separate group
+		OutTangents.resize(NumVertices * 3);
+		std::vector<float> MirroredTangents(NumVertices * 3);
+		std::vector<uint8> bSplit(NumVertices, 0);
+		ParallelFor(NumVertices, MIN_VERTICES_PER_TASK, pWorkerThreadPool, [&](size_t iBegin, size_t iEnd)
+		{
+			SCOPED_CPU_MARKER("Vertices");
+			for (size_t v = iBegin; v < iEnd; ++v)
+			{
+				const float* n = fnNormal(static_cast<uint32>(v));
+				const float* p = fnPosition(static_cast<uint32>(v));
+				float Sum[2][3] = {};
+				uint32 NumContributions[2] = {};
+				for (uint32 i = CornerOffsets[v]; i < CornerOffsets[v + 1]; ++i)
+				{
+					const uint32 c = Corners[i];
+					const FTriangle& Tri = Triangles[c / 3];
+					if (Tri.Flags & DEGENERATE)
+						continue;
+
+					const uint32 iTriBase = c - c % 3;
+					const float* pPrev = fnPosition(Indices[iTriBase + (c + 2) % 3]);
+					const float* pNext = fnPosition(Indices[iTriBase + (c + 1) % 3]);
+					float v1[3] = { pPrev[0] - p[0], pPrev[1] - p[1], pPrev[2] - p[2] };
+					float v2[3] = { pNext[0] - p[0], pNext[1] - p[1], pNext[2] - p[2] };
+					ProjectToPlane(n, v1);
+					ProjectToPlane(n, v2);
+					const float Angle = std::acos(std::clamp(Dot(v1, v2), -1.0f, 1.0f));
+
+					float Os[3] = { Tri.Os[0], Tri.Os[1], Tri.Os[2] };
+					ProjectToPlane(n, Os);
+
+					const int iGroup = (Tri.Flags & ORIENT_PRESERVING) ? 0 : 1;
+					Sum[iGroup][0] += Angle * Os[0];
+					Sum[iGroup][1] += Angle * Os[1];
+					Sum[iGroup][2] += Angle * Os[2];
+					++NumContributions[iGroup];
+				}
+
+				// orthonormal to n: project once more against the accumulated float error
+				const bool bHasGroup0 = NumContributions[0] > 0;
+				const bool bHasGroup1 = NumContributions[1] > 0;
+				float* T = &OutTangents[v * 3];
+				const float* Src = bHasGroup0 ? Sum[0] : Sum[1];
+				T[0] = Src[0]; T[1] = Src[1]; T[2] = Src[2];
+				ProjectToPlane(n, T);
+				if (!NotZero(Dot(T, T)))
+				{
+					// no contributions: use an axis perpendicular to the normal
+					const float ax = std::fabs(n[0]), ay = std::fabs(n[1]), az = std::fabs(n[2]);
+					T[0] = (ax <= ay && ax <= az) ? 1.0f : 0.0f;
+					T[1] = (T[0] == 0.0f && ay <= az) ? 1.0f : 0.0f;
+					T[2] = (T[0] == 0.0f && T[1] == 0.0f) ? 1.0f : 0.0f;
+					ProjectToPlane(n, T);
+				}
+				if (bHasGroup0 && bHasGroup1)
+				{
+					float* M = &MirroredTangents[v * 3];
+					M[0] = Sum[1][0]; M[1] = Sum[1][1]; M[2] = Sum[1][2];
+					ProjectToPlane(n, M);
+					bSplit[v] = 1;
+				}
+			}
+		});
+
+		// split the vertices on mirror seams, the mirrored corners reference the new vertex
+		OutSplitVertices.clear();
+		{
+			SCOPED_CPU_MARKER("SplitVertices");
+			for (size_t v = 0; v < NumVertices; ++v)
+			{
+				if (!bSplit[v])
+					continue;
+				const uint32 iNewVertex = static_cast<uint32>(NumVertices + OutSplitVertices.size());
+				OutSplitVertices.push_back(static_cast<uint32>(v));
+				OutTangents.insert(OutTangents.end(), &MirroredTangents[v * 3], &MirroredTangents[v * 3] + 3);
+				for (uint32 i = CornerOffsets[v]; i < CornerOffsets[v + 1]; ++i)
+				{
+					const uint32 c = Corners[i];
+					if ((Triangles[c / 3].Flags & (ORIENT_PRESERVING | DEGENERATE)) == 0)
+						Indices[c] = iNewVertex;
+				}
+			}
+		}
+
+		t.Stop();
+		if (pStats)
+		{
+			pStats->NumTriangles           = NumTriangles;
+			pStats->NumDegenerateTriangles = NumDegenerateTriangles.load();
+			pStats->NumSplitVertices       = OutSplitVertices.size();
+			pStats->TimeMs                 = t.DeltaTime() * 1000.0f;
+			pStats->NumThreads             = pWorkerThreadPool ? pWorkerThreadPool->GetThreadPoolSize() + 1 : 1;
+		}
+	}
+}
@@ -0,0 +1,118 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+#pragma once
+
+#include "../Core/Types.h"
+
+#include <algorithm>
+#include <vector>
+
+class ThreadPool;
+
+//
+// TANGENT SPACE
+//
+// MikkTSpace compatible tangent generation for the meshes imported without a TANGENT attribute,
+// matching the tangent space normal maps are baked in by the common tools:
+//  - per triangle: the unit dP/du direction, oriented by the sign of the UV area
+//  - per corner  : the triangle tangent projected onto the vertex normal plane, weighted by the corner angle
+//  - per vertex  : the sum of its corners, normalized. Corners of mirrored UV triangles (negative UV area)
+//                  and regular triangles form separate groups: vertices on mirror seams are split.
+// Triangles with degenerate UVs don't contribute, their vertices fall back to an axis perpendicular to the normal.
+//
+// Triangles are processed in parallel over index ranges, 4 triangles per SSE iteration, then each vertex gathers the contributions of its
+// corners from a vertex -> corner table (the reduction), in parallel over vertex ranges. The calling thread
+// processes ranges too and never waits on unstarted tasks, so it's safe to call from a worker of the same pool.
+// The reduction stays scalar: each vertex walks a variable number of corners and the corner angle needs acos(),
+// which has no SSE instruction. A polynomial approximation would drift from the tangents the bakers generate.
+//
+// Ref: Mikkelsen - Simulation of Wrinkled Surfaces Revisited (2008), mikktspace.c
+//
+namespace TangentSpace
+{
+	struct FStats
+	{
+		size_t NumTriangles           = 0;
+		size_t NumDegenerateTriangles = 0; // zero UV area
+		size_t NumSplitVertices       = 0; // vertices added for the mirrored UV corners
+		float  TimeMs                 = 0.0f;
+		size_t NumThreads             = 1; // the calling thread + the workers available to it
+
+		void operator+=(const FStats& o) { NumTriangles += o.NumTriangles; NumDegenerateTriangles += o.NumDegenerateTriangles; NumSplitVertices += o.NumSplitVertices; TimeMs += o.TimeMs; NumThreads = std::max(NumThreads, o.NumThreads); }
+	};
+
+	struct FVertexStreams
+	{
+		const float* pPositions = nullptr;
+		const float* pNormals   = nullptr;
+		const float* pUVs       = nullptr;
+		size_t       Stride     = 0; // bytes, same for all streams
+		size_t       NumVertices = 0;
+	};
+
+	// Writes 3 floats per vertex to OutTangents, including the split vertices: OutSplitVertices receives the source vertex of
+	// each vertex to be appended after the NumVertices input vertices, and Indices are rewritten to reference them.
+	// pWorkerThreadPool is optional, small meshes are processed on the calling thread.
+	void GenerateTangents(const FVertexStreams& Streams, std::vector<uint32>& Indices, std::vector<float>& OutTangents, std::vector<uint32>& OutSplitVertices, ThreadPool* pWorkerThreadPool, FStats* pStats = nullptr);
+
+	// TVertex needs position, normal, uv & tangent float array members. Non-indexed meshes are supported: Indices can be empty.
+	template<class TVertex>
+	void GenerateTangents(std::vector<TVertex>& Vertices, std::vector<uint32>& Indices, ThreadPool* pWorkerThreadPool, FStats* pStats = nullptr);
+
+
+	// --------------------------------------------------------------------------------------------------------------------------------------------
+	// TEMPLATE DEFINITIONS
+	// --------------------------------------------------------------------------------------------------------------------------------------------
+	template<class TVertex>
+	void GenerateTangents(std::vector<TVertex>& Vertices, std::vector<uint32>& Indices, ThreadPool* pWorkerThreadPool, FStats* pStats)
+	{
+		if (Vertices.empty())
+			return;
+
+		FVertexStreams Streams;
+		Streams.pPositions  = Vertices[0].position;
+		Streams.pNormals    = Vertices[0].normal;
+		Streams.pUVs        = Vertices[0].uv;
+		Streams.Stride      = sizeof(TVertex);
+		Streams.NumVertices = Vertices.size();
+
+		std::vector<float> Tangents;
+		std::vector<uint32> SplitVertices;
+		if (Indices.empty())
+		{
+			std::vector<uint32> TriangleList(Vertices.size() - Vertices.size() % 3);
+			for (size_t i = 0; i < TriangleList.size(); ++i)
+				TriangleList[i] = static_cast<uint32>(i);
+			GenerateTangents(Streams, TriangleList, Tangents, SplitVertices, pWorkerThreadPool, pStats); // no shared vertices: no splits
+		}
+		else
+		{
+			GenerateTangents(Streams, Indices, Tangents, SplitVertices, pWorkerThreadPool, pStats);
+		}
+
+		Vertices.reserve(Vertices.size() + SplitVertices.size());
+		for (uint32 iSrc : SplitVertices)
+			Vertices.push_back(Vertices[iSrc]);
+		for (size_t i = 0; i < Vertices.size(); ++i)
+		{
+			Vertices[i].tangent[0] = Tangents[i * 3 + 0];
+			Vertices[i].tangent[1] = Tangents[i * 3 + 1];
+			Vertices[i].tangent[2] = Tangents[i * 3 + 2];
+		}
+	}
+}
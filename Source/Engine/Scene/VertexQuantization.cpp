@@ -0,0 +1,232 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+
+#include "VertexQuantization.h"
+
+#include "Engine/GPUMarker.h"
+
+#include <cmath>
+#include <cfloat>
+#include <climits>
+#include <algorithm>
+
+namespace VertexQuantization
+{
+	using FVertex = FVertexWithNormalAndTangent;
+	constexpr double RAD_TO_DEG = 180.0 / 3.14159265358979323846;
+
+	// zero-length vectors (missing tangents etc.) are encoded as the given axis
+	static void NormalizeOrDefault(const float v[3], float out[3], int DefaultAxis)
+	{
+		const float Len = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+		if (Len < 1e-8f || !std::isfinite(Len))
+		{
+			out[0] = out[1] = out[2] = 0.0f;
+			out[DefaultAxis] = 1.0f;
+			return;
+		}
+		out[0] = v[0] / Len;
+		out[1] = v[1] / Len;
+		out[2] = v[2] / Len;
+	}
+
+	static float DecodeUNORM(uint32 q, uint32 MaxValue) { return static_cast<float>(q) / MaxValue; }
+	static float DecodeSNORMRemapped(uint32 q, uint32 MaxValue) { return DecodeUNORM(q, MaxValue) * 2.0f - 1.0f; } // [0, 1] --> [-1, 1], as the shaders do
+
+	// angle between v and the decoded vector, in degrees
+	static double AngleDegrees(const float v[3], const float d[3])
+	{
+		const double cx = double(v[1]) * d[2] - double(v[2]) * d[1];
+		const double cy = double(v[2]) * d[0] - double(v[0]) * d[2];
+		const double cz = double(v[0]) * d[1] - double(v[1]) * d[0];
+		const double dot = double(v[0]) * d[0] + double(v[1]) * d[1] + double(v[2]) * d[2];
+		return std::atan2(std::sqrt(cx * cx + cy * cy + cz * cz), dot) * RAD_TO_DEG;
+	}
+
+	static double DirectionError16(const float v[3])
+	{
+		uint16 q[3];
+		PackRGB16F(v, q);
+		const float d[3] = { DecodeSNORMRemapped(q[0], USHRT_MAX), DecodeSNORMRemapped(q[1], USHRT_MAX), DecodeSNORMRemapped(q[2], USHRT_MAX) };
+		return AngleDegrees(v, d);
+	}
+	static double DirectionError10(const float v[3])
+	{
+		const uint32 q = PackRGB10A2(v[0], v[1], v[2]);
+		const float d[3] = { DecodeSNORMRemapped(q & 0x3FF, 1023), DecodeSNORMRemapped((q >> 10) & 0x3FF, 1023), DecodeSNORMRemapped((q >> 20) & 0x3FF, 1023) };
+		return AngleDegrees(v, d);
+	}
+
+	static void PackUV(const float uv[2], const float UVScaleBias[4], uint16 out[2])
+	{
+		float uvNormalized[2] =
+		{
+			std::clamp((uv[0] - UVScaleBias[2]) / UVScaleBias[0], 0.0f, 1.0f),
+			std::clamp((uv[1] - UVScaleBias[3]) / UVScaleBias[1], 0.0f, 1.0f)
+		};
+		PackUV16(uvNormalized, out);
+	}
+
+	void FReport::operator+=(const FReport& o)
+	{
+		MaxNormalErrorDegrees = std::max(MaxNormalErrorDegrees, o.MaxNormalErrorDegrees);
+		MaxUVError = std::max(MaxUVError, o.MaxUVError);
+		NumVertices += o.NumVertices;
+		BytesBefore += o.BytesBefore;
+		BytesAfter  += o.BytesAfter;
+	}
+
+	FReport SelectFormat(const GeometryData<FVertex, uint32>& Data, const FParams& Params, float UVScaleBias[4])
+	{
+		SCOPED_CPU_MARKER("VertexQuantization::SelectFormat");
+		FReport Report;
+		UVScaleBias[0] = UVScaleBias[1] = 1.0f;
+		UVScaleBias[2] = UVScaleBias[3] = 0.0f;
+
+		// uv bounds
+		bool bFiniteUVs = true;
+		float UVMin[2] = {  FLT_MAX,  FLT_MAX };
+		float UVMax[2] = { -FLT_MAX, -FLT_MAX };
+		for (const std::vector<FVertex>& Vertices : Data.LODVertices)
+		{
+			Report.NumVertices += Vertices.size();
+			for (const FVertex& v : Vertices)
+			{
+				bFiniteUVs = bFiniteUVs && std::isfinite(v.uv[0]) && std::isfinite(v.uv[1]);
+				for (int i = 0; i < 2; ++i)
+				{
+					UVMin[i] = std::min(UVMin[i], v.uv[i]);
+					UVMax[i] = std::max(UVMax[i], v.uv[i]);
+				}
+			}
+		}
+		Report.BytesBefore = Report.NumVertices * sizeof(FVertex);
+		Report.BytesAfter = Report.BytesBefore;
+		if (Report.NumVertices == 0 || !bFiniteUVs)
+			return Report;
+
+		for (int i = 0; i < 2; ++i)
+		{
+			if (UVMin[i] >= 0.0f && UVMax[i] <= 1.0f)
+				continue; // unorm range already, keep the identity remap
+			UVScaleBias[i] = std::max(UVMax[i] - UVMin[i], FLT_MIN);
+			UVScaleBias[2 + i] = UVMin[i];
+		}
+
+		// measure
+		double MaxError10 = 0.0;
+		double MaxError16 = 0.0;
+		double MaxErrorUV = 0.0;
+		for (const std::vector<FVertex>& Vertices : Data.LODVertices)
+		{
+			for (const FVertex& v : Vertices)
+			{
+				float n[3]; NormalizeOrDefault(v.normal, n, 1);
+				float t[3]; NormalizeOrDefault(v.tangent, t, 0);
+				MaxError10 = std::max({ MaxError10, DirectionError10(n), DirectionError10(t) });
+				MaxError16 = std::max({ MaxError16, DirectionError16(n), DirectionError16(t) });
+
+				uint16 q[2];
+				PackUV(v.uv, UVScaleBias, q);
+				for (int i = 0; i < 2; ++i)
+				{
+					const float uvDecoded = DecodeUNORM(q[i], USHRT_MAX) * UVScaleBias[i] + UVScaleBias[2 + i];
+					MaxErrorUV = std::max(MaxErrorUV, std::abs(double(uvDecoded) - v.uv[i]));
+				}
+			}
+		}
+
+		// select
+		if (MaxErrorUV > Params.MaxUVError)
+		{
+			UVScaleBias[0] = UVScaleBias[1] = 1.0f;
+			UVScaleBias[2] = UVScaleBias[3] = 0.0f;
+			return Report; // uv range too large for 16 bits, keep full precision
+		}
+		if (MaxError10 <= Params.MaxNormalErrorDegrees)
+		{
+			Report.Format = NORMAL_AND_TANGENT_PACKED2;
+			Report.MaxNormalErrorDegrees = static_cast<float>(MaxError10);
+			Report.BytesAfter = Report.NumVertices * sizeof(FVertexWithNormalAndTangentPacked2);
+		}
+		else if (MaxError16 <= Params.MaxNormalErrorDegrees)
+		{
+			Report.Format = NORMAL_AND_TANGENT_PACKED1;
+			Report.MaxNormalErrorDegrees = static_cast<float>(MaxError16);
+			Report.BytesAfter = Report.NumVertices * sizeof(FVertexWithNormalAndTangentPacked1);
+		}
+		else
+		{
+			UVScaleBias[0] = UVScaleBias[1] = 1.0f;
+			UVScaleBias[2] = UVScaleBias[3] = 0.0f;
+			return Report;
+		}
+		Report.MaxUVError = static_cast<float>(MaxErrorUV);
+		return Report;
+	}
+
+	template<class TPackedVertex, class FPackFn>
+	static GeometryData<TPackedVertex, uint32> PackVertices(GeometryData<FVertex, uint32>&& Data, const float UVScaleBias[4], FPackFn&& fnPackDirections)
+	{
+		GeometryData<TPackedVertex, uint32> Packed(Data.LODVertices.size());
+		for (size_t LOD = 0; LOD < Data.LODVertices.size(); ++LOD)
+		{
+			const std::vector<FVertex>& Vertices = Data.LODVertices[LOD];
+			std::vector<TPackedVertex>& PackedVertices = Packed.LODVertices[LOD];
+			PackedVertices.resize(Vertices.size());
+			for (size_t i = 0; i < Vertices.size(); ++i)
+			{
+				const FVertex& v = Vertices[i];
+				TPackedVertex& p = PackedVertices[i];
+				p.position[0] = v.position[0];
+				p.position[1] = v.position[1];
+				p.position[2] = v.position[2];
+
+				float n[3]; NormalizeOrDefault(v.normal, n, 1);
+				float t[3]; NormalizeOrDefault(v.tangent, t, 0);
+				fnPackDirections(n, t, p);
+				PackUV(v.uv, UVScaleBias, p.uv);
+			}
+			Packed.LODIndices[LOD] = std::move(Data.LODIndices[LOD]);
+		}
+		Packed.LODErrors = std::move(Data.LODErrors);
+		Packed.LODMeshlets = std::move(Data.LODMeshlets); // positions & triangle order are unchanged
+		for (int i = 0; i < 4; ++i)
+			Packed.UVScaleBias[i] = UVScaleBias[i];
+		return Packed;
+	}
+
+	GeometryData<FVertexWithNormalAndTangentPacked1, uint32> PackVertices1(GeometryData<FVertex, uint32>&& Data, const float UVScaleBias[4])
+	{
+		SCOPED_CPU_MARKER("VertexQuantization::PackVertices1");
+		return PackVertices<FVertexWithNormalAndTangentPacked1>(std::move(Data), UVScaleBias, [](const float n[3], const float t[3], FVertexWithNormalAndTangentPacked1& p)
+		{
+			PackRGB16F(n, p.normal);
+			PackRGB16F(t, p.tangent);
+		});
+	}
+	GeometryData<FVertexWithNormalAndTangentPacked2, uint32> PackVertices2(GeometryData<FVertex, uint32>&& Data, const float UVScaleBias[4])
+	{
+		SCOPED_CPU_MARKER("VertexQuantization::PackVertices2");
+		return PackVertices<FVertexWithNormalAndTangentPacked2>(std::move(Data), UVScaleBias, [](const float n[3], const float t[3], FVertexWithNormalAndTangentPacked2& p)
+		{
+			p.normal  = PackRGB10A2(n[0], n[1], n[2]);
+			p.tangent = PackRGB10A2(t[0], t[1], t[2]);
+		});
+	}
+}
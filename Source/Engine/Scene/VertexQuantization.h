@@ -0,0 +1,66 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+#pragma once
+
+#include "../Core/Types.h"
+#include "MeshGeometryData.h"
+#include "Renderer/Resources/Buffer.h"
+
+//
+// VERTEX QUANTIZATION
+//
+// Picks the smallest vertex format that keeps the imported attributes within the error limits:
+//
+//   format                            | size | normal & tangent | uv
+//   ----------------------------------+------+------------------+---------
+//   FVertexWithNormalAndTangentPacked2| 24B  | RGB10A2 unorm    | RG16 unorm
+//   FVertexWithNormalAndTangentPacked1| 28B  | RGB16 unorm      | RG16 unorm
+//   FVertexWithNormalAndTangent       | 44B  | RGB32 float      | RG32 float
+//
+// Positions stay fp32 in all the formats. UVs outside [0, 1] (tiling, atlases) are remapped to
+// the UV bounds of the mesh, the shaders undo the remap with GeometryData::UVScaleBias which the
+// renderer folds into the material's UV scale & bias.
+//
+namespace VertexQuantization
+{
+	struct FParams
+	{
+		float MaxNormalErrorDegrees = 0.125f;         // max angle between the source and the decoded normals/tangents, 10 bit encodings stay below ~0.1 degrees
+		float MaxUVError            = 1.0f / 8192.0f; // max absolute UV difference: 1/8th of a texel of a 1K texture
+	};
+
+	struct FReport
+	{
+		EVertexBufferType Format = NORMAL_AND_TANGENT;
+		float MaxNormalErrorDegrees = 0.0f; // of the selected format
+		float MaxUVError = 0.0f;            // of the selected format
+		size_t NumVertices = 0;             // all LODs
+		size_t BytesBefore = 0;
+		size_t BytesAfter = 0;
+
+		void operator+=(const FReport& o);
+	};
+
+	// Measures the error of each packed format on all the LODs of Data and returns the smallest format within the limits.
+	// UVScaleBias receives the UV remap of the packed formats: uv = uv_packed * scale + bias.
+	FReport SelectFormat(const GeometryData<FVertexWithNormalAndTangent, uint32>& Data, const FParams& Params, float UVScaleBias[4]);
+
+	// Encodes the vertices using the UV remap returned by SelectFormat()
+	GeometryData<FVertexWithNormalAndTangentPacked1, uint32> PackVertices1(GeometryData<FVertexWithNormalAndTangent, uint32>&& Data, const float UVScaleBias[4]);
+	GeometryData<FVertexWithNormalAndTangentPacked2, uint32> PackVertices2(GeometryData<FVertexWithNormalAndTangent, uint32>&& Data, const float UVScaleBias[4]);
+}
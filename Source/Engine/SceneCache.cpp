@@ -0,0 +1,382 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+
+#include "SceneCache.h"
+#include "GPUMarker.h"
+#include "Core/Hash.h"
+#include "Core/MappedFile.h"
+#include "Core/VirtualFileSystem.h"
+#include "Core/FileParser.h"
+
+#include "Libs/VQUtils/Include/utils.h"
+#include "Libs/VQUtils/Include/Log.h"
+#include "Libs/VQUtils/Include/Timer.h"
+
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+#include <cstring>
+
+static const std::string SCENE_CACHE_DIRECTORY = "Cache/Scenes";
+
+using Hash::HashBytes;
+
+template<class T> static inline const T* GetTable(const FMappedFile& File, uint64 Offset) { return File.GetDataAt<T>(static_cast<size_t>(Offset)); }
+
+
+std::string SceneCache::GetCookedFilePath(const std::string& SceneFilePath)
+{
+	return SCENE_CACHE_DIRECTORY + "/" + DirectoryUtil::GetFileNameWithoutExtension(SceneFilePath) + ".vqscene";
+}
+
+uint64 SceneCache::ComputeSourceHash(const std::string& SceneFilePath)
+{
+	SCOPED_CPU_MARKER("SceneCache::ComputeSourceHash");
+	VFS::FFile SceneFile;
+	if (!VFS::ReadFile(SceneFilePath, SceneFile) || SceneFile.GetSize() == 0)
+		return 0;
+	return HashBytes(SceneFile.GetData(), SceneFile.GetSize());
+}
+
+
+
+//
+// WRITE
+//
+bool SceneCache::WriteCookedScene(const std::string& CookedFilePath, uint64 SourceHash, const FSceneRepresentation& Scene)
+{
+	SCOPED_CPU_MARKER("SceneCache::WriteCookedScene");
+
+	std::vector<FCookedGameObject> Objects(Scene.Objects.size());
+	std::vector<FCookedMaterial>   Materials(Scene.Materials.size());
+	std::string                    Strings;
+	std::unordered_map<std::string, uint32> StringOffsets; // generated levels repeat the same model paths & names
+
+	auto fnAddString = [&Strings, &StringOffsets](const std::string& s)
+	{
+		auto it = StringOffsets.find(s);
+		if (it != StringOffsets.end())
+			return it->second;
+		const uint32 Offset = static_cast<uint32>(Strings.size());
+		Strings.append(s.c_str(), s.size() + 1);
+		StringOffsets.emplace(s, Offset);
+		return Offset;
+	};
+	fnAddString(""); // offset 0
+
+	// tables
+	for (size_t iObj = 0; iObj < Scene.Objects.size(); ++iObj)
+	{
+		const FGameObjectRepresentation& obj = Scene.Objects[iObj];
+		FCookedGameObject& cooked = Objects[iObj];
+		memcpy(cooked.Position, &obj.tf._position, sizeof(cooked.Position));
+		memcpy(cooked.Rotation, &obj.tf._rotation.V, sizeof(float) * 3);
+		cooked.Rotation[3] = obj.tf._rotation.S;
+		memcpy(cooked.Scale, &obj.tf._scale, sizeof(cooked.Scale));
+		cooked.ModelNameOffset       = fnAddString(obj.ModelName);
+		cooked.ModelPathOffset       = fnAddString(obj.ModelFilePath);
+		cooked.BuiltinMeshNameOffset = fnAddString(obj.BuiltinMeshName);
+		cooked.MaterialNameOffset    = fnAddString(obj.MaterialName);
+	}
+	for (size_t iMat = 0; iMat < Scene.Materials.size(); ++iMat)
+	{
+		const FMaterialRepresentation& mat = Scene.Materials[iMat];
+		FCookedMaterial& cooked = Materials[iMat];
+		cooked = {};
+		cooked.NameOffset = fnAddString(mat.Name);
+		cooked.TexturePathOffsets[COOKED_MATERIAL_TEXTURE_DIFFUSE]    = fnAddString(mat.DiffuseMapFilePath);
+		cooked.TexturePathOffsets[COOKED_MATERIAL_TEXTURE_NORMAL]     = fnAddString(mat.NormalMapFilePath);
+		cooked.TexturePathOffsets[COOKED_MATERIAL_TEXTURE_EMISSIVE]   = fnAddString(mat.EmissiveMapFilePath);
+		cooked.TexturePathOffsets[COOKED_MATERIAL_TEXTURE_ALPHA_MASK] = fnAddString(mat.AlphaMaskMapFilePath);
+		cooked.TexturePathOffsets[COOKED_MATERIAL_TEXTURE_METALLIC]   = fnAddString(mat.MetallicMapFilePath);
+		cooked.TexturePathOffsets[COOKED_MATERIAL_TEXTURE_ROUGHNESS]  = fnAddString(mat.RoughnessMapFilePath);
+		cooked.TexturePathOffsets[COOKED_MATERIAL_TEXTURE_AO]         = fnAddString(mat.AOMapFilePath);
+		cooked.TexturePathOffsets[COOKED_MATERIAL_TEXTURE_HEIGHT]     = fnAddString(mat.HeightMapFilePath);
+		memcpy(cooked.DiffuseColor, &mat.DiffuseColor, sizeof(cooked.DiffuseColor));
+		cooked.Alpha = mat.Alpha;
+		memcpy(cooked.EmissiveColor, &mat.EmissiveColor, sizeof(cooked.EmissiveColor));
+		cooked.EmissiveIntensity = mat.EmissiveIntensity;
+		cooked.Metalness = mat.Metalness;
+		cooked.Roughness = mat.Roughness;
+		cooked.Displacement = mat.Displacement;
+		cooked.TilingX = mat.TilingX;
+		cooked.TilingY = mat.TilingY;
+		cooked.TessellationDomain         = static_cast<uint8>(mat.TessellationDomain);
+		cooked.TessellationOutputTopology = static_cast<uint8>(mat.TessellationOutputTopology);
+		cooked.TessellationPartitioning   = static_cast<uint8>(mat.TessellationPartitioning);
+		cooked.bTessellationEnabled       = mat.TessellationEnabled ? 1 : 0;
+		memcpy(cooked.Tessellation, &mat.Tessellation, sizeof(cooked.Tessellation));
+	}
+
+	FCookedSceneHeader Header = {};
+	Header.Magic                      = COOKED_SCENE_MAGIC;
+	Header.FormatVersion              = COOKED_SCENE_FORMAT_VERSION;
+	Header.ParserVersion              = SCENE_PARSER_VERSION;
+	Header.SourceHash                 = SourceHash;
+	Header.NumObjects                 = static_cast<uint32>(Objects.size());
+	Header.NumMaterials               = static_cast<uint32>(Materials.size());
+	Header.NumCameras                 = static_cast<uint32>(Scene.Cameras.size());
+	Header.NumLights                  = static_cast<uint32>(Scene.Lights.size());
+	Header.CameraSize                 = sizeof(FCameraParameters);
+	Header.LightSize                  = sizeof(Light);
+	Header.SceneNameOffset            = fnAddString(Scene.SceneName);
+	Header.EnvironmentMapPresetOffset = fnAddString(Scene.EnvironmentMapPreset);
+	Header.StringTableSize            = static_cast<uint32>(Strings.size());
+	Header.OffsetObjects              = sizeof(FCookedSceneHeader);
+	Header.OffsetMaterials            = Header.OffsetObjects   + sizeof(FCookedGameObject) * Objects.size();
+	Header.OffsetCameras              = Header.OffsetMaterials + sizeof(FCookedMaterial)   * Materials.size();
+	Header.OffsetLights               = Header.OffsetCameras   + sizeof(FCameraParameters) * Scene.Cameras.size();
+	Header.OffsetStrings              = Header.OffsetLights    + sizeof(Light)             * Scene.Lights.size();
+	Header.FileSize                   = Header.OffsetStrings   + Strings.size();
+
+	// write to a temp file and rename it at the end so that a cooked file is either complete or absent
+	DirectoryUtil::CreateFolderIfItDoesntExist(SCENE_CACHE_DIRECTORY);
+	const std::string TempFilePath = CookedFilePath + ".tmp";
+	{
+		std::ofstream File(TempFilePath, std::ios::binary | std::ios::trunc);
+		if (!File.is_open())
+		{
+			Log::Error("SceneCache: couldn't open %s for writing", TempFilePath.c_str());
+			return false;
+		}
+
+		auto fnWrite = [&File](const void* pData, uint64 NumBytes) { File.write(static_cast<const char*>(pData), static_cast<std::streamsize>(NumBytes)); };
+		fnWrite(&Header, sizeof(Header));
+		fnWrite(Objects.data(), sizeof(FCookedGameObject) * Objects.size());
+		fnWrite(Materials.data(), sizeof(FCookedMaterial) * Materials.size());
+		fnWrite(Scene.Cameras.data(), sizeof(FCameraParameters) * Scene.Cameras.size());
+		fnWrite(Scene.Lights.data(), sizeof(Light) * Scene.Lights.size());
+		fnWrite(Strings.data(), Strings.size());
+
+		if (!File.good())
+		{
+			Log::Error("SceneCache: error writing %s", TempFilePath.c_str());
+			File.close();
+			std::remove(TempFilePath.c_str());
+			return false;
+		}
+	}
+
+	std::error_code ec;
+	std::filesystem::rename(TempFilePath, CookedFilePath, ec);
+	if (ec)
+	{
+		Log::Error("SceneCache: couldn't move %s to %s: %s", TempFilePath.c_str(), CookedFilePath.c_str(), ec.message().c_str());
+		std::remove(TempFilePath.c_str());
+		return false;
+	}
+	return true;
+}
+
+
+
+//
+// READ
+//
+static bool ValidateCookedScene(const FMappedFile& File, const std::string& CookedFilePath)
+{
+	using namespace SceneCache;
+	if (File.GetSize() < sizeof(FCookedSceneHeader))
+	{
+		Log::Warning("SceneCache: %s is truncated", CookedFilePath.c_str());
+		return false;
+	}
+	const FCookedSceneHeader& Header = *GetTable<FCookedSceneHeader>(File, 0);
+	if (Header.Magic != COOKED_SCENE_MAGIC || Header.FormatVersion != COOKED_SCENE_FORMAT_VERSION
+		|| Header.CameraSize != sizeof(FCameraParameters) || Header.LightSize != sizeof(Light))
+	{
+		Log::Info("SceneCache: %s has an unknown format (version %u, expected %u)", CookedFilePath.c_str(), Header.FormatVersion, COOKED_SCENE_FORMAT_VERSION);
+		return false;
+	}
+	const bool bTablesFit = Header.FileSize == File.GetSize()
+		&& Header.OffsetObjects   + sizeof(FCookedGameObject) * Header.NumObjects   <= Header.OffsetMaterials
+		&& Header.OffsetMaterials + sizeof(FCookedMaterial)   * Header.NumMaterials <= Header.OffsetCameras
+		&& Header.OffsetCameras   + sizeof(FCameraParameters) * Header.NumCameras   <= Header.OffsetLights
+		&& Header.OffsetLights    + sizeof(Light)             * Header.NumLights    <= Header.OffsetStrings
+		&& Header.OffsetStrings   + Header.StringTableSize                          <= Header.FileSize
+		&& Header.StringTableSize > 0 && *GetTable<char>(File, Header.OffsetStrings + Header.StringTableSize - 1) == '\0';
+	if (!bTablesFit)
+	{
+		Log::Warning("SceneCache: %s is corrupt", CookedFilePath.c_str());
+		return false;
+	}
+
+	bool bRangesValid = Header.SceneNameOffset < Header.StringTableSize && Header.EnvironmentMapPresetOffset < Header.StringTableSize;
+	const FCookedGameObject* pObjects = GetTable<FCookedGameObject>(File, Header.OffsetObjects);
+	for (uint32 i = 0; i < Header.NumObjects && bRangesValid; ++i)
+	{
+		bRangesValid = pObjects[i].ModelNameOffset < Header.StringTableSize
+			&& pObjects[i].ModelPathOffset         < Header.StringTableSize
+			&& pObjects[i].BuiltinMeshNameOffset   < Header.StringTableSize
+			&& pObjects[i].MaterialNameOffset      < Header.StringTableSize;
+	}
+	const FCookedMaterial* pMaterials = GetTable<FCookedMaterial>(File, Header.OffsetMaterials);
+	for (uint32 i = 0; i < Header.NumMaterials && bRangesValid; ++i)
+	{
+		bRangesValid = pMaterials[i].NameOffset < Header.StringTableSize;
+		for (uint32 iTex = 0; iTex < NUM_COOKED_MATERIAL_TEXTURES && bRangesValid; ++iTex)
+			bRangesValid = pMaterials[i].TexturePathOffsets[iTex] < Header.StringTableSize;
+	}
+	if (!bRangesValid)
+	{
+		Log::Warning("SceneCache: %s is corrupt", CookedFilePath.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool SceneCache::ReadCookedScene(const std::string& CookedFilePath, uint64 SourceHash, FSceneRepresentation& OutScene)
+{
+	SCOPED_CPU_MARKER("SceneCache::ReadCookedScene");
+	FMappedFile File;
+	if (!File.Open(CookedFilePath))
+		return false;
+
+	if (!ValidateCookedScene(File, CookedFilePath))
+		return false;
+
+	const FCookedSceneHeader& Header = *GetTable<FCookedSceneHeader>(File, 0);
+	if (Header.SourceHash != SourceHash || Header.ParserVersion != SCENE_PARSER_VERSION)
+	{
+		Log::Info("SceneCache: %s is stale (source %s, parser version %u -> %u)", CookedFilePath.c_str()
+			, (Header.SourceHash != SourceHash ? "changed" : "unchanged"), Header.ParserVersion, SCENE_PARSER_VERSION);
+		return false;
+	}
+
+	const char* pStrings = GetTable<char>(File, Header.OffsetStrings);
+	FSceneRepresentation& Scene = OutScene;
+	Scene = {};
+	Scene.SceneName = pStrings + Header.SceneNameOffset;
+	Scene.EnvironmentMapPreset = pStrings + Header.EnvironmentMapPresetOffset;
+
+	{
+		SCOPED_CPU_MARKER("Objects");
+		const FCookedGameObject* pObjects = GetTable<FCookedGameObject>(File, Header.OffsetObjects);
+		Scene.Objects.resize(Header.NumObjects);
+		for (uint32 i = 0; i < Header.NumObjects; ++i)
+		{
+			const FCookedGameObject& cooked = pObjects[i];
+			FGameObjectRepresentation& obj = Scene.Objects[i];
+			obj.tf = Transform(
+				  DirectX::XMFLOAT3(cooked.Position[0], cooked.Position[1], cooked.Position[2])
+				, Quaternion(cooked.Rotation[3], DirectX::XMFLOAT3(cooked.Rotation[0], cooked.Rotation[1], cooked.Rotation[2]))
+				, DirectX::XMFLOAT3(cooked.Scale[0], cooked.Scale[1], cooked.Scale[2])
+			);
+			obj.ModelName       = pStrings + cooked.ModelNameOffset;
+			obj.ModelFilePath   = pStrings + cooked.ModelPathOffset;
+			obj.BuiltinMeshName = pStrings + cooked.BuiltinMeshNameOffset;
+			obj.MaterialName    = pStrings + cooked.MaterialNameOffset;
+		}
+	}
+	{
+		SCOPED_CPU_MARKER("Materials");
+		const FCookedMaterial* pMaterials = GetTable<FCookedMaterial>(File, Header.OffsetMaterials);
+		Scene.Materials.resize(Header.NumMaterials);
+		for (uint32 i = 0; i < Header.NumMaterials; ++i)
+		{
+			const FCookedMaterial& cooked = pMaterials[i];
+			FMaterialRepresentation& mat = Scene.Materials[i];
+			mat.Name                 = pStrings + cooked.NameOffset;
+			mat.DiffuseMapFilePath   = pStrings + cooked.TexturePathOffsets[COOKED_MATERIAL_TEXTURE_DIFFUSE];
+			mat.NormalMapFilePath    = pStrings + cooked.TexturePathOffsets[COOKED_MATERIAL_TEXTURE_NORMAL];
+			mat.EmissiveMapFilePath  = pStrings + cooked.TexturePathOffsets[COOKED_MATERIAL_TEXTURE_EMISSIVE];
+			mat.AlphaMaskMapFilePath = pStrings + cooked.TexturePathOffsets[COOKED_MATERIAL_TEXTURE_ALPHA_MASK];
+			mat.MetallicMapFilePath  = pStrings + cooked.TexturePathOffsets[COOKED_MATERIAL_TEXTURE_METALLIC];
+			mat.RoughnessMapFilePath = pStrings + cooked.TexturePathOffsets[COOKED_MATERIAL_TEXTURE_ROUGHNESS];
+			mat.AOMapFilePath        = pStrings + cooked.TexturePathOffsets[COOKED_MATERIAL_TEXTURE_AO];
+			mat.HeightMapFilePath    = pStrings + cooked.TexturePathOffsets[COOKED_MATERIAL_TEXTURE_HEIGHT];
+			memcpy(&mat.DiffuseColor, cooked.DiffuseColor, sizeof(cooked.DiffuseColor));
+			mat.Alpha = cooked.Alpha;
+			memcpy(&mat.EmissiveColor, cooked.EmissiveColor, sizeof(cooked.EmissiveColor));
+			mat.EmissiveIntensity = cooked.EmissiveIntensity;
+			mat.Metalness = cooked.Metalness;
+			mat.Roughness = cooked.Roughness;
+			mat.Displacement = cooked.Displacement;
+			mat.TilingX = cooked.TilingX;
+			mat.TilingY = cooked.TilingY;
+			mat.TessellationDomain         = static_cast<ETessellationDomain>(cooked.TessellationDomain);
+			mat.TessellationOutputTopology = static_cast<ETessellationOutputTopology>(cooked.TessellationOutputTopology);
+			mat.TessellationPartitioning   = static_cast<ETessellationPartitioning>(cooked.TessellationPartitioning);
+			mat.TessellationEnabled        = cooked.bTessellationEnabled != 0;
+			memcpy(&mat.Tessellation, cooked.Tessellation, sizeof(cooked.Tessellation));
+		}
+	}
+
+	// stored as-is
+	Scene.Cameras.resize(Header.NumCameras);
+	memcpy(Scene.Cameras.data(), GetTable<FCameraParameters>(File, Header.OffsetCameras), sizeof(FCameraParameters) * Header.NumCameras);
+	Scene.Lights.resize(Header.NumLights);
+	memcpy(Scene.Lights.data(), GetTable<Light>(File, Header.OffsetLights), sizeof(Light) * Header.NumLights);
+	return true;
+}
+
+
+
+//
+// LOAD
+//
+FSceneRepresentation SceneCache::LoadScene(const std::string& SceneFilePath)
+{
+	SCOPED_CPU_MARKER("SceneCache::LoadScene");
+	Timer t;
+	t.Start();
+	FSceneRepresentation Scene;
+
+#if SCENE_CACHE_ENABLED
+	const std::string CookedFilePath = GetCookedFilePath(SceneFilePath);
+	const uint64 SourceHash = ComputeSourceHash(SceneFilePath);
+	if (SourceHash != 0 && ReadCookedScene(CookedFilePath, SourceHash, Scene))
+	{
+		t.Stop();
+		Log::Info("[Scene] Loaded %s from %s in %.2fms: %zu objects, %zu materials, %zu lights", SceneFilePath.c_str(), CookedFilePath.c_str()
+			, t.DeltaTime() * 1000.0f, Scene.Objects.size(), Scene.Materials.size(), Scene.Lights.size());
+		return Scene;
+	}
+#endif
+
+	Scene = FileParser::ParseSceneFile(SceneFilePath);
+	t.Stop();
+	Log::Info("[Scene] Parsed %s in %.2fms: %zu objects, %zu materials, %zu lights", SceneFilePath.c_str()
+		, t.DeltaTime() * 1000.0f, Scene.Objects.size(), Scene.Materials.size(), Scene.Lights.size());
+
+#if SCENE_CACHE_ENABLED
+	if (SourceHash != 0)
+		WriteCookedScene(CookedFilePath, SourceHash, Scene);
+#endif
+	return Scene;
+}
+
+size_t SceneCache::CookSceneFiles(const std::string& SceneDirectory)
+{
+	SCOPED_CPU_MARKER("SceneCache::CookSceneFiles");
+	size_t NumCooked = 0;
+	for (const std::string& FilePath : DirectoryUtil::GetFilesInPath(SceneDirectory))
+	{
+		if (StrUtil::GetLowercased(DirectoryUtil::GetFileExtension(FilePath)) != "xml")
+			continue;
+
+		const uint64 SourceHash = ComputeSourceHash(FilePath);
+		const std::string CookedFilePath = GetCookedFilePath(FilePath);
+		if (SourceHash != 0 && WriteCookedScene(CookedFilePath, SourceHash, FileParser::ParseSceneFile(FilePath)))
+		{
+			Log::Info("SceneCache: cooked %s -> %s", FilePath.c_str(), CookedFilePath.c_str());
+			++NumCooked;
+		}
+	}
+	return NumCooked;
+}
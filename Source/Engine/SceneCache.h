@@ -0,0 +1,140 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+#pragma once
+
+#include "Core/Types.h"
+#include "Scene/Serialization.h"
+
+#include <string>
+#include <type_traits>
+
+// Set to 0 to always parse the scene XML files
+#define SCENE_CACHE_ENABLED 1
+
+//
+// SCENE CACHE
+//
+// Cooked binary representation of a scene file (FSceneRepresentation): the XML files in Data/Levels stay the
+// authoring format, the cooked file replaces the DOM walk & the text to float parsing on the next loads.
+// Objects, materials, cameras & lights are stored as fixed size records, strings are deduplicated into a
+// string table. The loader memory-maps the file and fills the representation with a single allocation per
+// container, the objects are then created in bulk by Scene::LoadGameObjects().
+//
+// A cooked scene is written when the XML is parsed (LoadScene()) or by the -CookScenes command line option
+// (CookSceneFiles()). It's used only if the XML hash & the parser version match, otherwise it's rebuilt.
+//
+// File layout, offsets are from the beginning of the file:
+//
+//   FCookedSceneHeader
+//   FCookedGameObject [NumObjects]
+//   FCookedMaterial   [NumMaterials]
+//   FCameraParameters [NumCameras]  as-is
+//   Light             [NumLights]   as-is
+//   char              [StringTableSize]  null-terminated strings
+//
+namespace SceneCache
+{
+	constexpr uint32 COOKED_SCENE_MAGIC          = 0x43535156; // "VQSC"
+	constexpr uint32 COOKED_SCENE_FORMAT_VERSION = 1;          // bump when the layout below changes
+	constexpr uint32 SCENE_PARSER_VERSION        = 1;          // bump when the output of FileParser::ParseSceneFile() changes
+
+	struct FCookedSceneHeader
+	{
+		uint32 Magic;
+		uint32 FormatVersion;
+		uint32 ParserVersion;
+		uint32 NumObjects;
+		uint32 NumMaterials;
+		uint32 NumCameras;
+		uint32 NumLights;
+		uint32 StringTableSize;
+		uint32 SceneNameOffset;
+		uint32 EnvironmentMapPresetOffset;
+		uint32 CameraSize; // sizeof(FCameraParameters) & sizeof(Light): the records are stored as-is
+		uint32 LightSize;
+		uint64 SourceHash;
+		uint64 FileSize;
+		uint64 OffsetObjects;
+		uint64 OffsetMaterials;
+		uint64 OffsetCameras;
+		uint64 OffsetLights;
+		uint64 OffsetStrings;
+	};
+	struct FCookedGameObject
+	{
+		float  Position[3];
+		float  Rotation[4]; // quaternion: xyz, w
+		float  Scale[3];
+		uint32 ModelNameOffset;
+		uint32 ModelPathOffset;
+		uint32 BuiltinMeshNameOffset;
+		uint32 MaterialNameOffset;
+	};
+	enum ECookedMaterialTexture : uint32
+	{
+		COOKED_MATERIAL_TEXTURE_DIFFUSE = 0,
+		COOKED_MATERIAL_TEXTURE_NORMAL,
+		COOKED_MATERIAL_TEXTURE_EMISSIVE,
+		COOKED_MATERIAL_TEXTURE_ALPHA_MASK,
+		COOKED_MATERIAL_TEXTURE_METALLIC,
+		COOKED_MATERIAL_TEXTURE_ROUGHNESS,
+		COOKED_MATERIAL_TEXTURE_AO,
+		COOKED_MATERIAL_TEXTURE_HEIGHT,
+
+		NUM_COOKED_MATERIAL_TEXTURES
+	};
+	struct FCookedMaterial
+	{
+		uint32 NameOffset;
+		uint32 TexturePathOffsets[NUM_COOKED_MATERIAL_TEXTURES];
+		float  DiffuseColor[3];
+		float  Alpha;
+		float  EmissiveColor[3];
+		float  EmissiveIntensity;
+		float  Metalness;
+		float  Roughness;
+		float  Displacement;
+		float  TilingX;
+		float  TilingY;
+		uint8  TessellationDomain;
+		uint8  TessellationOutputTopology;
+		uint8  TessellationPartitioning;
+		uint8  bTessellationEnabled;
+		uint8  Tessellation[sizeof(VQ_SHADER_DATA::TessellationParams)];
+	};
+	static_assert(sizeof(FCookedSceneHeader) == 104, "cooked file layout changed, bump COOKED_SCENE_FORMAT_VERSION");
+	static_assert(sizeof(FCookedGameObject)  == 56 , "cooked file layout changed, bump COOKED_SCENE_FORMAT_VERSION");
+	static_assert(std::is_trivially_copyable_v<FCameraParameters> && std::is_trivially_copyable_v<Light>, "cameras & lights are cooked as-is");
+
+	// Cache/Scenes/<SceneFileName>.vqscene
+	std::string GetCookedFilePath(const std::string& SceneFilePath);
+
+	// Hashes the scene file contents, 0 if the file can't be read
+	uint64 ComputeSourceHash(const std::string& SceneFilePath);
+
+	bool WriteCookedScene(const std::string& CookedFilePath, uint64 SourceHash, const FSceneRepresentation& Scene);
+
+	// returns false if the file doesn't exist, is corrupt or is stale w.r.t. the given source hash
+	bool ReadCookedScene(const std::string& CookedFilePath, uint64 SourceHash, FSceneRepresentation& OutScene);
+
+	// Reads the cooked scene if it's up to date, otherwise parses the XML and cooks it for the next load
+	FSceneRepresentation LoadScene(const std::string& SceneFilePath);
+
+	// Cooks every scene XML file in the directory, returns the number of scenes cooked
+	size_t CookSceneFiles(const std::string& SceneDirectory);
+}
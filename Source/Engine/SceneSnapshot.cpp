@@ -0,0 +1,232 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+
+#include "SceneSnapshot.h"
+#include "GPUMarker.h"
+#include "Core/MappedFile.h"
+
+#include "Libs/VQUtils/Include/utils.h"
+#include "Libs/VQUtils/Include/Log.h"
+
+#include <filesystem>
+#include <fstream>
+#include <cstring>
+
+static const std::string SCENE_SNAPSHOT_DIRECTORY = "Snapshots";
+
+static constexpr int NUM_LIGHT_MOBILITY_TYPES = Light::EMobility::NUM_LIGHT_MOBILITY_TYPES;
+
+std::string SceneSnapshot::GetSnapshotFilePath(const std::string& SceneName)
+{
+	return SCENE_SNAPSHOT_DIRECTORY + "/" + SceneName + ".vqsnap";
+}
+
+
+
+//
+// WRITE
+//
+bool SceneSnapshot::WriteSnapshot(const std::string& FilePath, const FSceneSnapshot& Snapshot)
+{
+	SCOPED_CPU_MARKER("SceneSnapshot::WriteSnapshot");
+
+	std::string Strings;
+	auto fnAddString = [&Strings](const std::string& s)
+	{
+		const uint32 Offset = static_cast<uint32>(Strings.size());
+		Strings.append(s.c_str(), s.size() + 1);
+		return Offset;
+	};
+	fnAddString(""); // offset 0
+
+	std::vector<uint32> MaterialNameOffsets(Snapshot.MaterialNames.size());
+	for (size_t i = 0; i < Snapshot.MaterialNames.size(); ++i)
+		MaterialNameOffsets[i] = fnAddString(Snapshot.MaterialNames[i]);
+
+	size_t NumLights = 0;
+	FSnapshotHeader Header = {};
+	Header.Magic                      = SCENE_SNAPSHOT_MAGIC;
+	Header.FormatVersion              = SCENE_SNAPSHOT_FORMAT_VERSION;
+	Header.NumCameras                 = static_cast<uint32>(Snapshot.Cameras.size());
+	for (int i = 0; i < NUM_LIGHT_MOBILITY_TYPES; ++i)
+	{
+		Header.NumLights[i] = static_cast<uint32>(Snapshot.Lights[i].size());
+		NumLights += Snapshot.Lights[i].size();
+	}
+	Header.NumTransforms              = static_cast<uint32>(Snapshot.Transforms.size());
+	Header.NumMaterials               = static_cast<uint32>(Snapshot.Materials.size());
+	Header.SceneNameOffset            = fnAddString(Snapshot.SceneName);
+	Header.EnvironmentMapPresetOffset = fnAddString(Snapshot.EnvironmentMapPreset);
+	Header.StringTableSize            = static_cast<uint32>(Strings.size());
+	Header.ActiveCamera               = Snapshot.ActiveCamera;
+	Header.LightSize                  = sizeof(Light);
+	Header.MaterialSize               = sizeof(Material);
+	Header.RenderSettingsSize         = sizeof(FSnapshotRenderSettings);
+	Header.OffsetCameras              = sizeof(FSnapshotHeader);
+	Header.OffsetLights               = Header.OffsetCameras        + sizeof(FSnapshotCamera)    * Snapshot.Cameras.size();
+	Header.OffsetTransforms           = Header.OffsetLights         + sizeof(Light)              * NumLights;
+	Header.OffsetMaterials            = Header.OffsetTransforms     + sizeof(FSnapshotTransform) * Snapshot.Transforms.size();
+	Header.OffsetMaterialNames        = Header.OffsetMaterials      + sizeof(Material)           * Snapshot.Materials.size();
+	Header.OffsetRenderSettings       = Header.OffsetMaterialNames  + sizeof(uint32)             * MaterialNameOffsets.size();
+	Header.OffsetStrings              = Header.OffsetRenderSettings + sizeof(FSnapshotRenderSettings);
+	Header.FileSize                   = Header.OffsetStrings        + Strings.size();
+
+	// the whole file is assembled in memory & written with a single call
+	std::vector<char> Buffer(static_cast<size_t>(Header.FileSize));
+	auto fnCopy = [&Buffer](uint64 Offset, const void* pData, size_t NumBytes) { if (NumBytes) memcpy(Buffer.data() + Offset, pData, NumBytes); };
+	fnCopy(0, &Header, sizeof(Header));
+	fnCopy(Header.OffsetCameras, Snapshot.Cameras.data(), sizeof(FSnapshotCamera) * Snapshot.Cameras.size());
+	uint64 OffsetLights = Header.OffsetLights;
+	for (int i = 0; i < NUM_LIGHT_MOBILITY_TYPES; ++i)
+	{
+		fnCopy(OffsetLights, Snapshot.Lights[i].data(), sizeof(Light) * Snapshot.Lights[i].size());
+		OffsetLights += sizeof(Light) * Snapshot.Lights[i].size();
+	}
+	fnCopy(Header.OffsetTransforms, Snapshot.Transforms.data(), sizeof(FSnapshotTransform) * Snapshot.Transforms.size());
+	fnCopy(Header.OffsetMaterials, Snapshot.Materials.data(), sizeof(Material) * Snapshot.Materials.size());
+	fnCopy(Header.OffsetMaterialNames, MaterialNameOffsets.data(), sizeof(uint32) * MaterialNameOffsets.size());
+	fnCopy(Header.OffsetRenderSettings, &Snapshot.RenderSettings, sizeof(FSnapshotRenderSettings));
+	fnCopy(Header.OffsetStrings, Strings.data(), Strings.size());
+
+	// write to a temp file and rename it at the end so that a snapshot is either complete or absent
+	DirectoryUtil::CreateFolderIfItDoesntExist(SCENE_SNAPSHOT_DIRECTORY);
+	const std::string TempFilePath = FilePath + ".tmp";
+	{
+		std::ofstream File(TempFilePath, std::ios::binary | std::ios::trunc);
+		if (!File.is_open())
+		{
+			Log::Error("SceneSnapshot: couldn't open %s for writing", TempFilePath.c_str());
+			return false;
+		}
+		File.write(Buffer.data(), static_cast<std::streamsize>(Buffer.size()));
+		if (!File.good())
+		{
+			Log::Error("SceneSnapshot: error writing %s", TempFilePath.c_str());
+			File.close();
+			std::remove(TempFilePath.c_str());
+			return false;
+		}
+	}
+
+	std::error_code ec;
+	std::filesystem::rename(TempFilePath, FilePath, ec);
+	if (ec)
+	{
+		Log::Error("SceneSnapshot: couldn't move %s to %s: %s", TempFilePath.c_str(), FilePath.c_str(), ec.message().c_str());
+		std::remove(TempFilePath.c_str());
+		return false;
+	}
+	return true;
+}
+
+
+
+//
+// READ
+//
+static bool ValidateSnapshot(const FMappedFile& File, const std::string& FilePath)
+{
+	using namespace SceneSnapshot;
+	if (File.GetSize() < sizeof(FSnapshotHeader))
+	{
+		Log::Warning("SceneSnapshot: %s is truncated", FilePath.c_str());
+		return false;
+	}
+	const FSnapshotHeader& Header = *File.GetDataAt<FSnapshotHeader>(0);
+	if (Header.Magic != SCENE_SNAPSHOT_MAGIC || Header.FormatVersion != SCENE_SNAPSHOT_FORMAT_VERSION
+		|| Header.LightSize != sizeof(Light) || Header.MaterialSize != sizeof(Material) || Header.RenderSettingsSize != sizeof(FSnapshotRenderSettings))
+	{
+		Log::Warning("SceneSnapshot: %s has an unknown format (version %u, expected %u)", FilePath.c_str(), Header.FormatVersion, SCENE_SNAPSHOT_FORMAT_VERSION);
+		return false;
+	}
+
+	uint64 NumLights = 0;
+	for (int i = 0; i < NUM_LIGHT_MOBILITY_TYPES; ++i)
+		NumLights += Header.NumLights[i];
+	const bool bTablesFit = Header.FileSize == File.GetSize()
+		&& Header.OffsetCameras        + sizeof(FSnapshotCamera)    * Header.NumCameras    <= Header.OffsetLights
+		&& Header.OffsetLights         + sizeof(Light)              * NumLights            <= Header.OffsetTransforms
+		&& Header.OffsetTransforms     + sizeof(FSnapshotTransform) * Header.NumTransforms <= Header.OffsetMaterials
+		&& Header.OffsetMaterials      + sizeof(Material)           * Header.NumMaterials  <= Header.OffsetMaterialNames
+		&& Header.OffsetMaterialNames  + sizeof(uint32)             * Header.NumMaterials  <= Header.OffsetRenderSettings
+		&& Header.OffsetRenderSettings + sizeof(FSnapshotRenderSettings)                   <= Header.OffsetStrings
+		&& Header.OffsetStrings        + Header.StringTableSize                            <= Header.FileSize
+		&& Header.StringTableSize > 0 && *File.GetDataAt<char>(static_cast<size_t>(Header.OffsetStrings + Header.StringTableSize - 1)) == '\0';
+	if (!bTablesFit)
+	{
+		Log::Warning("SceneSnapshot: %s is corrupt", FilePath.c_str());
+		return false;
+	}
+
+	bool bRangesValid = Header.SceneNameOffset < Header.StringTableSize && Header.EnvironmentMapPresetOffset < Header.StringTableSize;
+	const uint32* pMaterialNameOffsets = File.GetDataAt<uint32>(static_cast<size_t>(Header.OffsetMaterialNames));
+	for (uint32 i = 0; i < Header.NumMaterials && bRangesValid; ++i)
+		bRangesValid = pMaterialNameOffsets[i] < Header.StringTableSize;
+	if (!bRangesValid)
+	{
+		Log::Warning("SceneSnapshot: %s is corrupt", FilePath.c_str());
+		return false;
+	}
+	return true;
+}
+
+template<class T> static void ReadTable(const FMappedFile& File, uint64 Offset, size_t NumElements, std::vector<T>& OutTable)
+{
+	OutTable.resize(NumElements); // memcpy'd rather than cast: the records aren't aligned in the file
+	if (NumElements)
+		memcpy(OutTable.data(), File.GetDataAt<char>(static_cast<size_t>(Offset)), sizeof(T) * NumElements);
+}
+
+bool SceneSnapshot::ReadSnapshot(const std::string& FilePath, FSceneSnapshot& OutSnapshot)
+{
+	SCOPED_CPU_MARKER("SceneSnapshot::ReadSnapshot");
+	FMappedFile File;
+	if (!File.Open(FilePath))
+		return false;
+
+	if (!ValidateSnapshot(File, FilePath))
+		return false;
+
+	const FSnapshotHeader& Header = *File.GetDataAt<FSnapshotHeader>(0);
+	const char* pStrings = File.GetDataAt<char>(static_cast<size_t>(Header.OffsetStrings));
+
+	FSceneSnapshot& Snapshot = OutSnapshot;
+	Snapshot = {};
+	Snapshot.SceneName            = pStrings + Header.SceneNameOffset;
+	Snapshot.EnvironmentMapPreset = pStrings + Header.EnvironmentMapPresetOffset;
+	Snapshot.ActiveCamera         = Header.ActiveCamera;
+
+	ReadTable(File, Header.OffsetCameras, Header.NumCameras, Snapshot.Cameras);
+	uint64 OffsetLights = Header.OffsetLights;
+	for (int i = 0; i < NUM_LIGHT_MOBILITY_TYPES; ++i)
+	{
+		ReadTable(File, OffsetLights, Header.NumLights[i], Snapshot.Lights[i]);
+		OffsetLights += sizeof(Light) * Header.NumLights[i];
+	}
+	ReadTable(File, Header.OffsetTransforms, Header.NumTransforms, Snapshot.Transforms);
+	ReadTable(File, Header.OffsetMaterials, Header.NumMaterials, Snapshot.Materials);
+
+	std::vector<uint32> MaterialNameOffsets;
+	ReadTable(File, Header.OffsetMaterialNames, Header.NumMaterials, MaterialNameOffsets);
+	Snapshot.MaterialNames.resize(Header.NumMaterials);
+	for (uint32 i = 0; i < Header.NumMaterials; ++i)
+		Snapshot.MaterialNames[i] = pStrings + MaterialNameOffsets[i];
+
+	memcpy(&Snapshot.RenderSettings, File.GetDataAt<char>(static_cast<size_t>(Header.OffsetRenderSettings)), sizeof(FSnapshotRenderSettings));
+	return true;
+}
@@ -0,0 +1,150 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+#pragma once
+
+#include "Core/Types.h"
+#include "Scene/Light.h"
+#include "Scene/Material.h"
+#include "Scene/SceneViews.h"
+
+#include <string>
+#include <vector>
+#include <type_traits>
+
+//
+// SCENE SNAPSHOT
+//
+// Binary capture of the runtime state of a loaded scene: cameras, lights, object transforms, material
+// parameters, the environment map and the render options. Reproducing a perf issue or capturing a perf
+// regression run starts from the exact same state instead of the scene file's initial one.
+//
+// Restoring a snapshot of the loaded scene overwrites the state in place, no assets are loaded. The snapshot
+// of another scene (or of a scene whose objects have been added/removed since) loads the scene first, the
+// AssetCache hands out the resident models & textures, and the state is applied once the load completes.
+// See VQEngine::SaveSceneSnapshot() & VQEngine::RestoreSceneSnapshot().
+//
+// Objects are matched by their order in the scene (Scene::mGameObjectHandles), materials by their name.
+// The runtime IDs of the materials (textures, SRVs) are not restored, only their parameters.
+//
+// File layout, offsets are from the beginning of the file:
+//
+//   FSnapshotHeader
+//   FSnapshotCamera         [NumCameras]
+//   Light                   [NumLights[STATIC] + NumLights[STATIONARY] + NumLights[DYNAMIC]]  as-is
+//   FSnapshotTransform      [NumTransforms]
+//   Material                [NumMaterials]  as-is
+//   uint32                  [NumMaterials]  material name offsets
+//   FSnapshotRenderSettings
+//   char                    [StringTableSize]  null-terminated strings
+//
+namespace SceneSnapshot
+{
+	constexpr uint32 SCENE_SNAPSHOT_MAGIC          = 0x53535156; // "VQSS"
+	constexpr uint32 SCENE_SNAPSHOT_FORMAT_VERSION = 1;          // bump when the layout below changes
+
+	struct FSnapshotHeader
+	{
+		uint32 Magic;
+		uint32 FormatVersion;
+		uint32 NumCameras;
+		uint32 NumLights[Light::EMobility::NUM_LIGHT_MOBILITY_TYPES];
+		uint32 NumTransforms;
+		uint32 NumMaterials;
+		uint32 StringTableSize;
+		uint32 SceneNameOffset;
+		uint32 EnvironmentMapPresetOffset;
+		int32  ActiveCamera;
+		uint32 LightSize; // sizeof(Light), sizeof(Material) & sizeof(FSnapshotRenderSettings): stored as-is
+		uint32 MaterialSize;
+		uint32 RenderSettingsSize;
+		uint32 Padding;
+		uint64 FileSize;
+		uint64 OffsetCameras;
+		uint64 OffsetLights;
+		uint64 OffsetTransforms;
+		uint64 OffsetMaterials;
+		uint64 OffsetMaterialNames;
+		uint64 OffsetRenderSettings;
+		uint64 OffsetStrings;
+	};
+	struct FSnapshotCamera
+	{
+		float  Position[3];
+		float  Yaw;         // radians
+		float  Pitch;       // radians
+		float  NearZ;
+		float  FarZ;
+		float  FieldOfView; // radians
+		uint32 bPerspectiveProjection;
+		uint32 ControllerType; // ECameraControllerType
+	};
+	struct FSnapshotTransform
+	{
+		float Position[3];
+		float Rotation[4]; // quaternion: xyz, w
+		float Scale[3];
+	};
+	struct FSnapshotPostProcess // the user-facing subset of FPostProcessParameters
+	{
+		FPostProcessParameters::FTonemapper          Tonemapper;
+		FPostProcessParameters::FVizualizationParams VizParams;
+		int32 UpscalingAlgorithm;     // FPostProcessParameters::EUpscalingAlgorithm
+		int32 UpscalingQualityPreset; // FPostProcessParameters::AMD_FSR1_Preset
+		int32 DrawMode;               // EDrawMode
+		float ResolutionScale;
+		float Sharpness;
+		float RCASSharpnessStops;
+		float CASSharpen;
+		uint8 bEnableCAS;
+		uint8 bEnableGaussianBlur;
+		uint8 bAntiAliasing;          // FGraphicsSettings::bAntiAliasing
+		uint8 Padding;
+	};
+	struct FSnapshotRenderSettings
+	{
+		FSceneRenderOptions  SceneRenderOptions;
+		FSnapshotPostProcess PostProcess;
+	};
+	static_assert(sizeof(FSnapshotHeader)    == 128, "snapshot file layout changed, bump SCENE_SNAPSHOT_FORMAT_VERSION");
+	static_assert(sizeof(FSnapshotCamera)    == 40 , "snapshot file layout changed, bump SCENE_SNAPSHOT_FORMAT_VERSION");
+	static_assert(sizeof(FSnapshotTransform) == 40 , "snapshot file layout changed, bump SCENE_SNAPSHOT_FORMAT_VERSION");
+	static_assert(std::is_trivially_copyable_v<Light> && std::is_trivially_copyable_v<Material> && std::is_trivially_copyable_v<FSnapshotRenderSettings>
+		, "lights, materials & render settings are stored as-is");
+
+	struct FSceneSnapshot
+	{
+		std::string SceneName;            // FResourceNames::mSceneNames entry
+		std::string EnvironmentMapPreset; // empty: no environment map
+		int32       ActiveCamera = 0;
+
+		std::vector<FSnapshotCamera>    Cameras;
+		std::vector<Light>              Lights[Light::EMobility::NUM_LIGHT_MOBILITY_TYPES];
+		std::vector<FSnapshotTransform> Transforms;    // Scene::mGameObjectHandles order
+		std::vector<Material>           Materials;     // parameters only, the runtime IDs are ignored on restore
+		std::vector<std::string>        MaterialNames; // [i] names Materials[i]
+		FSnapshotRenderSettings         RenderSettings = {};
+	};
+
+	// Snapshots/<SceneName>.vqsnap
+	std::string GetSnapshotFilePath(const std::string& SceneName);
+
+	bool WriteSnapshot(const std::string& FilePath, const FSceneSnapshot& Snapshot);
+
+	// returns false if the file doesn't exist, is corrupt or was written by another build
+	bool ReadSnapshot(const std::string& FilePath, FSceneSnapshot& OutSnapshot);
+}
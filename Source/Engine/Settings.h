@@ -75,6 +75,11 @@ struct FEngineSettings
 
 	bool bAutomatedTestRun     = false;
 	int NumAutomatedTestFrames = -1;
+
+	bool bHotReloadScenes = false; // watch the scene file & apply its changes w/o reloading the scene
+	int AssetRetentionBudgetMB = 1024; // texture memory of the unreferenced models & textures kept resident across scene switches, see AssetCache
+	int ScenePreloadBudgetMB = 0;      // >0: preload the next scene of the list once a scene is loaded, see VQEngine::StartPreloadingScene()
 	
 	char StartupScene[512];
+	char StartupSnapshot[512]; // non-empty: restore the scene snapshot file at startup instead of loading StartupScene, see SceneSnapshot.h
 };
\ No newline at end of file
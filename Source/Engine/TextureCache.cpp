@@ -0,0 +1,312 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+
+#include "TextureCache.h"
+#include "Core/Hash.h"
+
+#include <filesystem>
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+
+static const std::string TEXTURE_CACHE_DIRECTORY = "Cache/Textures";
+static constexpr size_t  MIP_ALIGNMENT = 16;
+
+using Hash::HashBytes;
+static inline uint64 AlignUp(uint64 Value, uint64 Alignment) { return (Value + Alignment - 1) & ~(Alignment - 1); }
+
+
+
+std::string TextureCache::GetCookedFilePath(const std::string& TextureFilePath)
+{
+	// the runtime requests the textures w/ the paths composed from the model directory & the glTF URIs
+	// while the cooker walks Data/: hash a normalized path so that both end up with the same file
+	std::string Path = TextureFilePath;
+	std::replace(Path.begin(), Path.end(), '\\', '/');
+	Path = std::filesystem::path(Path).lexically_normal().generic_string();
+	std::transform(Path.begin(), Path.end(), Path.begin(), [](char c) { return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c; });
+
+	const uint64 PathHash = HashBytes(Path.data(), Path.size());
+	char HashStr[17]; snprintf(HashStr, sizeof(HashStr), "%016llx", PathHash);
+	return TEXTURE_CACHE_DIRECTORY + "/" + std::filesystem::path(Path).stem().string() + "_" + HashStr + ".vqtex";
+}
+
+bool TextureCache::IsCookable(const std::string& TextureFilePath)
+{
+	std::string Extension = std::filesystem::path(TextureFilePath).extension().string();
+	std::transform(Extension.begin(), Extension.end(), Extension.begin(), [](char c) { return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c; });
+	return Extension == ".png" || Extension == ".jpg" || Extension == ".jpeg" || Extension == ".tga" || Extension == ".bmp";
+}
+
+uint64 TextureCache::ComputeSourceHash(const void* pFileData, size_t FileSize)
+{
+	return HashBytes(pFileData, FileSize);
+}
+
+
+
+//
+// COOK
+//
+TextureCache::FCookedTexture TextureCache::CookTexture(const FSourceImage& Image, bool bGenerateMips)
+{
+	FCookedTexture Texture;
+	if (!Image.pData || Image.Width == 0 || Image.Height == 0 || (Image.BytesPerPixel != 4 && Image.BytesPerPixel != 16))
+		return Texture;
+
+	const uint32 NumMips = bGenerateMips ? CalculateMipLevelCount(Image.Width, Image.Height) : 1;
+	Texture.BytesPerPixel = Image.BytesPerPixel;
+	Texture.Flags = Image.BytesPerPixel == 16 ? static_cast<uint32>(COOKED_TEXTURE_HDR) : 0u;
+	Texture.Mips.resize(NumMips);
+	Texture.MipData.resize(NumMips);
+
+	uint64 Offset = 0;
+	for (uint32 Mip = 0; Mip < NumMips; ++Mip)
+	{
+		FCookedMip& mip = Texture.Mips[Mip];
+		mip.Width  = std::max(1u, Image.Width  >> Mip);
+		mip.Height = std::max(1u, Image.Height >> Mip);
+		mip.DataOffset = Offset;
+		Offset = AlignUp(Offset + Texture.GetMipSize(Mip), MIP_ALIGNMENT);
+	}
+	Texture.Storage.resize(Offset);
+	for (uint32 Mip = 0; Mip < NumMips; ++Mip)
+		Texture.MipData[Mip] = Texture.Storage.data() + Texture.Mips[Mip].DataOffset;
+
+	memcpy(Texture.Storage.data(), Image.pData, Texture.GetMipSize(0));
+	for (uint32 Mip = 1; Mip < NumMips; ++Mip)
+	{
+		DownsampleMip(Texture.MipData[Mip - 1], const_cast<void*>(Texture.MipData[Mip]), Texture.Mips[Mip - 1].Width, Texture.Mips[Mip - 1].Height, Texture.BytesPerPixel);
+	}
+
+	if (HasAlphaValues(Image.pData, Image.Width, Image.Height, Image.BytesPerPixel))
+		Texture.Flags |= static_cast<uint32>(COOKED_TEXTURE_USES_ALPHA);
+	return Texture;
+}
+
+bool TextureCache::WriteCookedTexture(const std::string& CookedFilePath, const FSourceStamp& Source, const FCookedTexture& Texture)
+{
+	const uint32 NumMips = static_cast<uint32>(Texture.Mips.size());
+	if (NumMips == 0)
+		return false;
+
+	// layout
+	FCookedTextureHeader Header = {};
+	Header.Magic           = COOKED_TEXTURE_MAGIC;
+	Header.FormatVersion   = COOKED_TEXTURE_FORMAT_VERSION;
+	Header.CookerVersion   = TEXTURE_COOKER_VERSION;
+	Header.Flags           = Texture.Flags;
+	Header.SourceHash      = Source.Hash;
+	Header.SourceSize      = Source.Size;
+	Header.SourceWriteTime = Source.WriteTime;
+	Header.Width           = Texture.Mips[0].Width;
+	Header.Height          = Texture.Mips[0].Height;
+	Header.BytesPerPixel   = Texture.BytesPerPixel;
+	Header.NumMips         = NumMips;
+
+	std::vector<FCookedMip> Mips = Texture.Mips;
+	uint64 Offset = sizeof(FCookedTextureHeader) + sizeof(FCookedMip) * NumMips;
+	for (uint32 Mip = 0; Mip < NumMips; ++Mip)
+	{
+		Mips[Mip].DataOffset = Offset = AlignUp(Offset, MIP_ALIGNMENT);
+		Offset += Texture.GetMipSize(Mip);
+	}
+	Header.FileSize = Offset;
+
+	// write to a temp file and rename it at the end so that a cooked file is either complete or absent
+	std::error_code ec;
+	std::filesystem::create_directories(std::filesystem::path(CookedFilePath).parent_path(), ec);
+	const std::string TempFilePath = CookedFilePath + ".tmp";
+	{
+		std::ofstream File(TempFilePath, std::ios::binary | std::ios::trunc);
+		if (!File.is_open())
+			return false;
+
+		static const char PADDING[MIP_ALIGNMENT] = {};
+		auto fnWrite = [&File](const void* pData, uint64 NumBytes) { File.write(static_cast<const char*>(pData), static_cast<std::streamsize>(NumBytes)); };
+		auto fnPadTo = [&File, &fnWrite](uint64 TargetOffset) { const uint64 Pos = static_cast<uint64>(File.tellp()); if (TargetOffset > Pos) fnWrite(PADDING, TargetOffset - Pos); };
+
+		fnWrite(&Header, sizeof(Header));
+		fnWrite(Mips.data(), sizeof(FCookedMip) * NumMips);
+		for (uint32 Mip = 0; Mip < NumMips; ++Mip)
+		{
+			fnPadTo(Mips[Mip].DataOffset);
+			fnWrite(Texture.MipData[Mip], Texture.GetMipSize(Mip));
+		}
+
+		if (!File.good())
+		{
+			File.close();
+			std::remove(TempFilePath.c_str());
+			return false;
+		}
+	}
+
+	std::filesystem::rename(TempFilePath, CookedFilePath, ec);
+	if (ec)
+	{
+		std::remove(TempFilePath.c_str());
+		return false;
+	}
+	return true;
+}
+
+
+
+//
+// READ
+//
+bool TextureCache::ParseCookedTexture(const void* pFileData, size_t FileSize, FCookedTexture& OutTexture)
+{
+	if (!pFileData || FileSize < sizeof(FCookedTextureHeader))
+		return false;
+
+	FCookedTextureHeader Header;
+	memcpy(&Header, pFileData, sizeof(Header));
+	if (Header.Magic != COOKED_TEXTURE_MAGIC
+		|| Header.FormatVersion != COOKED_TEXTURE_FORMAT_VERSION
+		|| Header.CookerVersion != TEXTURE_COOKER_VERSION
+		|| Header.FileSize != FileSize
+		|| (Header.BytesPerPixel != 4 && Header.BytesPerPixel != 16)
+		|| Header.NumMips == 0 || Header.NumMips > CalculateMipLevelCount(Header.Width, Header.Height))
+	{
+		return false;
+	}
+	if (sizeof(FCookedTextureHeader) + sizeof(FCookedMip) * Header.NumMips > FileSize)
+		return false;
+
+	OutTexture = FCookedTexture();
+	OutTexture.Flags = Header.Flags;
+	OutTexture.BytesPerPixel = Header.BytesPerPixel;
+	OutTexture.Source.Size = Header.SourceSize;
+	OutTexture.Source.WriteTime = Header.SourceWriteTime;
+	OutTexture.Source.Hash = Header.SourceHash;
+	OutTexture.Mips.resize(Header.NumMips);
+	OutTexture.MipData.resize(Header.NumMips);
+	memcpy(OutTexture.Mips.data(), static_cast<const uint8*>(pFileData) + sizeof(FCookedTextureHeader), sizeof(FCookedMip) * Header.NumMips);
+	for (uint32 Mip = 0; Mip < Header.NumMips; ++Mip)
+	{
+		const FCookedMip& mip = OutTexture.Mips[Mip];
+		const bool bValid = mip.Width  == std::max(1u, Header.Width  >> Mip)
+			&& mip.Height == std::max(1u, Header.Height >> Mip)
+			&& mip.DataOffset % MIP_ALIGNMENT == 0
+			&& mip.DataOffset + OutTexture.GetMipSize(Mip) <= FileSize;
+		if (!bValid)
+			return false;
+		OutTexture.MipData[Mip] = static_cast<const uint8*>(pFileData) + mip.DataOffset;
+	}
+	return true;
+}
+
+bool TextureCache::ReadCookedTextureSource(const std::string& CookedFilePath, FSourceStamp& OutSource)
+{
+	std::ifstream File(CookedFilePath, std::ios::binary);
+	FCookedTextureHeader Header = {};
+	if (!File.read(reinterpret_cast<char*>(&Header), sizeof(Header)))
+		return false;
+
+	std::error_code ec;
+	const bool bValid = Header.Magic == COOKED_TEXTURE_MAGIC
+		&& Header.FormatVersion == COOKED_TEXTURE_FORMAT_VERSION
+		&& Header.CookerVersion == TEXTURE_COOKER_VERSION
+		&& Header.FileSize == std::filesystem::file_size(CookedFilePath, ec);
+	if (!bValid)
+		return false;
+	OutSource.Size = Header.SourceSize;
+	OutSource.WriteTime = Header.SourceWriteTime;
+	OutSource.Hash = Header.SourceHash;
+	return true;
+}
+
+
+
+//
+// SHARED
+//
+uint32 TextureCache::CalculateMipLevelCount(uint32 Width, uint32 Height)
+{
+	uint32 NumMips = 1;
+	for (uint32 Size = std::max(Width, Height); Size > 1; Size >>= 1)
+		++NumMips;
+	return NumMips;
+}
+
+void TextureCache::DownsampleMip(const void* pSrc, void* pDst, uint32 SrcWidth, uint32 SrcHeight, uint32 BytesPerPixel)
+{
+	const uint32 DstWidth  = std::max(1u, SrcWidth  / 2);
+	const uint32 DstHeight = std::max(1u, SrcHeight / 2);
+
+	// 2x2 footprint of each output pixel, clamped at the edges for the 1-pixel wide/tall levels
+	for (uint32 y = 0; y < DstHeight; ++y)
+	{
+		const uint32 y0 = std::min(2 * y, SrcHeight - 1);
+		const uint32 y1 = std::min(2 * y + 1, SrcHeight - 1);
+		for (uint32 x = 0; x < DstWidth; ++x)
+		{
+			const uint32 x0 = std::min(2 * x, SrcWidth - 1);
+			const uint32 x1 = std::min(2 * x + 1, SrcWidth - 1);
+			const size_t iSamples[4] = { y0 * SrcWidth + x0, y0 * SrcWidth + x1, y1 * SrcWidth + x0, y1 * SrcWidth + x1 };
+			const size_t iDst = static_cast<size_t>(y) * DstWidth + x;
+
+			if (BytesPerPixel == 4)
+			{
+				const uint8* pImgSrc = static_cast<const uint8*>(pSrc);
+				      uint8* pImgDst = static_cast<      uint8*>(pDst);
+				for (uint32 ch = 0; ch < 4; ++ch)
+				{
+					uint32 Sum = 0;
+					for (size_t iSmp : iSamples)
+						Sum += pImgSrc[iSmp * 4 + ch];
+					pImgDst[iDst * 4 + ch] = static_cast<uint8>(Sum / 4);
+				}
+			}
+			else if (BytesPerPixel == 16)
+			{
+				const float* pImgSrc = static_cast<const float*>(pSrc);
+				      float* pImgDst = static_cast<      float*>(pDst);
+				for (uint32 ch = 0; ch < 3; ++ch) // color channel ~ rgba, care for RGB only
+				{
+					float Min = pImgSrc[iSamples[0] * 4 + ch];
+					for (size_t iSmp : iSamples)
+						Min = std::min(Min, pImgSrc[iSmp * 4 + ch]);
+					pImgDst[iDst * 4 + ch] = Min;
+				}
+				pImgDst[iDst * 4 + 3] = 1.0f;
+			}
+		}
+	}
+}
+
+bool TextureCache::HasAlphaValues(const void* pData, uint32 Width, uint32 Height, uint32 BytesPerPixel)
+{
+	const uint8* pImg = static_cast<const uint8*>(pData);
+	const uint32 AlphaByteOffset = 3 * BytesPerPixel / 4;
+	bool bAllZero = true;
+	bool bAllWhite = true;
+	const size_t NumPixels = static_cast<size_t>(Width) * Height;
+	for (size_t iPixel = 0; iPixel < NumPixels; ++iPixel)
+	{
+		const uint8 a = pImg[iPixel * BytesPerPixel + AlphaByteOffset];
+		bAllZero = bAllZero && a == 0;
+		bAllWhite = bAllWhite && a == 255;
+		if (!bAllWhite && !bAllZero)
+			return true;
+	}
+	return false; // all 1 or all 0
+}
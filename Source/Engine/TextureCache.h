@@ -0,0 +1,141 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+#pragma once
+
+#include "Core/Types.h"
+
+#include <string>
+#include <vector>
+
+// Set to 0 to always decode the source images & generate the mips at runtime
+#define TEXTURE_CACHE_ENABLED 1
+
+//
+// TEXTURE CACHE
+//
+// Cooked representation of a texture file: the decoded RGBA pixels of every mip level and the alpha usage,
+// i.e. the output of the runtime's decode -> mip generation -> alpha check chain in TextureManager.
+// The cooked files are written offline by the VQCook tool (Source/Tools/VQCook.cpp), the runtime only loads
+// them: TextureManager::DiskRead() hands the mip chain to the upload as-is when the cooked file is up to date,
+// and falls back to the source image otherwise. Like VQCook's manifest, the source is validated w/ its size &
+// write time and hashed only if those changed. A cooked file w/o its source (cooked-only data) is used as-is.
+//
+// This file is shared with VQCook and has no engine dependencies (logging, VFS, D3D12): it builds on Linux.
+//
+// File layout, offsets are from the beginning of the file:
+//
+//   FCookedTextureHeader
+//   FCookedMip [NumMips]
+//   mip data, tightly packed rows, each level 16-byte aligned
+//
+namespace TextureCache
+{
+	constexpr uint32 COOKED_TEXTURE_MAGIC          = 0x58545156; // "VQTX"
+	constexpr uint32 COOKED_TEXTURE_FORMAT_VERSION = 2;          // bump when the layout below changes
+	constexpr uint32 TEXTURE_COOKER_VERSION        = 1;          // bump when the output of CookTexture() changes
+
+	enum ECookedTextureFlags : uint32
+	{
+		COOKED_TEXTURE_USES_ALPHA = 1 << 0, // FTexture::UsesAlphaChannel
+		COOKED_TEXTURE_HDR        = 1 << 1, // RGBA32F, RGBA8 otherwise
+	};
+	struct FCookedTextureHeader
+	{
+		uint32 Magic;
+		uint32 FormatVersion;
+		uint32 CookerVersion;
+		uint32 Flags;         // ECookedTextureFlags
+		uint64 SourceHash;    // ComputeSourceHash() of the source image file
+		uint64 SourceSize;    // FSourceStamp
+		int64  SourceWriteTime;
+		uint64 FileSize;
+		uint32 Width;
+		uint32 Height;
+		uint32 BytesPerPixel;
+		uint32 NumMips;
+	};
+	struct FCookedMip
+	{
+		uint64 DataOffset;
+		uint32 Width;
+		uint32 Height;
+	};
+	static_assert(sizeof(FCookedTextureHeader) == 64, "cooked file layout changed, bump COOKED_TEXTURE_FORMAT_VERSION");
+	static_assert(sizeof(FCookedMip)           == 16, "cooked file layout changed, bump COOKED_TEXTURE_FORMAT_VERSION");
+
+	// content hash of a source file & the size/write time (std::filesystem::file_time_type ticks) it was computed from
+	struct FSourceStamp
+	{
+		uint64 Size = 0;
+		int64  WriteTime = 0;
+		uint64 Hash = 0;
+	};
+
+	// decoded source image, the input of CookTexture()
+	struct FSourceImage
+	{
+		const void* pData = nullptr; // tightly packed RGBA8 or RGBA32F rows
+		uint32 Width = 0;
+		uint32 Height = 0;
+		uint32 BytesPerPixel = 0;    // 4 or 16
+	};
+
+	// cooked texture in memory: written by WriteCookedTexture(), or a view over a cooked file read by ParseCookedTexture()
+	struct FCookedTexture
+	{
+		uint32 Flags = 0;
+		uint32 BytesPerPixel = 0;
+		FSourceStamp              Source;   // set by ParseCookedTexture()
+		std::vector<FCookedMip>   Mips;     // DataOffset unused in memory
+		std::vector<const void*>  MipData;  // [NumMips]
+		std::vector<uint8>        Storage;  // owns MipData when cooked in memory, empty for the views
+
+		inline size_t GetMipSize(size_t Mip) const { return static_cast<size_t>(Mips[Mip].Width) * Mips[Mip].Height * BytesPerPixel; }
+	};
+
+	// Cache/Textures/<texturefilename>_<PathHash>.vqtex, the path is lower-cased & normalized: case & separator insensitive
+	std::string GetCookedFilePath(const std::string& TextureFilePath);
+
+	// The formats with a cooked representation. HDR images (environment maps) aren't cooked:
+	// their RGBA32F mip chains are several times larger than the source, reading them back costs more than decoding.
+	bool IsCookable(const std::string& TextureFilePath);
+
+	// Hashes the source file contents
+	uint64 ComputeSourceHash(const void* pFileData, size_t FileSize);
+
+	// Decoded image -> mip chain & alpha usage
+	FCookedTexture CookTexture(const FSourceImage& Image, bool bGenerateMips);
+	bool WriteCookedTexture(const std::string& CookedFilePath, const FSourceStamp& Source, const FCookedTexture& Texture);
+
+	// Validates the cooked file in memory against the versions, the output views point into pFileData.
+	// Returns false if the file is corrupt or built by another version: the caller checks OutTexture.Source against the source.
+	bool ParseCookedTexture(const void* pFileData, size_t FileSize, FCookedTexture& OutTexture);
+	bool ReadCookedTextureSource(const std::string& CookedFilePath, FSourceStamp& OutSource); // false if the file is missing, corrupt or built by another version
+
+	//
+	// shared w/ the runtime texture processing
+	//
+	uint32 CalculateMipLevelCount(uint32 Width, uint32 Height);
+
+	// Writes the next mip level of the given image, max(1, W/2) x max(1, H/2) pixels:
+	// a box filter for RGBA8, a min filter on RGB for RGBA32F (alpha=1). Used by VQ_DXGI_UTILS::MipImage() too.
+	void DownsampleMip(const void* pSrc, void* pDst, uint32 SrcWidth, uint32 SrcHeight, uint32 BytesPerPixel);
+
+	// true if the alpha channel has values other than all-0 or all-255
+	bool HasAlphaValues(const void* pData, uint32 Width, uint32 Height, uint32 BytesPerPixel);
+}
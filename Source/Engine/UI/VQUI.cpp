@@ -20,6 +20,7 @@
 #include "Engine/Scene/SceneViews.h"
 #include "Engine/Scene/Scene.h"
 #include "Engine/Core/Window.h"
+#include "Engine/Core/MemoryTracking.h"
 
 #include "Renderer/Rendering/RenderPass/MagnifierPass.h"
 #include "Renderer/Renderer.h"
@@ -709,6 +710,8 @@ void VQEngine::DrawKeyMappingsWindow()
 		ImGui::Text("     Shift+R : Reload level");
 		ImGui::Text("Page Up/Down : Change the HDRI Environment Map");
 		ImGui::Text("         1-4 : Change between available scenes");
+		ImGui::Text("          F6 : Save scene snapshot");
+		ImGui::Text("          F7 : Restore scene snapshot");
 		ImGui::Text("           C : Cycle scene cameras");
 		ImGui::Text("           G : Toggle gamma correction");
 		ImGui::Text("           B : Toggle FidelityFX Sharpening");
@@ -824,6 +827,33 @@ void VQEngine::DrawProfilerWindow(const FSceneStats& FrameStats, float dt)
 			ImGui::TextColored(DataTextColor, "Bounding Box     : %d", rs.NumBoundingBoxDrawCommands);
 			ImGui::TextColored(DataTextColor, "Total Draws      : %d", rs.NumDraws);
 			ImGui::TextColored(DataTextColor, "Total Dispatches : %d", rs.NumDispatches);
+			ImGui::TextColored(DataTextColor, "Meshlets Culled  : %d / %d", rs.NumCulledMeshlets, rs.NumMeshlets);
+			ImGui::TextColored(DataTextColor, "Tris Culled      : %d", rs.NumCulledMeshletTriangles);
+		}
+		ImGuiSpacing3();
+		if (ImGui::CollapsingHeader("MEMORY", ImGuiTreeNodeFlags_DefaultOpen))
+		{
+#if VQENGINE_MEMORY_TRACKING
+			ImGui::TextColored(DataTextColor, "%-12s %10s %10s %8s", "Tag", "Current", "Peak", "Allocs");
+			ImGui::TextColored(DataTextColor, "---------------------------------------------");
+			for (int i = 0; i < static_cast<int>(EMemoryTag::NUM_MEMORY_TAGS); ++i)
+			{
+				const EMemoryTag Tag = static_cast<EMemoryTag>(i);
+				const FMemoryTagStats ms = MemoryTracking::GetStats(Tag);
+				ImGui::TextColored(DataTextColor, "%-12s %10s %10s %8lld"
+					, MemoryTracking::GetTagName(Tag)
+					, StrUtil::FormatByte(static_cast<size_t>(std::max<int64_t>(0, ms.CurrentBytes))).c_str()
+					, StrUtil::FormatByte(static_cast<size_t>(ms.PeakBytes)).c_str()
+					, static_cast<long long>(ms.NumLiveAllocations)
+				);
+			}
+			if (ImGui::Button("Dump JSON"))
+			{
+				MemoryTracking::DumpJSONToFile("Cache/MemoryStats.json");
+			}
+#else
+			ImGui::TextColored(DataTextColor, "Memory tracking is compiled out (VQENGINE_MEMORY_TRACKING=0)");
+#endif
 		}
 	}
 	ImGui::End();
@@ -30,7 +30,9 @@
 #include "EnvironmentMap.h"
 #include "Settings.h"
 #include "AssetLoader.h"
+#include "Scene/Serialization.h"
 #include "LoadingScreen.h"
+#include "SceneSnapshot.h"
 
 #include "UI/VQUI.h"
 
@@ -40,6 +42,7 @@
 
 #include <memory>
 #include <latch>
+#include <filesystem>
 
 //--------------------------------------------------------------------
 // MUILTI-THREADING 
@@ -177,6 +180,9 @@ public:
 	void UpdateThread_UpdateAppState(const float dt);
 	void UpdateThread_UpdateScene_MainWnd(const float dt);
 	void UpdateThread_UpdateScene_DebugWnd(const float dt);
+	void UpdateThread_HotReloadScene(const float dt); // polls the scene file when FEngineSettings::bHotReloadScenes is set
+	bool UpdateThread_ApplySceneSnapshot(const SceneSnapshot::FSceneSnapshot& Snapshot);
+	void CancelScenePreload(); // waits for the asset in flight
 
 	// PostUpdate()
 	// - Computes visibility per FSceneView
@@ -205,11 +211,21 @@ public:
 	// Scene Interface
 	// ---------------------------------------------------------
 	void StartLoadingScene(int IndexScene);
+
+	// Parses the scene file and decodes the scene's assets on a low priority worker while the current scene
+	// keeps running. StartLoadingScene() of the same scene then picks up the parsed scene, the cooked models
+	// and the resident textures, leaving mostly the GPU uploads and the object creation to the load.
+	void StartPreloadingScene(int IndexScene, uint64 MemoryCapBytes);
 	
 	void StartLoadingEnvironmentMap(int IndexEnvMap);
 	
 	void UnloadEnvironmentMap();
 
+	// Snapshots of the loaded scene's runtime state, see SceneSnapshot.h. Restoring the snapshot of the loaded scene
+	// is applied in place, otherwise the snapshot's scene is loaded first and the snapshot is applied when it completes.
+	bool SaveSceneSnapshot(const std::string& FilePath, int FRAME_DATA_INDEX);
+	bool RestoreSceneSnapshot(const std::string& FilePath);
+
 	void WaitForBuiltinMeshGeneration();
 
 	// Getters
@@ -243,6 +259,7 @@ private:
 #endif
 	ThreadPool                      mWorkers_ModelLoading;
 	ThreadPool                      mWorkers_MeshLoading;
+	ThreadPool                      mWorkers_Preload;
 
 	// sync
 	std::atomic<bool>               mbStopAllThreads;
@@ -313,6 +330,20 @@ private:
 	std::queue<std::string>         mQueue_SceneLoad;
 	int                             mIndex_SelectedScene;
 	std::unique_ptr<Scene>          mpScene;
+	std::string                     mSceneFilePath;            // file of the loaded scene, see UpdateThread_HotReloadScene()
+	std::filesystem::file_time_type mSceneFileWriteTime;
+	float                           mSceneUnloadTime = 0.0f;   // last scene switch, logged with the AssetCache stats
+	float                           mSceneHotReloadPollTimer = 0.0f;
+	std::unique_ptr<SceneSnapshot::FSceneSnapshot> mpPendingSceneSnapshot; // applied once the scene load completes
+	struct FScenePreload
+	{
+		std::string                     SceneFilePath; // empty: no preload
+		FSceneRepresentation            SceneRep;      // written by the preload worker, read once it's Done
+		std::filesystem::file_time_type WriteTime;
+		std::atomic<bool>               bCancel = false;
+		std::future<void>               Done;
+	};
+	FScenePreload                   mScenePreload;
 	
 	// ui
 	ImGuiContext*                   mpImGuiContext;
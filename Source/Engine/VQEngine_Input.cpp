@@ -87,6 +87,19 @@ void VQEngine::HandleUIInput()
 			if (input.IsKeyTriggered("F3")) Toggle(mUIState.bWindowVisible_GraphicsSettingsPanel);
 			if (input.IsKeyTriggered("F4")) Toggle(mUIState.bWindowVisible_Editor);
 
+			if (input.IsKeyTriggered("F9")) // trace capture: the first press starts collecting, the next ones export
+			{
+				if (!Trace::IsEnabled())
+				{
+					Trace::SetEnabled(true);
+				}
+				else
+				{
+					const std::string FilePath = "Traces/Capture_" + std::to_string(Trace::GetTimestamp() / 1000000) + ".json";
+					Trace::ExportChromeJSON(FilePath);
+				}
+			}
+
 			if (input.IsKeyTriggered("B"))
 			{
 				WaitUntilRenderingFinishes();
@@ -213,5 +226,10 @@ void VQEngine::HandleMainWindowInput(Input& input, HWND hwnd)
 		if (input.IsKeyTriggered("2")) { mIndex_SelectedScene = 1; this->StartLoadingScene(mIndex_SelectedScene); }
 		if (input.IsKeyTriggered("3")) { mIndex_SelectedScene = 2; this->StartLoadingScene(mIndex_SelectedScene); }
 		if (input.IsKeyTriggered("4")) { mIndex_SelectedScene = 3; this->StartLoadingScene(mIndex_SelectedScene); }
+
+		// Scene snapshots
+		const std::string SnapshotFilePath = SceneSnapshot::GetSnapshotFilePath(mResourceNames.mSceneNames[mIndex_SelectedScene]);
+		if (input.IsKeyTriggered("F6")) { this->SaveSceneSnapshot(SnapshotFilePath, FRAME_DATA_INDEX); }
+		if (input.IsKeyTriggered("F7")) { this->RestoreSceneSnapshot(SnapshotFilePath); }
 	}
 }
\ No newline at end of file
@@ -22,6 +22,7 @@
 #include "Scene/Scene.h"
 
 #include "Core/FileParser.h"
+#include "Core/VirtualFileSystem.h"
 #include "Core/Window.h"
 
 #include "Renderer/Renderer.h"
@@ -86,6 +87,8 @@ bool VQEngine::Initialize(const FStartupParameters& Params)
 	ThreadPool& WorkerThreads = mWorkers_Simulation;
 #endif
 	InitializeEngineSettings(Params);
+	VFS::MountPakFiles("Data/"); // before anything reads the assets
+	mAssetLoader.mAssetCache.SetBudget(mSettings.AssetRetentionBudgetMB > 0 ? static_cast<uint64>(mSettings.AssetRetentionBudgetMB) << 20 : 0);
 	InitializeEngineThreads();
 	InitializeEnvironmentMaps();
 	InitializeHDRProfiles();
@@ -100,6 +103,7 @@ bool VQEngine::Initialize(const FStartupParameters& Params)
 	// otherwise device may be lost if launched from RenderDoc
 	mpRenderer->Initialize(mSettings.gfx); // Device, Queues, Heaps, WorkerThreads
 	// --------------------------------------------------------
+	VFS::SetDecompressionWorkers(&mpRenderer->GetTextureManager().GetDiskWorkers());
 
 	// offload system info acquisition to a thread as it takes a few seconds on Debug build
 	WorkerThreads.AddTask([&]()
@@ -132,8 +136,10 @@ void VQEngine::Destroy()
 {
 	ExitThreads();
 
+	VFS::SetDecompressionWorkers(nullptr);
 	mpRenderer->Unload();
 	mpRenderer->Destroy();
+	VFS::UnmountAll();
 }
 
 
@@ -179,7 +185,12 @@ void VQEngine::InitializeEngineSettings(const FStartupParameters& Params)
 	s.bAutomatedTestRun = false;
 	s.NumAutomatedTestFrames = 100; // default num frames to run if -Test is specified in cmd line params
 
+	s.bHotReloadScenes = false;
+	s.AssetRetentionBudgetMB = 1024;
+	s.ScenePreloadBudgetMB = 0;
+
 	strncpy_s(s.StartupScene, "Default", sizeof(s.StartupScene));
+	s.StartupSnapshot[0] = '\0';
 
 	// Override #0 : from file
 	FStartupParameters paramFile;
@@ -214,6 +225,9 @@ void VQEngine::InitializeEngineSettings(const FStartupParameters& Params)
 	}
 
 	if (paramFile.bOverrideENGSetting_StartupScene)              strncpy_s(s.StartupScene, pf.StartupScene, sizeof(s.StartupScene));
+	if (paramFile.bOverrideENGSetting_bHotReloadScenes)          s.bHotReloadScenes = pf.bHotReloadScenes;
+	if (paramFile.bOverrideENGSetting_AssetRetentionBudgetMB)    s.AssetRetentionBudgetMB = pf.AssetRetentionBudgetMB;
+	if (paramFile.bOverrideENGSetting_ScenePreloadBudgetMB)      s.ScenePreloadBudgetMB = pf.ScenePreloadBudgetMB;
 
 
 	// Override #1 : if there's command line params
@@ -244,6 +258,10 @@ void VQEngine::InitializeEngineSettings(const FStartupParameters& Params)
 	}
 
 	if (Params.bOverrideENGSetting_StartupScene)               strncpy_s(s.StartupScene, p.StartupScene, sizeof(s.StartupScene));
+	if (Params.bOverrideENGSetting_StartupSnapshot)            strncpy_s(s.StartupSnapshot, p.StartupSnapshot, sizeof(s.StartupSnapshot));
+	if (Params.bOverrideENGSetting_bHotReloadScenes)           s.bHotReloadScenes = p.bHotReloadScenes;
+	if (Params.bOverrideENGSetting_AssetRetentionBudgetMB)     s.AssetRetentionBudgetMB = p.AssetRetentionBudgetMB;
+	if (Params.bOverrideENGSetting_ScenePreloadBudgetMB)       s.ScenePreloadBudgetMB = p.ScenePreloadBudgetMB;
 }
 
 void VQEngine::InitializeWindows(const FStartupParameters& Params)
@@ -338,6 +356,10 @@ void VQEngine::InitializeScenes()
 	}
 	mIndex_SelectedScene = static_cast<int>(it2 - mSceneNames.begin());
 
+	// the snapshot selects its own scene, the startup scene is the fallback
+	if (mSettings.StartupSnapshot[0] != '\0' && this->RestoreSceneSnapshot(mSettings.StartupSnapshot))
+		return;
+
 	this->StartLoadingScene(mIndex_SelectedScene);
 }
 
@@ -359,6 +381,7 @@ void VQEngine::InitializeEngineThreads()
 
 	mWorkers_ModelLoading.Initialize(HWCores    , "LoadWorkers_Model"  , 0xFFDDAA00);
 	mWorkers_MeshLoading.Initialize(HWCores     , "LoadWorkers_Mesh"   , 0xFFEE2266);
+	mWorkers_Preload.Initialize(1               , "PreloadWorker"      , 0xFF777777);
 
 #if VQENGINE_MT_PIPELINED_UPDATE_AND_RENDER_THREADS
 	mRenderThread = std::thread(&VQEngine::RenderThread_Main, this);
@@ -377,6 +400,8 @@ void VQEngine::InitializeEngineThreads()
 void VQEngine::ExitThreads()
 {
 	SCOPED_CPU_MARKER("ExitThreads");
+	mScenePreload.bCancel.store(true);
+	mWorkers_Preload.Destroy();
 	mWorkers_ModelLoading.Destroy();
 	mWorkers_MeshLoading.Destroy();
 	mbStopAllThreads.store(true);
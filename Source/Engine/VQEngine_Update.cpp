@@ -22,6 +22,7 @@
 #include "Scene/SceneViews.h"
 #include "../Scenes/Scenes.h" // scene instances
 #include "Core/FileParser.h"
+#include "SceneCache.h"
 #include "Core/Window.h"
 #include "imgui.h"
 
@@ -127,7 +128,10 @@ void VQEngine::UpdateThread_Tick(const float dt)
 
 void VQEngine::UpdateThread_Exit()
 {
+	CancelScenePreload();
+	mAssetLoader.ClearPreloadedModels();
 	mpScene->Unload();
+	mAssetLoader.mAssetCache.Clear();
 	ExitUI();
 }
 
@@ -180,14 +184,26 @@ void VQEngine::UpdateThread_UpdateAppState(const float dt)
 			// animate loading screen
 
 
+			// hand the finished models to their game objects while the rest of the scene is loading
+			if (mbLoadingLevel)
+			{
+				mpScene->AssignLoadedModels();
+			}
+
 			// check if loading is done
 			const int NumActiveTasks = mWorkers_ModelLoading.GetNumActiveTasks();
 			const bool bLoadTasksFinished = NumActiveTasks == 0;
 			if (bLoadTasksFinished)
 			{
-				if (mbLoadingLevel)
+				const bool bLoadedLevel = mbLoadingLevel;
+				if (bLoadedLevel)
 				{
 					mpScene->OnLoadComplete(mBuiltinMeshes);
+
+					// lazily release what the previous scene left in the cache & this one didn't pick up
+					mAssetLoader.mAssetCache.ClearKeepSet();
+					mAssetLoader.mAssetCache.Trim();
+					mAssetLoader.ClearPreloadedModels();
 				}
 				// OnEnvMapLoaded = noop
 
@@ -201,6 +217,23 @@ void VQEngine::UpdateThread_UpdateAppState(const float dt)
 				float dt_loading = mpTimer->StopGetDeltaTimeAndReset();
 				SetEffectiveFrameRateLimit(mSettings.gfx.MaxFrameRate);
 				Log::Info("Loading completed in %.2fs, starting scene simulation", dt_loading);
+				if (bLoadedLevel)
+				{
+					const AssetCache::FStats CacheStats = mAssetLoader.mAssetCache.GetStats();
+					Log::Info("[AssetCache] Scene switch: unload %.2fs + load %.2fs | models: %u retained, %u restored, %u evicted | textures: %u reused, %u evicted | %.1fMB unreferenced"
+						, mSceneUnloadTime, dt_loading
+						, CacheStats.NumRetainedModels, CacheStats.NumRestoredModels, CacheStats.NumEvictedModels
+						, CacheStats.NumReusedTextures, CacheStats.NumEvictedTextures
+						, mAssetLoader.mAssetCache.GetUnreferencedBytes() / (1024.0 * 1024.0));
+
+					// warm up the scene PageUp would switch to
+					const int NumScenes = static_cast<int>(mResourceNames.mSceneNames.size());
+					const int IndexNextScene = CircularIncrement(mIndex_SelectedScene, NumScenes);
+					if (mSettings.ScenePreloadBudgetMB > 0 && IndexNextScene != mIndex_SelectedScene)
+					{
+						StartPreloadingScene(IndexNextScene, static_cast<uint64>(mSettings.ScenePreloadBudgetMB) << 20);
+					}
+				}
 				mpTimer->Start();
 				UpdateThread_UpdateScene_MainWnd(dt);
 				UpdateThread_UpdateScene_DebugWnd(dt);
@@ -208,6 +241,17 @@ void VQEngine::UpdateThread_UpdateAppState(const float dt)
 		}
 	}	break;
 	case EAppState::SIMULATING:
+		if (mpPendingSceneSnapshot)
+		{
+			WaitUntilRenderingFinishes();
+			if (!UpdateThread_ApplySceneSnapshot(*mpPendingSceneSnapshot))
+				Log::Warning("Scene snapshot: %s changed since the snapshot was taken, keeping the scene file state", mpPendingSceneSnapshot->SceneName.c_str());
+			mpPendingSceneSnapshot.reset();
+		}
+		if (mSettings.bHotReloadScenes)
+		{
+			UpdateThread_HotReloadScene(dt);
+		}
 		// TODO: threaded?
 		UpdateThread_UpdateScene_MainWnd(dt);
 		UpdateThread_UpdateScene_DebugWnd(dt);
@@ -503,11 +547,48 @@ void VQEngine::Load_SceneData_Dispatch()
 		else if (SceneType == "Terrain")          pScene = std::make_unique<TerrainScene>(*this, NUM_SWAPCHAIN_BACKBUFFERS, input, mpWinMain, *mpRenderer);
 	};
 
+	// load scene representation from disk: the unload keeps the assets the next scene uses
+	const std::string SceneFilePath = "Data/Levels/" + SceneFileName + ".xml";
+	FSceneRepresentation SceneRep;
+	bool bUsePreloadedSceneRep = false;
+	if (!mScenePreload.SceneFilePath.empty())
+	{
+		// the preloaded models & textures stay with the asset loader/cache either way, only the parsed scene is taken here
+		const bool bSameScene = mScenePreload.SceneFilePath == SceneFilePath; // SceneFilePath is only written on this thread
+		CancelScenePreload(); // WriteTime & SceneRep are written by the preload task, read them after it's done
+
+		std::error_code ec;
+		const std::filesystem::file_time_type WriteTime = std::filesystem::last_write_time(SceneFilePath, ec);
+		bUsePreloadedSceneRep = bSameScene && !ec && WriteTime == mScenePreload.WriteTime && !mScenePreload.SceneRep.SceneName.empty();
+		if (bUsePreloadedSceneRep)
+		{
+			SceneRep = std::move(mScenePreload.SceneRep);
+		}
+		mScenePreload.SceneRep = FSceneRepresentation();
+	}
+	if (!bUsePreloadedSceneRep)
+	{
+		SCOPED_CPU_MARKER("DeserializeScene");
+		SceneRep = SceneCache::LoadScene(SceneFilePath);
+	}
+
 	const bool bUpscalingEnabled = mpScene ? mpScene->GetPostProcessParameters(0).IsFSREnabled() : false;
+	int iReusedEnvironmentMap = -1;
+	mSceneUnloadTime = 0.0f;
+	mAssetLoader.mAssetCache.ResetStats();
 	if (mpScene)
 	{
+		const int iEnvMap = mpScene->mIndex_ActiveEnvironmentMapPreset;
+		if (iEnvMap != -1 && mResourceNames.mEnvironmentMapPresetNames[iEnvMap] == SceneRep.EnvironmentMapPreset)
+		{
+			iReusedEnvironmentMap = iEnvMap;
+		}
+		mAssetLoader.mAssetCache.SetKeepSet(SceneRep);
+
+		Timer tUnload; tUnload.Start();
 		this->WaitUntilRenderingFinishes();
-		mpScene->Unload(); // is this really necessary when we fnCreateSceneInstance() ?
+		mpScene->Unload(&mWorkers_Simulation, iReusedEnvironmentMap != -1); // is this really necessary when we fnCreateSceneInstance() ?
+		mSceneUnloadTime = tUnload.Tick();
 		
 		for(int i=0; i<FUIState::EEditorMode::NUM_EDITOR_MODES; ++i)
 			mUIState.SelectedEditeeIndex[i] = INVALID_ID;
@@ -515,13 +596,12 @@ void VQEngine::Load_SceneData_Dispatch()
 		mpRenderer->ResetNumFramesRendered();
 	}
 
-	// load scene representation from disk
-	const std::string SceneFilePath = "Data/Levels/" + SceneFileName + ".xml";
-	FSceneRepresentation SceneRep;
+	fnCreateSceneInstance(SceneRep.SceneName, mpScene);
 	{
-		SCOPED_CPU_MARKER("DeserializeScene");
-		SceneRep = FileParser::ParseSceneFile(SceneFilePath);
-		fnCreateSceneInstance(SceneRep.SceneName, mpScene);
+		std::error_code ec;
+		mSceneFilePath = SceneFilePath;
+		mSceneFileWriteTime = std::filesystem::last_write_time(SceneFilePath, ec);
+		mSceneHotReloadPollTimer = 0.0f;
 	}
 
 	//----------------------------------------------------------------------
@@ -541,8 +621,12 @@ void VQEngine::Load_SceneData_Dispatch()
 	}
 	//----------------------------------------------------------------------
 	
-	// start loading environment map textures
-	if (!SceneRep.EnvironmentMapPreset.empty())
+	// start loading environment map textures, unless the previous scene left the same one loaded
+	if (iReusedEnvironmentMap != -1)
+	{
+		mpScene->mIndex_ActiveEnvironmentMapPreset = iReusedEnvironmentMap;
+	}
+	else if (!SceneRep.EnvironmentMapPreset.empty())
 	{
 		mWorkers_Simulation.AddTask([=]() { LoadEnvironmentMap(SceneRep.EnvironmentMapPreset, mSettings.gfx.EnvironmentMapResolution); });
 	}
@@ -551,6 +635,193 @@ void VQEngine::Load_SceneData_Dispatch()
 	mpScene->StartLoading(SceneRep, mWorkers_Simulation);
 }
 
+void VQEngine::UpdateThread_HotReloadScene(const float dt)
+{
+	constexpr float HOT_RELOAD_POLL_INTERVAL_SECONDS = 0.5f;
+
+	// objects added by the previous reloads get their models as they finish loading
+	if (mpScene->HasPendingModelLoads())
+	{
+		mpScene->AssignLoadedModels();
+		if (!mpScene->HasPendingModelLoads())
+			mpScene->ReleaseMeshGeometry();
+	}
+
+	mSceneHotReloadPollTimer += dt;
+	if (mSceneHotReloadPollTimer < HOT_RELOAD_POLL_INTERVAL_SECONDS || mSceneFilePath.empty())
+		return;
+	mSceneHotReloadPollTimer = 0.0f;
+
+	SCOPED_CPU_MARKER("HotReloadScene");
+	std::error_code ec;
+	const std::filesystem::file_time_type WriteTime = std::filesystem::last_write_time(mSceneFilePath, ec);
+	if (ec || WriteTime == mSceneFileWriteTime)
+		return;
+
+	// editors may save in multiple steps: keep the last write time until the file parses, so that it's picked up on the next poll
+	if (!FileParser::IsXMLFileValid(mSceneFilePath))
+	{
+		Log::Warning("Hot-reload: couldn't parse %s, keeping the current scene", mSceneFilePath.c_str());
+		return;
+	}
+	mSceneFileWriteTime = WriteTime;
+
+	Log::Info("Hot-reload: %s changed", mSceneFilePath.c_str());
+	FSceneRepresentation SceneRep = SceneCache::LoadScene(mSceneFilePath);
+
+	WaitUntilRenderingFinishes();
+	const FSceneHotReloadStats Stats = mpScene->HotReload(SceneRep, mWorkers_Simulation);
+	if (!Stats.HasChanges())
+	{
+		Log::Info("Hot-reload: no changes in %s", mSceneFilePath.c_str());
+		return;
+	}
+
+	// the selected objects & lights may have been removed
+	for (int i = 0; i < FUIState::EEditorMode::NUM_EDITOR_MODES; ++i)
+		mUIState.SelectedEditeeIndex[i] = INVALID_ID;
+
+	if (Stats.bEnvironmentMapChanged)
+	{
+		const std::string& EnvMapPreset = mpScene->mSceneRepresentation.EnvironmentMapPreset;
+		const std::vector<std::string>& EnvMapNames = mResourceNames.mEnvironmentMapPresetNames;
+		auto it = std::find(EnvMapNames.begin(), EnvMapNames.end(), EnvMapPreset);
+		if (it != EnvMapNames.end())
+		{
+			StartLoadingEnvironmentMap(static_cast<int>(it - EnvMapNames.begin()));
+		}
+		else
+		{
+			if (!EnvMapPreset.empty())
+				Log::Warning("Hot-reload: environment map preset not found: %s", EnvMapPreset.c_str());
+			UnloadEnvironmentMap();
+			mpScene->mIndex_ActiveEnvironmentMapPreset = -1;
+		}
+	}
+}
+
+bool VQEngine::SaveSceneSnapshot(const std::string& FilePath, int FRAME_DATA_INDEX)
+{
+	SCOPED_CPU_MARKER("SaveSceneSnapshot");
+	if (mbLoadingLevel || !mpScene)
+	{
+		Log::Warning("Scene snapshot: can't save while a scene is loading");
+		return false;
+	}
+
+	Timer t;
+	t.Start();
+
+	SceneSnapshot::FSceneSnapshot Snapshot;
+	Snapshot.SceneName = mResourceNames.mSceneNames[mIndex_SelectedScene];
+	const int iEnvMap = mpScene->mIndex_ActiveEnvironmentMapPreset;
+	if (iEnvMap >= 0 && iEnvMap < static_cast<int>(mResourceNames.mEnvironmentMapPresetNames.size()))
+	{
+		Snapshot.EnvironmentMapPreset = mResourceNames.mEnvironmentMapPresetNames[iEnvMap];
+	}
+	mpScene->CaptureSnapshot(Snapshot, FRAME_DATA_INDEX);
+	Snapshot.RenderSettings.PostProcess.bAntiAliasing = mSettings.gfx.bAntiAliasing ? 1 : 0;
+
+	if (!SceneSnapshot::WriteSnapshot(FilePath, Snapshot))
+		return false;
+
+	t.Stop();
+	Log::Info("[Snapshot] Saved %s to %s in %.2fms: %zu objects, %zu materials, %zu cameras"
+		, Snapshot.SceneName.c_str(), FilePath.c_str(), t.DeltaTime() * 1000.0f
+		, Snapshot.Transforms.size(), Snapshot.Materials.size(), Snapshot.Cameras.size());
+	return true;
+}
+
+bool VQEngine::RestoreSceneSnapshot(const std::string& FilePath)
+{
+	SCOPED_CPU_MARKER("RestoreSceneSnapshot");
+	std::unique_ptr<SceneSnapshot::FSceneSnapshot> pSnapshot = std::make_unique<SceneSnapshot::FSceneSnapshot>();
+	if (!SceneSnapshot::ReadSnapshot(FilePath, *pSnapshot))
+	{
+		Log::Warning("Scene snapshot: couldn't read %s", FilePath.c_str());
+		return false;
+	}
+
+	const std::vector<std::string>& SceneNames = mResourceNames.mSceneNames;
+	auto it = std::find(SceneNames.begin(), SceneNames.end(), pSnapshot->SceneName);
+	if (it == SceneNames.end())
+	{
+		Log::Warning("Scene snapshot: scene not found: %s", pSnapshot->SceneName.c_str());
+		return false;
+	}
+	const int IndexScene = static_cast<int>(it - SceneNames.begin());
+
+	// the loaded scene: apply in place, no asset is touched
+	const bool bSceneLoaded = mpScene && !mbLoadingLevel && mAppState == EAppState::SIMULATING && IndexScene == mIndex_SelectedScene;
+	if (bSceneLoaded)
+	{
+		WaitUntilRenderingFinishes();
+		if (UpdateThread_ApplySceneSnapshot(*pSnapshot))
+			return true;
+		Log::Info("Scene snapshot: %s objects changed since the snapshot, reloading the scene", pSnapshot->SceneName.c_str());
+	}
+
+	// another scene: load it first, the AssetCache hands out what's already resident
+	Log::Info("[Snapshot] Loading %s for %s", pSnapshot->SceneName.c_str(), FilePath.c_str());
+	mIndex_SelectedScene = IndexScene;
+	StartLoadingScene(mIndex_SelectedScene);
+	mpPendingSceneSnapshot = std::move(pSnapshot);
+	return true;
+}
+
+bool VQEngine::UpdateThread_ApplySceneSnapshot(const SceneSnapshot::FSceneSnapshot& Snapshot)
+{
+	SCOPED_CPU_MARKER("UpdateThread_ApplySceneSnapshot");
+	Timer t;
+	t.Start();
+
+	const FPostProcessParameters& PPParams = mpScene->GetPostProcessParameters(0);
+	const FPostProcessParameters::EUpscalingAlgorithm UpscalingAlgorithmPrev = PPParams.UpscalingAlgorithm;
+	const float ResolutionScalePrev = PPParams.ResolutionScale;
+	if (!mpScene->ApplySnapshot(Snapshot))
+		return false;
+
+	mSettings.gfx.bAntiAliasing = Snapshot.RenderSettings.PostProcess.bAntiAliasing != 0;
+
+	// the selected objects & lights may not be there anymore
+	for (int i = 0; i < FUIState::EEditorMode::NUM_EDITOR_MODES; ++i)
+		mUIState.SelectedEditeeIndex[i] = INVALID_ID;
+
+	const std::vector<std::string>& EnvMapNames = mResourceNames.mEnvironmentMapPresetNames;
+	auto it = std::find(EnvMapNames.begin(), EnvMapNames.end(), Snapshot.EnvironmentMapPreset);
+	const int iEnvMap = it != EnvMapNames.end() ? static_cast<int>(it - EnvMapNames.begin()) : -1;
+	if (iEnvMap != mpScene->mIndex_ActiveEnvironmentMapPreset)
+	{
+		if (iEnvMap != -1)
+		{
+			StartLoadingEnvironmentMap(iEnvMap);
+		}
+		else
+		{
+			if (!Snapshot.EnvironmentMapPreset.empty())
+				Log::Warning("Scene snapshot: environment map preset not found: %s", Snapshot.EnvironmentMapPreset.c_str());
+			UnloadEnvironmentMap();
+			mpScene->mIndex_ActiveEnvironmentMapPreset = -1;
+		}
+	}
+
+	// the render targets are sized w/ the upscaling settings, see the "J" hotkey
+	if (PPParams.UpscalingAlgorithm != UpscalingAlgorithmPrev || PPParams.ResolutionScale != ResolutionScalePrev)
+	{
+		const HWND hwnd = mpWinMain->GetHWND();
+		const uint32 W = mpWinMain->GetWidth();
+		const uint32 H = mpWinMain->GetHeight();
+		mEventQueue_WinToVQE_Renderer.AddItem(std::make_unique<WindowResizeEvent>(W, H, hwnd));
+		mEventQueue_WinToVQE_Update.AddItem(std::make_unique<WindowResizeEvent>(W, H, hwnd));
+	}
+
+	mpRenderer->ClearRenderPassHistories();
+	t.Stop();
+	Log::Info("[Snapshot] Restored %s in %.2fms: %zu objects, %zu materials, %zu cameras", Snapshot.SceneName.c_str(), t.DeltaTime() * 1000.0f
+		, Snapshot.Transforms.size(), Snapshot.Materials.size(), Snapshot.Cameras.size());
+	return true;
+}
+
 void VQEngine::LoadLoadingScreenData()
 {
 	SCOPED_CPU_MARKER("LoadLoadingScreenData");
@@ -689,8 +960,49 @@ void VQEngine::StartLoadingScene(int IndexScene)
 
 	mAppState = INITIALIZING;
 	mbLoadingLevel.store(true); // thread-safe
+	mpPendingSceneSnapshot.reset(); // belongs to the scene that was being loaded, see RestoreSceneSnapshot()
 	SetEffectiveFrameRateLimit(-1); // set to monitor refresh rate to not max out frame rate during loading screen
 	Log::Info("StartLoadingScene: %d", IndexScene);
 	mpRenderer->ClearRenderPassHistories();
 }
 
+void VQEngine::StartPreloadingScene(int IndexScene, uint64 MemoryCapBytes)
+{
+	assert(IndexScene >= 0 && IndexScene < mResourceNames.mSceneNames.size());
+	const std::string SceneFilePath = "Data/Levels/" + mResourceNames.mSceneNames[IndexScene] + ".xml";
+	if (mScenePreload.SceneFilePath == SceneFilePath)
+		return; // already preloading/preloaded
+
+	CancelScenePreload();
+
+	Log::Info("StartPreloadingScene: %d (%s, cap=%s)", IndexScene, mResourceNames.mSceneNames[IndexScene].c_str(), StrUtil::FormatByte(MemoryCapBytes).c_str());
+	mScenePreload.SceneFilePath = SceneFilePath;
+	mScenePreload.bCancel.store(false);
+	mScenePreload.Done = mWorkers_Preload.AddTask([this, SceneFilePath, MemoryCapBytes]()
+	{
+		SCOPED_CPU_MARKER("PreloadScene");
+		SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST); // stay out of the way of the update/render threads
+
+		std::error_code ec;
+		mScenePreload.WriteTime = std::filesystem::last_write_time(SceneFilePath, ec);
+		mScenePreload.SceneRep = SceneCache::LoadScene(SceneFilePath);
+		if (!mScenePreload.bCancel.load())
+		{
+			mAssetLoader.PreloadSceneAssets(mScenePreload.SceneRep, MemoryCapBytes, mScenePreload.bCancel);
+		}
+	});
+}
+
+void VQEngine::CancelScenePreload()
+{
+	if (mScenePreload.SceneFilePath.empty())
+		return;
+	SCOPED_CPU_MARKER("CancelScenePreload");
+	mScenePreload.bCancel.store(true);
+	if (mScenePreload.Done.valid())
+	{
+		mScenePreload.Done.wait();
+	}
+	mScenePreload.SceneFilePath.clear();
+}
+
@@ -253,6 +253,7 @@ static size_t GeneratePSOHash(const FPSODesc& PSODesc)
 		const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc = PSODesc.D3D12GraphicsDesc;
 
 		// Input Layout
+		hashInput += std::to_string(PSODesc.VertexFormat); // the layout is reflected at compile time, see OverrideInputLayoutForVertexFormat()
 		hashInput += std::to_string(desc.InputLayout.NumElements);
 		for (UINT i = 0; i < desc.InputLayout.NumElements; ++i) 
 		{
@@ -657,6 +658,52 @@ std::vector<FPSODesc> VQRenderer::LoadBuiltinPSODescs()
 	return descs;
 }
 
+// Reflection assigns 32-bit formats to all the vertex attributes, the packed vertex formats
+// encode them in UNORM formats at fixed offsets instead (see Buffer.h & VertexAttributes.hlsl)
+static void OverrideInputLayoutForVertexFormat(std::vector<D3D12_INPUT_ELEMENT_DESC>& InputLayout, EVertexBufferType VertexFormat)
+{
+	struct FElement { const char* SemanticName; UINT SemanticIndex; DXGI_FORMAT Format; UINT Offset; };
+	static const FElement Packed1Layout[] = // 28B
+	{
+		  { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT   , 0  }
+		, { "NORMAL"  , 0, DXGI_FORMAT_R16G16B16A16_UNORM, 12 } // normal.xyz, tangent.x
+		, { "TANGENT" , 0, DXGI_FORMAT_R16G16_UNORM      , 20 } // tangent.yz
+		, { "TEXCOORD", 0, DXGI_FORMAT_R16G16_UNORM      , 24 }
+	};
+	static const FElement Packed2Layout[] = // 24B
+	{
+		  { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT   , 0  }
+		, { "NORMAL"  , 0, DXGI_FORMAT_R10G10B10A2_UNORM , 12 }
+		, { "TANGENT" , 0, DXGI_FORMAT_R10G10B10A2_UNORM , 16 }
+		, { "TEXCOORD", 0, DXGI_FORMAT_R16G16_UNORM      , 20 }
+	};
+	static_assert(sizeof(FVertexWithNormalAndTangentPacked1) == 28);
+	static_assert(sizeof(FVertexWithNormalAndTangentPacked2) == 24);
+
+	const FElement* pLayout = nullptr;
+	size_t NumElements = 0;
+	switch (VertexFormat)
+	{
+	case NORMAL_AND_TANGENT_PACKED1: pLayout = Packed1Layout; NumElements = _countof(Packed1Layout); break;
+	case NORMAL_AND_TANGENT_PACKED2: pLayout = Packed2Layout; NumElements = _countof(Packed2Layout); break;
+	default: return; // keep the reflected layout
+	}
+
+	for (D3D12_INPUT_ELEMENT_DESC& elem : InputLayout)
+	{
+		bool bFound = false;
+		for (size_t i = 0; i < NumElements && !bFound; ++i)
+		{
+			if (elem.SemanticIndex != pLayout[i].SemanticIndex || _stricmp(elem.SemanticName, pLayout[i].SemanticName) != 0)
+				continue;
+			elem.Format = pLayout[i].Format;
+			elem.AlignedByteOffset = pLayout[i].Offset;
+			bFound = true;
+		}
+		assert(bFound || _strnicmp(elem.SemanticName, "SV_", 3) == 0); // system values aren't fetched from the vertex buffer
+	}
+}
+
 ID3D12PipelineState* VQRenderer::CompileGraphicsPSO(FPSODesc& Desc, std::vector<std::shared_future<FShaderStageCompileResult>>& ShaderCompileResults)
 {
 	SCOPED_CPU_MARKER_C("CompileGraphicsPSO", 0xFF0022EE);
@@ -734,6 +781,7 @@ ID3D12PipelineState* VQRenderer::CompileGraphicsPSO(FPSODesc& Desc, std::vector<
 		if (bHasVS)
 		{
 			inputLayout = ShaderUtils::ReflectInputLayoutFromVS(ShaderReflections.at(EShaderStage::VS).Get());
+			OverrideInputLayoutForVertexFormat(inputLayout, Desc.VertexFormat);
 			d3d12GraphicsPSODesc.InputLayout = { inputLayout.data(), static_cast<UINT>(inputLayout.size()) };
 		}
 	}
@@ -785,7 +833,7 @@ ID3D12PipelineState* VQRenderer::CompileComputePSO(FPSODesc& Desc, std::vector<s
 	// Assign CS shader blob to PSODesc
 	for (std::shared_future<FShaderStageCompileResult>& TaskResult : ShaderCompileResults)
 	{
-		FShaderStageCompileResult ShaderCompileResult = TaskResult.get();
+		const FShaderStageCompileResult& ShaderCompileResult = TaskResult.get();
 
 		CD3DX12_SHADER_BYTECODE ShaderByteCode(ShaderCompileResult.ShaderBlob.GetByteCode(), ShaderCompileResult.ShaderBlob.GetByteCodeSize());
 		d3d12ComputePSODesc.CS = ShaderByteCode;
@@ -1467,11 +1515,12 @@ void FLightingPSOs::GatherPSOLoadDescs(const std::unordered_map<RS_ID, ID3D12Roo
 	for(size_t iOutTopo = 0 ; iOutTopo  < NUM_OUTTOP_OPTIONS   ; ++iOutTopo) 
 	for(size_t iTessCull = 0; iTessCull < NUM_TESS_CULL_OPTIONS; ++iTessCull)
 	for(size_t iAlpha = 0   ; iAlpha    < NUM_ALPHA_OPTIONS    ; ++iAlpha)
+	for(size_t iVertexFormat = 0; iVertexFormat < NUM_MESH_OPTIONS; ++iVertexFormat)
 	{
 		if (ShouldSkipTessellationVariant(iTess, iDomain, iPart, iOutTopo, iTessCull))
 			continue;
 		
-		const size_t key = Hash(iMSAA, iRaster, iFaceCull, iOutMoVec, iOutRough, iTess, iDomain, iPart, iOutTopo, iTessCull, iAlpha);
+		const size_t key = Hash(iMSAA, iRaster, iFaceCull, iOutMoVec, iOutRough, iTess, iDomain, iPart, iOutTopo, iTessCull, iAlpha, iVertexFormat);
 		
 		std::string PSOName = "PSO_FwdLighting";
 		if (iAlpha == 1) PSOName += "_AlphaMasked";
@@ -1481,8 +1530,10 @@ void FLightingPSOs::GatherPSOLoadDescs(const std::unordered_map<RS_ID, ID3D12Roo
 		{
 			AppendTessellationPSONameTokens(PSOName, iDomain, iPart, iOutTopo, iTessCull);
 		}
+		AppendVertexFormatPSONameTokens(PSOName, iVertexFormat);
 
 		psoLoadDesc.PSOName = PSOName;
+		psoLoadDesc.VertexFormat = GetVertexFormatOptionType(iVertexFormat);
 
 		// MSAA
 		psoDesc.SampleDesc.Count = MSAA_SAMPLE_COUNTS[iMSAA];
@@ -1544,6 +1595,7 @@ void FLightingPSOs::GatherPSOLoadDescs(const std::unordered_map<RS_ID, ID3D12Roo
 				AppendTessellationGSMacros(psoLoadDesc.ShaderStageCompileDescs[3/*GS*/].Macros, iOutTopo, iTessCull);
 			}
 		}
+		AppendVertexFormatVSMacros(psoLoadDesc.ShaderStageCompileDescs[0/*VS*/].Macros, iVertexFormat);
 		if (iOutMoVec)
 		{
 			const FShaderMacro MVMacro = { "OUTPUT_MOTION_VECTORS", "1" };
@@ -1607,11 +1659,12 @@ void FDepthPrePassPSOs::GatherPSOLoadDescs(const std::unordered_map<RS_ID, ID3D1
 	for(size_t iOutTopo = 0 ; iOutTopo  < NUM_OUTTOP_OPTIONS   ; ++iOutTopo) 
 	for(size_t iTessCull = 0; iTessCull < NUM_TESS_CULL_OPTIONS; ++iTessCull)
 	for(size_t iAlpha = 0   ; iAlpha    < NUM_ALPHA_OPTIONS    ; ++iAlpha)
+	for(size_t iVertexFormat = 0; iVertexFormat < NUM_MESH_OPTIONS; ++iVertexFormat)
 	{
 		if (ShouldSkipTessellationVariant(iTess, iDomain, iPart, iOutTopo, iTessCull))
 			continue;
 
-		const size_t key = Hash(iMSAA, iRaster, iFaceCull, iTess, iDomain, iPart, iOutTopo, iTessCull, iAlpha);
+		const size_t key = Hash(iMSAA, iRaster, iFaceCull, iTess, iDomain, iPart, iOutTopo, iTessCull, iAlpha, iVertexFormat);
 		
 		std::string PSOName = "PSO_ZPrePass";
 		if (iAlpha == 1) PSOName += "_AlphaMasked";
@@ -1621,7 +1674,9 @@ void FDepthPrePassPSOs::GatherPSOLoadDescs(const std::unordered_map<RS_ID, ID3D1
 		{
 			AppendTessellationPSONameTokens(PSOName, iDomain, iPart, iOutTopo, iTessCull);
 		}
+		AppendVertexFormatPSONameTokens(PSOName, iVertexFormat);
 		psoLoadDesc.PSOName = PSOName;
+		psoLoadDesc.VertexFormat = GetVertexFormatOptionType(iVertexFormat);
 
 		// MSAA
 		psoDesc.SampleDesc.Count = MSAA_SAMPLE_COUNTS[iMSAA];
@@ -1674,6 +1729,7 @@ void FDepthPrePassPSOs::GatherPSOLoadDescs(const std::unordered_map<RS_ID, ID3D1
 				AppendTessellationGSMacros(psoLoadDesc.ShaderStageCompileDescs[3/*GS*/].Macros, iOutTopo, iTessCull);
 			}
 		}
+		AppendVertexFormatVSMacros(psoLoadDesc.ShaderStageCompileDescs[0/*VS*/].Macros, iVertexFormat);
 		for (FShaderStageCompileDesc& shdDesc : psoLoadDesc.ShaderStageCompileDescs) // all stages
 		{
 			shdDesc.Macros.push_back(InstancedDrawMacro);
@@ -1720,11 +1776,12 @@ void FShadowPassPSOs::GatherPSOLoadDescs(const std::unordered_map<RS_ID, ID3D12R
 	for(size_t iOutTopo = 0 ; iOutTopo  < NUM_OUTTOP_OPTIONS; ++iOutTopo) 
 	for(size_t iTessCull = 0; iTessCull < NUM_TESS_CULL_OPTIONS; ++iTessCull)
 	for(size_t iAlpha = 0   ; iAlpha    < NUM_ALPHA_OPTIONS ; ++iAlpha)
+	for(size_t iVertexFormat = 0; iVertexFormat < NUM_MESH_OPTIONS; ++iVertexFormat)
 	{
 		if (ShouldSkipTessellationVariant(iTess, iDomain, iPart, iOutTopo, iTessCull))
 			continue;
 
-		const size_t key = Hash(iDepthMode, iRaster, iFaceCull, iTess, iDomain, iPart, iOutTopo, iTessCull, iAlpha);
+		const size_t key = Hash(iDepthMode, iRaster, iFaceCull, iTess, iDomain, iPart, iOutTopo, iTessCull, iAlpha, iVertexFormat);
 		
 		std::string PSOName = "PSO_ShadowPass";
 		if (iDepthMode == 1) PSOName += "_LinearDepth";
@@ -1734,7 +1791,9 @@ void FShadowPassPSOs::GatherPSOLoadDescs(const std::unordered_map<RS_ID, ID3D12R
 		{
 			AppendTessellationPSONameTokens(PSOName, iDomain, iPart, iOutTopo, iTessCull);
 		}
+		AppendVertexFormatPSONameTokens(PSOName, iVertexFormat);
 		psoLoadDesc.PSOName = PSOName;
+		psoLoadDesc.VertexFormat = GetVertexFormatOptionType(iVertexFormat);
 
 		// RS
 		psoDesc.RasterizerState.FillMode = FillModes[iRaster];
@@ -1779,6 +1838,7 @@ void FShadowPassPSOs::GatherPSOLoadDescs(const std::unordered_map<RS_ID, ID3D12R
 			if(iTessCull > 0)
 				AppendTessellationGSMacros(psoLoadDesc.ShaderStageCompileDescs[3/*GS*/].Macros, iOutTopo, iTessCull);
 		}
+		AppendVertexFormatVSMacros(psoLoadDesc.ShaderStageCompileDescs[0/*VS*/].Macros, iVertexFormat);
 		for (FShaderStageCompileDesc& shdDesc : psoLoadDesc.ShaderStageCompileDescs)
 		{
 			shdDesc.Macros.push_back(InstancedDrawMacro);
@@ -1799,7 +1859,7 @@ void FShadowPassPSOs::GatherPSOLoadDescs(const std::unordered_map<RS_ID, ID3D12R
 
 
 
-size_t FLightingPSOs::Hash(size_t iMSAA, size_t iRaster, size_t iFaceCull, size_t iOutMoVec, size_t iOutRough, size_t iTess, size_t iDomain, size_t iPart, size_t iOutTopo, size_t iTessCullMode, size_t iAlpha)
+size_t FLightingPSOs::Hash(size_t iMSAA, size_t iRaster, size_t iFaceCull, size_t iOutMoVec, size_t iOutRough, size_t iTess, size_t iDomain, size_t iPart, size_t iOutTopo, size_t iTessCullMode, size_t iAlpha, size_t iVertexFormat)
 {
 	return iMSAA
 		+ NUM_MSAA_OPTIONS * iRaster
@@ -1811,10 +1871,11 @@ size_t FLightingPSOs::Hash(size_t iMSAA, size_t iRaster, size_t iFaceCull, size_
 		+ NUM_MSAA_OPTIONS * NUM_RASTER_OPTS * NUM_FACECULL_OPTS * NUM_MOVEC_OPTS * NUM_ROUGH_OPTS * NUM_TESS_ENABLED * NUM_DOMAIN_OPTIONS * iPart
 		+ NUM_MSAA_OPTIONS * NUM_RASTER_OPTS * NUM_FACECULL_OPTS * NUM_MOVEC_OPTS * NUM_ROUGH_OPTS * NUM_TESS_ENABLED * NUM_DOMAIN_OPTIONS * NUM_PARTIT_OPTIONS * iOutTopo
 		+ NUM_MSAA_OPTIONS * NUM_RASTER_OPTS * NUM_FACECULL_OPTS * NUM_MOVEC_OPTS * NUM_ROUGH_OPTS * NUM_TESS_ENABLED * NUM_DOMAIN_OPTIONS * NUM_PARTIT_OPTIONS * NUM_OUTTOP_OPTIONS * iTessCullMode
-		+ NUM_MSAA_OPTIONS * NUM_RASTER_OPTS * NUM_FACECULL_OPTS * NUM_MOVEC_OPTS * NUM_ROUGH_OPTS * NUM_TESS_ENABLED * NUM_DOMAIN_OPTIONS * NUM_PARTIT_OPTIONS * NUM_OUTTOP_OPTIONS * NUM_TESS_CULL_OPTIONS * iAlpha;
+		+ NUM_MSAA_OPTIONS * NUM_RASTER_OPTS * NUM_FACECULL_OPTS * NUM_MOVEC_OPTS * NUM_ROUGH_OPTS * NUM_TESS_ENABLED * NUM_DOMAIN_OPTIONS * NUM_PARTIT_OPTIONS * NUM_OUTTOP_OPTIONS * NUM_TESS_CULL_OPTIONS * iAlpha
+		+ NUM_MSAA_OPTIONS * NUM_RASTER_OPTS * NUM_FACECULL_OPTS * NUM_MOVEC_OPTS * NUM_ROUGH_OPTS * NUM_TESS_ENABLED * NUM_DOMAIN_OPTIONS * NUM_PARTIT_OPTIONS * NUM_OUTTOP_OPTIONS * NUM_TESS_CULL_OPTIONS * NUM_ALPHA_OPTIONS * iVertexFormat;
 }
 
-size_t FDepthPrePassPSOs::Hash(size_t iMSAA, size_t iRaster, size_t iFaceCull, size_t iTess, size_t iDomain, size_t iPart, size_t iOutTopo, size_t iTessCullMode, size_t iAlpha)
+size_t FDepthPrePassPSOs::Hash(size_t iMSAA, size_t iRaster, size_t iFaceCull, size_t iTess, size_t iDomain, size_t iPart, size_t iOutTopo, size_t iTessCullMode, size_t iAlpha, size_t iVertexFormat)
 {
 	return iMSAA
 		+ NUM_MSAA_OPTIONS * iRaster
@@ -1824,10 +1885,11 @@ size_t FDepthPrePassPSOs::Hash(size_t iMSAA, size_t iRaster, size_t iFaceCull, s
 		+ NUM_MSAA_OPTIONS * NUM_RASTER_OPTS * NUM_FACECULL_OPTS * NUM_TESS_ENABLED * NUM_DOMAIN_OPTIONS * iPart
 		+ NUM_MSAA_OPTIONS * NUM_RASTER_OPTS * NUM_FACECULL_OPTS * NUM_TESS_ENABLED * NUM_DOMAIN_OPTIONS * NUM_PARTIT_OPTIONS * iOutTopo
 		+ NUM_MSAA_OPTIONS * NUM_RASTER_OPTS * NUM_FACECULL_OPTS * NUM_TESS_ENABLED * NUM_DOMAIN_OPTIONS * NUM_PARTIT_OPTIONS * NUM_OUTTOP_OPTIONS * iTessCullMode
-		+ NUM_MSAA_OPTIONS * NUM_RASTER_OPTS * NUM_FACECULL_OPTS * NUM_TESS_ENABLED * NUM_DOMAIN_OPTIONS * NUM_PARTIT_OPTIONS * NUM_OUTTOP_OPTIONS * NUM_TESS_CULL_OPTIONS * iAlpha;
+		+ NUM_MSAA_OPTIONS * NUM_RASTER_OPTS * NUM_FACECULL_OPTS * NUM_TESS_ENABLED * NUM_DOMAIN_OPTIONS * NUM_PARTIT_OPTIONS * NUM_OUTTOP_OPTIONS * NUM_TESS_CULL_OPTIONS * iAlpha
+		+ NUM_MSAA_OPTIONS * NUM_RASTER_OPTS * NUM_FACECULL_OPTS * NUM_TESS_ENABLED * NUM_DOMAIN_OPTIONS * NUM_PARTIT_OPTIONS * NUM_OUTTOP_OPTIONS * NUM_TESS_CULL_OPTIONS * NUM_ALPHA_OPTIONS * iVertexFormat;
 }
 
-size_t FShadowPassPSOs::Hash(size_t iDepthMode, size_t iRaster, size_t iFaceCull, size_t iTess, size_t iDomain, size_t iPart, size_t iOutTopo, size_t iTessCullMode, size_t iAlpha)
+size_t FShadowPassPSOs::Hash(size_t iDepthMode, size_t iRaster, size_t iFaceCull, size_t iTess, size_t iDomain, size_t iPart, size_t iOutTopo, size_t iTessCullMode, size_t iAlpha, size_t iVertexFormat)
 {
 	return iDepthMode
 		+ NUM_DEPTH_RENDER_OPTS * iRaster
@@ -1837,5 +1899,6 @@ size_t FShadowPassPSOs::Hash(size_t iDepthMode, size_t iRaster, size_t iFaceCull
 		+ NUM_DEPTH_RENDER_OPTS * NUM_RASTER_OPTS * NUM_FACECULL_OPTS * NUM_TESS_ENABLED * NUM_DOMAIN_OPTIONS * iPart
 		+ NUM_DEPTH_RENDER_OPTS * NUM_RASTER_OPTS * NUM_FACECULL_OPTS * NUM_TESS_ENABLED * NUM_DOMAIN_OPTIONS * NUM_PARTIT_OPTIONS * iOutTopo
 		+ NUM_DEPTH_RENDER_OPTS * NUM_RASTER_OPTS * NUM_FACECULL_OPTS * NUM_TESS_ENABLED * NUM_DOMAIN_OPTIONS * NUM_PARTIT_OPTIONS * NUM_OUTTOP_OPTIONS * iTessCullMode
-		+ NUM_DEPTH_RENDER_OPTS * NUM_RASTER_OPTS * NUM_FACECULL_OPTS * NUM_TESS_ENABLED * NUM_DOMAIN_OPTIONS * NUM_PARTIT_OPTIONS * NUM_OUTTOP_OPTIONS * NUM_TESS_CULL_OPTIONS * iAlpha;
+		+ NUM_DEPTH_RENDER_OPTS * NUM_RASTER_OPTS * NUM_FACECULL_OPTS * NUM_TESS_ENABLED * NUM_DOMAIN_OPTIONS * NUM_PARTIT_OPTIONS * NUM_OUTTOP_OPTIONS * NUM_TESS_CULL_OPTIONS * iAlpha
+		+ NUM_DEPTH_RENDER_OPTS * NUM_RASTER_OPTS * NUM_FACECULL_OPTS * NUM_TESS_ENABLED * NUM_DOMAIN_OPTIONS * NUM_PARTIT_OPTIONS * NUM_OUTTOP_OPTIONS * NUM_TESS_CULL_OPTIONS * NUM_ALPHA_OPTIONS * iVertexFormat;
 }
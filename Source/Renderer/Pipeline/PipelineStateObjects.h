@@ -21,7 +21,9 @@
 #include "ShaderCompileUtils.h"
 #include <unordered_map>
 #include "Tessellation.h"
+#include "Resources/Buffer.h"
 #include "Engine/Core/Types.h"
+#include "Engine/Core/FlatHashMap.h"
 
 namespace D3D12MA { class Allocator; }
 class Window;
@@ -41,6 +43,7 @@ struct FPSODesc
 	D3D12_COMPUTE_PIPELINE_STATE_DESC  D3D12ComputeDesc;
 	D3D12_GRAPHICS_PIPELINE_STATE_DESC D3D12GraphicsDesc;
 	std::vector<FShaderStageCompileDesc> ShaderStageCompileDescs;
+	EVertexBufferType VertexFormat = DEFAULT; // packed formats override the input layout reflected from the VS
 };
 
 struct FPSOCreationTaskParameters
@@ -112,12 +115,22 @@ enum EBuiltinRootSignatures
 static constexpr size_t NUM_MSAA_OPTIONS = 2; 
 static constexpr UINT MSAA_SAMPLE_COUNTS[NUM_MSAA_OPTIONS] = { 1, 4 };
 
+// full precision/packed1/packed2, see GetVertexFormatOption()
+inline void AppendVertexFormatPSONameTokens(std::string& PSOName, size_t iVertexFormat)
+{
+	if (iVertexFormat > 0) PSOName += "_Packed" + std::to_string(iVertexFormat);
+}
+inline void AppendVertexFormatVSMacros(std::vector<FShaderMacro>& Macros, size_t iVertexFormat)
+{
+	if (iVertexFormat > 0) Macros.push_back(FShaderMacro::CreateShaderMacro("PACKED_VERTEX_ATTRIBUTES", "%d", static_cast<int>(iVertexFormat)));
+}
+
 struct PSOCollection
 {
 	virtual void GatherPSOLoadDescs(const std::unordered_map<RS_ID, ID3D12RootSignature*>& mRootSignatureLookup) = 0;
 	PSO_ID Get(size_t hash) const;
 
-	std::unordered_map<size_t, PSO_ID>   mapPSO;
+	FlatHashMap<size_t, PSO_ID>          mapPSO;
 	std::unordered_map<size_t, FPSODesc> mapLoadDesc;
 };
 
@@ -140,15 +153,18 @@ struct FLightingPSOs : PSOCollection
 	static constexpr size_t NUM_ALPHA_OPTIONS = 2; // opaque/alpha masked
 	static constexpr size_t NUM_MAT_OPTIONS = NUM_ALPHA_OPTIONS;
 
-	static size_t Hash(size_t iMSAA, size_t iRaster, size_t iFaceCull, size_t iOutMoVec, size_t iOutRough, size_t iTess, size_t iDomain, size_t iPart, size_t iOutTopo, size_t iTessCullMode, size_t iAlpha);
-	inline PSO_ID  Get(size_t iMSAA, size_t iRaster, size_t iFaceCull, size_t iOutMoVec, size_t iOutRough, size_t iTess, size_t iDomain, size_t iPart, size_t iOutTopo, size_t iTessCullMode, size_t iAlpha) const
+	// mesh
+	static constexpr size_t NUM_MESH_OPTIONS = NUM_VERTEX_FORMAT_OPTIONS;
+
+	static size_t Hash(size_t iMSAA, size_t iRaster, size_t iFaceCull, size_t iOutMoVec, size_t iOutRough, size_t iTess, size_t iDomain, size_t iPart, size_t iOutTopo, size_t iTessCullMode, size_t iAlpha, size_t iVertexFormat);
+	inline PSO_ID  Get(size_t iMSAA, size_t iRaster, size_t iFaceCull, size_t iOutMoVec, size_t iOutRough, size_t iTess, size_t iDomain, size_t iPart, size_t iOutTopo, size_t iTessCullMode, size_t iAlpha, size_t iVertexFormat) const
 	{
-		return PSOCollection::Get(Hash(iMSAA, iRaster, iFaceCull, iOutMoVec, iOutRough, iTess, iDomain, iPart, iOutTopo, iTessCullMode, iAlpha));
+		return PSOCollection::Get(Hash(iMSAA, iRaster, iFaceCull, iOutMoVec, iOutRough, iTess, iDomain, iPart, iOutTopo, iTessCullMode, iAlpha, iVertexFormat));
 	}
 
 	void GatherPSOLoadDescs(const std::unordered_map<RS_ID, ID3D12RootSignature*>& mRootSignatureLookup) override;
 
-	static constexpr size_t NUM_OPTIONS_PERMUTATIONS = NUM_MAT_OPTIONS * NUM_RENDERING_OPTIONS * NUM_OUTPUT_OPTS * Tessellation::NUM_TESS_OPTIONS;
+	static constexpr size_t NUM_OPTIONS_PERMUTATIONS = NUM_MESH_OPTIONS * NUM_MAT_OPTIONS * NUM_RENDERING_OPTIONS * NUM_OUTPUT_OPTS * Tessellation::NUM_TESS_OPTIONS;
 };
 
 // ------------------------------------------------------------------------------------------------------------------------
@@ -164,15 +180,18 @@ struct FDepthPrePassPSOs : public PSOCollection
 	static constexpr size_t NUM_ALPHA_OPTIONS = 2; // opaque/alpha masked
 	static constexpr size_t NUM_MAT_OPTIONS = NUM_ALPHA_OPTIONS;
 
-	static size_t Hash(size_t iMSAA, size_t iRaster, size_t iFaceCull, size_t iTess, size_t iDomain, size_t iPart, size_t iOutTopo, size_t iTessCullMode, size_t iAlpha);
-	inline PSO_ID  Get(size_t iMSAA, size_t iRaster, size_t iFaceCull, size_t iTess, size_t iDomain, size_t iPart, size_t iOutTopo, size_t iTessCullMode, size_t iAlpha) const
+	// mesh
+	static constexpr size_t NUM_MESH_OPTIONS = NUM_VERTEX_FORMAT_OPTIONS;
+
+	static size_t Hash(size_t iMSAA, size_t iRaster, size_t iFaceCull, size_t iTess, size_t iDomain, size_t iPart, size_t iOutTopo, size_t iTessCullMode, size_t iAlpha, size_t iVertexFormat);
+	inline PSO_ID  Get(size_t iMSAA, size_t iRaster, size_t iFaceCull, size_t iTess, size_t iDomain, size_t iPart, size_t iOutTopo, size_t iTessCullMode, size_t iAlpha, size_t iVertexFormat) const
 	{
-		return PSOCollection::Get(Hash(iMSAA, iRaster, iFaceCull, iTess, iDomain, iPart, iOutTopo, iTessCullMode, iAlpha));
+		return PSOCollection::Get(Hash(iMSAA, iRaster, iFaceCull, iTess, iDomain, iPart, iOutTopo, iTessCullMode, iAlpha, iVertexFormat));
 	}
 
 	void GatherPSOLoadDescs(const std::unordered_map<RS_ID, ID3D12RootSignature*>& mRootSignatureLookup) override;
 
-	static constexpr size_t NUM_OPTIONS_PERMUTATIONS = NUM_MAT_OPTIONS * NUM_RENDERING_OPTIONS * Tessellation::NUM_TESS_OPTIONS;
+	static constexpr size_t NUM_OPTIONS_PERMUTATIONS = NUM_MESH_OPTIONS * NUM_MAT_OPTIONS * NUM_RENDERING_OPTIONS * Tessellation::NUM_TESS_OPTIONS;
 };
 
 // ------------------------------------------------------------------------------------------------------------------------
@@ -189,16 +208,19 @@ struct FShadowPassPSOs : public PSOCollection
 	static constexpr size_t NUM_ALPHA_OPTIONS = 2; // opaque/alpha masked
 	static constexpr size_t NUM_MAT_OPTIONS = NUM_ALPHA_OPTIONS;
 
+	// mesh
+	static constexpr size_t NUM_MESH_OPTIONS = NUM_VERTEX_FORMAT_OPTIONS;
+
 
-	static size_t Hash(size_t iDepthMode, size_t iRaster, size_t iFaceCull, size_t iTess, size_t iDomain, size_t iPart, size_t iOutTopo, size_t iTessCullMode, size_t iAlpha);
-	inline PSO_ID  Get(size_t iDepthMode, size_t iRaster, size_t iFaceCull, size_t iTess, size_t iDomain, size_t iPart, size_t iOutTopo, size_t iTessCullMode, size_t iAlpha) const
+	static size_t Hash(size_t iDepthMode, size_t iRaster, size_t iFaceCull, size_t iTess, size_t iDomain, size_t iPart, size_t iOutTopo, size_t iTessCullMode, size_t iAlpha, size_t iVertexFormat);
+	inline PSO_ID  Get(size_t iDepthMode, size_t iRaster, size_t iFaceCull, size_t iTess, size_t iDomain, size_t iPart, size_t iOutTopo, size_t iTessCullMode, size_t iAlpha, size_t iVertexFormat) const
 	{
-		return PSOCollection::Get(Hash(iDepthMode, iRaster, iFaceCull, iTess, iDomain, iPart, iOutTopo, iTessCullMode, iAlpha));
+		return PSOCollection::Get(Hash(iDepthMode, iRaster, iFaceCull, iTess, iDomain, iPart, iOutTopo, iTessCullMode, iAlpha, iVertexFormat));
 	}
 
 	void GatherPSOLoadDescs(const std::unordered_map<RS_ID, ID3D12RootSignature*>& mRootSignatureLookup) override;
 
-	static constexpr size_t NUM_OPTIONS_PERMUTATIONS = NUM_MAT_OPTIONS * NUM_RENDERING_OPTIONS * Tessellation::NUM_TESS_OPTIONS;
+	static constexpr size_t NUM_OPTIONS_PERMUTATIONS = NUM_MESH_OPTIONS * NUM_MAT_OPTIONS * NUM_RENDERING_OPTIONS * Tessellation::NUM_TESS_OPTIONS;
 };
 
 // ------------------------------------------------------------------------------------------------------------------------
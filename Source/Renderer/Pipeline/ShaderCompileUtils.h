@@ -22,6 +22,7 @@
 #define WIN32_LEAN_AND_MEAN
 #define NOMINMAX
 #include "Shader.h"
+#include "Engine/Core/MemoryTracking.h"
 #include <vector>
 #include <string>
 #include <d3d12.h>
@@ -161,4 +162,5 @@ struct FShaderStageCompileResult
 	EShaderStage ShaderStage;
 	std::wstring FilePath;
 	bool bSM6;
+	MEMORY_TRACKED_BYTES(SHADER_BLOBS, TrackedBytes);
 };
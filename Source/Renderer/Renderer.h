@@ -37,6 +37,7 @@
 
 #include "Engine/Core/Types.h"
 #include "Engine/Core/Platform.h"
+#include "Engine/Core/FlatHashMap.h"
 #include "Engine/Settings.h"
 
 #define VQUTILS_SYSTEMINFO_INCLUDE_D3D12 1
@@ -90,6 +91,9 @@ struct FRenderStats
 	uint   NumLitMeshDrawCommands = 0;
 	uint   NumShadowMeshDrawCommands = 0;
 	uint   NumBoundingBoxDrawCommands = 0;
+	uint   NumMeshlets = 0;
+	uint   NumCulledMeshlets = 0;
+	uint   NumCulledMeshletTriangles = 0;
 	inline void Reset() { *this = FRenderStats(); }
 };
 struct FCommandRecordingThreadConfig
@@ -208,6 +212,8 @@ public:
 
 	void                         DestroyTexture(TextureID& texID);
 	void                         DestroySRV(SRV_ID srvID);
+	void                         DestroySRVs(const std::vector<SRV_ID>& srvIDs); // single lock for the whole batch
+	void                         DestroyVertexAndIndexBuffers(const std::vector<BufferID>& VBIDs, const std::vector<BufferID>& IBIDs);
 	void                         DestroyDSV(DSV_ID dsvID);
 
 	const VBV&                   GetVertexBufferView(BufferID Id) const;
@@ -372,20 +378,18 @@ private:
 	mutable std::mutex     mMtxStaticIBHeap;
 	
 	// resources & views
-	std::unordered_map<SamplerID, SAMPLER>    mSamplers;
-	std::unordered_map<BufferID, VBV>         mVBVs;
-	std::unordered_map<BufferID, IBV>         mIBVs;
-	std::unordered_map<CBV_ID  , CBV_SRV_UAV> mCBVs;
-	std::unordered_map<SRV_ID  , CBV_SRV_UAV> mSRVs;
-	std::unordered_map<UAV_ID  , CBV_SRV_UAV> mUAVs;
-	std::unordered_map<RTV_ID  , RTV>         mRTVs;
-	std::unordered_map<DSV_ID  , DSV>         mDSVs;
-	mutable std::mutex                        mMtxDynamicCBHeap;
-	mutable std::mutex                        mMtxSRVs_CBVs_UAVs; // TODO: separate mutexes for SRV/CBV/UAV
-	mutable std::mutex                        mMtxRTVs;
-	mutable std::mutex                        mMtxDSVs;
-	mutable std::mutex                        mMtxVBVs;
-	mutable std::mutex                        mMtxIBVs;
+	std::unordered_map<SamplerID, SAMPLER>        mSamplers;
+	ConcurrentFlatHashMap<BufferID, VBV>          mVBVs; // read every draw, written by the mesh loader threads
+	ConcurrentFlatHashMap<BufferID, IBV>          mIBVs; // read every draw, written by the mesh loader threads
+	FlatHashMap<CBV_ID  , CBV_SRV_UAV>            mCBVs;
+	ConcurrentFlatHashMap<SRV_ID  , CBV_SRV_UAV>  mSRVs; // read every draw, written by the texture loader threads
+	FlatHashMap<UAV_ID  , CBV_SRV_UAV>            mUAVs;
+	FlatHashMap<RTV_ID  , RTV>                    mRTVs;
+	FlatHashMap<DSV_ID  , DSV>                    mDSVs;
+	mutable std::mutex                            mMtxDynamicCBHeap;
+	mutable std::mutex                            mMtxSRVs_CBVs_UAVs; // TODO: separate mutexes for SRV/CBV/UAV
+	mutable std::mutex                            mMtxRTVs;
+	mutable std::mutex                            mMtxDSVs;
 	TextureManager                            mTextureManager;
 
 	// PSOs & Root Signatures
@@ -26,7 +26,10 @@
 using namespace DirectX;
 using namespace VQ_SHADER_DATA;
 
+static const Material FALLBACK_MATERIAL = Material(); // drawn w/ the default parameters if a material ID went stale
+
 #define ENABLE_WORKER_THREADS 1
+#define ENABLE_MESHLET_CULLING 1
 
 struct FDrawCallInputDataRange
 {
@@ -137,6 +140,7 @@ static void BatchShadowViewDrawCalls(
 				draw.IB = drawData.VBIB.second;
 				draw.numIndices = drawData.NumIndices;
 				draw.numInstances = r.Stride;
+				draw.iVertexFormat = drawData.iVertexFormat;
 
 				++iDraw;
 			}
@@ -151,9 +155,11 @@ static void BatchShadowViewDrawCalls(
 
 				draw.IATopology = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
 
-				assert(ViewVisibleMeshes.pMaterialPool);
-				const Material& mat = *ViewVisibleMeshes.pMaterialPool->Get(ViewVisibleMeshes.MaterialID[iMesh]);
-				pPerObj[iDraw]->texScaleBias = float4(mat.tiling.x, mat.tiling.y, mat.uv_bias.x, mat.uv_bias.y);
+				assert(ViewVisibleMeshes.pMaterials);
+				const Material* pMat = ViewVisibleMeshes.pMaterials->Get(ViewVisibleMeshes.MaterialID[iMesh]);
+				assert(pMat); // validated by the culling, see FFrustumCullWorkerContext::SortMeshData()
+				const Material& mat = pMat ? *pMat : FALLBACK_MATERIAL;
+				pPerObj[iDraw]->texScaleBias = Mesh::ComposeUVScaleBias(ViewVisibleMeshes.PerDrawData[iMesh].UVScaleBias, mat.tiling, mat.uv_bias);
 				pPerObj[iDraw]->displacement = mat.displacement;
 				draw.SRVMaterialMaps = mat.SRVMaterialMaps;
 				draw.SRVHeightMap = mat.SRVHeightMap;
@@ -198,13 +204,64 @@ static void BatchShadowViewDrawCalls(
 	}
 }
 
+#if ENABLE_MESHLET_CULLING
+// Replaces the draws of the meshes with meshlets with the index ranges of their visible meshlets.
+// Instanced draws are kept as-is as the meshlet visibility differs per instance, so are the
+// tessellated draws which have their own patch culling.
+static void CullMainViewMeshlets(
+	std::vector<FInstancedDrawParameters>& drawParams,
+	const std::vector<FDrawCallInputDataRange>& drawCallRanges,
+	const FVisibleMeshDataSoA& ViewVisibleMeshes,
+	const XMMATRIX viewProj,
+	const XMVECTOR vCameraPosition,
+	FMeshletCullStats& Stats
+)
+{
+	SCOPED_CPU_MARKER("CullMeshlets");
+	constexpr size_t MAX_DRAWS_PER_MESH = 8; // the visible meshlet ranges are merged beyond this
+
+	bool bAnyMeshlets = false;
+	for (const FDrawCallInputDataRange& r : drawCallRanges)
+		bAnyMeshlets = bAnyMeshlets || (r.Stride == 1 && ViewVisibleMeshes.PerDrawData[r.iStart].NumMeshlets > 0);
+	if (!bAnyMeshlets)
+		return;
+
+	std::vector<FInstancedDrawParameters> culledDrawParams;
+	culledDrawParams.reserve(drawParams.size());
+	std::vector<FIndexRange> ranges;
+	for (size_t iDraw = 0; iDraw < drawCallRanges.size(); ++iDraw)
+	{
+		const FDrawCallInputDataRange& r = drawCallRanges[iDraw];
+		const FPerDrawData& drawData = ViewVisibleMeshes.PerDrawData[r.iStart];
+		const FInstancedDrawParameters& draw = drawParams[iDraw];
+		if (r.Stride != 1 || drawData.NumMeshlets == 0 || draw.PackedTessellationConfig != 0)
+		{
+			culledDrawParams.push_back(draw);
+			continue;
+		}
+
+		ranges.clear();
+		CullMeshlets(drawData.pMeshlets, drawData.NumMeshlets, ViewVisibleMeshes.Transform[r.iStart].matWorldTransformation(), viewProj, vCameraPosition, MAX_DRAWS_PER_MESH, ranges, &Stats);
+		for (const FIndexRange& range : ranges) // no ranges: the mesh is culled entirely
+		{
+			FInstancedDrawParameters& culledDraw = culledDrawParams.emplace_back(draw);
+			culledDraw.startIndex = range.IndexOffset;
+			culledDraw.numIndices = range.NumIndices;
+		}
+	}
+	drawParams = std::move(culledDrawParams);
+}
+#endif
+
 static void BatchMainViewDrawCalls(
 	std::vector<FInstancedDrawParameters>& drawParams,
 	const FVisibleMeshDataSoA& ViewVisibleMeshes,
 	const XMMATRIX viewProj,     // take in copy for less cache thrashing
 	const XMMATRIX viewProjPrev, // take in copy for less cache thrashing
+	const XMVECTOR vCameraPosition,
 	DynamicBufferHeap& CBHeap,
-	const VQRenderer* pRenderer
+	const VQRenderer* pRenderer,
+	FMeshletCullStats& MeshletCullStats
 )
 {
 	SCOPED_CPU_MARKER_C("BatchMainViewDrawCalls", 0xFF00AA00);
@@ -314,7 +371,9 @@ static void BatchMainViewDrawCalls(
 				draw.VB = drawData.VBIB.first;
 				draw.IB = drawData.VBIB.second;
 				draw.numIndices = drawData.NumIndices;
+				draw.startIndex = 0;
 				draw.numInstances = r.Stride;
+				draw.iVertexFormat = drawData.iVertexFormat;
 
 				++iDraw;
 			}
@@ -329,9 +388,12 @@ static void BatchMainViewDrawCalls(
 
 				draw.IATopology = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
 				
-				assert(ViewVisibleMeshes.pMaterialPool);
-				const Material& mat = *ViewVisibleMeshes.pMaterialPool->Get(ViewVisibleMeshes.MaterialID[iMesh]);
+				assert(ViewVisibleMeshes.pMaterials);
+				const Material* pMat = ViewVisibleMeshes.pMaterials->Get(ViewVisibleMeshes.MaterialID[iMesh]);
+				assert(pMat); // validated by the culling, see FFrustumCullWorkerContext::SortMeshData()
+				const Material& mat = pMat ? *pMat : FALLBACK_MATERIAL;
 				mat.GetCBufferData(pPerObj[iDraw]->materialData);
+				pPerObj[iDraw]->materialData.uvScaleOffset = Mesh::ComposeUVScaleBias(ViewVisibleMeshes.PerDrawData[iMesh].UVScaleBias, mat.tiling, mat.uv_bias);
 				draw.SRVMaterialMaps = mat.SRVMaterialMaps;
 				draw.SRVHeightMap = mat.SRVHeightMap;
 
@@ -373,6 +435,10 @@ static void BatchMainViewDrawCalls(
 			}
 		}
 	}
+
+#if ENABLE_MESHLET_CULLING
+	CullMainViewMeshlets(drawParams, drawCallRanges, ViewVisibleMeshes, viewProj, vCameraPosition, MeshletCullStats);
+#endif
 }
 
 static DynamicBufferHeap& GetThreadConstantBufferHeap(
@@ -689,14 +755,21 @@ void VQRenderer::BatchDrawCalls(
 		MainViewFrustumRenderList.DataReadySignal.Wait();
 		// -------------------------------------------------- SYNC ---------------------------------------------------
 
+		FMeshletCullStats MeshletCullStats;
 		BatchMainViewDrawCalls(
 			DrawData.mainViewDrawParams,
 			MainViewFrustumRenderList.Data,
 			SceneView.viewProj,
 			SceneView.viewProjPrev,
+			SceneView.cameraPosition,
 			CBHeap, 
-			this
+			this,
+			MeshletCullStats
 		);
+		DrawData.numMainViewMeshlets = MeshletCullStats.NumMeshlets;
+		DrawData.numMainViewCulledMeshlets = MeshletCullStats.NumFrustumCulled + MeshletCullStats.NumBackfaceCulled;
+		DrawData.numMainViewMeshletIndices = MeshletCullStats.NumIndices;
+		DrawData.numMainViewCulledMeshletIndices = MeshletCullStats.NumIndices - MeshletCullStats.NumVisibleIndices;
 		MainViewFrustumRenderList.BatchDoneSignal.Notify();
 	});
 
@@ -129,6 +129,10 @@ struct FInstancedDrawParameters
 	// draw params
 	uint numInstances = 0;
 	uint numIndices = 0;
+	uint startIndex = 0; // != 0 for the index ranges of the visible meshlets
+
+	// PSO-mesh configs
+	uint8 iVertexFormat = 0; // GetVertexFormatOption()
 
 	// PSO-material configs
 	//   Tessellation Config
@@ -202,5 +206,11 @@ struct FSceneDrawData
 	std::vector<FOutlineRenderData> outlineRenderParams;
 	std::vector<MeshRenderData_t> debugVertexAxesRenderParams;
 	std::vector<BoundingBoxRenderData_t> boundingBoxRenderParams;
+
+	// meshlet culling of the main view, see CullMeshlets()
+	uint numMainViewMeshlets = 0;
+	uint numMainViewCulledMeshlets = 0;
+	uint numMainViewMeshletIndices = 0;
+	uint numMainViewCulledMeshletIndices = 0;
 };
 
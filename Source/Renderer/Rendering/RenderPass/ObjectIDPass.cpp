@@ -127,22 +127,26 @@ static size_t GetPSO_Key(
 	size_t iPart,
 	size_t iOutTopo,
 	size_t iTessCullMode,
-	size_t iAlpha)
+	size_t iAlpha,
+	size_t iVertexFormat)
 {
 	using namespace Tessellation;
+	constexpr size_t NUM_ALPHA_OPTIONS = 2;
 	return iTess
 		+ NUM_TESS_ENABLED * iDomain
 		+ NUM_TESS_ENABLED * NUM_DOMAIN_OPTIONS * iPart
 		+ NUM_TESS_ENABLED * NUM_DOMAIN_OPTIONS * NUM_PARTIT_OPTIONS * iOutTopo
 		+ NUM_TESS_ENABLED * NUM_DOMAIN_OPTIONS * NUM_PARTIT_OPTIONS * NUM_OUTTOP_OPTIONS * iTessCullMode
-		+ NUM_TESS_ENABLED * NUM_DOMAIN_OPTIONS * NUM_PARTIT_OPTIONS * NUM_OUTTOP_OPTIONS * NUM_TESS_CULL_OPTIONS * iAlpha;
+		+ NUM_TESS_ENABLED * NUM_DOMAIN_OPTIONS * NUM_PARTIT_OPTIONS * NUM_OUTTOP_OPTIONS * NUM_TESS_CULL_OPTIONS * iAlpha
+		+ NUM_TESS_ENABLED * NUM_DOMAIN_OPTIONS * NUM_PARTIT_OPTIONS * NUM_OUTTOP_OPTIONS * NUM_TESS_CULL_OPTIONS * NUM_ALPHA_OPTIONS * iVertexFormat;
 }
-static size_t GetPSO_Key(const Material& mat, const VQRenderer& mRenderer)
+static size_t GetPSO_Key(const Material& mat, const Mesh& mesh, const VQRenderer& mRenderer)
 {
 	uint8 iTess = 0; uint8 iDomain = 0; uint8 iPart = 0; uint8 iOutTopo = 0; uint8 iTessCull = 0;
 	mat.GetTessellationPSOConfig(iTess, iDomain, iPart, iOutTopo, iTessCull);
 	const size_t iAlpha = mat.IsAlphaMasked(mRenderer) ? 1 : 0;
-	return GetPSO_Key(iTess, iDomain, iPart, iOutTopo, iTessCull, iAlpha);
+	const size_t iVertexFormat = GetVertexFormatOption(mesh.GetVertexFormat());
+	return GetPSO_Key(iTess, iDomain, iPart, iOutTopo, iTessCull, iAlpha, iVertexFormat);
 }
 
 PSO_ID ObjectIDPass::GetPSO_ID(
@@ -151,9 +155,10 @@ PSO_ID ObjectIDPass::GetPSO_ID(
 	size_t iPart,
 	size_t iOutTopo,
 	size_t iTessCullMode,
-	size_t iAlpha) const
+	size_t iAlpha,
+	size_t iVertexFormat) const
 {
-	return mapPSO.at(GetPSO_Key(iTess, iDomain, iPart, iOutTopo, iTessCullMode, iAlpha));
+	return mapPSO.at(GetPSO_Key(iTess, iDomain, iPart, iOutTopo, iTessCullMode, iAlpha, iVertexFormat));
 }
 
 
@@ -217,7 +222,7 @@ void ObjectIDPass::RecordCommands(const IRenderPassDrawParameters* pDrawParamete
 		// select PSO
 		size_t iTess = 0; size_t iDomain = 0; size_t iPart = 0; size_t iOutTopo = 0; size_t iTessCull = 0;
 		meshRenderCmd.UnpackTessellationConfig(iTess, iDomain, iPart, iOutTopo, iTessCull);
-		const PSO_ID psoID = this->GetPSO_ID(iTess, iDomain, iPart, iOutTopo, iTessCull, iAlpha);
+		const PSO_ID psoID = this->GetPSO_ID(iTess, iDomain, iPart, iOutTopo, iTessCull, iAlpha, meshRenderCmd.iVertexFormat);
 		if (psoPrev != psoID)
 		{
 			pCmd->SetPipelineState(mRenderer.GetPSO(psoID));
@@ -257,7 +262,7 @@ void ObjectIDPass::RecordCommands(const IRenderPassDrawParameters* pDrawParamete
 		}
 
 		// draw
-		pCmd->DrawIndexedInstanced(meshRenderCmd.numIndices, meshRenderCmd.numInstances, 0, 0, 0);
+		pCmd->DrawIndexedInstanced(meshRenderCmd.numIndices, meshRenderCmd.numInstances, meshRenderCmd.startIndex, 0, 0);
 
 		ibPrev = meshRenderCmd.IB;
 		vbPrev = meshRenderCmd.VB;
@@ -308,10 +313,11 @@ std::vector<FPSOCreationTaskParameters> ObjectIDPass::CollectPSOCreationParamete
 	for(size_t iOutTopo = 0 ; iOutTopo  < NUM_OUTTOP_OPTIONS; ++iOutTopo) 
 	for(size_t iTessCull = 0; iTessCull < NUM_TESS_CULL_OPTIONS; ++iTessCull)
 	for(size_t iAlpha = 0   ; iAlpha    < NUM_ALPHA_OPTIONS ; ++iAlpha)
+	for(size_t iVertexFormat = 0; iVertexFormat < NUM_VERTEX_FORMAT_OPTIONS; ++iVertexFormat)
 	{
 		if (ShouldSkipTessellationVariant(iTess, iDomain, iPart, iOutTopo, iTessCull))
 			continue;
-		const size_t key = GetPSO_Key(iTess, iDomain, iPart, iOutTopo, iTessCull, iAlpha);
+		const size_t key = GetPSO_Key(iTess, iDomain, iPart, iOutTopo, iTessCull, iAlpha, iVertexFormat);
 		mapPSO[key] = INVALID_ID;
 	}
 	
@@ -323,11 +329,12 @@ std::vector<FPSOCreationTaskParameters> ObjectIDPass::CollectPSOCreationParamete
 	for(size_t iOutTopo = 0 ; iOutTopo  < NUM_OUTTOP_OPTIONS; ++iOutTopo) 
 	for(size_t iTessCull = 0; iTessCull < NUM_TESS_CULL_OPTIONS; ++iTessCull)
 	for(size_t iAlpha = 0   ; iAlpha    < NUM_ALPHA_OPTIONS ; ++iAlpha)
+	for(size_t iVertexFormat = 0; iVertexFormat < NUM_VERTEX_FORMAT_OPTIONS; ++iVertexFormat)
 	{
 		if (ShouldSkipTessellationVariant(iTess, iDomain, iPart, iOutTopo, iTessCull))
 			continue;
 
-		const size_t key = GetPSO_Key(iTess, iDomain, iPart, iOutTopo, iTessCull, iAlpha);
+		const size_t key = GetPSO_Key(iTess, iDomain, iPart, iOutTopo, iTessCull, iAlpha, iVertexFormat);
 
 		// PSO name
 		std::string PSOName = "PSO_ObjectIDPass";
@@ -336,7 +343,9 @@ std::vector<FPSOCreationTaskParameters> ObjectIDPass::CollectPSOCreationParamete
 		{
 			AppendTessellationPSONameTokens(PSOName, iDomain, iPart, iOutTopo, iTessCull);
 		}
+		AppendVertexFormatPSONameTokens(PSOName, iVertexFormat);
 		psoLoadDesc.PSOName = PSOName;
+		psoLoadDesc.VertexFormat = GetVertexFormatOptionType(iVertexFormat);
 
 		// topology
 		psoDesc.PrimitiveTopologyType = iTess == 1
@@ -377,6 +386,7 @@ std::vector<FPSOCreationTaskParameters> ObjectIDPass::CollectPSOCreationParamete
 			if (iTessCull > 0)
 				AppendTessellationGSMacros(psoLoadDesc.ShaderStageCompileDescs[3/*GS*/].Macros, iOutTopo, iTessCull);
 		}
+		AppendVertexFormatVSMacros(psoLoadDesc.ShaderStageCompileDescs[0/*VS*/].Macros, iVertexFormat);
 		for (FShaderStageCompileDesc& shdDesc : psoLoadDesc.ShaderStageCompileDescs)
 		{
 			shdDesc.Macros.push_back(InstancedDrawMacro);
@@ -20,7 +20,7 @@
 #include "Shaders/VQPlatform.h"
 #include "RenderPass.h"
 
-#include <unordered_map>
+#include "Engine/Core/FlatHashMap.h"
 
 struct FSceneView;
 struct FSceneDrawData;
@@ -57,13 +57,13 @@ public:
 	inline int4 ReadBackPixel(int screenCoordsX, int screenCoordsY, HWND hwnd) const { return ReadBackPixel(int2(screenCoordsX, screenCoordsY), hwnd); }
 	inline int4 ReadBackPixel(float2 uv, HWND hwnd) const { return ReadBackPixel((int)(uv.x * mOutputResolutionX), (int)(uv.y * mOutputResolutionY), hwnd); }
 
-	PSO_ID GetPSO_ID(size_t iTess,size_t iDomain,size_t iPart,size_t iOutTopo,size_t iTessCullMode,size_t iAlpha) const;
+	PSO_ID GetPSO_ID(size_t iTess,size_t iDomain,size_t iPart,size_t iOutTopo,size_t iTessCullMode,size_t iAlpha,size_t iVertexFormat) const;
 
 	ID3D12Resource* GetGPUTextureResource() const;
 	ID3D12Resource* GetCPUTextureResource() const;
 
 private:
-	std::unordered_map<size_t, PSO_ID> mapPSO;
+	FlatHashMap<size_t, PSO_ID> mapPSO;
 
 	int mOutputResolutionX = 0;
 	int mOutputResolutionY = 0;
@@ -161,7 +161,8 @@ void OutlinePass::RecordCommands(const IRenderPassDrawParameters* pDrawParameter
 				iPart,
 				iOutTopo,
 				iTessCull,
-				iAlpha
+				iAlpha,
+				GetVertexFormatOption(cmd.pMesh->GetVertexFormat())
 			);
 			const PSO_ID psoID = mapPSO.at(key);
 			ID3D12PipelineState* pPSO = mRenderer.GetPSO(psoID);
@@ -232,7 +233,7 @@ void OutlinePass::RecordCommands(const IRenderPassDrawParameters* pDrawParameter
 	}
 }
 
-size_t OutlinePass::Hash(size_t iPass, size_t iMSAA, size_t iTess, size_t iDomain, size_t iPart, size_t iOutTopo, size_t iTessCullMode, size_t iAlpha)
+size_t OutlinePass::Hash(size_t iPass, size_t iMSAA, size_t iTess, size_t iDomain, size_t iPart, size_t iOutTopo, size_t iTessCullMode, size_t iAlpha, size_t iVertexFormat)
 {
 	return iPass
 		+ NUM_PASS_OPTIONS * iMSAA
@@ -241,7 +242,8 @@ size_t OutlinePass::Hash(size_t iPass, size_t iMSAA, size_t iTess, size_t iDomai
 		+ NUM_PASS_OPTIONS * NUM_MSAA_OPTIONS * NUM_TESS_ENABLED * NUM_DOMAIN_OPTIONS * iPart
 		+ NUM_PASS_OPTIONS * NUM_MSAA_OPTIONS * NUM_TESS_ENABLED * NUM_DOMAIN_OPTIONS * NUM_PARTIT_OPTIONS * iOutTopo
 		+ NUM_PASS_OPTIONS * NUM_MSAA_OPTIONS * NUM_TESS_ENABLED * NUM_DOMAIN_OPTIONS * NUM_PARTIT_OPTIONS * NUM_OUTTOP_OPTIONS * iTessCullMode
-		+ NUM_PASS_OPTIONS * NUM_MSAA_OPTIONS * NUM_TESS_ENABLED * NUM_DOMAIN_OPTIONS * NUM_PARTIT_OPTIONS * NUM_OUTTOP_OPTIONS * NUM_TESS_CULL_OPTIONS * iAlpha;
+		+ NUM_PASS_OPTIONS * NUM_MSAA_OPTIONS * NUM_TESS_ENABLED * NUM_DOMAIN_OPTIONS * NUM_PARTIT_OPTIONS * NUM_OUTTOP_OPTIONS * NUM_TESS_CULL_OPTIONS * iAlpha
+		+ NUM_PASS_OPTIONS * NUM_MSAA_OPTIONS * NUM_TESS_ENABLED * NUM_DOMAIN_OPTIONS * NUM_PARTIT_OPTIONS * NUM_OUTTOP_OPTIONS * NUM_TESS_CULL_OPTIONS * NUM_ALPHA_OPTIONS * iVertexFormat;
 }
 
 std::vector<FPSOCreationTaskParameters> OutlinePass::CollectPSOCreationParameters()
@@ -276,11 +278,12 @@ std::vector<FPSOCreationTaskParameters> OutlinePass::CollectPSOCreationParameter
 	for(size_t iOutTopo = 0 ; iOutTopo  < NUM_OUTTOP_OPTIONS; ++iOutTopo) 
 	for(size_t iTessCull = 0; iTessCull < NUM_TESS_CULL_OPTIONS; ++iTessCull)
 	for(size_t iAlpha = 0   ; iAlpha    < NUM_ALPHA_OPTIONS ; ++iAlpha)
+	for(size_t iVertexFormat = 0; iVertexFormat < NUM_MESH_OPTIONS; ++iVertexFormat)
 	{
 		if (ShouldSkipTessellationVariant(iTess, iDomain, iPart, iOutTopo, iTessCull))
 			continue;
 
-		const size_t key = Hash(iPass, iMSAA, iTess, iDomain, iPart, iOutTopo, iTessCull, iAlpha);
+		const size_t key = Hash(iPass, iMSAA, iTess, iDomain, iPart, iOutTopo, iTessCull, iAlpha, iVertexFormat);
 		this->mapPSO[key] = INVALID_ID;
 	}
 
@@ -293,11 +296,12 @@ std::vector<FPSOCreationTaskParameters> OutlinePass::CollectPSOCreationParameter
 	for(size_t iOutTopo = 0 ; iOutTopo  < NUM_OUTTOP_OPTIONS; ++iOutTopo) 
 	for(size_t iTessCull = 0; iTessCull < NUM_TESS_CULL_OPTIONS; ++iTessCull)
 	for(size_t iAlpha = 0   ; iAlpha    < NUM_ALPHA_OPTIONS ; ++iAlpha)
+	for(size_t iVertexFormat = 0; iVertexFormat < NUM_MESH_OPTIONS; ++iVertexFormat)
 	{
 		if (ShouldSkipTessellationVariant(iTess, iDomain, iPart, iOutTopo, iTessCull))
 			continue;
 
-		const size_t key = Hash(iPass, iMSAA, iTess, iDomain, iPart, iOutTopo, iTessCull, iAlpha);
+		const size_t key = Hash(iPass, iMSAA, iTess, iDomain, iPart, iOutTopo, iTessCull, iAlpha, iVertexFormat);
 
 		// PSO name
 		std::string PSOName = pszPSONameBases[iPass];
@@ -307,7 +311,9 @@ std::vector<FPSOCreationTaskParameters> OutlinePass::CollectPSOCreationParameter
 		{
 			AppendTessellationPSONameTokens(PSOName, iDomain, iPart, iOutTopo, iTessCull);
 		}
+		AppendVertexFormatPSONameTokens(PSOName, iVertexFormat);
 		psoLoadDesc.PSOName = PSOName;
+		psoLoadDesc.VertexFormat = GetVertexFormatOptionType(iVertexFormat);
 
 		// MSAA
 		psoDesc.SampleDesc.Count = MSAA_SAMPLE_COUNTS[iMSAA];
@@ -385,6 +391,7 @@ std::vector<FPSOCreationTaskParameters> OutlinePass::CollectPSOCreationParameter
 				AppendTessellationGSMacros(psoLoadDesc.ShaderStageCompileDescs[3/*GS*/].Macros, iOutTopo, iTessCull);
 			}
 		}
+		AppendVertexFormatVSMacros(psoLoadDesc.ShaderStageCompileDescs[0/*VS*/].Macros, iVertexFormat);
 		
 		// macros: all stages
 		const FShaderMacro InstancedDrawMacro = FShaderMacro::CreateShaderMacro("INSTANCED_DRAW", "%d", RENDER_INSTANCED_SCENE_MESHES);
@@ -18,7 +18,7 @@
 #pragma once
 
 #include "RenderPass.h"
-#include <unordered_map>
+#include "Engine/Core/FlatHashMap.h"
 
 struct FSceneView;
 struct FSceneDrawData;
@@ -67,8 +67,9 @@ private:
 	static constexpr size_t NUM_ALPHA_OPTIONS = 2; // opaque/alpha masked
 	static constexpr size_t NUM_MAT_OPTIONS = NUM_ALPHA_OPTIONS;
 	static constexpr size_t NUM_PASS_OPTIONS = 2; // 0:stencil/1:mask
-	static constexpr size_t NUM_OPTIONS_PERMUTATIONS = NUM_PASS_OPTIONS * NUM_MAT_OPTIONS * NUM_RENDERING_OPTIONS * Tessellation::NUM_TESS_OPTIONS;
-	static size_t Hash(size_t iPass, size_t iMSAA, size_t iTess, size_t iDomain, size_t iPart, size_t iOutTopo, size_t iTessCullMode, size_t iAlpha);
+	static constexpr size_t NUM_MESH_OPTIONS = NUM_VERTEX_FORMAT_OPTIONS;
+	static constexpr size_t NUM_OPTIONS_PERMUTATIONS = NUM_PASS_OPTIONS * NUM_MAT_OPTIONS * NUM_RENDERING_OPTIONS * Tessellation::NUM_TESS_OPTIONS * NUM_MESH_OPTIONS;
+	static size_t Hash(size_t iPass, size_t iMSAA, size_t iTess, size_t iDomain, size_t iPart, size_t iOutTopo, size_t iTessCullMode, size_t iAlpha, size_t iVertexFormat);
 
-	std::unordered_map<size_t, PSO_ID>   mapPSO;
+	FlatHashMap<size_t, PSO_ID>          mapPSO;
 };
@@ -338,6 +338,9 @@ HRESULT VQRenderer::RenderScene(ThreadPool& WorkerThreads, const Window* pWindow
 	for (auto& vParams : SceneDrawData.spotShadowDrawParams ) mRenderStats.NumShadowMeshDrawCommands += (uint)vParams.size();
 	for (auto& vParams : SceneDrawData.pointShadowDrawParams) mRenderStats.NumShadowMeshDrawCommands += (uint)vParams.size();
 	mRenderStats.NumShadowMeshDrawCommands += (uint)SceneDrawData.directionalShadowDrawParams.size();
+	mRenderStats.NumMeshlets = SceneDrawData.numMainViewMeshlets;
+	mRenderStats.NumCulledMeshlets = SceneDrawData.numMainViewCulledMeshlets;
+	mRenderStats.NumCulledMeshletTriangles = SceneDrawData.numMainViewCulledMeshletIndices / 3;
 	mRenderStats.NumDispatches = 0;
 	mRenderStats.NumDraws = 0;
 
@@ -1010,7 +1013,7 @@ void VQRenderer::DrawShadowViewMeshList(ID3D12GraphicsCommandList* pCmd, const s
 		size_t iTess = 0; size_t iDomain = 0; size_t iPart = 0; size_t iOutTopo = 0; size_t iTessCull = 0;
 		draw.UnpackTessellationConfig(iTess, iDomain, iPart, iOutTopo, iTessCull);
 
-		const PSO_ID psoID = this->mShadowPassPSOs.Get(iDepthMode, iRaster, iFaceCull, iTess, iDomain, iPart, iOutTopo, iTessCull, iAlpha);
+		const PSO_ID psoID = this->mShadowPassPSOs.Get(iDepthMode, iRaster, iFaceCull, iTess, iDomain, iPart, iOutTopo, iTessCull, iAlpha, draw.iVertexFormat);
 		pCmd->SetPipelineState(this->GetPSO(psoID));
 
 		// set constant buffer data
@@ -1036,7 +1039,7 @@ void VQRenderer::DrawShadowViewMeshList(ID3D12GraphicsCommandList* pCmd, const s
 		pCmd->IASetVertexBuffers(0, 1, &vb);
 		pCmd->IASetIndexBuffer(&ib);
 
-		pCmd->DrawIndexedInstanced(draw.numIndices, draw.numInstances, 0, 0, 0);
+		pCmd->DrawIndexedInstanced(draw.numIndices, draw.numInstances, draw.startIndex, 0, 0);
 	}
 
 #else 
@@ -1057,7 +1060,7 @@ void VQRenderer::DrawShadowViewMeshList(ID3D12GraphicsCommandList* pCmd, const s
 		pCBuffer->matWorld = renderCmd.matWorldTransformation;
 		pCmd->SetGraphicsRootConstantBufferView(0, cbAddr);
 
-		const Mesh& mesh = mpScene->mMeshes.at(renderCmd.meshID);
+		const Mesh& mesh = *mpScene->mMeshes.Get(renderCmd.meshID);
 		DrawMesh(pCmd, mesh);
 	}
 #endif
@@ -1321,7 +1324,7 @@ void VQRenderer::RenderDepthPrePass(
 		size_t iTess = 0; size_t iDomain = 0; size_t iPart = 0; size_t iOutTopo = 0; size_t iTessCull = 0;
 		meshRenderCmd.UnpackTessellationConfig(iTess, iDomain, iPart, iOutTopo, iTessCull);
 
-		const PSO_ID psoID = this->mZPrePassPSOs.Get(iMSAA, iRaster, iFaceCull, iTess, iDomain, iPart, iOutTopo, iTessCull, iAlpha);
+		const PSO_ID psoID = this->mZPrePassPSOs.Get(iMSAA, iRaster, iFaceCull, iTess, iDomain, iPart, iOutTopo, iTessCull, iAlpha, meshRenderCmd.iVertexFormat);
 
 		if (psoIDPrev != psoID)
 		{
@@ -1353,7 +1356,7 @@ void VQRenderer::RenderDepthPrePass(
 			pCmd->IASetIndexBuffer(&ib);
 		}
 
-		pCmd->DrawIndexedInstanced(meshRenderCmd.numIndices, meshRenderCmd.numInstances, 0, 0, 0);
+		pCmd->DrawIndexedInstanced(meshRenderCmd.numIndices, meshRenderCmd.numInstances, meshRenderCmd.startIndex, 0, 0);
 
 		psoIDPrev = psoID;
 		ibPrev = meshRenderCmd.IB;
@@ -1734,7 +1737,7 @@ void VQRenderer::RenderSceneColor(
 			size_t iTess = 0; size_t iDomain = 0; size_t iPart = 0; size_t iOutTopo = 0; size_t iTessCull = 0;
 			meshRenderCmd.UnpackTessellationConfig(iTess, iDomain, iPart, iOutTopo, iTessCull);
 
-			PSO_ID psoID = this->mLightingPSOs.Get(iMSAA, iRaster, iFaceCull, iOutMoVec, iOutRough, iTess, iDomain, iPart, iOutTopo, iTessCull, iAlpha);
+			PSO_ID psoID = this->mLightingPSOs.Get(iMSAA, iRaster, iFaceCull, iOutMoVec, iOutRough, iTess, iDomain, iPart, iOutTopo, iTessCull, iAlpha, meshRenderCmd.iVertexFormat);
 			ID3D12PipelineState* pPipelineState = this->GetPSO(psoID);
 			
 			if(psoID_Prev != psoID) // TODO: profile PSO
@@ -1775,7 +1778,7 @@ void VQRenderer::RenderSceneColor(
 				pCmd->IASetIndexBuffer(&ib);
 			}
 
-			pCmd->DrawIndexedInstanced(meshRenderCmd.numIndices, meshRenderCmd.numInstances, 0, 0, 0);
+			pCmd->DrawIndexedInstanced(meshRenderCmd.numIndices, meshRenderCmd.numInstances, meshRenderCmd.startIndex, 0, 0);
 
 			psoID_Prev = psoID;
 			ibPrev = meshRenderCmd.IB;
@@ -141,37 +141,33 @@ struct FVertexWithNormalAndTangentPacked2 // 24B
     uint16   uv      [2]; // rg16      4B
 };
 
-static void AssertUnitLength(float x, float y, float z) { assert(sqrt(x*x + y*y + z*z) == 1.0f); }
+static void AssertUnitLength(float x, float y, float z) { assert(fabs(sqrt(x*x + y*y + z*z) - 1.0f) < 1e-3f); }
 static void AssertUnitLength(float v[3]) { AssertUnitLength(v[0], v[1], v[2]); }
-static uint PackRGB10A2(float x, float y, float z)
+static uint PackRGB10A2(float x, float y, float z) // [-1, 1] --> DXGI_FORMAT_R10G10B10A2_UNORM, decode: v * 2 - 1
 {
     AssertUnitLength(x,y,z);
-    const uint i0 = static_cast<uint>(x * 1023.0f);
-    const uint i1 = static_cast<uint>(y * 1023.0f);
-    const uint i2 = static_cast<uint>(z * 1023.0f);
-    return (i0 << 22) | (i1 << 12) | (i2 << 2) | 3 /*11 for a*/;
+    const uint i0 = static_cast<uint>((x * 0.5f + 0.5f) * 1023.0f + 0.5f);
+    const uint i1 = static_cast<uint>((y * 0.5f + 0.5f) * 1023.0f + 0.5f);
+    const uint i2 = static_cast<uint>((z * 0.5f + 0.5f) * 1023.0f + 0.5f);
+    return i0 | (i1 << 10) | (i2 << 20) | (3u << 30) /*11 for a*/;
 }
 static uint PackRGB10A2(float v[3]) { return(PackRGB10A2(v[0], v[1], v[2])); }
-static const uint16 PackFP16(float f)
+static const uint16 PackFP16(float f) // [0, 1] --> UNORM16
 {
     assert(f >= 0.0f && f <= 1.0f);
-    return static_cast<uint16>(f * USHRT_MAX);
+    return static_cast<uint16>(f * USHRT_MAX + 0.5f);
 }
-static const void PackRGB16F(float v[3], uint16 vpacked[3])
+static const void PackRGB16F(const float v[3], uint16 vpacked[3]) // [-1, 1] --> UNORM16, decode: v * 2 - 1
 {
     assert(v[0] >= -1.0f && v[0] <= 1.0f);
     assert(v[1] >= -1.0f && v[1] <= 1.0f);
     assert(v[2] >= -1.0f && v[2] <= 1.0f);
-    AssertUnitLength(v);
+    AssertUnitLength(v[0], v[1], v[2]);
 
     // [-1,1] --> [0, 1]
-    v[0] = (v[0] + 1.0f) * 0.5f;
-    v[1] = (v[1] + 1.0f) * 0.5f;
-    v[2] = (v[2] + 1.0f) * 0.5f;
-
-    vpacked[0] = PackFP16(v[0]);
-    vpacked[1] = PackFP16(v[1]);
-    vpacked[2] = PackFP16(v[2]);
+    vpacked[0] = PackFP16((v[0] + 1.0f) * 0.5f);
+    vpacked[1] = PackFP16((v[1] + 1.0f) * 0.5f);
+    vpacked[2] = PackFP16((v[2] + 1.0f) * 0.5f);
 }
 static void PackUV16(float uv[2], uint16 uvpacked[2])
 {
@@ -206,6 +202,34 @@ template<class TVertex> static constexpr bool VertexHasPackedUVs()
     return std::is_same<TVertex, FVertexWithNormalAndTangentPacked2>()
         || std::is_same<TVertex, FVertexWithNormalAndTangentPacked1>();
 }
+template<class TVertex> static constexpr EVertexBufferType GetVertexBufferType()
+{
+         if constexpr (std::is_same<TVertex, FVertexWithColor>())                   return COLOR;
+    else if constexpr (std::is_same<TVertex, FVertexWithColorAndAlpha>())           return COLOR_AND_ALPHA;
+    else if constexpr (std::is_same<TVertex, FVertexWithNormal>())                  return NORMAL;
+    else if constexpr (std::is_same<TVertex, FVertexWithNormalAndTangent>())        return NORMAL_AND_TANGENT;
+    else if constexpr (std::is_same<TVertex, FVertexWithNormalAndTangentPacked1>()) return NORMAL_AND_TANGENT_PACKED1;
+    else if constexpr (std::is_same<TVertex, FVertexWithNormalAndTangentPacked2>()) return NORMAL_AND_TANGENT_PACKED2;
+    return DEFAULT;
+}
+
+// The scene mesh PSOs are permuted over the vertex formats below. Option 0 uses the input layout
+// reflected from the vertex shader, the packed options override it with their UNORM formats.
+constexpr size_t NUM_VERTEX_FORMAT_OPTIONS = 3; // full precision, packed1, packed2
+static size_t GetVertexFormatOption(EVertexBufferType Type)
+{
+    switch (Type)
+    {
+    case NORMAL_AND_TANGENT_PACKED1: return 1;
+    case NORMAL_AND_TANGENT_PACKED2: return 2;
+    default: return 0;
+    }
+}
+static EVertexBufferType GetVertexFormatOptionType(size_t iVertexFormat)
+{
+    constexpr EVertexBufferType Types[NUM_VERTEX_FORMAT_OPTIONS] = { NORMAL_AND_TANGENT, NORMAL_AND_TANGENT_PACKED1, NORMAL_AND_TANGENT_PACKED2 };
+    return Types[iVertexFormat];
+}
 //
 // STATIC BUFFER HEAP
 //
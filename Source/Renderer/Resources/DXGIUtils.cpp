@@ -21,6 +21,7 @@
 #include "DXGIUtils.h"
 
 #include "Engine/GPUMarker.h"
+#include "Engine/TextureCache.h"
 
 #include <algorithm>
 #include <cassert>
@@ -253,68 +254,10 @@ namespace VQ_DXGI_UTILS
 		assert(pDataSrc);
 
 		SCOPED_CPU_MARKER("MipImage");
-
-#define GetByte(color, component) (((color) >> (8 * (component))) & 0xff)
-#define GetColor(ptr, x,y) (ptr[(x)+(y)*width])
-#define SetColor(ptr, x,y, col) ptr[(x)+(y)*width/2]=col;
-
-		int offsetsX[] = { 0,1,0,1 };
-		int offsetsY[] = { 0,0,1,1 };
 		assert(bytesPerPixel == 4 || bytesPerPixel == 16);
-		
-		if (bytesPerPixel == 4)
-		{
-			const uint32_t* pImgSrc = (const uint32_t*)pDataSrc;
-			uint32_t* pImgDst = (uint32_t*)pDataDst;
-
-			for (uint32_t y = 0; y < height; y += 2)
-			{
-				for (uint32_t x = 0; x < width; x += 2)
-				{
-					uint32_t ccc = 0;
-					for (uint32_t c = 0; c < 4; c++)
-					{
-						uint32_t cc = 0;
-						cc += GetByte(GetColor(pImgSrc, x + offsetsX[0], y + offsetsY[0]), 3 - c);
-						cc += GetByte(GetColor(pImgSrc, x + offsetsX[1], y + offsetsY[1]), 3 - c);
-						cc += GetByte(GetColor(pImgSrc, x + offsetsX[2], y + offsetsY[2]), 3 - c);
-						cc += GetByte(GetColor(pImgSrc, x + offsetsX[3], y + offsetsY[3]), 3 - c);
-						ccc = (ccc << 8) | (cc / 4); // ABGR
-					}
-					SetColor(pImgDst, x / 2, y / 2, ccc);
-				}
-			}
-		}
 
-		if (bytesPerPixel == 16)
-		{
-			using std::min;
-			const float* pImgSrc = (const float*)pDataSrc;
-			      float* pImgDst = (      float*)pDataDst;
-			// each iteration handles 4 pixels from current level, writes out to a single pixel
-			for (uint32_t y = 0; y < height; y += 2) // [0, 2, 4, ...]
-			for (uint32_t x = 0; x < width ; x += 2) // [0, 2, 4, ...]
-			{
-				float rgb[4][3] = {}; // 4 samples of rgb
-				for (uint smp = 0; smp < 4; ++smp)
-				{
-					for (int ch = 0; ch < 3; ++ch) // color channel ~ rgba, care for RGB only
-						rgb[smp][ch] = pImgSrc[(x + offsetsX[smp]) * 4 + (y + offsetsY[smp]) * 4 * width + ch];
-				}
-
-				// filter: use min filter rather than interpolation
-				float rgbFiltered[4];
-				for (int ch = 0; ch < 3; ++ch)
-					rgbFiltered[ch] = min(rgb[0][ch], min(rgb[1][ch], min(rgb[2][ch], rgb[3][ch])));
-				rgbFiltered[3] = 1.0f;
-
-				uint outX = x >> 1;
-				uint outY = y >> 1;
-
-				for (int ch = 0; ch < 4; ++ch)
-					pImgDst[(outX * 4) + 4 * outY * (width >> 1) + ch] = rgbFiltered[ch];
-			}
-		}
+		// shared w/ the offline texture cooker so that the cooked & the runtime mip chains match
+		TextureCache::DownsampleMip(pDataSrc, pDataDst, width, height, bytesPerPixel);
 
 #if 0
 		// For cutouts we need we need to scale the alpha channel to match the coverage of the top MIP map
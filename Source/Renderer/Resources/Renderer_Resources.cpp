@@ -197,7 +197,7 @@ BufferID VQRenderer::CreateVertexBuffer(const FBufferDesc& desc)
 	if (bSuccess)
 	{
 		Id = LAST_USED_VBV_ID++;
-		mVBVs[Id] = vbv;
+		mVBVs.Insert(Id, vbv);
 	}
 	else
 		Log::Error("VQRenderer: Couldn't allocate vertex buffer");
@@ -214,7 +214,7 @@ BufferID VQRenderer::CreateIndexBuffer(const FBufferDesc& desc)
 	if (bSuccess)
 	{
 		Id = LAST_USED_IBV_ID++;
-		mIBVs[Id] = ibv;
+		mIBVs.Insert(Id, ibv);
 	}
 	else
 		Log::Error("Couldn't allocate index buffer");
@@ -299,7 +299,7 @@ SRV_ID VQRenderer::AllocateSRV(uint NumDescriptors)
 
 	this->mHeapCBV_SRV_UAV.AllocateDescriptor(NumDescriptors, &srv);
 	Id = LAST_USED_SRV_ID++;
-	this->mSRVs[Id] = srv;
+	this->mSRVs.Insert(Id, srv);
 
 	return Id;
 }
@@ -375,8 +375,8 @@ void VQRenderer::InitializeNullSRV(SRV_ID srvID, uint heapIndex, UINT ShaderComp
 	nullSrvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
 	{
 		std::lock_guard<std::mutex> lk(this->mMtxSRVs_CBVs_UAVs);
-		pDevice->CreateShaderResourceView(nullptr, &nullSrvDesc, mSRVs.at(srvID).GetCPUDescHandle(heapIndex));
-		Log::Info("InitializeNullSRV %d[%d] | desc_gpu_addr = 0x%x", srvID, heapIndex, mSRVs.at(srvID).GetGPUDescHandle(heapIndex).ptr);
+		pDevice->CreateShaderResourceView(nullptr, &nullSrvDesc, mSRVs.At(srvID).GetCPUDescHandle(heapIndex));
+		Log::Info("InitializeNullSRV %d[%d] | desc_gpu_addr = 0x%x", srvID, heapIndex, mSRVs.At(srvID).GetGPUDescHandle(heapIndex).ptr);
 	}
 }
 
@@ -440,12 +440,12 @@ void VQRenderer::InitializeSRV(SRV_ID srvID, uint heapIndex, TextureID texID, bo
 	// get SRV
 	std::lock_guard<std::mutex> lk(mMtxSRVs_CBVs_UAVs);
 	{
-		if (mSRVs.find(srvID) == mSRVs.end())
+		if (!mSRVs.Contains(srvID))
 		{
 			Log::Error("SRV Not allocated for texID = %d", texID);
 			return;
 		}
-		SRV& srv = mSRVs.at(srvID);
+		SRV& srv = mSRVs.At(srvID);
 
 		const bool bBufferSRV = resourceDesc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER;
 		const bool bCustomComponentMappingSpecified = ShaderComponentMapping != D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
@@ -595,7 +595,7 @@ void VQRenderer::InitializeSRV(SRV_ID srvID, uint heapIndex, TextureID texID, bo
 void VQRenderer::InitializeSRV(SRV_ID srvID, uint heapIndex, D3D12_SHADER_RESOURCE_VIEW_DESC& srvDesc)
 {
 	std::lock_guard<std::mutex> lk(mMtxSRVs_CBVs_UAVs);
-	SRV& srv = mSRVs.at(srvID);
+	SRV& srv = mSRVs.At(srvID);
 	mDevice.GetDevicePtr()->CreateShaderResourceView(nullptr, &srvDesc, srv.GetCPUDescHandle(heapIndex));
 	Log::Info("InitializeSRV %d[%d] | desc_gpu_addr = 0x%x", srvID, heapIndex, srv.GetGPUDescHandle(heapIndex).ptr);
 }
@@ -733,7 +733,7 @@ void VQRenderer::InitializeSRVForBuffer(SRV_ID srvID, uint heapIndex, TextureID
 	desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
 	{
 		std::lock_guard<std::mutex> lk(mMtxSRVs_CBVs_UAVs);
-		SRV& srv = mSRVs.at(srvID);
+		SRV& srv = mSRVs.At(srvID);
 		mDevice.GetDevicePtr()->CreateShaderResourceView(pRsc, &desc, srv.GetCPUDescHandle(heapIndex));
 		assert(heapIndex < srv.GetSize());
 		Log::Info("InitializeSRVForBuffer %d[%d] | desc_gpu_addr = 0x%x", srvID, heapIndex, srv.GetGPUDescHandle(heapIndex).ptr);
@@ -820,8 +820,27 @@ void VQRenderer::DestroySRV(SRV_ID srvID)
 	if (srvID == INVALID_ID)
 		return;
 	std::lock_guard<std::mutex> lk(mMtxSRVs_CBVs_UAVs);
-	mHeapCBV_SRV_UAV.FreeDescriptor(&mSRVs.at(srvID));
-	mSRVs.erase(srvID);
+	mHeapCBV_SRV_UAV.FreeDescriptor(&mSRVs.At(srvID));
+	mSRVs.Remove(srvID);
+}
+void VQRenderer::DestroySRVs(const std::vector<SRV_ID>& srvIDs)
+{
+	SCOPED_CPU_MARKER("DestroySRVs");
+	std::lock_guard<std::mutex> lk(mMtxSRVs_CBVs_UAVs);
+	for (SRV_ID srvID : srvIDs)
+	{
+		if (CBV_SRV_UAV* pSRV = mSRVs.Get(srvID))
+			mHeapCBV_SRV_UAV.FreeDescriptor(pSRV);
+	}
+	mSRVs.Remove(srvIDs);
+}
+void VQRenderer::DestroyVertexAndIndexBuffers(const std::vector<BufferID>& VBIDs, const std::vector<BufferID>& IBIDs)
+{
+	SCOPED_CPU_MARKER("DestroyVertexAndIndexBuffers");
+	// StaticBufferHeap is a linear allocator and has no per-buffer free: only the buffer views are released here,
+	// the heap memory itself stays allocated until the heap is destroyed.
+	mVBVs.Remove(VBIDs);
+	mIBVs.Remove(IBIDs);
 }
 void VQRenderer::DestroyDSV(DSV_ID dsvID)
 {
@@ -910,6 +929,7 @@ FShaderStageCompileResult VQRenderer::LoadShader(const FShaderStageCompileDesc&
 		return Result; // no crash until runtime
 	}
 
+	MEMORY_TRACKED_BYTES_SET(Result.TrackedBytes, ShaderBlob.GetByteCodeSize());
 	return Result;
 }
 
@@ -920,28 +940,29 @@ FShaderStageCompileResult VQRenderer::LoadShader(const FShaderStageCompileDesc&
 // -----------------------------------------------------------------------------------------------------------------
 const VBV& VQRenderer::GetVertexBufferView(BufferID Id) const
 {
-	if (mVBVs.find(Id) == mVBVs.end())
+	const VBV* pVBV = mVBVs.Get(Id);
+	if (!pVBV)
 	{
 		static D3D12_VERTEX_BUFFER_VIEW kDefaultVBV = {};
 		return kDefaultVBV;
 	}
-	return mVBVs.at(Id);
+	return *pVBV;
 }
 
 const IBV& VQRenderer::GetIndexBufferView(BufferID Id) const
 {
-	if (mIBVs.find(Id) == mIBVs.end())
+	const IBV* pIBV = mIBVs.Get(Id);
+	if (!pIBV)
 	{
 		static D3D12_INDEX_BUFFER_VIEW kDefaultIBV = {};
 		return kDefaultIBV;
 	}
-	return mIBVs.at(Id);
+	return *pIBV;
 }
 const CBV_SRV_UAV& VQRenderer::GetShaderResourceView(SRV_ID Id) const
 {
-	std::lock_guard<std::mutex> lk(mMtxSRVs_CBVs_UAVs);
-	assert(Id < LAST_USED_SRV_ID && mSRVs.find(Id) != mSRVs.end());
-	return mSRVs.at(Id);
+	assert(Id < LAST_USED_SRV_ID && mSRVs.Contains(Id));
+	return mSRVs.At(Id);
 }
 
 const CBV_SRV_UAV& VQRenderer::GetUnorderedAccessView(UAV_ID Id) const { return mUAVs.at(Id); }
@@ -26,6 +26,8 @@
 #include "Libs/D3DX12/d3dx12.h"
 
 #include "Engine/GPUMarker.h"
+#include "Engine/TextureCache.h"
+#include "Engine/Core/VirtualFileSystem.h"
 
 
 using namespace Microsoft::WRL;
@@ -36,6 +38,7 @@ using namespace Microsoft::WRL;
 #define DISK_WORKER_MAKRER SCOPED_CPU_MARKER_C("DiskWorker", 0xFF00AAAA);
 #define MIP_WORKER_MAKRER SCOPED_CPU_MARKER_C("MipWorker", 0xFFAA0000);
 #define GPU_WORKER_MAKRER SCOPED_CPU_MARKER_C("GPUWorker", 0xFFAA00AA);
+#define RELEASE_WORKER_MAKRER SCOPED_CPU_MARKER_C("ReleaseWorker", 0xFF777777);
 
 //--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 //
@@ -47,27 +50,6 @@ static TextureID GenerateUniqueID()
 {
 	return LAST_USED_TEXTURE_ID.fetch_add(1);
 }
-static bool HasAlphaValues(const void* pData, uint W, uint H, DXGI_FORMAT Format)
-{
-	SCOPED_CPU_MARKER("HasAlphaValues");
-	const uint BytesPerPixel = (uint)VQ_DXGI_UTILS::GetPixelByteSize(Format);
-	bool bAllZero = true;
-	bool bAllWhite = true;
-	assert(BytesPerPixel >= 4);
-	for (uint row = 0; row < H; ++row) // this is not OK, we need threading here.
-	for (uint col = 0; col < W; ++col)
-	{
-		const char* pImg = static_cast<const char*>(pData);
-		const uint iPixel = row * W + col;
-		const uint AlphaByteOffset = 3 * BytesPerPixel / 4;
-		const uint8 a = pImg[iPixel * BytesPerPixel + AlphaByteOffset];
-		bAllZero = bAllZero && a == 0;
-		bAllWhite = bAllWhite && a == 255;
-		if (!bAllWhite && !bAllZero)
-			return true;
-	}
-	return false; // all 1 or all 0
-}
 static bool HasAlphaValuesSIMD(const void* pData, uint W, uint H, DXGI_FORMAT Format)
 {
 	SCOPED_CPU_MARKER("HasAlphaValuesSIMD");
@@ -209,6 +191,7 @@ void TextureManager::InitializeEarly()
 	mDiskWorkers.Initialize(HWCores, "TextureManagerDiskWorkers");
 	mMipWorkers.Initialize(std::max<size_t>(2, HWCores / 2), "TextureManagerMipWorkers");
 	mGPUWorkers.Initialize(1, "TextureManagerGPUWorkers");
+	mReleaseWorkers.Initialize(1, "TextureManagerReleaseWorkers");
 }
 
 void TextureManager::InitializeLate(
@@ -250,6 +233,7 @@ void TextureManager::Destroy()
 	}
 
 	// thread pool cleanup
+	mReleaseWorkers.Destroy(); // pending releases may wait on in-flight textures, destroy before the loading workers
 	mDiskWorkers.Destroy();
 	mMipWorkers.Destroy();
 	mGPUWorkers.Destroy();
@@ -313,12 +297,13 @@ TextureID TextureManager::CreateTexture(const FTextureRequest& Request, bool bCh
 
 	const bool bInitFromFile = !Request.FilePath.empty();
 	const bool bInitFromRAM = !Request.DataArray.empty();
+	const StringID FilePathID = bInitFromFile ? StringInterner::Intern(Request.FilePath) : EMPTY_STRING_ID;
 
 	// check cache for file-based textures
 	if (bInitFromFile)
 	{
 		std::lock_guard<std::mutex> Lock(mLoadedTexturePathsMutex);
-		if (auto It = mLoadedTexturePaths.find(Request.FilePath); It != mLoadedTexturePaths.end())
+		if (auto It = mLoadedTexturePaths.find(FilePathID); It != mLoadedTexturePaths.end())
 		{
 #if LOG_CACHED_RESOURCES_ON_LOAD
 			Log::Info("Texture already loaded: %s", FilePath.c_str());
@@ -335,7 +320,9 @@ TextureID TextureManager::CreateTexture(const FTextureRequest& Request, bool bCh
 	{
 		SCOPED_CPU_MARKER("CacheRequest");
 		std::lock_guard<std::shared_mutex> lock(mMetadataMutex);
-		mMetadata[id].Request = Request;
+		FTextureMetaData& Meta = mMetadata[id];
+		Meta.Request = Request;
+		Meta.FilePathID = FilePathID;
 	}
 
 	// Initialize task state
@@ -380,7 +367,7 @@ TextureID TextureManager::CreateTexture(const FTextureRequest& Request, bool bCh
 	{
 		SCOPED_CPU_MARKER("CachePath");
 		std::lock_guard<std::mutex> Lock(mLoadedTexturePathsMutex);
-		mLoadedTexturePaths[Request.FilePath] = id;
+		mLoadedTexturePaths[FilePathID] = id;
 	}
 
 	return id;
@@ -390,15 +377,20 @@ void TextureManager::DestroyTexture(TextureID& ID)
 {
 	SCOPED_CPU_MARKER("DestroyTexture");
 
-	// Wait for tasks to complete
+	// Wait for tasks to complete: don't hold mTaskMutex while waiting,
+	// the workers need it to signal completion.
+	std::latch* pSignal = nullptr;
 	{
 		std::lock_guard<std::mutex> lock(mTaskMutex);
 		auto taskIt = mTaskStates.find(ID);
 		if (taskIt != mTaskStates.end())
-		{
-			taskIt->second.CompletionSignal.wait();
-			mTaskStates.erase(taskIt);
-		}
+			pSignal = &taskIt->second.CompletionSignal;
+	}
+	if (pSignal)
+	{
+		pSignal->wait();
+		std::lock_guard<std::mutex> lock(mTaskMutex);
+		mTaskStates.erase(ID);
 	}
 	// Get metadata
 	FTextureMetaData meta;
@@ -428,10 +420,12 @@ void TextureManager::DestroyTexture(TextureID& ID)
 	}
 
 	// Remove from bookkeeping
-	if (!meta.Request.FilePath.empty())
+	if (meta.FilePathID != EMPTY_STRING_ID)
 	{
 		std::lock_guard<std::mutex> PathLock(mLoadedTexturePathsMutex);
-		mLoadedTexturePaths.erase(meta.Request.FilePath);
+		auto itPath = mLoadedTexturePaths.find(meta.FilePathID);
+		if (itPath != mLoadedTexturePaths.end() && itPath->second == ID) // path may have been reloaded under a new ID, see DestroyTextures()
+			mLoadedTexturePaths.erase(itPath);
 	}
 
 	// Purge pending uploads
@@ -461,6 +455,41 @@ void TextureManager::DestroyTexture(TextureID& ID)
 	ID = INVALID_ID;
 }
 
+void TextureManager::DestroyTextures(const std::vector<TextureID>& IDs)
+{
+	SCOPED_CPU_MARKER("DestroyTextures");
+	if (IDs.empty())
+		return;
+
+	// Evict the file paths from the cache right away: a texture requested while
+	// the release is in flight (e.g. by the next scene) gets loaded under a new ID
+	// instead of being handed the one that is about to be destroyed.
+	{
+		std::shared_lock<std::shared_mutex> metaLock(mMetadataMutex);
+		std::lock_guard<std::mutex> pathLock(mLoadedTexturePathsMutex);
+		for (TextureID ID : IDs)
+		{
+			auto it = mMetadata.find(ID);
+			if (it == mMetadata.end() || it->second.FilePathID == EMPTY_STRING_ID)
+				continue;
+			auto itPath = mLoadedTexturePaths.find(it->second.FilePathID);
+			if (itPath != mLoadedTexturePaths.end() && itPath->second == ID)
+				mLoadedTexturePaths.erase(itPath);
+		}
+	}
+
+	// the actual release waits on in-flight tasks & touches the upload queue, keep it off the calling thread
+	mReleaseWorkers.AddTask([this, IDs]()
+	{
+		RELEASE_WORKER_MAKRER;
+		for (TextureID ID : IDs)
+		{
+			TextureID id = ID;
+			DestroyTexture(id);
+		}
+	});
+}
+
 void TextureManager::WaitForTexture(TextureID ID) const
 {
 	SCOPED_CPU_MARKER_C("WaitForTexture", 0xFFAA0000);
@@ -531,6 +560,12 @@ void TextureManager::GetTextureDimensions(TextureID ID, int& Width, int& Height,
 	Mips = Texture.MipCount;
 }
 
+uint64 TextureManager::GetTextureAllocationSize(TextureID ID) const
+{
+	const FTexture* pTexture = GetTexture(ID);
+	return pTexture && pTexture->Allocation ? pTexture->Allocation->GetSize() : 0;
+}
+
 const FTexture* TextureManager::GetTexture(TextureID id) const
 {
 	std::shared_lock<std::shared_mutex> lock(mMetadataMutex);
@@ -557,13 +592,18 @@ void TextureManager::DiskRead(TextureID id, const FTextureRequest& request)
 		std::lock_guard<std::mutex> lock(mTaskMutex);
 		mTaskStates[id].State = ETextureTaskState::Reading;
 	}
+
+#if TEXTURE_CACHE_ENABLED
+	if (TextureCache::IsCookable(request.FilePath) && LoadCookedTexture(id, request))
+		return;
+#endif
 	
 	// load image
 	FTextureData data;
 	{
 		std::string fileName = DirectoryUtil::GetFileNameFromPath(request.FilePath);
 		SCOPED_CPU_MARKER_F("LoadFromFile: %s", fileName.c_str());
-		data.DiskImage = Image::LoadFromFile(request.FilePath.c_str());
+		data.DiskImage = VFS::LoadImageFile(request.FilePath); // loose or packed
 	}
 
 	// check image
@@ -579,6 +619,7 @@ void TextureManager::DiskRead(TextureID id, const FTextureRequest& request)
 
 	// Set InputData to point to the image data for consistency
 	data.InputData.push_back(data.DiskImage.pData);
+	MEMORY_TRACKED_BYTES_SET(data.TrackedBytes, static_cast<size_t>(data.DiskImage.Width) * data.DiskImage.Height * data.DiskImage.BytesPerPixel);
 
 	// Update metadata with image properties
 	{
@@ -607,6 +648,91 @@ void TextureManager::DiskRead(TextureID id, const FTextureRequest& request)
 	ScheduleNextTask(id);
 }
 
+bool TextureManager::LoadCookedTexture(TextureID id, const FTextureRequest& request)
+{
+	SCOPED_CPU_MARKER("LoadCookedTexture");
+	const std::string CookedFilePath = TextureCache::GetCookedFilePath(request.FilePath);
+	if (!VFS::Exists(CookedFilePath))
+		return false; // not cooked, see Tools/VQCook.cpp
+
+	VFS::FFile CookedFile;
+	TextureCache::FCookedTexture Cooked;
+	if (!VFS::ReadFile(CookedFilePath, CookedFile) || !TextureCache::ParseCookedTexture(CookedFile.GetData(), CookedFile.GetSize(), Cooked))
+	{
+		Log::Info("Cooked texture is corrupt or from another version: %s (source: %s)", CookedFilePath.c_str(), request.FilePath.c_str());
+		return false;
+	}
+
+	// the source is read & hashed only if its size or write time changed since the cook, w/o the source (cooked-only data) the cooked file is used as-is
+	VFS::FFileInfo SourceInfo;
+	if (VFS::GetFileInfo(request.FilePath, SourceInfo) && (SourceInfo.Size != Cooked.Source.Size || SourceInfo.WriteTime != Cooked.Source.WriteTime))
+	{
+		SCOPED_CPU_MARKER("HashSource");
+		VFS::FFile SourceFile;
+		if (!VFS::ReadFile(request.FilePath, SourceFile) || SourceFile.GetSize() == 0
+			|| TextureCache::ComputeSourceHash(SourceFile.GetData(), SourceFile.GetSize()) != Cooked.Source.Hash)
+		{
+			Log::Info("Cooked texture is stale: %s (source: %s)", CookedFilePath.c_str(), request.FilePath.c_str());
+			return false;
+		}
+	}
+	const uint32 Width  = Cooked.Mips[0].Width;
+	const uint32 Height = Cooked.Mips[0].Height;
+	if (request.bGenerateMips && Cooked.Mips.size() != TextureCache::CalculateMipLevelCount(Width, Height))
+		return false; // cooked w/o the mip chain
+
+	// copy the mip chain out of the file, the rest of the pipeline works w/ the owned images
+	FTextureData data;
+	data.MipImages.resize(request.bGenerateMips ? Cooked.Mips.size() : 1);
+	size_t MipChainBytes = 0;
+	for (size_t Mip = 0; Mip < data.MipImages.size(); ++Mip)
+	{
+		const size_t NumBytes = Cooked.GetMipSize(Mip);
+		Image& MipImage = data.MipImages[Mip];
+		MipImage = Image::CreateEmptyImage(NumBytes);
+		memcpy(MipImage.pData, Cooked.MipData[Mip], NumBytes);
+		MipImage.Width = static_cast<int>(Cooked.Mips[Mip].Width);
+		MipImage.Height = static_cast<int>(Cooked.Mips[Mip].Height);
+		MipImage.BytesPerPixel = static_cast<int>(Cooked.BytesPerPixel);
+		MipChainBytes += NumBytes;
+	}
+	MEMORY_TRACKED_BYTES_SET(data.TrackedBytes, MipChainBytes);
+
+	// Update metadata with image properties, the alpha check result is cooked too: InputData stays empty
+	// so that AllocateResource() doesn't scan the pixels again.
+	{
+		SCOPED_CPU_MARKER("UpdateRequestDesc");
+		std::lock_guard<std::shared_mutex> lock(mMetadataMutex);
+		auto& meta = mMetadata[id];
+		meta.Request.D3D12Desc.Width = Width;
+		meta.Request.D3D12Desc.Height = Height;
+		meta.Request.D3D12Desc.Format = Cooked.BytesPerPixel == 16 ? DXGI_FORMAT_R32G32B32A32_FLOAT : DXGI_FORMAT_R8G8B8A8_UNORM;
+		meta.Request.D3D12Desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+		meta.Request.D3D12Desc.MipLevels = static_cast<UINT16>(data.MipImages.size());
+		meta.Request.D3D12Desc.DepthOrArraySize = 1;
+		meta.Request.D3D12Desc.SampleDesc.Count = 1;
+		meta.Request.D3D12Desc.SampleDesc.Quality = 0;
+		meta.Request.D3D12Desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+		meta.Request.D3D12Desc.Flags = D3D12_RESOURCE_FLAG_NONE;
+		meta.Request.InitialState = D3D12_RESOURCE_STATE_COMMON;
+		meta.Texture.UsesAlphaChannel = (Cooked.Flags & TextureCache::COOKED_TEXTURE_USES_ALPHA) != 0;
+	}
+
+	// Store data
+	{
+		std::lock_guard<std::mutex> lock(mDataMutex);
+		mTextureData[id] = std::move(data);
+	}
+
+	// the mips are cooked: continue from the mip generation stage
+	{
+		std::lock_guard<std::mutex> lock(mTaskMutex);
+		mTaskStates[id].State = ETextureTaskState::MipGenerating;
+	}
+	ScheduleNextTask(id);
+	return true;
+}
+
 void TextureManager::LoadFromMemory(TextureID id, const FTextureRequest& request)
 {
 	SCOPED_CPU_MARKER("LoadFromMemory");
@@ -693,12 +819,14 @@ void TextureManager::GenerateMips(TextureID id)
 
 	// Initialize MipImages
 	data.MipImages.resize(meta.Request.D3D12Desc.MipLevels);
+	size_t MipChainBytes = 0;
 
 	// Set first mip from InputData (DiskImage or procedural data)
 	if (data.DiskImage.IsValid())
 	{
 		data.MipImages[0] = std::move(data.DiskImage); // Move DiskImage to MipImages[0]
 		data.DiskImage = Image();
+		MipChainBytes += static_cast<size_t>(data.MipImages[0].Width) * data.MipImages[0].Height * data.MipImages[0].BytesPerPixel;
 	}
 	else
 	{
@@ -708,6 +836,7 @@ void TextureManager::GenerateMips(TextureID id)
 		data.MipImages[0].Width = Footprints[0].Footprint.Width;
 		data.MipImages[0].Height = Footprints[0].Footprint.Height;
 		data.MipImages[0].BytesPerPixel = static_cast<int>(VQ_DXGI_UTILS::GetPixelByteSize(meta.Request.D3D12Desc.Format));
+		MipChainBytes += Footprints[0].Footprint.Height * Footprints[0].Footprint.RowPitch;
 	}
 
 	// Generate subsequent mips
@@ -718,6 +847,7 @@ void TextureManager::GenerateMips(TextureID id)
 		data.MipImages[Mip].Width = Footprints[Mip].Footprint.Width;
 		data.MipImages[Mip].Height = Footprints[Mip].Footprint.Height;
 		data.MipImages[Mip].BytesPerPixel = static_cast<int>(VQ_DXGI_UTILS::GetPixelByteSize(meta.Request.D3D12Desc.Format));
+		MipChainBytes += Footprints[Mip].Footprint.Height * Footprints[Mip].Footprint.RowPitch;
 
 		// Generate mip data
 		VQ_DXGI_UTILS::MipImage(
@@ -728,6 +858,7 @@ void TextureManager::GenerateMips(TextureID id)
 			(uint)VQ_DXGI_UTILS::GetPixelByteSize(meta.Request.D3D12Desc.Format)
 		);
 	}
+	MEMORY_TRACKED_BYTES_SET(data.TrackedBytes, MipChainBytes);
 
 	{
 		std::lock_guard<std::mutex> lock(mDataMutex);
@@ -880,7 +1011,7 @@ void TextureManager::QueueUploadToGPUTask(TextureID id)
 
 	FTextureUploadTask Task;
 	Task.ID = id;
-	if (meta.Request.bGenerateMips && !pData->MipImages.empty())
+	if (!pData->MipImages.empty()) // generated or cooked mips
 	{
 		Task.DataArray.resize(pData->MipImages.size());
 		for (size_t i = 0; i < pData->MipImages.size(); ++i)
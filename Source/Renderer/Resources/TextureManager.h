@@ -21,6 +21,9 @@
 #include "Texture.h"
 
 #include "Engine/Core/Types.h"
+#include "Engine/Core/MemoryTracking.h"
+#include "Engine/Core/FlatHashMap.h"
+#include "Engine/Core/StringInterner.h"
 #include "Libs/VQUtils/Include/Multithreading/EventSignal.h"
 #include "Libs/VQUtils/Include/Multithreading/ThreadPool.h"
 #include "Libs/VQUtils/Include/Image.h"
@@ -75,6 +78,7 @@ public:
 
     TextureID CreateTexture(const FTextureRequest& Request, bool bCheckAlpha = false);
     void DestroyTexture(TextureID& ID);
+    void DestroyTextures(const std::vector<TextureID>& IDs); // async, released on mReleaseWorkers
 
     void WaitForTexture(TextureID ID) const;
 
@@ -86,6 +90,9 @@ public:
     void                   GetTextureDimensions(TextureID ID, int& Width, int& Height, int& Slices, int& Mips) const;
     inline bool            GetTextureAlphaChannelUsed(TextureID ID) const { return GetTexture(ID)->UsesAlphaChannel; }
     inline uint            GetTextureMips(TextureID ID) const { return GetTexture(ID)->MipCount; }
+    uint64                 GetTextureAllocationSize(TextureID ID) const; // 0 until the texture memory is allocated
+
+    inline ThreadPool&     GetDiskWorkers() { return mDiskWorkers; } // also decompresses the pak file reads, see VFS::SetDecompressionWorkers()
 
 private:
     struct FTextureTaskState
@@ -98,6 +105,7 @@ private:
     {
         FTextureRequest Request;
         FTexture Texture; // Resource, Allocation, Format, etc.
+        StringID FilePathID = EMPTY_STRING_ID; // Request.FilePath, key of mLoadedTexturePaths
     };
     struct FTextureData
     {
@@ -105,6 +113,7 @@ private:
         std::vector<Image> MipImages;        // For generated mip levels
         std::vector<uint8_t> OwnedData;      // For temporary buffers during mip generation
         std::vector<const void*> InputData;  // For procedural textures (points to FTextureRequest::DataArray)
+        MEMORY_TRACKED_BYTES(TEXTURE_DATA, TrackedBytes); // owned image memory, released with the entry in mTextureData
     };
     struct FTextureUploadTask
     {
@@ -114,7 +123,7 @@ private:
     };
 
     // Task state and synchronization
-    std::unordered_map<TextureID, FTextureTaskState> mTaskStates;
+    FlatHashMap<TextureID, FTextureTaskState> mTaskStates; // values stay put on rehash: the latches are waited on w/o the lock
     mutable std::mutex mTaskMutex;
 
     // Texture data (temporary, cleared after upload)
@@ -122,17 +131,18 @@ private:
     mutable std::mutex mDataMutex;
     
     // Texture metadata (immutable after creation)
-    std::unordered_map<TextureID, FTextureMetaData> mMetadata;
+    FlatHashMap<TextureID, FTextureMetaData> mMetadata; // GetTexture() hands out pointers into here
     mutable std::shared_mutex mMetadataMutex;
 
     // Cache for file-based textures
-    std::unordered_map<std::string, TextureID> mLoadedTexturePaths;
+    std::unordered_map<StringID, TextureID> mLoadedTexturePaths;
     std::mutex mLoadedTexturePathsMutex;
 
     // thread pools
     ThreadPool mDiskWorkers;
     ThreadPool mMipWorkers;
     ThreadPool mGPUWorkers;
+    ThreadPool mReleaseWorkers;
 
     // upload thread state
     concurrency::concurrent_queue<FTextureUploadTask> mUploadQueue;
@@ -153,6 +163,7 @@ private:
 
     // private functions
     void DiskRead(TextureID id, const FTextureRequest& request);
+    bool LoadCookedTexture(TextureID id, const FTextureRequest& request); // see Engine/TextureCache.h
     void LoadFromMemory(TextureID id, const FTextureRequest& request);
     void GenerateMips(TextureID ID);
     void AllocateResource(TextureID ID);
@@ -107,13 +107,13 @@ void StressTestScene::InitializeScene()
 	{
 		const GameObject* pObj = GetGameObject(hObj);
 		const ModelID iModel = pObj->mModelID;
-		auto it = mModels.find(iModel);
-		if (it == mModels.end())
+		const Model* pModel = mModels.Get(iModel);
+		if (!pModel)
 		{
 			continue;
 		}
 
-		const Model& model = it->second;
+		const Model& model = *pModel;
 		
 		const bool bGeneratedObject = model.mModelName.empty();
 		if (bGeneratedObject)
@@ -312,9 +312,7 @@ void StressTestScene::LoadScene(FSceneRepresentation& scene)
 		}
 	}
 
-	// TODO: pre-alloc
-
-	// object chunk
+	// object chunk: allocated in one go, Scene::LoadGameObjects() creates them in batch
 	const size_t NumObjectsToAllocate
 		= DIMENSION_X * DIMENSION_Y * DIMENSION_Z // randomized objects 
 		+ NUM_ROUGHNESS_INSTANCES * NUM_METALLIC_INSTANCES // gradient spheres
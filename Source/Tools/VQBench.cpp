@@ -0,0 +1,238 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+
+//
+// VQBench: measures the lookup cost of the scene containers & the renderer hash maps, see
+// Engine/Core/SlotMap.h and Engine/Core/FlatHashMap.h
+//
+//   VQBench [-count=<N>] [-lookups=<N>] [-runs=<N>] [-seed=<N>]
+//
+// Compares SlotMap<T>::Get() against the std::unordered_map<int, T> lookups the Scene
+// used for meshes/models/materials before the slot maps. Both containers hold the same
+// objects & go through the same insert/remove churn, then are queried with the same
+// handle sequences: in insertion order (draw list walk) and shuffled (culled/sorted lists).
+//
+// Compares FlatHashMap<K, V>::find() against std::unordered_map<K, V>::find() for the two key
+// distributions of the renderer tables: sequential int IDs w/ the same churn (VB/IB/SRV views)
+// and random size_t hashes (PSO maps), queried in a shuffled order.
+//
+// Reports the best of the runs in nanoseconds per lookup.
+//
+#include "Engine/Core/SlotMap.h"
+#include "Engine/Core/FlatHashMap.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct FBenchObject // roughly the size of a Mesh
+{
+	float Data[32] = {};
+};
+struct FBenchView // roughly the size of a buffer view / descriptor handle
+{
+	float Data[4] = {};
+};
+
+struct FBenchParams
+{
+	size_t NumObjects = 4096;
+	size_t NumLookups = 1 << 20;
+	int    NumRuns = 8;
+	uint32 Seed = 7;
+};
+
+template<class TMap, class TKey>
+static const FBenchView& Find(const TMap& Map, const TKey& Key)
+{
+	auto it = Map.find(Key);
+	assert(it != Map.end());
+	return it->second;
+}
+
+static void PrintUsage()
+{
+	printf("Usage:\n");
+	printf("  VQBench [-count=<N>] [-lookups=<N>] [-runs=<N>] [-seed=<N>]\n");
+}
+
+template<class THandle, class TLookupFn>
+static double MeasureLookups(const std::vector<THandle>& Handles, size_t NumLookups, int NumRuns, TLookupFn&& Lookup, float& Sink)
+{
+	double BestSeconds = 1e30;
+	for (int iRun = 0; iRun < NumRuns; ++iRun)
+	{
+		float Sum = 0.0f;
+		const auto t0 = std::chrono::high_resolution_clock::now();
+		for (size_t iLookup = 0; iLookup < NumLookups; iLookup += Handles.size())
+		{
+			for (const THandle& Handle : Handles)
+				Sum += Lookup(Handle).Data[0];
+		}
+		const auto t1 = std::chrono::high_resolution_clock::now();
+		BestSeconds = std::min(BestSeconds, std::chrono::duration<double>(t1 - t0).count());
+		Sink += Sum; // keeps the loop from being optimized away
+	}
+	const size_t NumLookupsPerRun = (NumLookups + Handles.size() - 1) / Handles.size() * Handles.size(); // whole passes over the handles
+	return BestSeconds * 1e9 / static_cast<double>(NumLookupsPerRun);
+}
+
+int main(int argc, char** argv)
+{
+	FBenchParams Params;
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string Arg = argv[i];
+		if      (Arg.rfind("-count="  , 0) == 0) Params.NumObjects = std::stoull(Arg.substr(strlen("-count=")));
+		else if (Arg.rfind("-lookups=", 0) == 0) Params.NumLookups = std::stoull(Arg.substr(strlen("-lookups=")));
+		else if (Arg.rfind("-runs="   , 0) == 0) Params.NumRuns    = std::stoi(Arg.substr(strlen("-runs=")));
+		else if (Arg.rfind("-seed="   , 0) == 0) Params.Seed       = static_cast<uint32>(std::stoul(Arg.substr(strlen("-seed="))));
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	const size_t Capacity = static_cast<size_t>(SlotMap<FBenchObject>::HANDLE_INDEX_MASK) + 1;
+	if (Params.NumObjects == 0 || Params.NumObjects > Capacity / 2 || Params.NumLookups == 0 || Params.NumRuns <= 0)
+	{
+		fprintf(stderr, "-count must be in [1, %zu], -lookups & -runs must be positive\n", Capacity / 2);
+		return 1;
+	}
+
+	std::mt19937 rng(Params.Seed);
+
+	// scene containers: fill both the way the Scene does: the unordered_map with incrementing IDs, the slot map with its handles
+	SlotMap<FBenchObject> Slots(Capacity);
+	std::unordered_map<int, FBenchObject> Map;
+	std::vector<int> SlotHandles, MapKeys;
+	int LastUsedID = 0;
+	for (size_t i = 0; i < Params.NumObjects; ++i)
+	{
+		FBenchObject obj;
+		obj.Data[0] = static_cast<float>(i);
+		SlotHandles.push_back(Slots.Insert(obj));
+		MapKeys.push_back(LastUsedID);
+		Map[LastUsedID++] = obj;
+	}
+
+	// churn: unload & reload a quarter of the objects, as scene switches / hot reloads do
+	for (size_t i = 0; i < Params.NumObjects / 4; ++i)
+	{
+		const size_t iObj = rng() % Params.NumObjects;
+		FBenchObject obj;
+		obj.Data[0] = static_cast<float>(iObj);
+
+		Slots.Remove(SlotHandles[iObj]);
+		SlotHandles[iObj] = Slots.Insert(obj);
+
+		Map.erase(MapKeys[iObj]);
+		MapKeys[iObj] = LastUsedID;
+		Map[LastUsedID++] = obj;
+	}
+
+	// shuffled query order, same permutation for both containers
+	std::vector<size_t> Permutation(Params.NumObjects);
+	for (size_t i = 0; i < Permutation.size(); ++i)
+		Permutation[i] = i;
+	std::shuffle(Permutation.begin(), Permutation.end(), rng);
+	std::vector<int> SlotHandlesShuffled(Params.NumObjects), MapKeysShuffled(Params.NumObjects);
+	for (size_t i = 0; i < Permutation.size(); ++i)
+	{
+		SlotHandlesShuffled[i] = SlotHandles[Permutation[i]];
+		MapKeysShuffled[i] = MapKeys[Permutation[i]];
+	}
+
+	auto fnMapLookup  = [&Map  ](int Key   ) -> const FBenchObject& { return Map.at(Key); };
+	auto fnSlotLookup = [&Slots](int Handle) -> const FBenchObject& { const FBenchObject* p = Slots.Get(Handle); assert(p); return *p; };
+
+	float Sink = 0.0f;
+	const double MapInOrder = MeasureLookups(MapKeys            , Params.NumLookups, Params.NumRuns, fnMapLookup , Sink);
+	const double SlotInOrder = MeasureLookups(SlotHandles        , Params.NumLookups, Params.NumRuns, fnSlotLookup, Sink);
+	const double MapShuffled = MeasureLookups(MapKeysShuffled    , Params.NumLookups, Params.NumRuns, fnMapLookup , Sink);
+	const double SlotShuffled = MeasureLookups(SlotHandlesShuffled, Params.NumLookups, Params.NumRuns, fnSlotLookup, Sink);
+
+	// renderer hash maps: sequential IDs w/ the same churn as above, then random 64-bit PSO hashes
+	std::unordered_map<int, FBenchView> IDMap;
+	FlatHashMap<int, FBenchView> IDFlatMap;
+	std::vector<int> IDs;
+	int LastUsedViewID = 0;
+	for (size_t i = 0; i < Params.NumObjects; ++i)
+	{
+		FBenchView View;
+		View.Data[0] = static_cast<float>(i);
+		IDs.push_back(LastUsedViewID);
+		IDMap[LastUsedViewID] = View;
+		IDFlatMap[LastUsedViewID++] = View;
+	}
+	for (size_t i = 0; i < Params.NumObjects / 4; ++i)
+	{
+		const size_t iView = rng() % Params.NumObjects;
+		FBenchView View;
+		View.Data[0] = static_cast<float>(iView);
+		IDMap.erase(IDs[iView]);
+		IDFlatMap.erase(IDs[iView]);
+		IDs[iView] = LastUsedViewID;
+		IDMap[LastUsedViewID] = View;
+		IDFlatMap[LastUsedViewID++] = View;
+	}
+	std::shuffle(IDs.begin(), IDs.end(), rng);
+
+	std::unordered_map<size_t, FBenchView> HashMap;
+	FlatHashMap<size_t, FBenchView> HashFlatMap;
+	std::vector<size_t> Hashes;
+	std::mt19937_64 rng64(Params.Seed);
+	while (Hashes.size() < Params.NumObjects)
+	{
+		const size_t Hash = static_cast<size_t>(rng64());
+		if (HashMap.find(Hash) != HashMap.end())
+			continue;
+		FBenchView View;
+		View.Data[0] = static_cast<float>(Hashes.size());
+		Hashes.push_back(Hash);
+		HashMap[Hash] = View;
+		HashFlatMap[Hash] = View;
+	}
+	std::shuffle(Hashes.begin(), Hashes.end(), rng);
+
+	auto fnIDMapLookup       = [&IDMap      ](int    Key) -> const FBenchView& { return Find(IDMap      , Key); };
+	auto fnIDFlatMapLookup   = [&IDFlatMap  ](int    Key) -> const FBenchView& { return Find(IDFlatMap  , Key); };
+	auto fnHashMapLookup     = [&HashMap    ](size_t Key) -> const FBenchView& { return Find(HashMap    , Key); };
+	auto fnHashFlatMapLookup = [&HashFlatMap](size_t Key) -> const FBenchView& { return Find(HashFlatMap, Key); };
+	const double IDMapTime       = MeasureLookups(IDs   , Params.NumLookups, Params.NumRuns, fnIDMapLookup      , Sink);
+	const double IDFlatMapTime   = MeasureLookups(IDs   , Params.NumLookups, Params.NumRuns, fnIDFlatMapLookup  , Sink);
+	const double HashMapTime     = MeasureLookups(Hashes, Params.NumLookups, Params.NumRuns, fnHashMapLookup    , Sink);
+	const double HashFlatMapTime = MeasureLookups(Hashes, Params.NumLookups, Params.NumRuns, fnHashFlatMapLookup, Sink);
+
+	printf("%zu objects (%zu bytes each), %zu lookups, best of %d runs\n", Params.NumObjects, sizeof(FBenchObject), Params.NumLookups, Params.NumRuns);
+	printf("  %-10s %16s %16s %10s\n", "order", "unordered_map", "SlotMap", "speedup");
+	printf("  %-10s %13.2f ns %13.2f ns %9.2fx\n", "in-order", MapInOrder , SlotInOrder , MapInOrder  / SlotInOrder);
+	printf("  %-10s %13.2f ns %13.2f ns %9.2fx\n", "shuffled", MapShuffled, SlotShuffled, MapShuffled / SlotShuffled);
+	printf("\n%zu keys (%zu byte values), shuffled\n", Params.NumObjects, sizeof(FBenchView));
+	printf("  %-10s %16s %16s %10s\n", "keys", "unordered_map", "FlatHashMap", "speedup");
+	printf("  %-10s %13.2f ns %13.2f ns %9.2fx\n", "IDs"   , IDMapTime  , IDFlatMapTime  , IDMapTime   / IDFlatMapTime);
+	printf("  %-10s %13.2f ns %13.2f ns %9.2fx\n", "PSO hash", HashMapTime, HashFlatMapTime, HashMapTime / HashFlatMapTime);
+	return Sink == -1.0f ? 1 : 0; // consume the sink
+}
@@ -0,0 +1,494 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+
+//
+// VQCook: offline asset cooker, builds the derived data the engine would otherwise compute on first load
+//
+//   VQCook [<directory>...] [-force] [-j=<NumThreads>]
+//
+//   - textures (png/jpg/tga/bmp): decode, mip chain & alpha usage -> Cache/Textures/*.vqtex, see Engine/TextureCache.h
+//   - HDRI environment maps: the <name>_8k.hdr sources are downsized to the 4k/2k/1k variants next to them,
+//     which EnvironmentMap.cpp would otherwise create on the first load of an environment map
+//
+// Run from the engine's working directory (the repo root), the default input directory is Data/.
+// A build is incremental: the content hashes of the sources are kept in Cache/VQCook.manifest together w/ the
+// size & write time of the file they were computed from, an artifact is rebuilt only if its source hash changes.
+//
+// The tool has no Windows/D3D12 dependencies (std::thread & std::filesystem, stb), on Linux:
+//
+//   c++ -std=c++20 -O2 -pthread -I. -ISource Source/Tools/VQCook.cpp Source/Engine/TextureCache.cpp -o VQCook
+//
+// VQCook covers the textures & HDRIs only. Not cooked here:
+//   - models (tangents, LODs, meshlets): the glTF import is cooked by the engine into Cache/Meshes on the first load, see MeshCache.h.
+//     The import pipeline builds Mesh objects (DirectXMath, renderer buffers) and isn't available to this tool
+//   - scenes: VQE -CookScenes, see SceneCache.h
+//   - shaders: compiled w/ DXC into Cache/Shaders by the engine, which requires the Windows toolchain
+//
+#include "Engine/TextureCache.h"
+#include "Engine/Core/Hash.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "Libs/VQUtils/Libs/stb/stb_image.h"
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "Libs/VQUtils/Libs/stb/stb_image_write.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static const std::string MANIFEST_FILE_PATH = "Cache/VQCook.manifest";
+static constexpr uint32 MANIFEST_VERSION = 1;
+
+static void PrintUsage()
+{
+	printf("Usage:\n");
+	printf("  VQCook [<directory>...] [-force] [-j=<NumThreads>]\n");
+}
+
+static std::string ToLower(std::string s)
+{
+	std::transform(s.begin(), s.end(), s.begin(), [](char c) { return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c; });
+	return s;
+}
+
+
+//
+// MANIFEST
+//
+// S <SourceHash> <Size> <WriteTime> <Path>  content hash of a source file, reused while its size & write time are unchanged
+// A <SourceHash> <Path>                     an artifact written by the cooker & the hash of the source it was built from
+//
+using TextureCache::FSourceStamp; // also stored in the cooked textures, the runtime validates them the same way
+struct FManifest
+{
+	std::unordered_map<std::string, FSourceStamp> Sources;
+	std::unordered_map<std::string, uint64>       Artifacts;
+
+	bool Load(const std::string& FilePath)
+	{
+		std::ifstream File(FilePath);
+		if (!File.is_open())
+			return false;
+
+		std::string Line;
+		uint32 Version = 0;
+		if (!std::getline(File, Line) || sscanf(Line.c_str(), "VQCook %u", &Version) != 1 || Version != MANIFEST_VERSION)
+			return false; // rebuild everything
+
+		while (std::getline(File, Line))
+		{
+			std::istringstream ss(Line);
+			char Type = 0;
+			std::string HashStr;
+			ss >> Type >> HashStr;
+			const uint64 Hash = std::strtoull(HashStr.c_str(), nullptr, 16);
+			FSourceStamp Stamp;
+			if (Type == 'S')
+				ss >> Stamp.Size >> Stamp.WriteTime;
+			std::string Path;
+			ss.get(); // separator
+			std::getline(ss, Path);
+			if (!ss.fail() && !Path.empty())
+			{
+				if (Type == 'S') { Stamp.Hash = Hash; Sources[Path] = Stamp; }
+				if (Type == 'A') { Artifacts[Path] = Hash; }
+			}
+		}
+		return true;
+	}
+
+	bool Save(const std::string& FilePath) const
+	{
+		std::error_code ec;
+		fs::create_directories(fs::path(FilePath).parent_path(), ec);
+		const std::string TempFilePath = FilePath + ".tmp";
+		{
+			std::ofstream File(TempFilePath, std::ios::trunc);
+			if (!File.is_open())
+				return false;
+			char HashStr[17];
+			File << "VQCook " << MANIFEST_VERSION << "\n";
+			for (const auto& [Path, Stamp] : Sources)
+			{
+				snprintf(HashStr, sizeof(HashStr), "%016llx", Stamp.Hash);
+				File << "S " << HashStr << " " << Stamp.Size << " " << Stamp.WriteTime << " " << Path << "\n";
+			}
+			for (const auto& [Path, Hash] : Artifacts)
+			{
+				snprintf(HashStr, sizeof(HashStr), "%016llx", Hash);
+				File << "A " << HashStr << " " << Path << "\n";
+			}
+			if (!File.good())
+				return false;
+		}
+		fs::rename(TempFilePath, FilePath, ec);
+		return !ec;
+	}
+};
+
+
+//
+// JOBS
+//
+enum class EJobType { Texture, HDRI };
+enum class EJobResult { Cooked, UpToDate, Failed };
+struct FCookJob
+{
+	EJobType    Type = EJobType::Texture;
+	std::string SourcePath;
+
+	// output, merged into the manifest on the main thread
+	FSourceStamp              SourceStamp;
+	std::vector<std::string>  Artifacts;
+	EJobResult                Result = EJobResult::Failed;
+	std::string               Message;
+};
+
+struct FCookContext
+{
+	const FManifest* pManifest = nullptr; // read-only while the jobs run
+	bool bForce = false;
+	std::mutex MtxPrint;
+};
+
+static bool ReadFileContents(const std::string& Path, std::vector<uint8>& Data)
+{
+	std::ifstream File(Path, std::ios::binary | std::ios::ate);
+	if (!File.is_open())
+		return false;
+	Data.resize(static_cast<size_t>(File.tellg()));
+	File.seekg(0);
+	return static_cast<bool>(File.read(reinterpret_cast<char*>(Data.data()), static_cast<std::streamsize>(Data.size())));
+}
+
+// content hash of the source w/o reading it when the manifest has a record w/ the same size & write time.
+// Data is filled only if the file had to be read.
+static bool GetSourceStamp(const FCookContext& Ctx, const std::string& Path, FSourceStamp& Stamp, std::vector<uint8>& Data)
+{
+	std::error_code ec;
+	Stamp.Size = static_cast<uint64>(fs::file_size(Path, ec));
+	if (ec)
+		return false;
+	Stamp.WriteTime = static_cast<int64>(fs::last_write_time(Path, ec).time_since_epoch().count());
+
+	auto it = Ctx.pManifest->Sources.find(Path);
+	if (!Ctx.bForce && it != Ctx.pManifest->Sources.end() && it->second.Size == Stamp.Size && it->second.WriteTime == Stamp.WriteTime)
+	{
+		Stamp.Hash = it->second.Hash;
+		return true;
+	}
+
+	if (!ReadFileContents(Path, Data))
+		return false;
+	Stamp.Hash = TextureCache::ComputeSourceHash(Data.data(), Data.size());
+	return true;
+}
+
+static void CookTexture(const FCookContext& Ctx, FCookJob& Job)
+{
+	std::vector<uint8> FileData;
+	if (!GetSourceStamp(Ctx, Job.SourcePath, Job.SourceStamp, FileData))
+	{
+		Job.Message = "couldn't read the file";
+		return;
+	}
+
+	const std::string CookedFilePath = TextureCache::GetCookedFilePath(Job.SourcePath);
+	Job.Artifacts.push_back(CookedFilePath);
+	// the stamp has to match too, otherwise the runtime would hash the source on every load
+	TextureCache::FSourceStamp CookedSource;
+	if (!Ctx.bForce && TextureCache::ReadCookedTextureSource(CookedFilePath, CookedSource)
+		&& CookedSource.Hash == Job.SourceStamp.Hash && CookedSource.Size == Job.SourceStamp.Size && CookedSource.WriteTime == Job.SourceStamp.WriteTime)
+	{
+		Job.Result = EJobResult::UpToDate;
+		return;
+	}
+
+	if (FileData.empty() && !ReadFileContents(Job.SourcePath, FileData))
+	{
+		Job.Message = "couldn't read the file";
+		return;
+	}
+
+	// same output as the runtime decode (VFS::LoadImageFile()): RGBA8
+	int Width = 0, Height = 0, NumChannels = 0;
+	stbi_uc* pDecoded = stbi_load_from_memory(FileData.data(), static_cast<int>(FileData.size()), &Width, &Height, &NumChannels, 4);
+	if (!pDecoded)
+	{
+		Job.Message = std::string("couldn't decode: ") + stbi_failure_reason();
+		return;
+	}
+
+	TextureCache::FSourceImage Image;
+	Image.pData = pDecoded;
+	Image.Width = static_cast<uint32>(Width);
+	Image.Height = static_cast<uint32>(Height);
+	Image.BytesPerPixel = 4;
+	const TextureCache::FCookedTexture Cooked = TextureCache::CookTexture(Image, true);
+	stbi_image_free(pDecoded);
+
+	if (!TextureCache::WriteCookedTexture(CookedFilePath, Job.SourceStamp, Cooked))
+	{
+		Job.Message = "couldn't write " + CookedFilePath;
+		return;
+	}
+	char Msg[128];
+	snprintf(Msg, sizeof(Msg), "%ux%u, %zu mips%s", Image.Width, Image.Height, Cooked.Mips.size(), (Cooked.Flags & TextureCache::COOKED_TEXTURE_USES_ALPHA) ? ", alpha" : "");
+	Job.Message = Msg;
+	Job.Result = EJobResult::Cooked;
+}
+
+
+//
+// HDRI
+//
+// EnvironmentMaps.ini refers to the HDRIs as <name>_%resolution%.hdr, the engine picks 1k-8k based on the
+// monitor resolution and downsizes the 8k source if the picked one doesn't exist, see EnvironmentMap.cpp.
+//
+struct FHDRIResolution { const char* Suffix; uint32 Width; uint32 Height; };
+static const FHDRIResolution HDRI_RESOLUTIONS[] = { { "8k", 8192, 4096 }, { "4k", 4096, 2048 }, { "2k", 2048, 1024 }, { "1k", 1024, 512 } };
+
+static bool IsHDRISource(const fs::path& Path)
+{
+	const std::string Stem = ToLower(Path.stem().string());
+	return ToLower(Path.extension().string()) == ".hdr" && Stem.size() > 3 && Stem.compare(Stem.size() - 3, 3, "_8k") == 0;
+}
+
+// area average: every source texel contributes to the destination texel it falls into
+static std::vector<float> ResizeImage(const float* pSrc, uint32 SrcWidth, uint32 SrcHeight, uint32 DstWidth, uint32 DstHeight)
+{
+	std::vector<float> Dst(static_cast<size_t>(DstWidth) * DstHeight * 4, 0.0f);
+	std::vector<float> Weights(static_cast<size_t>(DstWidth) * DstHeight, 0.0f);
+	for (uint32 y = 0; y < SrcHeight; ++y)
+	{
+		const size_t yDst = static_cast<size_t>(y) * DstHeight / SrcHeight;
+		for (uint32 x = 0; x < SrcWidth; ++x)
+		{
+			const size_t iDst = yDst * DstWidth + static_cast<size_t>(x) * DstWidth / SrcWidth;
+			const float* pTexel = pSrc + (static_cast<size_t>(y) * SrcWidth + x) * 4;
+			for (int ch = 0; ch < 4; ++ch)
+				Dst[iDst * 4 + ch] += pTexel[ch];
+			Weights[iDst] += 1.0f;
+		}
+	}
+	for (size_t i = 0; i < Weights.size(); ++i)
+	for (int ch = 0; ch < 4; ++ch)
+		Dst[i * 4 + ch] = Weights[i] > 0.0f ? Dst[i * 4 + ch] / Weights[i] : 0.0f;
+	return Dst;
+}
+
+static void CookHDRI(const FCookContext& Ctx, FCookJob& Job)
+{
+	std::vector<uint8> FileData;
+	if (!GetSourceStamp(Ctx, Job.SourcePath, Job.SourceStamp, FileData))
+	{
+		Job.Message = "couldn't read the file";
+		return;
+	}
+
+	// targets: the missing variants & the ones cooked from an older version of the source.
+	// variants that exist but weren't written by the cooker are downloaded natively, those aren't touched.
+	const std::string SourceStem = fs::path(Job.SourcePath).stem().string();
+	const std::string NamePrefix = SourceStem.substr(0, SourceStem.size() - 2); // "<name>_"
+	std::vector<const FHDRIResolution*> Targets;
+	for (const FHDRIResolution& Res : HDRI_RESOLUTIONS)
+	{
+		const std::string TargetPath = (fs::path(Job.SourcePath).parent_path() / (NamePrefix + Res.Suffix + ".hdr")).generic_string();
+		if (TargetPath == Job.SourcePath)
+			continue;
+
+		std::error_code ec;
+		auto it = Ctx.pManifest->Artifacts.find(TargetPath);
+		const bool bCookedBefore = it != Ctx.pManifest->Artifacts.end();
+		const bool bExists = fs::exists(TargetPath, ec);
+		if (bExists && !bCookedBefore)
+			continue;
+		Job.Artifacts.push_back(TargetPath);
+		if (!Ctx.bForce && bExists && it->second == Job.SourceStamp.Hash)
+			continue;
+		Targets.push_back(&Res);
+	}
+	if (Targets.empty())
+	{
+		Job.Result = EJobResult::UpToDate;
+		return;
+	}
+
+	if (FileData.empty() && !ReadFileContents(Job.SourcePath, FileData))
+	{
+		Job.Message = "couldn't read the file";
+		return;
+	}
+	int Width = 0, Height = 0, NumChannels = 0;
+	float* pDecoded = stbi_loadf_from_memory(FileData.data(), static_cast<int>(FileData.size()), &Width, &Height, &NumChannels, 4);
+	FileData = std::vector<uint8>(); // 8k sources: release early
+	if (!pDecoded)
+	{
+		Job.Message = std::string("couldn't decode: ") + stbi_failure_reason();
+		return;
+	}
+
+	Job.Message.clear();
+	bool bSuccess = true;
+	size_t NumWritten = 0;
+	for (const FHDRIResolution* pRes : Targets)
+	{
+		const std::string TargetPath = (fs::path(Job.SourcePath).parent_path() / (NamePrefix + pRes->Suffix + ".hdr")).generic_string();
+		if (pRes->Width > static_cast<uint32>(Width) || pRes->Height > static_cast<uint32>(Height))
+		{
+			Job.Artifacts.erase(std::remove(Job.Artifacts.begin(), Job.Artifacts.end(), TargetPath), Job.Artifacts.end());
+			continue; // only downsizing
+		}
+		const std::vector<float> Resized = ResizeImage(pDecoded, static_cast<uint32>(Width), static_cast<uint32>(Height), pRes->Width, pRes->Height);
+		const std::string TempFilePath = TargetPath + ".tmp";
+		std::error_code ec;
+		const bool bWritten = stbi_write_hdr(TempFilePath.c_str(), static_cast<int>(pRes->Width), static_cast<int>(pRes->Height), 4, Resized.data()) != 0;
+		if (bWritten)
+			fs::rename(TempFilePath, TargetPath, ec);
+		if (!bWritten || ec)
+		{
+			fs::remove(TempFilePath, ec);
+			Job.Message += "couldn't write " + TargetPath + " ";
+			bSuccess = false;
+			continue;
+		}
+		Job.Message += std::string(pRes->Suffix) + " ";
+		++NumWritten;
+	}
+	stbi_image_free(pDecoded);
+	Job.Result = !bSuccess ? EJobResult::Failed : (NumWritten > 0 ? EJobResult::Cooked : EJobResult::UpToDate);
+}
+
+
+
+int main(int argc, char** argv)
+{
+	std::vector<std::string> InputDirectories;
+	unsigned NumThreads = std::max(1u, std::thread::hardware_concurrency());
+	FCookContext Ctx;
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string Arg = argv[i];
+		if (Arg == "-force")
+			Ctx.bForce = true;
+		else if (Arg.rfind("-j=", 0) == 0)
+			NumThreads = std::max(1, atoi(Arg.c_str() + 3));
+		else if (Arg[0] == '-')
+		{
+			PrintUsage();
+			return 1;
+		}
+		else
+			InputDirectories.push_back(Arg);
+	}
+	if (InputDirectories.empty())
+		InputDirectories.push_back("Data");
+
+	FManifest Manifest;
+	Manifest.Load(MANIFEST_FILE_PATH);
+	Ctx.pManifest = &Manifest;
+
+	// gather
+	std::vector<FCookJob> Jobs;
+	auto fnAddJob = [&Jobs](EJobType Type, const std::string& SourcePath)
+	{
+		FCookJob& Job = Jobs.emplace_back();
+		Job.Type = Type;
+		Job.SourcePath = SourcePath;
+	};
+	for (const std::string& Directory : InputDirectories)
+	{
+		std::error_code ec;
+		if (!fs::is_directory(Directory, ec))
+		{
+			fprintf(stderr, "Not a directory: %s\n", Directory.c_str());
+			return 1;
+		}
+		for (const fs::directory_entry& Entry : fs::recursive_directory_iterator(Directory, ec))
+		{
+			if (!Entry.is_regular_file(ec))
+				continue;
+			const std::string Path = Entry.path().lexically_normal().generic_string();
+			if (IsHDRISource(Entry.path()))
+				fnAddJob(EJobType::HDRI, Path);
+			else if (TextureCache::IsCookable(Path))
+				fnAddJob(EJobType::Texture, Path);
+		}
+	}
+	// the HDRIs take the longest, start w/ them so they don't end up as the tail of the build
+	std::stable_partition(Jobs.begin(), Jobs.end(), [](const FCookJob& Job) { return Job.Type == EJobType::HDRI; });
+
+	// cook
+	const auto TimeStart = std::chrono::steady_clock::now();
+	std::atomic<size_t> NextJob = 0;
+	auto fnWorker = [&]()
+	{
+		for (size_t iJob = NextJob.fetch_add(1); iJob < Jobs.size(); iJob = NextJob.fetch_add(1))
+		{
+			FCookJob& Job = Jobs[iJob];
+			switch (Job.Type)
+			{
+			case EJobType::Texture: CookTexture(Ctx, Job); break;
+			case EJobType::HDRI   : CookHDRI(Ctx, Job); break;
+			}
+			if (Job.Result != EJobResult::UpToDate)
+			{
+				std::lock_guard<std::mutex> lk(Ctx.MtxPrint);
+				fprintf(Job.Result == EJobResult::Failed ? stderr : stdout, "[%s] %s: %s\n", Job.Result == EJobResult::Failed ? "FAILED" : "cooked", Job.SourcePath.c_str(), Job.Message.c_str());
+			}
+		}
+	};
+	std::vector<std::thread> Workers;
+	for (unsigned i = 1; i < std::min<size_t>(NumThreads, Jobs.size()); ++i)
+		Workers.emplace_back(fnWorker);
+	fnWorker();
+	for (std::thread& Worker : Workers)
+		Worker.join();
+	const double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - TimeStart).count();
+
+	// update the manifest
+	size_t NumCooked = 0, NumUpToDate = 0, NumFailed = 0;
+	for (const FCookJob& Job : Jobs)
+	{
+		NumCooked   += Job.Result == EJobResult::Cooked   ? 1 : 0;
+		NumUpToDate += Job.Result == EJobResult::UpToDate ? 1 : 0;
+		NumFailed   += Job.Result == EJobResult::Failed   ? 1 : 0;
+		if (Job.Result == EJobResult::Failed)
+			continue;
+		Manifest.Sources[Job.SourcePath] = Job.SourceStamp;
+		for (const std::string& Artifact : Job.Artifacts)
+			Manifest.Artifacts[Artifact] = Job.SourceStamp.Hash;
+	}
+	if (!Manifest.Save(MANIFEST_FILE_PATH))
+		fprintf(stderr, "Couldn't write %s\n", MANIFEST_FILE_PATH.c_str());
+
+	printf("%zu cooked, %zu up to date, %zu failed (%.2fs, %u threads)\n", NumCooked, NumUpToDate, NumFailed, Seconds, NumThreads);
+	return NumFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,148 @@
+//	VQE
+//	Copyright(C) 2020  - Volkan Ilbeyli
+//
+//	This program is free software : you can redistribute it and / or modify
+//	it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or
+//	(at your option) any later version.
+//
+//	This program is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+//	GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License
+//	along with this program.If not, see <http://www.gnu.org/licenses/>.
+//
+//	Contact: volkanilbeyli@gmail.com
+
+//
+// VQPak: packs asset files into a pak file for the VFS, see Engine/Core/PakFile.h
+//
+//   VQPak <output.pak> <file|directory>... [-store] [-blocksize=<KB>]
+//   VQPak -list <file.pak>
+//
+// Run from the engine's working directory (the repo root): the files are stored with their
+// paths relative to it, e.g. Data/Models/Sponza/glTF/Sponza.gltf, and the engine mounts the
+// Data/*.pak files at startup. Directories are packed recursively.
+//
+#include "Engine/Core/PakFile.h"
+
+#include "Libs/VQUtils/Include/Multithreading/ThreadPool.h"
+
+#include <filesystem>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace Pak;
+
+static void PrintUsage()
+{
+	printf("Usage:\n");
+	printf("  VQPak <output.pak> <file|directory>... [-store] [-blocksize=<KB>]\n");
+	printf("  VQPak -list <file.pak>\n");
+}
+
+static std::string GetStoredPath(const std::filesystem::path& FilePath)
+{
+	std::error_code ec;
+	const std::filesystem::path RelativePath = FilePath.is_absolute() ? std::filesystem::relative(FilePath, std::filesystem::current_path(), ec) : FilePath;
+	return NormalizePath(RelativePath.generic_string());
+}
+
+static bool IsPackable(const std::filesystem::path& FilePath)
+{
+	const std::string Extension = FilePath.extension().string();
+	return _stricmp(Extension.c_str(), ".pak") != 0 && _stricmp(Extension.c_str(), ".tmp") != 0;
+}
+
+static int ListPak(const std::string& PakFilePath)
+{
+	FPakArchive Archive;
+	if (!Archive.Open(PakFilePath))
+	{
+		fprintf(stderr, "Couldn't open %s\n", PakFilePath.c_str());
+		return 1;
+	}
+
+	uint64 NumBytes = 0, NumStoredBytes = 0;
+	for (uint32 i = 0; i < Archive.GetNumEntries(); ++i)
+	{
+		const FPakEntry& Entry = Archive.GetEntry(i);
+		printf("%12llu %12llu %-4s %s\n", Entry.Size, Entry.StoredSize, Entry.Codec == PAK_CODEC_LZ4 ? "lz4" : "-", Archive.GetPath(Entry));
+		NumBytes += Entry.Size;
+		NumStoredBytes += Entry.StoredSize;
+	}
+	printf("%u files, %llu bytes stored in %llu (pak file: %llu bytes)\n", Archive.GetNumEntries(), NumBytes, NumStoredBytes, Archive.GetHeader().FileSize);
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc == 3 && strcmp(argv[1], "-list") == 0)
+		return ListPak(argv[2]);
+	if (argc < 3)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	const std::string PakFilePath = argv[1];
+	FPakWriteParams Params;
+	std::vector<FPakInputFile> Files;
+	for (int i = 2; i < argc; ++i)
+	{
+		const std::string Arg = argv[i];
+		if (Arg == "-store")
+		{
+			Params.bCompress = false;
+			continue;
+		}
+		if (Arg.rfind("-blocksize=", 0) == 0)
+		{
+			Params.BlockSize = static_cast<uint32>(std::stoul(Arg.substr(strlen("-blocksize=")))) << 10;
+			continue;
+		}
+
+		std::error_code ec;
+		const std::filesystem::path InputPath = Arg;
+		if (std::filesystem::is_directory(InputPath, ec))
+		{
+			for (const std::filesystem::directory_entry& Entry : std::filesystem::recursive_directory_iterator(InputPath, ec))
+			{
+				if (Entry.is_regular_file(ec) && IsPackable(Entry.path()))
+					Files.push_back({ GetStoredPath(Entry.path()), Entry.path().string() });
+			}
+		}
+		else if (std::filesystem::is_regular_file(InputPath, ec))
+		{
+			Files.push_back({ GetStoredPath(InputPath), InputPath.string() });
+		}
+		else
+		{
+			fprintf(stderr, "Not found: %s\n", Arg.c_str());
+			return 1;
+		}
+	}
+	if (Files.empty() || Params.BlockSize == 0)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	ThreadPool Workers;
+	Workers.Initialize(ThreadPool::sHardwareThreadCount, "VQPakWorkers");
+	FPakWriteStats Stats;
+	const bool bSuccess = WritePakFile(PakFilePath, std::move(Files), Params, &Workers, &Stats);
+	Workers.Destroy();
+	if (!bSuccess)
+	{
+		fprintf(stderr, "Failed writing %s\n", PakFilePath.c_str());
+		return 1;
+	}
+
+	printf("%s: %u files (%u compressed), %llu bytes -> %llu bytes\n", PakFilePath.c_str(), Stats.NumEntries, Stats.NumCompressedEntries, Stats.NumSourceBytes, Stats.NumStoredBytes);
+	return 0;
+}